@@ -23,6 +23,7 @@ enum WS2812_USB_CTRL {
 	LED_COUNT, /**< Command to specify the number of LEDs in the strip. */
 	REQUEST_LEN, /**< Command to request the length of the LED strip. */
 	REQUEST_LED_DATA, /**< Command to request the pixeldata. */
+	SAVE_BOOT_FRAME, /**< Command to store the current pixeldata as boot frame in flash. */
 	LED_CLEAR = 0x99 /**< Command to clear all LEDs (off). */
 };
 
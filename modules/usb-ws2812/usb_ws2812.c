@@ -19,6 +19,7 @@
 #include <../../include/linux/kthread.h>
 #include <../../include/linux/delay.h>
 #include <../../include/linux/list.h>
+#include <../../include/linux/uio.h>
 #include "usb_packets.h"
 #include "dev_packets.h"
 
@@ -233,6 +234,7 @@ struct ws2812 {
 
 	/* Others */
 	ws2812_pixel_buffer pixeldata; /**< Pixel Buffer */
+	bool pixeldata_dirty; /**< Pixel buffer changed, is sent at the end of the write() */
 	struct list_head request_list; /**< List of ws2812_read_request's */
 };
 
@@ -1071,20 +1073,78 @@ static void ws2812_usb_write_pixeldata_buffer(struct ws2812 *ws2812_struct)
 	mutex_unlock(lock);
 }
 
+/**
+ * @brief Sends the pixel data buffer if it was changed since the last transfer.
+ *
+ * Static pixel data packets only mark the buffer as dirty, so a write() with
+ * several pixel data packets (e.g. a batch of regions) transfers the buffer once.
+ *
+ * @param ws2812_struct Pointer to the ws2812 structure representing the USB device.
+ */
+static void ws2812_usb_flush_pixeldata_buffer(struct ws2812 *ws2812_struct)
+{
+	if (!ws2812_struct->pixeldata_dirty) {
+		return;
+	}
+	ws2812_struct->pixeldata_dirty = false;
+	ws2812_usb_write_pixeldata_buffer(ws2812_struct);
+	LOG_INFO("USB pixel data packet(s) sent\n");
+}
+
+/**
+ * @brief Parses and processes all packets of a buffer written by user space.
+ *
+ * The packets are handled in order by calling `ws2812_dev_file_parse_user_packet`,
+ * until all data is handled or a packet is invalid. Pixel data of consecutive
+ * pixel packets is sent to the device once at the end.
+ *
+ * @param ws2812_struct Pointer to the ws2812 structure representing the USB device.
+ * @param buf Kernel copy of the written data.
+ * @param len Length of the data.
+ *
+ * @return On success, returns len indicating that all data was processed. On failure, returns a
+ *         negative error code.
+ */
+static ssize_t ws2812_dev_file_parse_buffer(struct ws2812 *ws2812_struct,
+					    uint8_t *buf, size_t len)
+{
+	ws2812_usb_packet packet;
+	ssize_t bytes_read = 0;
+	uint8_t *next_packet = buf;
+	ssize_t bytes_left = len;
+	// parse the userdata
+	while (bytes_left > 0) {
+		bytes_read = ws2812_dev_file_parse_user_packet(
+			ws2812_struct, next_packet, bytes_left, &packet);
+		if (bytes_read <= 0) {
+			break;
+		}
+		next_packet += bytes_read;
+		bytes_left -= bytes_read;
+	}
+
+	// Pixeldaten aller Pakete dieses write() nur einmal senden
+	ws2812_usb_flush_pixeldata_buffer(ws2812_struct);
+
+	if (bytes_read <= 0) {
+		return bytes_read;
+	}
+	return len;
+}
+
 /**
  * @brief Writes data from user space to the WS2812 USB device.
  *
  * This function writes data received from user space to the WS2812 USB device. It allocates a buffer
- * to copy user data, then parses and processes the data in the form of packets. The function handles
- * each packet by calling `ws2812_dev_file_parse_user_packet`. It ensures that all packets are processed
- * sequentially until all user data is handled.
+ * to copy user data, then parses and processes the data in the form of packets with
+ * `ws2812_dev_file_parse_buffer`.
  *
  * @param file Pointer to the file structure representing the open file.
  * @param user_buf Pointer to the user buffer containing data to be written.
  * @param len Length of the data in the user buffer.
  * @param off_set Pointer to a long offset type, indicating the file position the user is accessing.
  *
- * @return On success, returns 0 indicating that all data was processed. On failure, returns a
+ * @return On success, returns len indicating that all data was processed. On failure, returns a
  *         negative error code.
  */
 static ssize_t ws2812_usb_write(struct file *file, const char *user_buf,
@@ -1095,37 +1155,57 @@ static ssize_t ws2812_usb_write(struct file *file, const char *user_buf,
 	uint8_t *buf = NULL;
 	ws2812_struct = file->private_data;
 
-	ws2812_usb_packet packet;
 	buf = kmalloc(len, GFP_KERNEL);
 	if (!buf) {
 		return -ENOMEM;
 	}
 
 	if (copy_from_user(buf, user_buf, len)) {
+		kfree(buf);
 		return -EFAULT;
 	}
 
-	ssize_t bytes_read = 0;
-	uint8_t *next_packet = buf;
-	ssize_t bytes_left = len;
-	// parse the userdata
-	while (bytes_left > 0) {
-		bytes_read = ws2812_dev_file_parse_user_packet(
-			ws2812_struct, next_packet, bytes_left, &packet);
-		if (bytes_read <= 0) {
-			return bytes_read;
-		}
-		next_packet += bytes_read;
-		bytes_left -= bytes_read;
+	ssize_t ret = ws2812_dev_file_parse_buffer(ws2812_struct, buf, len);
+	kfree(buf);
+	return ret;
+}
+
+/**
+ * @brief Writes scattered data from user space (writev) to the WS2812 USB device.
+ *
+ * Without this function the VFS calls ws2812_usb_write() once per iovec, so a packet
+ * header and its pixel data in different iovecs would be parsed as two incomplete
+ * packets. The segments are gathered into one buffer with a single copy and parsed
+ * like the data of a write().
+ *
+ * @param iocb Pointer to the kiocb of the write request.
+ * @param from Iterator over the user buffers.
+ *
+ * @return On success, returns the number of bytes written. On failure, returns a
+ *         negative error code.
+ */
+static ssize_t ws2812_usb_write_iter(struct kiocb *iocb, struct iov_iter *from)
+{
+	size_t len = iov_iter_count(from);
+	LOG_DEBUG("ws2812_usb_write_iter", "len = %ld", len);
+	struct ws2812 *ws2812_struct = iocb->ki_filp->private_data;
+
+	if (len == 0) {
+		return 0;
+	}
+	uint8_t *buf = kmalloc(len, GFP_KERNEL);
+	if (!buf) {
+		return -ENOMEM;
 	}
 
-	return 0;
-	// test:
-	if (copy_from_user(&packet, user_buf, sizeof(ws2812_usb_packet))) {
+	if (copy_from_iter(buf, len, from) != len) {
+		kfree(buf);
 		return -EFAULT;
 	}
 
-	return ws2812_usb_write_packet(ws2812_struct, &packet);
+	ssize_t ret = ws2812_dev_file_parse_buffer(ws2812_struct, buf, len);
+	kfree(buf);
+	return ret;
 }
 
 /*============================================================================*\
@@ -1184,6 +1264,33 @@ static ssize_t ws2812_ctrl_start_mode(struct ws2812 *ws2812_struct,
 	return start_mode_cb(ws2812_struct, new_mode);
 }
 
+/**
+ * @brief Stores the frame currently shown by the WS2812 USB controller as boot frame.
+ *
+ * This function sends a 'save boot frame' packet to the WS2812 USB device. The controller
+ * writes its current LED count and pixeldata to flash and shows this frame directly after
+ * the next power-up. The packet is queued behind all pixeldata packets that were already
+ * submitted, so the saved frame contains all previous updates.
+ *
+ * @param ws2812_struct Pointer to the ws2812 structure representing the USB device.
+ *
+ * @return Returns 0 on success, or a negative error code if the packet couldn't be sent.
+ */
+static ssize_t ws2812_ctrl_save_boot_frame(struct ws2812 *ws2812_struct)
+{
+	LOG_DEBUG("ws2812_ctrl_save_boot_frame", "");
+	ws2812_usb_packet save_packet = {
+		.ctrl = SAVE_BOOT_FRAME,
+	};
+
+	ssize_t error = ws2812_usb_write_packet(ws2812_struct, &save_packet);
+	if (error < 0) {
+		return error;
+	}
+	LOG_INFO("USB save boot frame packet sent.");
+	return 0;
+}
+
 /*======================================*\
  * Mode Callbacks
 \*======================================*/
@@ -1259,6 +1366,7 @@ static ssize_t ws2812_ctrl_static_set_length(struct ws2812 *ws2812_struct,
 
 	ws2812_usb_write_packet(ws2812_struct,
 				(ws2812_usb_packet *)&count_packet);
+	ws2812_struct->pixeldata_dirty = false;
 	ws2812_usb_write_pixeldata_buffer(ws2812_struct);
 
 	LOG_INFO("USB length packet sent");
@@ -1330,10 +1438,9 @@ static ssize_t ws2812_ctrl_static_set_pixeldata(struct ws2812 *ws2812_struct,
 		ws2812_struct->pixeldata.buffer[offset + i].blue = data[i].blue;
 	}
 	mutex_unlock(&ws2812_struct->pixeldata.buffer_mutex);
-	// write to device
-	ws2812_usb_write_pixeldata_buffer(ws2812_struct);
-
-	LOG_INFO("USB pixel data packet(s) sent\n");
+	// write to device at the end of the write(), so several pixel packets
+	// in one write() only cause one transfer of the buffer
+	ws2812_struct->pixeldata_dirty = true;
 
 	return 0;
 }
@@ -1641,12 +1748,18 @@ static ssize_t ws2812_dev_file_parse_user_packet(struct ws2812 *ws2812_struct,
 	ssize_t bytes_read = 0;
 	uint8_t ctrl = buffer[0];
 
+	// Aufeinanderfolgende Pixelpakete werden zusammen gesendet, vor allen
+	// anderen Paketen muessen sie aber raus (Reihenfolge bleibt erhalten).
+	if (ctrl != CHAR_LED_PIXEL_DATA) {
+		ws2812_usb_flush_pixeldata_buffer(ws2812_struct);
+	}
+
 	switch (ctrl) {
 	case CHAR_LED_LEN:
 		if (len < sizeof(led_len)) {
 			LOG_ERROR(
 				"Parsing of Length packet failed. Too small!");
-			return EBADMSG; // Kein vollständiges Paket!
+			return -EBADMSG; // Kein vollständiges Paket!
 		}
 		led_len *led_len_packet = (led_len *)(buffer);
 
@@ -1679,7 +1792,7 @@ static ssize_t ws2812_dev_file_parse_user_packet(struct ws2812 *ws2812_struct,
 			LOG_ERROR(
 				"Parsing of Pixeldata packet failed. Too small! Expected: %ld, got: %ld",
 				led_pixel_len, len - bytes_read);
-			return EBADMSG; // Kein vollständiges Paket!
+			return -EBADMSG; // Kein vollständiges Paket!
 		}
 		// Callback aufrufen
 		f_user_packet_cb pixel_cb =
@@ -1697,7 +1810,7 @@ static ssize_t ws2812_dev_file_parse_user_packet(struct ws2812 *ws2812_struct,
 	case CHAR_LED_CLEAR:
 		if (len < sizeof(led_clear)) {
 			LOG_ERROR("Parsing of Clear packet failed. Too small!");
-			return EBADMSG; // Kein vollständiges Paket!
+			return -EBADMSG; // Kein vollständiges Paket!
 		}
 
 		// Callback aufrufen
@@ -1714,14 +1827,14 @@ static ssize_t ws2812_dev_file_parse_user_packet(struct ws2812 *ws2812_struct,
 
 		if (len < sizeof(led_set_mode_s)) {
 			LOG_ERROR("Parsing of Mode packet failed. Too small!");
-			return EBADMSG; // Kein vollständiges Paket!
+			return -EBADMSG; // Kein vollständiges Paket!
 		}
 		led_set_mode_s *new_mode_packet = (led_set_mode_s *)buffer;
 		uint8_t new_mode_id = new_mode_packet->mode;
 		size_t packet_size = ws2812_get_mode_packet_size(new_mode_id);
 		if (len < packet_size) {
 			LOG_ERROR("Parsing of Mode packet failed. Too small!");
-			return EBADMSG; // Kein vollständiges Paket!
+			return -EBADMSG; // Kein vollständiges Paket!
 		}
 		led_set_mode *new_mode = (led_set_mode *)buffer;
 		bytes_read += packet_size;
@@ -1742,7 +1855,7 @@ static ssize_t ws2812_dev_file_parse_user_packet(struct ws2812 *ws2812_struct,
 		if (len < sizeof(led_get_data)) {
 			LOG_ERROR(
 				"Parsing of data request packet failed. Too small!");
-			return EBADMSG; // Kein vollständiges Paket!
+			return -EBADMSG; // Kein vollständiges Paket!
 		}
 		led_get_data *p_request = (led_get_data *)buffer;
 
@@ -1753,6 +1866,21 @@ static ssize_t ws2812_dev_file_parse_user_packet(struct ws2812 *ws2812_struct,
 		if (error < 0) {
 			return error;
 		}
+		bytes_read += sizeof(led_get_data);
+		break;
+	case CHAR_LED_SAVE_BOOT_FRAME:
+		if (len < sizeof(led_save_boot_frame)) {
+			LOG_ERROR(
+				"Parsing of save boot frame packet failed. Too small!");
+			return -EBADMSG; // Kein vollständiges Paket!
+		}
+
+		error = ws2812_ctrl_save_boot_frame(ws2812_struct);
+		if (error < 0) {
+			return error;
+		}
+		bytes_read += sizeof(led_save_boot_frame);
+
 		break;
 	default:
 		LOG_ERROR("Parsing failed! Unknown packet ctrl: %d", ctrl);
@@ -1868,6 +1996,7 @@ struct file_operations ws2812_dev_file_ops = {
 	.open = ws2812_dev_file_open,
 	.read = ws2812_usb_read,
 	.write = ws2812_usb_write,
+	.write_iter = ws2812_usb_write_iter,
 	.release = ws2812_dev_file_release,
 };
 
@@ -1916,6 +2045,7 @@ static int ws2812_usb_probe(struct usb_interface *interface,
 	ws2812_struct->parse_data_destination = &ws2812_struct->pixeldata;
 
 	ws2812_init_pixel_buffer(&ws2812_struct->pixeldata, 0);
+	ws2812_struct->pixeldata_dirty = false;
 
 	ws2812_struct->mode = CHAR_LED_MODE_STATIC;
 	ws2812_struct->parse_cb = &mode_callbacks[CHAR_LED_MODE_STATIC];
@@ -1970,8 +2100,9 @@ static int ws2812_usb_probe(struct usb_interface *interface,
 
 	struct usb_device *dev = ws2812_struct->usb_dev;
 	LOG_INFO(
-		"Found device!\n  ID: %x,%x\n  Minor: %d\n  Serial: %s\n  Endpoint in: %x (%ld bytes)\n  Endpoint out: %x",
+		"Found device!\n  ID: %x,%x\n  Interface: %d\n  Minor: %d\n  Serial: %s\n  Endpoint in: %x (%ld bytes)\n  Endpoint out: %x",
 		dev->descriptor.idVendor, dev->descriptor.idProduct,
+		interface->cur_altsetting->desc.bInterfaceNumber,
 		interface->minor, dev->serial,
 		ws2812_struct->bulk_in_endpointAddr,
 		ws2812_struct->bulk_in_size,
@@ -0,0 +1,7 @@
+#/bin/bash
+
+cd "$(dirname "$0")"
+mkdir -p build
+cd build
+cmake ..
+make
@@ -0,0 +1,395 @@
+/**
+ * @file fw_bench.c                                                            *
+ * @brief Feeds recorded or synthetic USB packet streams into the host build   *
+ *        of the firmware and measures the handler throughput.                *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#include <argp.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "host_shim.h"
+#include "tusb_config.h"
+#include "usb_packets.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+// rdtsc zählt mit der Nennfrequenz, nicht in Kerntakten (Turbo, Stromsparen)
+#define BENCH_TICK_UNIT "TSC-Ticks"
+#define BENCH_TICK_TSC 1
+static inline uint64_t bench_ticks(void)
+{
+	return __rdtsc();
+}
+#else
+#define BENCH_TICK_UNIT "ns"
+static inline uint64_t bench_ticks(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+#endif
+
+/**
+ * @def BENCH_PACKET_SIZE
+ * @brief Größe eines USB-Pakets im Stream.
+ */
+#define BENCH_PACKET_SIZE CFG_TUD_VENDOR_RX_BUFSIZE
+
+/**
+ * @def BENCH_PIXEL_PER_PACKET
+ * @brief Anzahl der Pixel in einem LED_DATA-Paket.
+ */
+#define BENCH_PIXEL_PER_PACKET 21
+
+const char *argp_program_version = "fw-bench";
+const char *argp_program_bug_address = "";
+static char doc[] =
+	"fw-bench spielt einen USB-Paketstrom in die Host-Version der Firmware ein und misst den Durchsatz der Paket-Handler. "
+	"Ein Strom ist eine Datei aus aneinandergereihten 64-Byte-Paketen für Interface 0. "
+	"Ohne --input wird ein Strom aus einem LED_COUNT-Paket und --frames Frames mit --leds Pixeln erzeugt.";
+static char args_doc[] = "";
+
+/**
+ * @struct argp_option
+ * @brief Structure for command-line options
+ */
+static struct argp_option options[] = {
+	{ "input", 'i', "FILE", 0, "Aufgezeichneter Paketstrom" },
+	{ "output", 'o', "FILE", 0, "Schreibt den verwendeten Paketstrom in eine Datei" },
+	{ "leds", 'n', "NUM", 0, "Anzahl der LEDs im erzeugten Strom (Standard 300)" },
+	{ "frames", 'f', "NUM", 0, "Anzahl der Frames im erzeugten Strom (Standard 1000)" },
+	{ "repeat", 'r', "NUM", 0, "Wie oft der Strom eingespielt wird (Standard 10)" },
+	{ 0 },
+};
+
+/**
+ * @struct arguments
+ * @brief Structure to hold command-line arguments
+ */
+struct arguments {
+	char *input;
+	char *output;
+	uint32_t leds;
+	uint32_t frames;
+	uint32_t repeat;
+};
+
+/**
+ * @brief Parses an unsigned number argument.
+ */
+static int parse_number(const char *arg, uint32_t *value)
+{
+	char *end;
+	unsigned long v = strtoul(arg, &end, 0);
+
+	if (*arg == '\0' || *end != '\0' || v > UINT32_MAX) {
+		printf("Error: %s is not a number\n", arg);
+		return -1;
+	}
+	*value = v;
+	return 0;
+}
+
+/**
+ * @brief Callback function to parse command-line options
+ */
+static error_t parse_opt(int key, char *arg, struct argp_state *state)
+{
+	struct arguments *arg_s = state->input;
+	switch (key) {
+	case 'i':
+		arg_s->input = arg;
+		break;
+	case 'o':
+		arg_s->output = arg;
+		break;
+	case 'n':
+		if (parse_number(arg, &arg_s->leds) < 0)
+			return ARGP_KEY_ERROR;
+		break;
+	case 'f':
+		if (parse_number(arg, &arg_s->frames) < 0)
+			return ARGP_KEY_ERROR;
+		break;
+	case 'r':
+		if (parse_number(arg, &arg_s->repeat) < 0)
+			return ARGP_KEY_ERROR;
+		break;
+	default:
+		return ARGP_ERR_UNKNOWN;
+	}
+	return 0;
+}
+
+static struct argp argp = { options, parse_opt, args_doc, doc, 0, 0, 0 };
+
+/**
+ * @struct bench_stream
+ * @brief A stream of USB packets.
+ */
+struct bench_stream {
+	uint8_t (*packets)[BENCH_PACKET_SIZE]; /**< The packets. */
+	size_t count; /**< Number of packets. */
+};
+
+/**
+ * @struct bench_stats
+ * @brief Measured times for one kind of packet.
+ */
+struct bench_stats {
+	uint64_t packets; /**< Number of handled packets. */
+	uint64_t ticks; /**< Ticks spent in tud_vendor_rx_cb(). */
+};
+
+/**
+ * @brief Reads a recorded stream, a trailing partial packet is ignored.
+ *
+ * @return 0 on success, -1 on error.
+ */
+static int bench_stream_read(struct bench_stream *stream, const char *path)
+{
+	FILE *file = fopen(path, "rb");
+	size_t capacity = 1024;
+
+	if (!file) {
+		printf("Kann %s nicht öffnen: %s\n", path, strerror(errno));
+		return -1;
+	}
+	stream->count = 0;
+	stream->packets = malloc(capacity * BENCH_PACKET_SIZE);
+	while (stream->packets) {
+		if (stream->count == capacity) {
+			capacity *= 2;
+			void *tmp = realloc(stream->packets,
+					    capacity * BENCH_PACKET_SIZE);
+			if (!tmp) {
+				free(stream->packets);
+				stream->packets = NULL;
+				break;
+			}
+			stream->packets = tmp;
+		}
+		if (fread(stream->packets[stream->count], BENCH_PACKET_SIZE, 1,
+			  file) != 1) {
+			break;
+		}
+		stream->count++;
+	}
+	fclose(file);
+	if (!stream->packets) {
+		printf("Kein Speicher für den Paketstrom\n");
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * @brief Creates a stream: one LED_COUNT packet followed by the frames.
+ *
+ * Every frame shifts a color ramp by one pixel, so consecutive frames differ.
+ *
+ * @return 0 on success, -1 on error.
+ */
+static int bench_stream_generate(struct bench_stream *stream, uint32_t leds,
+				 uint32_t frames)
+{
+	size_t per_frame = (leds + BENCH_PIXEL_PER_PACKET - 1) /
+			   BENCH_PIXEL_PER_PACKET;
+
+	stream->count = 1 + per_frame * frames;
+	stream->packets = calloc(stream->count, BENCH_PACKET_SIZE);
+	if (!stream->packets) {
+		printf("Kein Speicher für den Paketstrom\n");
+		return -1;
+	}
+
+	ws2812_usb_packet_count *count_pkg =
+		(ws2812_usb_packet_count *)stream->packets[0];
+	count_pkg->ctrl = LED_COUNT;
+	count_pkg->led_count_H = leds >> 8;
+	count_pkg->led_count_L = leds & 0xFF;
+
+	size_t p = 1;
+	for (uint32_t f = 0; f < frames; f++) {
+		for (uint32_t led = 0; led < leds; led++) {
+			if (led % BENCH_PIXEL_PER_PACKET == 0 && led != 0) {
+				p++;
+			}
+			ws2812_usb_packet_pixeldata *pkg =
+				(ws2812_usb_packet_pixeldata *)stream->packets[p];
+			ws2812_pixel *pixel =
+				&pkg->color_data[led % BENCH_PIXEL_PER_PACKET];
+			uint8_t v = led + f;
+			pkg->ctrl = LED_DATA;
+			pixel->red = v;
+			pixel->green = v * 3;
+			pixel->blue = 255 - v;
+		}
+		p++;
+	}
+	return 0;
+}
+
+/**
+ * @brief Writes a stream to a file.
+ *
+ * @return 0 on success, -1 on error.
+ */
+static int bench_stream_write(const struct bench_stream *stream,
+			      const char *path)
+{
+	FILE *file = fopen(path, "wb");
+
+	if (!file) {
+		printf("Kann %s nicht öffnen: %s\n", path, strerror(errno));
+		return -1;
+	}
+	if (fwrite(stream->packets, BENCH_PACKET_SIZE, stream->count, file) !=
+	    stream->count) {
+		printf("Fehler beim Schreiben von %s\n", path);
+		fclose(file);
+		return -1;
+	}
+	return fclose(file);
+}
+
+/**
+ * @brief Counts the pixels of all state machines written so far.
+ */
+static uint64_t bench_pio_words(void)
+{
+	uint64_t words = 0;
+
+	for (int sm = 0; sm < HOST_PIO_SM_COUNT; sm++) {
+		words += pio0->sm[sm].tx_words;
+	}
+	return words;
+}
+
+/**
+ * @brief Returns the monotonic time in nanoseconds.
+ */
+static uint64_t bench_now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+int main(int argc, char **argv)
+{
+	struct arguments arguments = {
+		.leds = 300,
+		.frames = 1000,
+		.repeat = 10,
+	};
+	struct bench_stream stream;
+	struct bench_stats stats[256];
+	uint64_t task_ticks = 0;
+	uint64_t task_pixels = 0;
+	uint64_t packets = 0;
+
+	argp_parse(&argp, argc, argv, 0, 0, &arguments);
+
+	if (arguments.input) {
+		if (bench_stream_read(&stream, arguments.input) < 0) {
+			return EXIT_FAILURE;
+		}
+	} else {
+		if (arguments.leds == 0 || arguments.leds > 1000) {
+			printf("Die Anzahl der LEDs muss zwischen 1 und 1000 liegen\n");
+			return EXIT_FAILURE;
+		}
+		if (bench_stream_generate(&stream, arguments.leds,
+					  arguments.frames) < 0) {
+			return EXIT_FAILURE;
+		}
+	}
+	if (arguments.output &&
+	    bench_stream_write(&stream, arguments.output) < 0) {
+		return EXIT_FAILURE;
+	}
+
+	memset(stats, 0, sizeof(stats));
+	host_shim_init();
+	ws2812b_init();
+	uint64_t init_words = bench_pio_words();
+	uint64_t init_time_us = host_time_us();
+
+	uint64_t start_ns = bench_now_ns();
+	uint64_t start_ticks = bench_ticks();
+	for (uint32_t r = 0; r < arguments.repeat; r++) {
+		for (size_t i = 0; i < stream.count; i++) {
+			const uint8_t *pkg = stream.packets[i];
+
+			uint64_t t0 = bench_ticks();
+			host_usb_receive(0, pkg, BENCH_PACKET_SIZE);
+			uint64_t t1 = bench_ticks();
+
+			uint64_t words = bench_pio_words();
+			ws2812b_task();
+			uint64_t t2 = bench_ticks();
+
+			stats[pkg[0]].packets++;
+			stats[pkg[0]].ticks += t1 - t0;
+			if (bench_pio_words() != words) {
+				task_ticks += t2 - t1;
+				task_pixels += bench_pio_words() - words;
+			}
+			packets++;
+		}
+	}
+	uint64_t elapsed_ticks = bench_ticks() - start_ticks;
+	uint64_t elapsed_ns = bench_now_ns() - start_ns;
+
+	printf("Pakete:                %" PRIu64 "\n", packets);
+	printf("Laufzeit:              %.3f ms\n", elapsed_ns / 1e6);
+	printf("Durchsatz:             %.0f Pakete/s\n",
+	       elapsed_ns ? packets * 1e9 / elapsed_ns : 0.0);
+#ifdef BENCH_TICK_TSC
+	printf("TSC-Frequenz:          %.3f GHz (gemessen, Ticks / ns)\n",
+	       elapsed_ns ? (double)elapsed_ticks / elapsed_ns : 0.0);
+#else
+	(void)elapsed_ticks;
+#endif
+	for (int ctrl = 0; ctrl < 256; ctrl++) {
+		if (!stats[ctrl].packets) {
+			continue;
+		}
+		printf("  ctrl 0x%02x:           %" PRIu64 " Pakete, %.1f %s/Paket",
+		       ctrl, stats[ctrl].packets,
+		       (double)stats[ctrl].ticks / stats[ctrl].packets,
+		       BENCH_TICK_UNIT);
+		if (ctrl == LED_DATA) {
+			// Bezogen auf 21 Pixel pro Paket, auch beim letzten Paket eines Frames
+			printf(", %.2f %s/Pixel",
+			       (double)stats[ctrl].ticks /
+				       (stats[ctrl].packets *
+					BENCH_PIXEL_PER_PACKET),
+			       BENCH_TICK_UNIT);
+		}
+		printf("\n");
+	}
+	if (task_pixels) {
+		printf("ws2812b_task:          %" PRIu64 " Pixel, %.2f %s/Pixel\n",
+		       task_pixels, (double)task_ticks / task_pixels,
+		       BENCH_TICK_UNIT);
+	}
+	printf("PIO-Wörter:            %" PRIu64 " (Prüfsumme %08" PRIx32 ")\n",
+	       bench_pio_words() - init_words, pio0->sm[0].tx_checksum);
+	printf("Simulierte Sleep-Zeit: %.3f ms\n",
+	       (host_time_us() - init_time_us) / 1e3);
+
+	free(stream.packets);
+	return EXIT_SUCCESS;
+}
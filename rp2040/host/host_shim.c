@@ -0,0 +1,181 @@
+/**
+ * @file host_shim.c                                                           *
+ * @brief Host implementation of the pico-sdk and TinyUSB functions used by    *
+ *        the firmware.                                                       *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "host_shim.h"
+#include "tusb.h"
+#include "hardware/clocks.h"
+#include "hardware/flash.h"
+#include "pico/time.h"
+#include "pico/unique_id.h"
+
+uint8_t host_flash[PICO_FLASH_SIZE_BYTES];
+pio_host host_pio0;
+uint32_t host_clk_sys_hz = 125000000;
+
+static host_pio_tx_hook pio_tx_hook;
+static void *pio_tx_hook_arg;
+static host_usb_in_hook usb_in_hook;
+static void *usb_in_hook_arg;
+static uint64_t time_us;
+
+/**
+ * @brief The packet currently delivered to the firmware.
+ */
+static struct {
+	const uint8_t *data;
+	uint32_t len;
+	uint32_t pos;
+} usb_rx[CFG_TUD_VENDOR];
+
+void host_shim_init(void)
+{
+	memset(host_flash, 0xFF, sizeof(host_flash));
+	memset(&host_pio0, 0, sizeof(host_pio0));
+	memset(usb_rx, 0, sizeof(usb_rx));
+	time_us = 0;
+}
+
+void host_pio_set_tx_hook(host_pio_tx_hook hook, void *arg)
+{
+	pio_tx_hook = hook;
+	pio_tx_hook_arg = arg;
+}
+
+void host_usb_set_in_hook(host_usb_in_hook hook, void *arg)
+{
+	usb_in_hook = hook;
+	usb_in_hook_arg = arg;
+}
+
+void host_usb_receive(uint8_t itf, const void *packet, uint32_t len)
+{
+	assert(itf < CFG_TUD_VENDOR);
+	usb_rx[itf].data = packet;
+	usb_rx[itf].len = len;
+	usb_rx[itf].pos = 0;
+	tud_vendor_rx_cb(itf);
+	usb_rx[itf].data = NULL;
+}
+
+uint64_t host_time_us(void)
+{
+	return time_us;
+}
+
+/* pico/time.h */
+
+void sleep_us(uint64_t us)
+{
+	time_us += us;
+}
+
+/* pico/unique_id.h */
+
+void pico_get_unique_board_id_string(char *id_out, uint32_t len)
+{
+	static const char id[] = "C0FFEE0000002812";
+
+	if (len == 0) {
+		return;
+	}
+	strncpy(id_out, id, len - 1);
+	id_out[len - 1] = '\0';
+}
+
+/* hardware/flash.h */
+
+void flash_range_erase(uint32_t flash_offs, size_t count)
+{
+	assert(flash_offs % FLASH_SECTOR_SIZE == 0);
+	assert(count % FLASH_SECTOR_SIZE == 0);
+	assert(flash_offs + count <= sizeof(host_flash));
+	memset(host_flash + flash_offs, 0xFF, count);
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data,
+			 size_t count)
+{
+	assert(flash_offs % FLASH_PAGE_SIZE == 0);
+	assert(count % FLASH_PAGE_SIZE == 0);
+	assert(flash_offs + count <= sizeof(host_flash));
+	for (size_t i = 0; i < count; i++) {
+		host_flash[flash_offs + i] &= data[i];
+	}
+}
+
+/* hardware/pio.h */
+
+uint pio_add_program(PIO pio, const pio_program_t *program)
+{
+	uint offset = pio->instr_used;
+
+	assert(offset + program->length <= HOST_PIO_INSTRUCTION_COUNT);
+	// JMP-Ziele sind im generierten Programm relativ zu 0
+	for (uint i = 0; i < program->length; i++) {
+		uint16_t instr = program->instructions[i];
+		if ((instr & 0xE000) == 0x0000) {
+			instr += offset;
+		}
+		pio->instr_mem[offset + i] = instr;
+	}
+	pio->instr_used += program->length;
+	return offset;
+}
+
+void pio_sm_init(PIO pio, uint sm, uint initial_pc,
+		 const pio_sm_config *config)
+{
+	assert(sm < HOST_PIO_SM_COUNT);
+	pio->sm[sm].config = *config;
+	pio->sm[sm].initial_pc = initial_pc;
+	pio->sm[sm].enabled = false;
+}
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data)
+{
+	pio->sm[sm].tx_words++;
+	pio->sm[sm].tx_checksum = (pio->sm[sm].tx_checksum << 1 |
+				   pio->sm[sm].tx_checksum >> 31) ^
+				  data;
+	if (pio_tx_hook) {
+		pio_tx_hook(pio, sm, data, pio_tx_hook_arg);
+	}
+}
+
+/* tusb.h */
+
+uint32_t tud_vendor_n_read(uint8_t itf, void *buffer, uint32_t bufsize)
+{
+	uint32_t n = usb_rx[itf].len - usb_rx[itf].pos;
+
+	if (!usb_rx[itf].data) {
+		return 0;
+	}
+	if (n > bufsize) {
+		n = bufsize;
+	}
+	memcpy(buffer, usb_rx[itf].data + usb_rx[itf].pos, n);
+	usb_rx[itf].pos += n;
+	return n;
+}
+
+void tud_vendor_n_read_flush(uint8_t itf)
+{
+	usb_rx[itf].pos = usb_rx[itf].len;
+}
+
+uint32_t tud_vendor_n_write(uint8_t itf, void const *buffer, uint32_t bufsize)
+{
+	if (usb_in_hook) {
+		usb_in_hook(itf, buffer, bufsize, usb_in_hook_arg);
+	}
+	return bufsize;
+}
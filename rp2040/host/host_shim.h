@@ -0,0 +1,85 @@
+/**
+ * @file host_shim.h                                                           *
+ * @brief Interface between the host shims and the host programs.             *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#ifndef _HOST_SHIM_H_
+#define _HOST_SHIM_H_
+
+#include <stdint.h>
+#include "hardware/pio.h"
+
+/**
+ * @brief Callback for every word the firmware writes to a TX FIFO.
+ *
+ * @param pio The PIO block.
+ * @param sm The state machine.
+ * @param data The word.
+ * @param arg The argument passed to host_pio_set_tx_hook().
+ */
+typedef void (*host_pio_tx_hook)(PIO pio, uint sm, uint32_t data, void *arg);
+
+/**
+ * @brief Callback for every packet the firmware sends to the USB host.
+ *
+ * @param itf The vendor interface.
+ * @param data The packet.
+ * @param len Length of the packet.
+ * @param arg The argument passed to host_usb_set_in_hook().
+ */
+typedef void (*host_usb_in_hook)(uint8_t itf, const void *data, uint32_t len,
+				 void *arg);
+
+/**
+ * @brief Resets the emulated hardware (flash erased, PIO empty, clock at 0).
+ *
+ * Must be called before ws2812b_init().
+ */
+void host_shim_init(void);
+
+/**
+ * @brief Sets the callback for TX FIFO writes, NULL only counts the words.
+ *
+ * @param hook The callback.
+ * @param arg Argument for the callback.
+ */
+void host_pio_set_tx_hook(host_pio_tx_hook hook, void *arg);
+
+/**
+ * @brief Sets the callback for packets to the USB host, NULL drops them.
+ *
+ * @param hook The callback.
+ * @param arg Argument for the callback.
+ */
+void host_usb_set_in_hook(host_usb_in_hook hook, void *arg);
+
+/**
+ * @brief Delivers a packet to a vendor interface and runs tud_vendor_rx_cb().
+ *
+ * @param itf The vendor interface.
+ * @param packet The packet.
+ * @param len Length of the packet (at most CFG_TUD_VENDOR_RX_BUFSIZE).
+ */
+void host_usb_receive(uint8_t itf, const void *packet, uint32_t len);
+
+/**
+ * @brief The simulated time the firmware spent in sleep_us().
+ *
+ * @return The time in microseconds.
+ */
+uint64_t host_time_us(void);
+
+/**
+ * @brief Initialises the firmware (implemented in main.c).
+ */
+void ws2812b_init(void);
+
+/**
+ * @brief Writes all ready strips to the PIO (implemented in main.c).
+ */
+void ws2812b_task();
+
+#endif /* _HOST_SHIM_H_ */
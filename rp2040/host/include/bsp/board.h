@@ -0,0 +1,23 @@
+/**
+ * @file board.h                                                               *
+ * @brief Host shim for the TinyUSB board support package.                     *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#ifndef _HOST_BSP_BOARD_H_
+#define _HOST_BSP_BOARD_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pico/time.h"
+
+/**
+ * @brief Board initialisation, nothing to do on the host.
+ */
+static inline void board_init(void)
+{
+}
+
+#endif /* _HOST_BSP_BOARD_H_ */
@@ -0,0 +1,40 @@
+/**
+ * @file clocks.h                                                              *
+ * @brief Host shim for the pico-sdk clock functions.                          *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#ifndef _HOST_HARDWARE_CLOCKS_H_
+#define _HOST_HARDWARE_CLOCKS_H_
+
+#include <stdint.h>
+
+/**
+ * @brief The clocks used by the firmware.
+ */
+enum clock_index {
+	clk_sys,
+};
+
+/**
+ * @brief The system clock in Hz, 125 MHz like the RP2040 default.
+ *
+ * Host tools may change it before the PIO programs are initialised.
+ */
+extern uint32_t host_clk_sys_hz;
+
+/**
+ * @brief Frequency of a clock.
+ *
+ * @param clk_index The clock.
+ * @return The frequency in Hz.
+ */
+static inline uint32_t clock_get_hz(enum clock_index clk_index)
+{
+	(void)clk_index;
+	return host_clk_sys_hz;
+}
+
+#endif /* _HOST_HARDWARE_CLOCKS_H_ */
@@ -0,0 +1,53 @@
+/**
+ * @file flash.h                                                               *
+ * @brief Host shim for the pico-sdk flash functions.                          *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#ifndef _HOST_HARDWARE_FLASH_H_
+#define _HOST_HARDWARE_FLASH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FLASH_PAGE_SIZE (1u << 8)
+#define FLASH_SECTOR_SIZE (1u << 12)
+
+#ifndef PICO_FLASH_SIZE_BYTES
+#define PICO_FLASH_SIZE_BYTES (2 * 1024 * 1024)
+#endif
+
+/**
+ * @brief The emulated flash, erased (0xFF) at program start.
+ */
+extern uint8_t host_flash[PICO_FLASH_SIZE_BYTES];
+
+/**
+ * @def XIP_BASE
+ * @brief Address the flash is mapped to, on the host the emulated flash array.
+ */
+#define XIP_BASE ((uintptr_t)host_flash)
+
+/**
+ * @brief Erases a range of the emulated flash.
+ *
+ * @param flash_offs Offset in the flash, must be sector aligned.
+ * @param count Number of bytes, multiple of FLASH_SECTOR_SIZE.
+ */
+void flash_range_erase(uint32_t flash_offs, size_t count);
+
+/**
+ * @brief Programs a range of the emulated flash.
+ *
+ * Like the real flash only bits can be cleared, programming does not set bits.
+ *
+ * @param flash_offs Offset in the flash, must be page aligned.
+ * @param data The data to program.
+ * @param count Number of bytes, multiple of FLASH_PAGE_SIZE.
+ */
+void flash_range_program(uint32_t flash_offs, const uint8_t *data,
+			 size_t count);
+
+#endif /* _HOST_HARDWARE_FLASH_H_ */
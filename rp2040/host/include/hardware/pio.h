@@ -0,0 +1,211 @@
+/**
+ * @file pio.h                                                                 *
+ * @brief Host shim for the pico-sdk PIO functions used by the firmware.       *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#ifndef _HOST_HARDWARE_PIO_H_
+#define _HOST_HARDWARE_PIO_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef unsigned int uint;
+
+#define HOST_PIO_SM_COUNT 4
+#define HOST_PIO_INSTRUCTION_COUNT 32
+
+/**
+ * @brief FIFO configuration of a state machine.
+ */
+enum pio_fifo_join {
+	PIO_FIFO_JOIN_NONE = 0,
+	PIO_FIFO_JOIN_TX = 1,
+	PIO_FIFO_JOIN_RX = 2,
+};
+
+/**
+ * @struct pio_program
+ * @brief A PIO program as generated by pioasm.
+ */
+typedef struct pio_program {
+	const uint16_t *instructions; /**< The instructions. */
+	uint8_t length; /**< Number of instructions. */
+	int8_t origin; /**< Fixed load address or -1. */
+} pio_program_t;
+
+/**
+ * @struct pio_sm_config
+ * @brief Configuration of a state machine.
+ *
+ * Unlike the SDK the fields are kept decoded, so the host tools can read them directly.
+ */
+typedef struct pio_sm_config {
+	uint wrap_target; /**< Absolute address of .wrap_target. */
+	uint wrap; /**< Absolute address of .wrap. */
+	uint sideset_bit_count; /**< Side-set bits including the enable bit. */
+	bool sideset_optional; /**< Side-set has an enable bit. */
+	bool sideset_pindirs; /**< Side-set drives the pin directions. */
+	uint sideset_base; /**< First side-set pin. */
+	uint out_base; /**< First OUT pin. */
+	uint out_count; /**< Number of OUT pins. */
+	uint set_base; /**< First SET pin. */
+	uint set_count; /**< Number of SET pins. */
+	bool out_shift_right; /**< OUT shifts to the right. */
+	bool autopull; /**< Autopull is enabled. */
+	uint pull_threshold; /**< Autopull threshold in bits. */
+	enum pio_fifo_join fifo_join; /**< FIFO configuration. */
+	float clkdiv; /**< Clock divider. */
+} pio_sm_config;
+
+/**
+ * @struct pio_host_sm
+ * @brief State of an emulated state machine.
+ */
+typedef struct pio_host_sm {
+	pio_sm_config config; /**< The configuration set by pio_sm_init(). */
+	uint initial_pc; /**< The start address. */
+	bool enabled; /**< State machine is running. */
+	uint64_t tx_words; /**< Words written to the TX FIFO. */
+	uint32_t tx_checksum; /**< Checksum over all words written to the TX FIFO. */
+} pio_host_sm;
+
+/**
+ * @struct pio_host
+ * @brief An emulated PIO block.
+ */
+typedef struct pio_host {
+	uint16_t instr_mem[HOST_PIO_INSTRUCTION_COUNT]; /**< Instruction memory. */
+	uint instr_used; /**< Number of used instruction slots. */
+	pio_host_sm sm[HOST_PIO_SM_COUNT]; /**< The state machines. */
+} pio_host;
+
+typedef pio_host *PIO;
+
+extern pio_host host_pio0;
+#define pio0 (&host_pio0)
+
+/**
+ * @brief Loads a program into the instruction memory.
+ *
+ * @param pio The PIO block.
+ * @param program The program.
+ * @return The load offset.
+ */
+uint pio_add_program(PIO pio, const pio_program_t *program);
+
+/**
+ * @brief Initialises a state machine with a configuration.
+ *
+ * @param pio The PIO block.
+ * @param sm The state machine.
+ * @param initial_pc The start address.
+ * @param config The configuration.
+ */
+void pio_sm_init(PIO pio, uint sm, uint initial_pc,
+		 const pio_sm_config *config);
+
+/**
+ * @brief Writes a word to the TX FIFO of a state machine.
+ *
+ * The FIFO never fills up on the host, the word is passed to the TX hook
+ * (see host_shim.h).
+ *
+ * @param pio The PIO block.
+ * @param sm The state machine.
+ * @param data The word.
+ */
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data);
+
+static inline void pio_sm_set_enabled(PIO pio, uint sm, bool enabled)
+{
+	pio->sm[sm].enabled = enabled;
+}
+
+static inline void pio_gpio_init(PIO pio, uint pin)
+{
+	(void)pio;
+	(void)pin;
+}
+
+static inline void pio_sm_set_consecutive_pindirs(PIO pio, uint sm,
+						  uint pin_base, uint pin_count,
+						  bool is_out)
+{
+	(void)pio;
+	(void)sm;
+	(void)pin_base;
+	(void)pin_count;
+	(void)is_out;
+}
+
+static inline pio_sm_config pio_get_default_sm_config(void)
+{
+	pio_sm_config c = {
+		.wrap_target = 0,
+		.wrap = HOST_PIO_INSTRUCTION_COUNT - 1,
+		.out_shift_right = true,
+		.pull_threshold = 32,
+		.fifo_join = PIO_FIFO_JOIN_NONE,
+		.clkdiv = 1.0f,
+	};
+	return c;
+}
+
+static inline void sm_config_set_wrap(pio_sm_config *c, uint wrap_target,
+				      uint wrap)
+{
+	c->wrap_target = wrap_target;
+	c->wrap = wrap;
+}
+
+static inline void sm_config_set_sideset(pio_sm_config *c, uint bit_count,
+					 bool optional, bool pindirs)
+{
+	c->sideset_bit_count = bit_count;
+	c->sideset_optional = optional;
+	c->sideset_pindirs = pindirs;
+}
+
+static inline void sm_config_set_sideset_pins(pio_sm_config *c,
+					      uint sideset_base)
+{
+	c->sideset_base = sideset_base;
+}
+
+static inline void sm_config_set_out_pins(pio_sm_config *c, uint out_base,
+					  uint out_count)
+{
+	c->out_base = out_base;
+	c->out_count = out_count;
+}
+
+static inline void sm_config_set_set_pins(pio_sm_config *c, uint set_base,
+					  uint set_count)
+{
+	c->set_base = set_base;
+	c->set_count = set_count;
+}
+
+static inline void sm_config_set_out_shift(pio_sm_config *c, bool shift_right,
+					   bool autopull, uint pull_threshold)
+{
+	c->out_shift_right = shift_right;
+	c->autopull = autopull;
+	c->pull_threshold = pull_threshold;
+}
+
+static inline void sm_config_set_fifo_join(pio_sm_config *c,
+					   enum pio_fifo_join join)
+{
+	c->fifo_join = join;
+}
+
+static inline void sm_config_set_clkdiv(pio_sm_config *c, float div)
+{
+	c->clkdiv = div;
+}
+
+#endif /* _HOST_HARDWARE_PIO_H_ */
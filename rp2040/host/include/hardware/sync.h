@@ -0,0 +1,34 @@
+/**
+ * @file sync.h                                                                *
+ * @brief Host shim for the pico-sdk interrupt control.                        *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#ifndef _HOST_HARDWARE_SYNC_H_
+#define _HOST_HARDWARE_SYNC_H_
+
+#include <stdint.h>
+
+/**
+ * @brief The host build has no interrupts, returns a dummy state.
+ *
+ * @return The saved interrupt state.
+ */
+static inline uint32_t save_and_disable_interrupts(void)
+{
+	return 0;
+}
+
+/**
+ * @brief Counterpart of save_and_disable_interrupts().
+ *
+ * @param status The saved interrupt state.
+ */
+static inline void restore_interrupts(uint32_t status)
+{
+	(void)status;
+}
+
+#endif /* _HOST_HARDWARE_SYNC_H_ */
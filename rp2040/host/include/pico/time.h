@@ -0,0 +1,24 @@
+/**
+ * @file time.h                                                                *
+ * @brief Host shim for the pico-sdk timer functions.                          *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#ifndef _HOST_PICO_TIME_H_
+#define _HOST_PICO_TIME_H_
+
+#include <stdint.h>
+
+/**
+ * @brief Blocking sleep of the firmware.
+ *
+ * The host build does not sleep, the time is added to a simulated clock
+ * (see host_shim.h) so the driver can report the time the device would have spent.
+ *
+ * @param us The time to sleep in microseconds.
+ */
+void sleep_us(uint64_t us);
+
+#endif /* _HOST_PICO_TIME_H_ */
@@ -0,0 +1,24 @@
+/**
+ * @file unique_id.h                                                           *
+ * @brief Host shim for the pico-sdk unique board id.                          *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#ifndef _HOST_PICO_UNIQUE_ID_H_
+#define _HOST_PICO_UNIQUE_ID_H_
+
+#include <stdint.h>
+
+#define PICO_UNIQUE_BOARD_ID_SIZE_BYTES 8
+
+/**
+ * @brief Writes the board id as hex string, the host uses a fixed id.
+ *
+ * @param id_out The buffer for the string.
+ * @param len The size of the buffer.
+ */
+void pico_get_unique_board_id_string(char *id_out, uint32_t len);
+
+#endif /* _HOST_PICO_UNIQUE_ID_H_ */
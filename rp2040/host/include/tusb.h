@@ -0,0 +1,186 @@
+/**
+ * @file tusb.h                                                                *
+ * @brief Host shim for the TinyUSB device stack (vendor class only).          *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#ifndef _HOST_TUSB_H_
+#define _HOST_TUSB_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "tusb_config.h"
+
+#define TU_BIT(n) (1UL << (n))
+#define TU_ARRAY_SIZE(_arr) (sizeof(_arr) / sizeof(_arr[0]))
+
+/**
+ * @brief Descriptor types.
+ */
+typedef enum {
+	TUSB_DESC_DEVICE = 0x01,
+	TUSB_DESC_CONFIGURATION = 0x02,
+	TUSB_DESC_STRING = 0x03,
+	TUSB_DESC_INTERFACE = 0x04,
+	TUSB_DESC_ENDPOINT = 0x05,
+} tusb_desc_type_t;
+
+/**
+ * @brief Endpoint transfer types.
+ */
+typedef enum {
+	TUSB_XFER_CONTROL = 0,
+	TUSB_XFER_ISOCHRONOUS,
+	TUSB_XFER_BULK,
+	TUSB_XFER_INTERRUPT,
+} tusb_xfer_type_t;
+
+/**
+ * @brief Device classes.
+ */
+typedef enum {
+	TUSB_CLASS_VENDOR_SPECIFIC = 0xFF,
+} tusb_class_code_t;
+
+/**
+ * @brief Standard device descriptor.
+ */
+typedef struct __attribute__((packed)) {
+	uint8_t bLength;
+	uint8_t bDescriptorType;
+	uint16_t bcdUSB;
+	uint8_t bDeviceClass;
+	uint8_t bDeviceSubClass;
+	uint8_t bDeviceProtocol;
+	uint8_t bMaxPacketSize0;
+	uint16_t idVendor;
+	uint16_t idProduct;
+	uint16_t bcdDevice;
+	uint8_t iManufacturer;
+	uint8_t iProduct;
+	uint8_t iSerialNumber;
+	uint8_t bNumConfigurations;
+} tusb_desc_device_t;
+
+/**
+ * @brief Standard configuration descriptor.
+ */
+typedef struct __attribute__((packed)) {
+	uint8_t bLength;
+	uint8_t bDescriptorType;
+	uint16_t wTotalLength;
+	uint8_t bNumInterfaces;
+	uint8_t bConfigurationValue;
+	uint8_t iConfiguration;
+	uint8_t bmAttributes;
+	uint8_t bMaxPower;
+} tusb_desc_configuration_t;
+
+/**
+ * @brief Standard interface descriptor.
+ */
+typedef struct __attribute__((packed)) {
+	uint8_t bLength;
+	uint8_t bDescriptorType;
+	uint8_t bInterfaceNumber;
+	uint8_t bAlternateSetting;
+	uint8_t bNumEndpoints;
+	uint8_t bInterfaceClass;
+	uint8_t bInterfaceSubClass;
+	uint8_t bInterfaceProtocol;
+	uint8_t iInterface;
+} tusb_desc_interface_t;
+
+/**
+ * @brief Standard endpoint descriptor, bmAttributes is a plain byte here.
+ */
+typedef struct __attribute__((packed)) {
+	uint8_t bLength;
+	uint8_t bDescriptorType;
+	uint8_t bEndpointAddress;
+	uint8_t bmAttributes;
+	uint16_t wMaxPacketSize;
+	uint8_t bInterval;
+} tusb_desc_endpoint_t;
+
+/**
+ * @brief Initialises the USB stack, nothing to do on the host.
+ *
+ * @return Always true.
+ */
+static inline bool tusb_init(void)
+{
+	return true;
+}
+
+/**
+ * @brief USB device task, packets are delivered by the driver instead.
+ */
+static inline void tud_task(void)
+{
+}
+
+/**
+ * @brief Reads from the packet currently delivered to a vendor interface.
+ *
+ * @param itf The vendor interface.
+ * @param buffer The destination.
+ * @param bufsize Size of the destination.
+ * @return Number of bytes read.
+ */
+uint32_t tud_vendor_n_read(uint8_t itf, void *buffer, uint32_t bufsize);
+
+/**
+ * @brief Discards the rest of the packet currently delivered to a vendor interface.
+ *
+ * @param itf The vendor interface.
+ */
+void tud_vendor_n_read_flush(uint8_t itf);
+
+/**
+ * @brief Sends data to the host, passed to the IN hook (see host_shim.h).
+ *
+ * @param itf The vendor interface.
+ * @param buffer The data.
+ * @param bufsize Number of bytes.
+ * @return Number of bytes written.
+ */
+uint32_t tud_vendor_n_write(uint8_t itf, void const *buffer,
+			    uint32_t bufsize);
+
+/**
+ * @brief Receive callback implemented by the firmware.
+ *
+ * @param itf The vendor interface.
+ */
+void tud_vendor_rx_cb(uint8_t itf);
+
+/**
+ * @brief Device descriptor callback implemented by the firmware.
+ *
+ * @return The device descriptor.
+ */
+uint8_t const *tud_descriptor_device_cb(void);
+
+/**
+ * @brief Configuration descriptor callback implemented by the firmware.
+ *
+ * @param index The configuration.
+ * @return The configuration descriptor including all interfaces and endpoints.
+ */
+uint8_t const *tud_descriptor_configuration_cb(uint8_t index);
+
+/**
+ * @brief String descriptor callback implemented by the firmware.
+ *
+ * @param index The string index.
+ * @param langid The language.
+ * @return The string descriptor or NULL.
+ */
+uint16_t const *tud_descriptor_string_cb(uint8_t index, uint16_t langid);
+
+#endif /* _HOST_TUSB_H_ */
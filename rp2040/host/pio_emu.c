@@ -0,0 +1,333 @@
+/**
+ * @file pio_emu.c                                                             *
+ * @brief Cycle accurate emulation of a single PIO state machine.              *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#include <string.h>
+#include "pio_emu.h"
+
+/**
+ * @brief Opcodes in bits 15:13 of an instruction.
+ */
+enum pio_emu_opcode {
+	OP_JMP = 0,
+	OP_WAIT = 1,
+	OP_IN = 2,
+	OP_OUT = 3,
+	OP_PUSH_PULL = 4,
+	OP_MOV = 5,
+	OP_IRQ = 6,
+	OP_SET = 7,
+};
+
+/**
+ * @brief Writes a value to a range of pins.
+ */
+static void pio_emu_write_pins(pio_emu *emu, uint base, uint count,
+			       uint32_t value)
+{
+	for (uint i = 0; i < count; i++) {
+		uint pin = (base + i) & 31;
+		emu->pins = (emu->pins & ~(1u << pin)) |
+			    (((value >> i) & 1) << pin);
+	}
+}
+
+/**
+ * @brief Moves the oldest FIFO word into the OSR.
+ *
+ * @return false if the FIFO is empty.
+ */
+static bool pio_emu_pull(pio_emu *emu)
+{
+	if (emu->fifo_level == 0) {
+		return false;
+	}
+	emu->osr = emu->fifo[emu->fifo_head];
+	emu->fifo_head = (emu->fifo_head + 1) % emu->fifo_depth;
+	emu->fifo_level--;
+	emu->osr_count = 0;
+	return true;
+}
+
+/**
+ * @brief Shifts bits out of the OSR in the configured direction.
+ */
+static uint32_t pio_emu_shift_out(pio_emu *emu, uint bit_count)
+{
+	uint32_t data;
+
+	if (bit_count == 32) {
+		data = emu->osr;
+		emu->osr = 0;
+	} else if (emu->config.out_shift_right) {
+		data = emu->osr & ((1u << bit_count) - 1);
+		emu->osr >>= bit_count;
+	} else {
+		data = emu->osr >> (32 - bit_count);
+		emu->osr <<= bit_count;
+	}
+	emu->osr_count += bit_count;
+	if (emu->osr_count > 32) {
+		emu->osr_count = 32;
+	}
+	return data;
+}
+
+/**
+ * @brief Reverses the bit order of a word.
+ */
+static uint32_t pio_emu_reverse(uint32_t v)
+{
+	uint32_t r = 0;
+
+	for (int i = 0; i < 32; i++) {
+		r = (r << 1) | ((v >> i) & 1);
+	}
+	return r;
+}
+
+void pio_emu_init(pio_emu *emu, PIO pio, uint sm)
+{
+	memset(emu, 0, sizeof(*emu));
+	emu->instr_mem = pio->instr_mem;
+	emu->config = pio->sm[sm].config;
+	emu->pc = pio->sm[sm].initial_pc;
+	// Der Teiler ist in Hardware ein 16.8-Festkommawert
+	emu->clkdiv_fixed = (uint32_t)(emu->config.clkdiv * 256.0f);
+	if (emu->clkdiv_fixed < 256) {
+		emu->clkdiv_fixed = 256;
+	}
+	emu->fifo_depth = emu->config.fifo_join == PIO_FIFO_JOIN_TX ?
+				  PIO_EMU_FIFO_DEPTH :
+				  PIO_EMU_FIFO_DEPTH / 2;
+	// Ein leeres OSR löst beim ersten OUT ein Autopull aus
+	emu->osr_count = 32;
+}
+
+bool pio_emu_put(pio_emu *emu, uint32_t data)
+{
+	if (emu->fifo_level == emu->fifo_depth) {
+		return false;
+	}
+	emu->fifo[(emu->fifo_head + emu->fifo_level) % emu->fifo_depth] = data;
+	emu->fifo_level++;
+	return true;
+}
+
+enum pio_emu_result pio_emu_step(pio_emu *emu)
+{
+	const pio_sm_config *c = &emu->config;
+
+	emu->cycle++;
+	if (emu->delay) {
+		emu->delay--;
+		return PIO_EMU_OK;
+	}
+
+	uint16_t instr = emu->instr_mem[emu->pc];
+	uint field = (instr >> 8) & 0x1F;
+	uint delay_bits = 5 - c->sideset_bit_count;
+	uint delay = field & ((1u << delay_bits) - 1);
+
+	// Side-Set wird auch ausgeführt, wenn die Instruktion blockiert
+	if (c->sideset_bit_count) {
+		uint side = field >> delay_bits;
+		uint side_count = c->sideset_bit_count;
+		bool enable = true;
+		if (c->sideset_optional) {
+			side_count--;
+			enable = (side >> side_count) & 1;
+			side &= (1u << side_count) - 1;
+		}
+		if (enable && !c->sideset_pindirs) {
+			pio_emu_write_pins(emu, c->sideset_base, side_count,
+					   side);
+		}
+	}
+
+	bool stall = false;
+	bool jump = false;
+	uint target = 0;
+	uint op_dest = (instr >> 5) & 7;
+	uint op_low = instr & 0x1F;
+
+	switch (instr >> 13) {
+	case OP_JMP: {
+		bool cond;
+		switch (op_dest) {
+		case 0:
+			cond = true;
+			break;
+		case 1:
+			cond = emu->x == 0;
+			break;
+		case 2:
+			cond = emu->x != 0;
+			emu->x--;
+			break;
+		case 3:
+			cond = emu->y == 0;
+			break;
+		case 4:
+			cond = emu->y != 0;
+			emu->y--;
+			break;
+		case 5:
+			cond = emu->x != emu->y;
+			break;
+		case 7:
+			cond = emu->osr_count < c->pull_threshold;
+			break;
+		default:
+			// JMP PIN braucht EXECCTRL_JMP_PIN und Eingänge
+			return PIO_EMU_UNSUPPORTED;
+		}
+		jump = cond;
+		target = op_low;
+		break;
+	}
+
+	case OP_OUT: {
+		if (c->autopull && emu->osr_count >= c->pull_threshold &&
+		    !pio_emu_pull(emu)) {
+			stall = true;
+			break;
+		}
+		uint32_t data = pio_emu_shift_out(emu, op_low ? op_low : 32);
+		switch (op_dest) {
+		case 0:
+			pio_emu_write_pins(emu, c->out_base, c->out_count,
+					   data);
+			break;
+		case 1:
+			emu->x = data;
+			break;
+		case 2:
+			emu->y = data;
+			break;
+		case 3:
+		case 4:
+			break;
+		case 5:
+			jump = true;
+			target = data & 31;
+			break;
+		default:
+			return PIO_EMU_UNSUPPORTED;
+		}
+		break;
+	}
+
+	case OP_PUSH_PULL: {
+		bool is_pull = (instr >> 7) & 1;
+		bool if_empty = (instr >> 6) & 1;
+		bool block = (instr >> 5) & 1;
+		if (!is_pull) {
+			return PIO_EMU_UNSUPPORTED;
+		}
+		if (if_empty && emu->osr_count < c->pull_threshold) {
+			break;
+		}
+		if (!pio_emu_pull(emu)) {
+			if (block) {
+				stall = true;
+			} else {
+				emu->osr = emu->x;
+				emu->osr_count = 0;
+			}
+		}
+		break;
+	}
+
+	case OP_MOV: {
+		uint op = (instr >> 3) & 3;
+		uint32_t src;
+		switch (instr & 7) {
+		case 1:
+			src = emu->x;
+			break;
+		case 2:
+			src = emu->y;
+			break;
+		case 3:
+			src = 0;
+			break;
+		case 7:
+			src = emu->osr;
+			break;
+		default:
+			return PIO_EMU_UNSUPPORTED;
+		}
+		if (op == 1) {
+			src = ~src;
+		} else if (op == 2) {
+			src = pio_emu_reverse(src);
+		}
+		switch (op_dest) {
+		case 0:
+			pio_emu_write_pins(emu, c->out_base, c->out_count, src);
+			break;
+		case 1:
+			emu->x = src;
+			break;
+		case 2:
+			emu->y = src;
+			break;
+		case 5:
+			jump = true;
+			target = src & 31;
+			break;
+		case 7:
+			emu->osr = src;
+			emu->osr_count = 0;
+			break;
+		default:
+			return PIO_EMU_UNSUPPORTED;
+		}
+		break;
+	}
+
+	case OP_SET:
+		switch (op_dest) {
+		case 0:
+			pio_emu_write_pins(emu, c->set_base, c->set_count,
+					   op_low);
+			break;
+		case 1:
+			emu->x = op_low;
+			break;
+		case 2:
+			emu->y = op_low;
+			break;
+		case 4:
+			break;
+		default:
+			return PIO_EMU_UNSUPPORTED;
+		}
+		break;
+
+	default:
+		return PIO_EMU_UNSUPPORTED;
+	}
+
+	if (stall) {
+		emu->stalled = true;
+		emu->stall_cycles++;
+		return PIO_EMU_OK;
+	}
+	emu->stalled = false;
+	emu->delay = delay;
+
+	if (jump) {
+		emu->pc = target;
+	} else if (emu->pc == c->wrap) {
+		emu->pc = c->wrap_target;
+	} else {
+		emu->pc = (emu->pc + 1) & 31;
+	}
+	return PIO_EMU_OK;
+}
@@ -0,0 +1,110 @@
+/**
+ * @file pio_emu.h                                                             *
+ * @brief Cycle accurate emulation of a single PIO state machine.              *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#ifndef _PIO_EMU_H_
+#define _PIO_EMU_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "hardware/pio.h"
+
+/**
+ * @def PIO_EMU_FIFO_DEPTH
+ * @brief Depth of the TX FIFO when joined with the RX FIFO.
+ */
+#define PIO_EMU_FIFO_DEPTH 8
+
+/**
+ * @brief Result of an emulation step.
+ */
+enum pio_emu_result {
+	PIO_EMU_OK = 0, /**< The state machine advanced by one cycle. */
+	PIO_EMU_UNSUPPORTED = -1, /**< The instruction is not supported by the emulator. */
+};
+
+/**
+ * @struct pio_emu
+ * @brief State of an emulated state machine.
+ *
+ * Supported are JMP, OUT, PULL, MOV, SET and side-set with delay, autopull and
+ * FIFO joining. WAIT, IN, PUSH and IRQ are reported as unsupported.
+ */
+typedef struct pio_emu {
+	const uint16_t *instr_mem; /**< The instruction memory of the PIO block. */
+	pio_sm_config config; /**< The configuration of the state machine. */
+	uint32_t clkdiv_fixed; /**< Clock divider in 16.8 fixed point like the hardware. */
+	uint pc; /**< The program counter. */
+	uint32_t x; /**< Scratch register X. */
+	uint32_t y; /**< Scratch register Y. */
+	uint32_t osr; /**< Output shift register. */
+	uint osr_count; /**< Bits shifted out of the OSR since the last pull. */
+	uint32_t fifo[PIO_EMU_FIFO_DEPTH]; /**< The TX FIFO. */
+	uint fifo_depth; /**< Usable depth of the TX FIFO. */
+	uint fifo_head; /**< Index of the oldest word in the FIFO. */
+	uint fifo_level; /**< Number of words in the FIFO. */
+	uint delay; /**< Remaining delay cycles of the last instruction. */
+	bool stalled; /**< The current instruction stalled in the last cycle. */
+	uint32_t pins; /**< Output levels of GPIO 0..31. */
+	uint64_t cycle; /**< Number of state machine cycles executed. */
+	uint64_t stall_cycles; /**< Cycles spent stalled. */
+} pio_emu;
+
+/**
+ * @brief Initialises the emulator from a state machine set up by pio_sm_init().
+ *
+ * @param emu The emulator.
+ * @param pio The PIO block holding the program.
+ * @param sm The state machine.
+ */
+void pio_emu_init(pio_emu *emu, PIO pio, uint sm);
+
+/**
+ * @brief Writes a word to the TX FIFO.
+ *
+ * @param emu The emulator.
+ * @param data The word.
+ * @return false if the FIFO is full.
+ */
+bool pio_emu_put(pio_emu *emu, uint32_t data);
+
+/**
+ * @brief Executes one cycle of the state machine.
+ *
+ * @param emu The emulator.
+ * @return PIO_EMU_OK or PIO_EMU_UNSUPPORTED.
+ */
+enum pio_emu_result pio_emu_step(pio_emu *emu);
+
+/**
+ * @brief Time of a state machine cycle in system clock cycles.
+ *
+ * The fractional divider is emulated, so single cycles may be one system
+ * clock longer or shorter than the average.
+ *
+ * @param emu The emulator.
+ * @param cycle The state machine cycle.
+ * @return The system clock cycle the state machine cycle starts at.
+ */
+static inline uint64_t pio_emu_sys_cycle(const pio_emu *emu, uint64_t cycle)
+{
+	return (cycle * emu->clkdiv_fixed) >> 8;
+}
+
+/**
+ * @brief Returns the level of a pin.
+ *
+ * @param emu The emulator.
+ * @param pin The GPIO number.
+ * @return The level.
+ */
+static inline bool pio_emu_pin(const pio_emu *emu, uint pin)
+{
+	return (emu->pins >> pin) & 1;
+}
+
+#endif /* _PIO_EMU_H_ */
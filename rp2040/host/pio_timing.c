@@ -0,0 +1,378 @@
+/**
+ * @file pio_timing.c                                                          *
+ * @brief Runs ws2812_program in the PIO emulator and checks the pulse widths  *
+ *        and the bit rate against the WS2812 datasheets.                     *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#include <argp.h>
+#include <float.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host_shim.h"
+#include "hardware/clocks.h"
+#include "pio_emu.h"
+#include "ws2812.pio.h"
+
+/**
+ * @def TIMING_PIN
+ * @brief GPIO the program drives, same as WS2812B_PIN in main.c.
+ */
+#define TIMING_PIN 2
+
+/**
+ * @struct timing_spec
+ * @brief Timing limits of a LED type in nanoseconds.
+ */
+struct timing_spec {
+	const char *name; /**< Name for --spec. */
+	const char *description; /**< Datasheet the limits are taken from. */
+	double t0h_min, t0h_max; /**< High time of a 0 bit. */
+	double t0l_min, t0l_max; /**< Low time of a 0 bit. */
+	double t1h_min, t1h_max; /**< High time of a 1 bit. */
+	double t1l_min, t1l_max; /**< Low time of a 1 bit. */
+	double period_min, period_max; /**< TH + TL of a bit. */
+	double reset_min; /**< Low time that latches the frame. */
+};
+
+static const struct timing_spec timing_specs[] = {
+	{ "ws2812b", "WS2812B Rev. V5", 220, 380, 580, 1000, 580, 1000, 220,
+	  420, 650, 1850, 280000 },
+	{ "ws2812b-v1", "WS2812B (first revision, +-150 ns)", 250, 550, 700,
+	  1000, 650, 950, 300, 600, 650, 1850, 50000 },
+	{ "ws2812", "WS2812 (+-150 ns)", 200, 500, 650, 950, 550, 850, 450,
+	  750, 650, 1850, 50000 },
+};
+
+#define TIMING_SPEC_COUNT (sizeof(timing_specs) / sizeof(timing_specs[0]))
+
+const char *argp_program_version = "pio-timing";
+const char *argp_program_bug_address = "";
+static char doc[] =
+	"pio-timing führt ws2812_program im PIO-Emulator aus, dekodiert das Signal am Ausgangspin und prüft Pulsbreiten und Bitrate gegen das Datenblatt. "
+	"Der Rückgabewert ist 0, wenn alle Pulse im Toleranzbereich liegen und die Daten korrekt dekodiert wurden. "
+	"Datenblätter: ws2812b (Standard), ws2812b-v1, ws2812.";
+static char args_doc[] = "";
+
+/**
+ * @struct argp_option
+ * @brief Structure for command-line options
+ */
+static struct argp_option options[] = {
+	{ "pixels", 'n', "NUM", 0, "Anzahl der gesendeten Pixel (Standard 300)" },
+	{ "freq", 'f', "HZ", 0, "Bitrate für ws2812_program_init (Standard 800000)" },
+	{ "sysclk", 's', "HZ", 0, "Systemtakt (Standard 125000000)" },
+	{ "spec", 't', "NAME", 0, "Datenblatt für die Grenzwerte" },
+	{ "feed", 'g', "NS", 0, "Abstand zwischen zwei FIFO-Schreibzugriffen, 0 hält den FIFO voll (Standard 0)" },
+	{ "verbose", 'v', 0, 0, "Gibt jedes Bit mit Pulsbreiten aus" },
+	{ 0 },
+};
+
+/**
+ * @struct arguments
+ * @brief Structure to hold command-line arguments
+ */
+struct arguments {
+	uint32_t pixels;
+	uint32_t freq;
+	uint32_t sysclk;
+	uint32_t feed_ns;
+	const struct timing_spec *spec;
+	bool verbose;
+};
+
+/**
+ * @brief Parses an unsigned number argument.
+ */
+static int parse_number(const char *arg, uint32_t *value)
+{
+	char *end;
+	unsigned long v = strtoul(arg, &end, 0);
+
+	if (*arg == '\0' || *end != '\0' || v > UINT32_MAX) {
+		printf("Error: %s is not a number\n", arg);
+		return -1;
+	}
+	*value = v;
+	return 0;
+}
+
+/**
+ * @brief Callback function to parse command-line options
+ */
+static error_t parse_opt(int key, char *arg, struct argp_state *state)
+{
+	struct arguments *arg_s = state->input;
+	switch (key) {
+	case 'n':
+		if (parse_number(arg, &arg_s->pixels) < 0)
+			return ARGP_KEY_ERROR;
+		break;
+	case 'f':
+		if (parse_number(arg, &arg_s->freq) < 0)
+			return ARGP_KEY_ERROR;
+		break;
+	case 's':
+		if (parse_number(arg, &arg_s->sysclk) < 0)
+			return ARGP_KEY_ERROR;
+		break;
+	case 'g':
+		if (parse_number(arg, &arg_s->feed_ns) < 0)
+			return ARGP_KEY_ERROR;
+		break;
+	case 't':
+		arg_s->spec = NULL;
+		for (size_t i = 0; i < TIMING_SPEC_COUNT; i++) {
+			if (strcmp(arg, timing_specs[i].name) == 0) {
+				arg_s->spec = &timing_specs[i];
+			}
+		}
+		if (!arg_s->spec) {
+			printf("Error: unbekanntes Datenblatt %s\n", arg);
+			return ARGP_KEY_ERROR;
+		}
+		break;
+	case 'v':
+		arg_s->verbose = true;
+		break;
+	default:
+		return ARGP_ERR_UNKNOWN;
+	}
+	return 0;
+}
+
+static struct argp argp = { options, parse_opt, args_doc, doc, 0, 0, 0 };
+
+/**
+ * @struct pulse_stats
+ * @brief Minimum, maximum and mean of a pulse width.
+ */
+struct pulse_stats {
+	double min; /**< Shortest pulse in ns. */
+	double max; /**< Longest pulse in ns. */
+	double sum; /**< Sum of all pulses in ns. */
+	uint64_t count; /**< Number of pulses. */
+	uint64_t violations; /**< Pulses outside the limits. */
+};
+
+/**
+ * @brief Adds a pulse and checks it against the limits.
+ */
+static void pulse_stats_add(struct pulse_stats *stats, double width,
+			    double min, double max)
+{
+	if (stats->count == 0 || width < stats->min) {
+		stats->min = width;
+	}
+	if (stats->count == 0 || width > stats->max) {
+		stats->max = width;
+	}
+	stats->sum += width;
+	stats->count++;
+	if (width < min || width > max) {
+		stats->violations++;
+	}
+}
+
+/**
+ * @brief Prints a pulse statistic with its limits.
+ */
+static void pulse_stats_print(const char *name,
+			      const struct pulse_stats *stats, double min,
+			      double max)
+{
+	if (!stats->count) {
+		printf("%-4s  -\n", name);
+		return;
+	}
+	printf("%-4s  min %7.1f  max %7.1f  mittel %7.1f ns  (Grenzen %4.0f..%4.0f)  %s\n",
+	       name, stats->min, stats->max, stats->sum / stats->count, min,
+	       max, stats->violations ? "FEHLER" : "ok");
+}
+
+/**
+ * @brief xorshift32 for reproducible test pixels.
+ */
+static uint32_t next_random(uint32_t *state)
+{
+	uint32_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+	return x;
+}
+
+int main(int argc, char **argv)
+{
+	struct arguments arguments = {
+		.pixels = 300,
+		.freq = 800000,
+		.sysclk = 125000000,
+		.spec = &timing_specs[0],
+	};
+	const struct timing_spec *spec;
+	pio_emu emu;
+
+	argp_parse(&argp, argc, argv, 0, 0, &arguments);
+	spec = arguments.spec;
+	if (arguments.pixels == 0 || arguments.freq == 0 ||
+	    arguments.sysclk == 0) {
+		printf("Pixel, Bitrate und Systemtakt müssen größer 0 sein\n");
+		return EXIT_FAILURE;
+	}
+
+	uint32_t *pixels = malloc(arguments.pixels * sizeof(uint32_t));
+	if (!pixels) {
+		printf("Kein Speicher für die Pixel\n");
+		return EXIT_FAILURE;
+	}
+	// Erst die Extremwerte, dann Zufallsdaten
+	uint32_t seed = 0x2812;
+	for (uint32_t i = 0; i < arguments.pixels; i++) {
+		pixels[i] = i == 0 ? 0x000000 :
+			    i == 1 ? 0xFFFFFF :
+				     next_random(&seed) & 0xFFFFFF;
+	}
+
+	host_shim_init();
+	host_clk_sys_hz = arguments.sysclk;
+	uint offset = pio_add_program(pio0, &ws2812_program);
+	ws2812_program_init(pio0, 0, offset, TIMING_PIN, arguments.freq);
+	pio_emu_init(&emu, pio0, 0);
+
+	const double ns_per_sys = 1e9 / arguments.sysclk;
+	const double threshold = (spec->t0h_max + spec->t1h_min) / 2;
+	const uint64_t total_bits = (uint64_t)arguments.pixels * 24;
+	const uint64_t max_cycles = total_bits * 1000 + 1000000 +
+				    (uint64_t)arguments.feed_ns *
+					    arguments.pixels;
+
+	struct pulse_stats t0h = { 0 }, t0l = { 0 }, t1h = { 0 }, t1l = { 0 };
+	struct pulse_stats period = { 0 };
+	uint64_t fed = 0;
+	uint64_t decoded = 0;
+	uint64_t errors = 0;
+	uint64_t latches = 0;
+	double next_feed = 0;
+	double rise = -1, fall = -1, first_rise = -1;
+	bool level = pio_emu_pin(&emu, TIMING_PIN);
+	bool last_bit = false;
+	double last_high = 0;
+
+	while (emu.cycle < max_cycles) {
+		double now = pio_emu_sys_cycle(&emu, emu.cycle) * ns_per_sys;
+
+		if (arguments.feed_ns == 0) {
+			while (fed < arguments.pixels &&
+			       pio_emu_put(&emu, pixels[fed] << 8u)) {
+				fed++;
+			}
+		} else if (fed < arguments.pixels && now >= next_feed &&
+			   pio_emu_put(&emu, pixels[fed] << 8u)) {
+			fed++;
+			next_feed = now + arguments.feed_ns;
+		}
+
+		if (pio_emu_step(&emu) != PIO_EMU_OK) {
+			printf("Nicht unterstützte Instruktion 0x%04x an Adresse %u\n",
+			       emu.instr_mem[emu.pc], emu.pc);
+			return 2;
+		}
+
+		bool new_level = pio_emu_pin(&emu, TIMING_PIN);
+		if (new_level != level && new_level) {
+			if (fall >= 0) {
+				double low = now - fall;
+				pulse_stats_add(last_bit ? &t1l : &t0l, low,
+						last_bit ? spec->t1l_min :
+							   spec->t0l_min,
+						last_bit ? spec->t1l_max :
+							   spec->t0l_max);
+				pulse_stats_add(&period, last_high + low,
+						spec->period_min,
+						spec->period_max);
+				if (low >= spec->reset_min) {
+					latches++;
+				}
+				if (arguments.verbose) {
+					printf("Bit %6" PRIu64 ": %d  high %7.1f  low %7.1f ns\n",
+					       decoded - 1, last_bit,
+					       last_high, low);
+				}
+			}
+			if (first_rise < 0) {
+				first_rise = now;
+			}
+			rise = now;
+		} else if (new_level != level && rise >= 0) {
+			double high = now - rise;
+			bool bit = high > threshold;
+			uint64_t index = decoded;
+			bool expected = (pixels[index / 24] >>
+					 (23 - index % 24)) &
+					1;
+			pulse_stats_add(bit ? &t1h : &t0h, high,
+					bit ? spec->t1h_min : spec->t0h_min,
+					bit ? spec->t1h_max : spec->t0h_max);
+			if (bit != expected) {
+				errors++;
+			}
+			last_bit = bit;
+			last_high = high;
+			fall = now;
+			decoded++;
+		}
+		level = new_level;
+
+		// Fertig, wenn alles gesendet ist und die State-Machine auf Daten wartet
+		if (decoded == total_bits && emu.stalled) {
+			break;
+		}
+	}
+	double end = pio_emu_sys_cycle(&emu, emu.cycle) * ns_per_sys;
+
+	printf("Datenblatt: %s\n", spec->description);
+	printf("Systemtakt %" PRIu32 " Hz, Teiler %.4f (16.8: %" PRIu32
+	       ".%" PRIu32 "/256), PIO-Takt %.0f ns\n",
+	       arguments.sysclk, emu.clkdiv_fixed / 256.0,
+	       emu.clkdiv_fixed >> 8, emu.clkdiv_fixed & 0xFF,
+	       emu.clkdiv_fixed / 256.0 * ns_per_sys);
+	pulse_stats_print("T0H", &t0h, spec->t0h_min, spec->t0h_max);
+	pulse_stats_print("T0L", &t0l, spec->t0l_min, spec->t0l_max);
+	pulse_stats_print("T1H", &t1h, spec->t1h_min, spec->t1h_max);
+	pulse_stats_print("T1L", &t1l, spec->t1l_min, spec->t1l_max);
+	pulse_stats_print("TH+TL", &period, spec->period_min,
+			  spec->period_max);
+
+	bool ok = decoded == total_bits && errors == 0 && latches == 0 &&
+		  t0h.violations == 0 && t0l.violations == 0 &&
+		  t1h.violations == 0 && t1l.violations == 0 &&
+		  period.violations == 0;
+
+	printf("Bits: %" PRIu64 "/%" PRIu64 " dekodiert, %" PRIu64
+	       " falsch, %" PRIu64 " ungewollte Latches\n",
+	       decoded, total_bits, errors, latches);
+	if (decoded > 1) {
+		double bit_time = (rise - first_rise) / (decoded - 1);
+		double frame = decoded * bit_time + spec->reset_min;
+		printf("Bitrate: %.0f bit/s (angefordert %" PRIu32
+		       "), %.0f Pixel/s\n",
+		       1e9 / bit_time, arguments.freq, 1e9 / bit_time / 24);
+		printf("Frame mit %" PRIu32 " Pixeln inkl. Reset: %.1f us, max. %.1f Frames/s\n",
+		       arguments.pixels, frame / 1e3, 1e9 / frame);
+	}
+	printf("PIO-Zyklen: %" PRIu64 ", davon %" PRIu64
+	       " blockiert, Laufzeit %.1f us\n",
+	       emu.cycle, emu.stall_cycles, end / 1e3);
+	printf("%s\n", ok ? "OK" : "FEHLER");
+
+	free(pixels);
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
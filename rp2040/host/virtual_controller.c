@@ -0,0 +1,835 @@
+/**
+ * @file virtual_controller.c                                                  *
+ * @brief Virtual WS2812B controller: runs the host build of the firmware      *
+ *        behind the Linux raw-gadget interface (e.g. on dummy_hcd).          *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#include <argp.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/usb/ch9.h>
+#include <linux/usb/raw_gadget.h>
+#include "host_shim.h"
+#include "hardware/flash.h"
+#include "tusb.h"
+#include "usb_packets.h"
+
+/**
+ * @def VC_PACKET_SIZE
+ * @brief Größe der Bulk-Pakete.
+ */
+#define VC_PACKET_SIZE CFG_USB_BULK_ENDPOINT_SIZE
+
+/**
+ * @def VC_BULK_PACKET_NS
+ * @brief Mindestabstand zweier Bulk-Pakete bei Full-Speed (19 x 64 Byte pro 1-ms-Frame).
+ */
+#define VC_BULK_PACKET_NS (1000000 / 19)
+
+/**
+ * @def VC_PIXEL_NS
+ * @brief Zeit für 24 Bit bei 800 kHz auf der Datenleitung.
+ */
+#define VC_PIXEL_NS 30000
+
+/**
+ * @def VC_PIO_FIFO_DEPTH
+ * @brief Tiefe des verbundenen TX-FIFOs, so viele Pixel blockieren put_pixel() nicht.
+ */
+#define VC_PIO_FIFO_DEPTH 8
+
+/**
+ * @def VC_IN_QUEUE_LEN
+ * @brief Anzahl der Pakete, die pro Streifen auf den Host warten können.
+ */
+#define VC_IN_QUEUE_LEN 16
+
+/**
+ * @def VC_WAKE_SIGNAL
+ * @brief Signal, mit dem blockierte EP_READ/EP_WRITE der Streifen-Threads abgebrochen werden.
+ */
+#define VC_WAKE_SIGNAL SIGUSR1
+
+/**
+ * @def VC_WAKE_RETRY_NS
+ * @brief Abstand, in dem das Wecksignal wiederholt wird, bis ein Thread beendet ist.
+ */
+#define VC_WAKE_RETRY_NS 1000000
+
+const char *argp_program_version = "virtual-controller";
+const char *argp_program_bug_address = "";
+static char doc[] =
+	"virtual-controller meldet sich über raw-gadget als WS2812B-Controller (VID 0xcafe, PID 0x1234) an und führt die Firmware auf dem Host aus. "
+	"Voraussetzung sind die Kernelmodule dummy_hcd und raw_gadget (modprobe dummy_hcd; modprobe raw_gadget). "
+	"Die Zeiten von USB Full-Speed, der Ausgabe an die LEDs und des Latch werden nachgebildet, mit --no-timing läuft die Firmware ohne Verzögerung.";
+static char args_doc[] = "";
+
+/**
+ * @struct argp_option
+ * @brief Structure for command-line options
+ */
+static struct argp_option options[] = {
+	{ "driver", 'd', "NAME", 0, "UDC-Treiber (Standard dummy_udc)" },
+	{ "device", 'D', "NAME", 0, "UDC-Gerät (Standard dummy_udc.0)" },
+	{ "flash", 'b', "FILE", 0, "Datei für den emulierten Flash (Boot-Frames)" },
+	{ "no-timing", 'n', 0, 0, "Keine Verzögerung für USB und LED-Ausgabe" },
+	{ "verbose", 'v', 0, 0, "Gibt USB-Ereignisse aus" },
+	{ 0 },
+};
+
+/**
+ * @struct arguments
+ * @brief Structure to hold command-line arguments
+ */
+struct arguments {
+	const char *driver;
+	const char *device;
+	const char *flash;
+	bool no_timing;
+	bool verbose;
+};
+
+/**
+ * @brief Callback function to parse command-line options
+ */
+static error_t parse_opt(int key, char *arg, struct argp_state *state)
+{
+	struct arguments *arg_s = state->input;
+	switch (key) {
+	case 'd':
+		arg_s->driver = arg;
+		break;
+	case 'D':
+		arg_s->device = arg;
+		break;
+	case 'b':
+		arg_s->flash = arg;
+		break;
+	case 'n':
+		arg_s->no_timing = true;
+		break;
+	case 'v':
+		arg_s->verbose = true;
+		break;
+	default:
+		return ARGP_ERR_UNKNOWN;
+	}
+	return 0;
+}
+
+static struct argp argp = { options, parse_opt, args_doc, doc, 0, 0, 0 };
+
+/**
+ * @struct vc_strip
+ * @brief Endpoints, threads and statistics of a strip.
+ */
+struct vc_strip {
+	int ep_in; /**< raw-gadget handle of the bulk IN endpoint, -1 if disabled. */
+	int ep_out; /**< raw-gadget handle of the bulk OUT endpoint, -1 if disabled. */
+	pthread_t out_thread; /**< Receives packets and runs the firmware. */
+	pthread_t in_thread; /**< Sends the answers of the firmware. */
+	bool running; /**< The threads are started. */
+	bool out_stop; /**< The OUT thread has to stop. */
+	bool out_exited; /**< The OUT thread has left its loop. */
+	bool in_exited; /**< The IN thread has left its loop. */
+	pthread_mutex_t in_lock; /**< Protects the IN queue. */
+	pthread_cond_t in_cond; /**< Signals a new packet or stop. */
+	uint8_t in_queue[VC_IN_QUEUE_LEN][VC_PACKET_SIZE]; /**< Answers for the host. */
+	uint32_t in_len[VC_IN_QUEUE_LEN]; /**< Length of the answers. */
+	unsigned in_head; /**< Oldest answer. */
+	unsigned in_count; /**< Number of queued answers. */
+	bool in_stop; /**< The IN thread has to stop. */
+	uint64_t frame_start_ns; /**< Arrival of the first packet of the current frame, 0 if none. */
+	uint64_t packets; /**< Received packets. */
+	uint64_t answers; /**< Sent packets. */
+	uint64_t dropped; /**< Answers dropped because the queue was full. */
+	uint64_t frames; /**< Frames written to the LEDs. */
+	uint64_t pixels; /**< Pixels written to the LEDs. */
+	uint64_t latency_sum_ns; /**< Sum of first packet to latch of all frames. */
+	uint64_t latency_max_ns; /**< Maximum of first packet to latch. */
+};
+
+static struct arguments arguments = {
+	.driver = "dummy_udc",
+	.device = "dummy_udc.0",
+};
+static int vc_fd = -1;
+static struct vc_strip vc_strips[WS2812B_STRIP_COUNT];
+static bool vc_configured;
+static uint64_t vc_start_ns;
+static volatile sig_atomic_t vc_stop;
+
+/**
+ * @brief Die Firmware läuft auf einem Kern, Pakete aller Streifen werden nacheinander verarbeitet.
+ */
+static pthread_mutex_t vc_firmware_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Alle Streifen teilen sich einen Full-Speed-Bus, die Pakete aller Endpoints werden nacheinander getaktet.
+ */
+static pthread_mutex_t vc_bus_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t vc_bus_next_ns; /**< Earliest time for the next bulk packet on the bus, under vc_bus_lock. */
+
+/**
+ * @brief Control request with data stage for EP0.
+ */
+struct vc_ep0_io {
+	struct usb_raw_ep_io inner;
+	uint8_t data[512];
+};
+
+/**
+ * @brief Bulk transfer for a data endpoint.
+ */
+struct vc_ep_io {
+	struct usb_raw_ep_io inner;
+	uint8_t data[VC_PACKET_SIZE];
+};
+
+/**
+ * @brief Event with room for a setup packet.
+ */
+struct vc_event {
+	struct usb_raw_event inner;
+	struct usb_ctrlrequest ctrl;
+};
+
+/**
+ * @brief Returns the monotonic time in nanoseconds.
+ */
+static uint64_t vc_now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+/**
+ * @brief Sleeps until an absolute monotonic time.
+ */
+static void vc_sleep_until(uint64_t ns)
+{
+	struct timespec ts = {
+		.tv_sec = ns / 1000000000u,
+		.tv_nsec = ns % 1000000000u,
+	};
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) ==
+	       EINTR && !vc_stop) {
+	}
+}
+
+/**
+ * @brief Waits for the next free bulk packet slot on the shared bus.
+ *
+ * The slot is reserved under the bus lock and waited for afterwards, so the
+ * strips queue up behind each other like on the real bus.
+ */
+static void vc_bus_wait(void)
+{
+	uint64_t now = vc_now_ns();
+	uint64_t slot;
+
+	pthread_mutex_lock(&vc_bus_lock);
+	slot = vc_bus_next_ns > now ? vc_bus_next_ns : now;
+	vc_bus_next_ns = slot + VC_BULK_PACKET_NS;
+	pthread_mutex_unlock(&vc_bus_lock);
+	if (slot > now) {
+		vc_sleep_until(slot);
+	}
+}
+
+/**
+ * @brief Writes the emulated flash to the flash file.
+ */
+static void vc_flash_store(void)
+{
+	FILE *file = fopen(arguments.flash, "wb");
+
+	if (!file || fwrite(host_flash, sizeof(host_flash), 1, file) != 1) {
+		printf("Flash konnte nicht gespeichert werden: %s\n",
+		       strerror(errno));
+	}
+	if (file) {
+		fclose(file);
+	}
+}
+
+/**
+ * @brief Loads the emulated flash from the flash file if it exists.
+ */
+static void vc_flash_load(void)
+{
+	FILE *file = fopen(arguments.flash, "rb");
+
+	if (!file) {
+		return;
+	}
+	if (fread(host_flash, sizeof(host_flash), 1, file) != 1) {
+		printf("Flash-Datei %s ist unvollständig, Flash bleibt gelöscht\n",
+		       arguments.flash);
+		memset(host_flash, 0xFF, sizeof(host_flash));
+	}
+	fclose(file);
+}
+
+/**
+ * @brief IN hook of the host shim, queues an answer of the firmware.
+ *
+ * Like the TinyUSB TX FIFO the answer is dropped if the queue is full.
+ */
+static void vc_usb_in(uint8_t itf, const void *data, uint32_t len, void *arg)
+{
+	struct vc_strip *strip = &vc_strips[itf];
+	(void)arg;
+
+	if (len > VC_PACKET_SIZE) {
+		len = VC_PACKET_SIZE;
+	}
+	pthread_mutex_lock(&strip->in_lock);
+	if (strip->in_count == VC_IN_QUEUE_LEN) {
+		strip->dropped++;
+	} else {
+		unsigned slot = (strip->in_head + strip->in_count) %
+				VC_IN_QUEUE_LEN;
+		memcpy(strip->in_queue[slot], data, len);
+		strip->in_len[slot] = len;
+		strip->in_count++;
+		pthread_cond_signal(&strip->in_cond);
+	}
+	pthread_mutex_unlock(&strip->in_lock);
+}
+
+/**
+ * @brief Runs the firmware for a received packet.
+ *
+ * The firmware blocks in put_pixel() once the PIO FIFO is full and in
+ * sleep_us() for the latch. Both times are waited here in real time while
+ * holding the firmware lock, as the single core of the RP2040 would.
+ */
+static void vc_firmware_receive(int s, const uint8_t *packet, uint32_t len)
+{
+	struct vc_strip *strip = &vc_strips[s];
+	uint64_t words[WS2812B_STRIP_COUNT];
+	uint64_t received = vc_now_ns();
+
+	pthread_mutex_lock(&vc_firmware_lock);
+	for (int i = 0; i < WS2812B_STRIP_COUNT; i++) {
+		words[i] = pio0->sm[i].tx_words;
+	}
+	uint64_t sleep_start = host_time_us();
+
+	host_usb_receive(s, packet, len);
+	ws2812b_task();
+
+	uint64_t busy_ns = (host_time_us() - sleep_start) * 1000;
+	for (int i = 0; i < WS2812B_STRIP_COUNT; i++) {
+		uint64_t out = pio0->sm[i].tx_words - words[i];
+		if (out > VC_PIO_FIFO_DEPTH) {
+			busy_ns += (out - VC_PIO_FIFO_DEPTH) * VC_PIXEL_NS;
+		}
+	}
+	if (!arguments.no_timing && busy_ns) {
+		vc_sleep_until(vc_now_ns() + busy_ns);
+	}
+
+	uint64_t out = pio0->sm[s].tx_words - words[s];
+	strip->packets++;
+	if (packet[0] == LED_DATA) {
+		if (!strip->frame_start_ns) {
+			strip->frame_start_ns = received;
+		}
+		if (out) {
+			uint64_t latency = vc_now_ns() - strip->frame_start_ns;
+			strip->frames++;
+			strip->pixels += out;
+			strip->latency_sum_ns += latency;
+			if (latency > strip->latency_max_ns) {
+				strip->latency_max_ns = latency;
+			}
+			strip->frame_start_ns = 0;
+		}
+	}
+	pthread_mutex_unlock(&vc_firmware_lock);
+
+	if (packet[0] == SAVE_BOOT_FRAME && arguments.flash) {
+		vc_flash_store();
+	}
+}
+
+/**
+ * @brief Thread receiving the packets of the bulk OUT endpoint of a strip.
+ */
+static void *vc_out_thread(void *arg)
+{
+	int s = (int)(intptr_t)arg;
+	struct vc_strip *strip = &vc_strips[s];
+	struct vc_ep_io io;
+
+	while (!vc_stop && !__atomic_load_n(&strip->out_stop, __ATOMIC_ACQUIRE)) {
+		io.inner.ep = strip->ep_out;
+		io.inner.flags = 0;
+		io.inner.length = sizeof(io.data);
+		int rv = ioctl(vc_fd, USB_RAW_IOCTL_EP_READ, &io);
+		if (rv < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			break;
+		}
+		if (!arguments.no_timing) {
+			// Full-Speed schafft höchstens 19 Bulk-Pakete pro Frame, für alle Streifen zusammen
+			vc_bus_wait();
+		}
+		if (rv > 0) {
+			vc_firmware_receive(s, io.data, rv);
+		}
+	}
+	__atomic_store_n(&strip->out_exited, true, __ATOMIC_RELEASE);
+	return NULL;
+}
+
+/**
+ * @brief Thread sending the answers of the firmware on the bulk IN endpoint of a strip.
+ */
+static void *vc_in_thread(void *arg)
+{
+	struct vc_strip *strip = &vc_strips[(intptr_t)arg];
+	struct vc_ep_io io;
+
+	for (;;) {
+		pthread_mutex_lock(&strip->in_lock);
+		while (!strip->in_count && !strip->in_stop) {
+			pthread_cond_wait(&strip->in_cond, &strip->in_lock);
+		}
+		if (strip->in_stop) {
+			pthread_mutex_unlock(&strip->in_lock);
+			break;
+		}
+		io.inner.ep = strip->ep_in;
+		io.inner.flags = 0;
+		io.inner.length = strip->in_len[strip->in_head];
+		memcpy(io.data, strip->in_queue[strip->in_head],
+		       io.inner.length);
+		strip->in_head = (strip->in_head + 1) % VC_IN_QUEUE_LEN;
+		strip->in_count--;
+		pthread_mutex_unlock(&strip->in_lock);
+
+		if (!arguments.no_timing) {
+			vc_bus_wait();
+		}
+		if (ioctl(vc_fd, USB_RAW_IOCTL_EP_WRITE, &io) < 0) {
+			// EINTR: Wecksignal von vc_deconfigure(), in_stop wird oben geprüft
+			if (errno == EINTR) {
+				continue;
+			}
+			break;
+		}
+		strip->answers++;
+	}
+	__atomic_store_n(&strip->in_exited, true, __ATOMIC_RELEASE);
+	return NULL;
+}
+
+/**
+ * @brief Handler of VC_WAKE_SIGNAL, only interrupts the blocking ioctl.
+ */
+static void vc_wake(int sig)
+{
+	(void)sig;
+}
+
+/**
+ * @brief Interrupts a strip thread until it has left its loop and joins it.
+ *
+ * raw-gadget refuses to disable an endpoint with a pending EP_READ/EP_WRITE
+ * (EBUSY), so the thread is woken with VC_WAKE_SIGNAL instead. The signal is
+ * repeated because it may arrive just before the thread enters the ioctl.
+ */
+static void vc_join_strip_thread(pthread_t thread, const bool *exited)
+{
+	while (!__atomic_load_n(exited, __ATOMIC_ACQUIRE)) {
+		pthread_kill(thread, VC_WAKE_SIGNAL);
+		vc_sleep_until(vc_now_ns() + VC_WAKE_RETRY_NS);
+	}
+	pthread_join(thread, NULL);
+}
+
+/**
+ * @brief Stops the threads and disables the endpoints of all strips.
+ *
+ * The endpoints are only disabled once no thread uses them any more.
+ */
+static void vc_deconfigure(void)
+{
+	for (int s = 0; s < WS2812B_STRIP_COUNT; s++) {
+		struct vc_strip *strip = &vc_strips[s];
+
+		if (strip->running) {
+			__atomic_store_n(&strip->out_stop, true, __ATOMIC_RELEASE);
+			pthread_mutex_lock(&strip->in_lock);
+			strip->in_stop = true;
+			pthread_cond_signal(&strip->in_cond);
+			pthread_mutex_unlock(&strip->in_lock);
+			vc_join_strip_thread(strip->out_thread, &strip->out_exited);
+			vc_join_strip_thread(strip->in_thread, &strip->in_exited);
+			strip->running = false;
+		}
+		if (strip->ep_out >= 0 &&
+		    ioctl(vc_fd, USB_RAW_IOCTL_EP_DISABLE, strip->ep_out) < 0) {
+			printf("Endpoint OUT von Streifen %d konnte nicht deaktiviert werden: %s\n",
+			       s, strerror(errno));
+		}
+		if (strip->ep_in >= 0 &&
+		    ioctl(vc_fd, USB_RAW_IOCTL_EP_DISABLE, strip->ep_in) < 0) {
+			printf("Endpoint IN von Streifen %d konnte nicht deaktiviert werden: %s\n",
+			       s, strerror(errno));
+		}
+		strip->ep_in = -1;
+		strip->ep_out = -1;
+		strip->in_stop = false;
+		strip->out_stop = false;
+		strip->out_exited = false;
+		strip->in_exited = false;
+		strip->in_count = 0;
+		strip->frame_start_ns = 0;
+	}
+	vc_configured = false;
+}
+
+/**
+ * @brief Enables the endpoints of the configuration descriptor and starts the threads.
+ *
+ * Interface n belongs to strip n, like in tud_vendor_rx_cb().
+ *
+ * @return 0 on success, -1 on error.
+ */
+static int vc_configure(void)
+{
+	const tusb_desc_configuration_t *config =
+		(const tusb_desc_configuration_t *)
+			tud_descriptor_configuration_cb(0);
+	const uint8_t *p = (const uint8_t *)config;
+	const uint8_t *end = p + config->wTotalLength;
+	int itf = -1;
+
+	if (vc_configured) {
+		vc_deconfigure();
+	}
+
+	while (p < end && p[0]) {
+		if (p[1] == TUSB_DESC_INTERFACE) {
+			itf = p[2];
+		} else if (p[1] == TUSB_DESC_ENDPOINT && itf >= 0 &&
+			   itf < WS2812B_STRIP_COUNT) {
+			struct usb_endpoint_descriptor ep;
+			memset(&ep, 0, sizeof(ep));
+			memcpy(&ep, p, USB_DT_ENDPOINT_SIZE);
+			int handle = ioctl(vc_fd, USB_RAW_IOCTL_EP_ENABLE, &ep);
+			if (handle < 0) {
+				printf("Endpoint 0x%02x konnte nicht aktiviert werden: %s\n",
+				       ep.bEndpointAddress, strerror(errno));
+				return -1;
+			}
+			if (ep.bEndpointAddress & USB_DIR_IN) {
+				vc_strips[itf].ep_in = handle;
+			} else {
+				vc_strips[itf].ep_out = handle;
+			}
+		}
+		p += p[0];
+	}
+
+	ioctl(vc_fd, USB_RAW_IOCTL_VBUS_DRAW, config->bMaxPower);
+	if (ioctl(vc_fd, USB_RAW_IOCTL_CONFIGURE, 0) < 0) {
+		printf("USB_RAW_IOCTL_CONFIGURE: %s\n", strerror(errno));
+		return -1;
+	}
+
+	// Strg+C soll EVENT_FETCH im Hauptthread unterbrechen, nicht die Streifen-Threads
+	sigset_t block, old;
+	sigemptyset(&block);
+	sigaddset(&block, SIGINT);
+	sigaddset(&block, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &block, &old);
+	for (int s = 0; s < WS2812B_STRIP_COUNT; s++) {
+		struct vc_strip *strip = &vc_strips[s];
+		if (strip->ep_in < 0 || strip->ep_out < 0) {
+			continue;
+		}
+		pthread_create(&strip->out_thread, NULL, vc_out_thread,
+			       (void *)(intptr_t)s);
+		pthread_create(&strip->in_thread, NULL, vc_in_thread,
+			       (void *)(intptr_t)s);
+		strip->running = true;
+	}
+	pthread_sigmask(SIG_SETMASK, &old, NULL);
+	vc_configured = true;
+	return 0;
+}
+
+/**
+ * @brief Answers a control request with data.
+ */
+static void vc_ep0_write(const void *data, size_t len, uint16_t length)
+{
+	struct vc_ep0_io io;
+
+	if (len > length) {
+		len = length;
+	}
+	if (len > sizeof(io.data)) {
+		len = sizeof(io.data);
+	}
+	io.inner.ep = 0;
+	io.inner.flags = 0;
+	io.inner.length = len;
+	memcpy(io.data, data, len);
+	if (ioctl(vc_fd, USB_RAW_IOCTL_EP0_WRITE, &io) < 0) {
+		printf("USB_RAW_IOCTL_EP0_WRITE: %s\n", strerror(errno));
+	}
+}
+
+/**
+ * @brief Acknowledges a control request without data.
+ */
+static void vc_ep0_ack(void)
+{
+	struct vc_ep0_io io;
+
+	io.inner.ep = 0;
+	io.inner.flags = 0;
+	io.inner.length = 0;
+	if (ioctl(vc_fd, USB_RAW_IOCTL_EP0_READ, &io) < 0) {
+		printf("USB_RAW_IOCTL_EP0_READ: %s\n", strerror(errno));
+	}
+}
+
+/**
+ * @brief Handles the standard requests of the enumeration, everything else is stalled.
+ */
+static void vc_handle_control(const struct usb_ctrlrequest *ctrl)
+{
+	uint16_t value = ctrl->wValue;
+	uint16_t length = ctrl->wLength;
+
+	if (arguments.verbose) {
+		printf("Control: bRequestType 0x%02x bRequest 0x%02x wValue 0x%04x wIndex 0x%04x wLength %u\n",
+		       ctrl->bRequestType, ctrl->bRequest, value,
+		       ctrl->wIndex, length);
+	}
+
+	if ((ctrl->bRequestType & USB_TYPE_MASK) != USB_TYPE_STANDARD) {
+		ioctl(vc_fd, USB_RAW_IOCTL_EP0_STALL, 0);
+		return;
+	}
+
+	switch (ctrl->bRequest) {
+	case USB_REQ_GET_DESCRIPTOR:
+		switch (value >> 8) {
+		case USB_DT_DEVICE: {
+			const uint8_t *desc = tud_descriptor_device_cb();
+			vc_ep0_write(desc, desc[0], length);
+			return;
+		}
+		case USB_DT_CONFIG: {
+			const tusb_desc_configuration_t *desc =
+				(const tusb_desc_configuration_t *)
+					tud_descriptor_configuration_cb(
+						value & 0xFF);
+			vc_ep0_write(desc, desc->wTotalLength, length);
+			return;
+		}
+		case USB_DT_STRING: {
+			const uint8_t *desc = (const uint8_t *)
+				tud_descriptor_string_cb(value & 0xFF,
+							 ctrl->wIndex);
+			if (desc) {
+				vc_ep0_write(desc, desc[0], length);
+				return;
+			}
+			break;
+		}
+		default:
+			break;
+		}
+		break;
+
+	case USB_REQ_SET_CONFIGURATION:
+		if (value == 0) {
+			vc_deconfigure();
+			vc_ep0_ack();
+			return;
+		}
+		if (vc_configure() == 0) {
+			vc_ep0_ack();
+			return;
+		}
+		break;
+
+	case USB_REQ_GET_CONFIGURATION: {
+		uint8_t configuration = vc_configured ? 1 : 0;
+		vc_ep0_write(&configuration, 1, length);
+		return;
+	}
+
+	case USB_REQ_SET_INTERFACE:
+		if (value == 0) {
+			vc_ep0_ack();
+			return;
+		}
+		break;
+
+	case USB_REQ_GET_INTERFACE: {
+		uint8_t alternate = 0;
+		vc_ep0_write(&alternate, 1, length);
+		return;
+	}
+
+	case USB_REQ_GET_STATUS: {
+		uint16_t status = 0;
+		vc_ep0_write(&status, 2, length);
+		return;
+	}
+
+	default:
+		break;
+	}
+	ioctl(vc_fd, USB_RAW_IOCTL_EP0_STALL, 0);
+}
+
+/**
+ * @brief Signal handler for a clean shutdown.
+ */
+static void vc_signal(int sig)
+{
+	(void)sig;
+	vc_stop = 1;
+}
+
+/**
+ * @brief Prints the statistics of all strips.
+ */
+static void vc_print_stats(void)
+{
+	double seconds = (vc_now_ns() - vc_start_ns) / 1e9;
+
+	for (int s = 0; s < WS2812B_STRIP_COUNT; s++) {
+		struct vc_strip *strip = &vc_strips[s];
+		printf("Streifen %d: %" PRIu64 " Pakete empfangen, %" PRIu64
+		       " gesendet (%" PRIu64 " verworfen), %" PRIu64
+		       " Frames, %" PRIu64 " Pixel\n",
+		       s, strip->packets, strip->answers, strip->dropped,
+		       strip->frames, strip->pixels);
+		if (strip->frames) {
+			printf("            %.1f Frames/s, Latenz erstes Paket bis Latch: mittel %.3f ms, max %.3f ms\n",
+			       strip->frames / seconds,
+			       strip->latency_sum_ns / 1e6 / strip->frames,
+			       strip->latency_max_ns / 1e6);
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	struct usb_raw_init init;
+	struct sigaction sa;
+
+	argp_parse(&argp, argc, argv, 0, 0, &arguments);
+
+	host_shim_init();
+	if (arguments.flash) {
+		vc_flash_load();
+	}
+	host_usb_set_in_hook(vc_usb_in, NULL);
+	ws2812b_init();
+
+	for (int s = 0; s < WS2812B_STRIP_COUNT; s++) {
+		vc_strips[s].ep_in = -1;
+		vc_strips[s].ep_out = -1;
+		pthread_mutex_init(&vc_strips[s].in_lock, NULL);
+		pthread_cond_init(&vc_strips[s].in_cond, NULL);
+	}
+
+	vc_fd = open("/dev/raw-gadget", O_RDWR);
+	if (vc_fd < 0) {
+		printf("/dev/raw-gadget: %s (modprobe raw_gadget?)\n",
+		       strerror(errno));
+		return EXIT_FAILURE;
+	}
+
+	memset(&init, 0, sizeof(init));
+	strncpy((char *)init.driver_name, arguments.driver,
+		UDC_NAME_LENGTH_MAX - 1);
+	strncpy((char *)init.device_name, arguments.device,
+		UDC_NAME_LENGTH_MAX - 1);
+	init.speed = USB_SPEED_FULL;
+	if (ioctl(vc_fd, USB_RAW_IOCTL_INIT, &init) < 0 ||
+	    ioctl(vc_fd, USB_RAW_IOCTL_RUN, 0) < 0) {
+		printf("raw-gadget konnte nicht gestartet werden: %s (modprobe dummy_hcd?)\n",
+		       strerror(errno));
+		close(vc_fd);
+		return EXIT_FAILURE;
+	}
+
+	// Ohne SA_RESTART, damit EVENT_FETCH bei Strg+C und EP_READ/EP_WRITE beim Wecksignal zurückkehren
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = vc_signal;
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+	sa.sa_handler = vc_wake;
+	sigaction(VC_WAKE_SIGNAL, &sa, NULL);
+
+	vc_start_ns = vc_now_ns();
+	printf("Virtueller Controller mit %d Streifen gestartet\n",
+	       WS2812B_STRIP_COUNT);
+
+	while (!vc_stop) {
+		struct vc_event event;
+
+		event.inner.type = 0;
+		event.inner.length = sizeof(event.ctrl);
+		if (ioctl(vc_fd, USB_RAW_IOCTL_EVENT_FETCH, &event) < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			printf("USB_RAW_IOCTL_EVENT_FETCH: %s\n",
+			       strerror(errno));
+			break;
+		}
+
+		switch (event.inner.type) {
+		case USB_RAW_EVENT_CONNECT:
+			if (arguments.verbose) {
+				printf("Connect\n");
+			}
+			break;
+		case USB_RAW_EVENT_CONTROL:
+			// Nach einem Reset räumt SET_CONFIGURATION die alten Endpoints ab
+			vc_handle_control(&event.ctrl);
+			break;
+		default:
+			break;
+		}
+	}
+
+	if (vc_configured) {
+		vc_deconfigure();
+	}
+	vc_print_stats();
+	close(vc_fd);
+	return EXIT_SUCCESS;
+}
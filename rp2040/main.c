@@ -10,13 +10,17 @@
 #include "tusb.h"
 #include "tusb_config.h"
 #include "hardware/pio.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
 #include "ws2812.pio.h"
 #include "usb_packets.h"
 #include <stdlib.h>
 
 /**
  * @def WS2812B_PIN
- * @brief Der PIO-Pin, an den die WS2812B-LEDs angeschlossen sind.
+ * @brief Der PIO-Pin, an den der erste WS2812B-Streifen angeschlossen ist.
+ *
+ * Streifen n ist an Pin WS2812B_PIN + n angeschlossen.
  */
 #define WS2812B_PIN 2
 
@@ -26,6 +30,10 @@
  */
 #define WS2812B_BUFFER_SIZE 1000
 
+// Jeder Streifen belegt eine State-Machine von pio0
+_Static_assert(WS2812B_STRIP_COUNT >= 1 && WS2812B_STRIP_COUNT <= 4,
+	       "WS2812B_STRIP_COUNT muss zwischen 1 und 4 liegen");
+
 /**
  * @struct ws2812b_pixel
  * @brief Datenstruktur zur Darstellung eines einzelnen WS2812B-Pixels.
@@ -36,23 +44,70 @@ typedef struct ws2812b_pixel {
 	uint8_t b; /**< Der Blauanteil des Pixels. */
 } ws2812b_pixel;
 
-ws2812b_pixel *ws2812b_buffer; /**< Der Pixel-Buffer. */
-uint32_t ws2812b_index = 0; /**< Der aktuelle Index im Buffer. */
-bool ws2812b_ready =
-	false; /**< Gibt an, ob der Buffer bereit ist, auf die LEDs geschrieben zu werden. */
-uint32_t ws2812b_count =
-	0; /**< Die in den Buffer geschriebenen WS2812B-Pixel. */
+/**
+ * @struct ws2812b_strip
+ * @brief Zustand eines an den Controller angeschlossenen WS2812B-Streifens.
+ *
+ * Jeder Streifen wird über ein eigenes USB-Vendor-Interface angesprochen und
+ * von einer eigenen PIO-State-Machine ausgegeben.
+ */
+typedef struct ws2812b_strip {
+	ws2812b_pixel *buffer; /**< Der Pixel-Buffer. */
+	uint32_t index; /**< Der aktuelle Index im Buffer. */
+	bool ready; /**< Gibt an, ob der Buffer bereit ist, auf die LEDs geschrieben zu werden. */
+	uint32_t count; /**< Die in den Buffer geschriebenen WS2812B-Pixel. */
+	uint32_t send_index; /**< Der Index für das Senden des Buffer */
+	uint sm; /**< Die State-Machine von pio0, die den Streifen ausgibt. */
+} ws2812b_strip;
+
+/**
+ * @def WS2812B_BOOT_FRAME_OFFSET
+ * @brief Offset des für den Boot-Frame eines Streifens reservierten Flash-Sektors.
+ *
+ * Die Sektoren liegen am Ende des Flash, Streifen 0 belegt den letzten Sektor.
+ */
+#define WS2812B_BOOT_FRAME_OFFSET(strip_index) \
+	(PICO_FLASH_SIZE_BYTES - ((strip_index) + 1) * FLASH_SECTOR_SIZE)
+
+/**
+ * @def WS2812B_BOOT_FRAME_MAGIC
+ * @brief Kennung eines gültigen Boot-Frames im Flash ("WS2B").
+ */
+#define WS2812B_BOOT_FRAME_MAGIC 0x57533242
+
+/**
+ * @struct ws2812b_boot_frame
+ * @brief Layout des Boot-Frames im reservierten Flash-Sektor.
+ */
+typedef struct ws2812b_boot_frame {
+	uint32_t magic; /**< WS2812B_BOOT_FRAME_MAGIC, wenn der Frame gültig ist. */
+	uint16_t count; /**< Anzahl der gespeicherten Pixel. */
+	uint16_t reserved; /**< Unbenutzt. */
+	ws2812b_pixel pixel[WS2812B_BUFFER_SIZE]; /**< Die gespeicherten Pixel. */
+} ws2812b_boot_frame;
+
+/**
+ * @def WS2812B_BOOT_FRAME_PROGRAM_SIZE
+ * @brief Größe des Boot-Frames aufgerundet auf ganze Flash-Pages.
+ */
+#define WS2812B_BOOT_FRAME_PROGRAM_SIZE                     \
+	((sizeof(ws2812b_boot_frame) + FLASH_PAGE_SIZE - 1) & \
+	 ~(FLASH_PAGE_SIZE - 1))
+
+_Static_assert(WS2812B_BOOT_FRAME_PROGRAM_SIZE <= FLASH_SECTOR_SIZE,
+	       "Boot-Frame passt nicht in einen Flash-Sektor");
 
-uint32_t ws2812b_send_index = 0; /**< Der Index für das Senden des Buffer */
+ws2812b_strip ws2812b_strips[WS2812B_STRIP_COUNT]; /**< Die LED-Streifen. */
 
 /**
  * @brief Setzt einen Pixelwert auf den Datenbus des WS2812B.
  *
+ * @param strip Der Streifen, auf dessen Datenbus der Pixel gesendet wird.
  * @param pixel_grb Der 24-Bit-Pixelwert in GRB-Reihenfolge.
  */
-static inline void put_pixel(uint32_t pixel_grb)
+static inline void put_pixel(ws2812b_strip *strip, uint32_t pixel_grb)
 {
-	pio_sm_put_blocking(pio0, 0, pixel_grb << 8u);
+	pio_sm_put_blocking(pio0, strip->sm, pixel_grb << 8u);
 }
 
 /**
@@ -70,51 +125,118 @@ static inline uint32_t urgb_u32(uint8_t r, uint8_t g, uint8_t b)
 
 /**
  * @brief Hauptfunktion zur Aktualisierung der WS2812B-LEDs.
+ *
+ * Gibt die Buffer aller Streifen aus, die vollständig empfangen wurden.
  */
 void ws2812b_task()
 {
-	if (ws2812b_ready) {
-		for (int i = 0; i < ws2812b_count; i++) {
-			put_pixel(urgb_u32(ws2812b_buffer[i].r,
-					   ws2812b_buffer[i].g,
-					   ws2812b_buffer[i].b));
+	bool updated = false;
+
+	for (int s = 0; s < WS2812B_STRIP_COUNT; s++) {
+		ws2812b_strip *strip = &ws2812b_strips[s];
+		if (!strip->ready) {
+			continue;
+		}
+		for (int i = 0; i < strip->count; i++) {
+			put_pixel(strip, urgb_u32(strip->buffer[i].r,
+						  strip->buffer[i].g,
+						  strip->buffer[i].b));
 		}
-		ws2812b_ready = false;
+		strip->ready = false;
+		updated = true;
+	}
+
+	if (updated) {
 		sleep_us(
 			500); /**< Blocking Sleep für die Aktualisierung der LEDs. */
 	}
 }
 
 /**
- * @brief Löscht alle Pixel im WS2812B-Buffer (Setzt Helligkeit auf 0).
+ * @brief Löscht alle Pixel eines Streifens (Setzt Helligkeit auf 0).
+ *
+ * @param strip Der zu löschende Streifen.
  */
-void ws2812b_clear()
+void ws2812b_clear(ws2812b_strip *strip)
 {
 	for (int i = 0; i < WS2812B_BUFFER_SIZE; i++) {
-		put_pixel(urgb_u32(0, 0, 0));
+		put_pixel(strip, urgb_u32(0, 0, 0));
 	}
 	sleep_us(500); /**< Blocking Sleep für die Aktualisierung der LEDs. */
 }
 
 /**
- * @brief Die Hauptfunktion des Programms.
+ * @brief Lädt den Boot-Frame eines Streifens aus dem Flash in dessen Buffer.
  *
- * Initialisiert die Hardware, den Buffer und die Endlosschleife für die Programm-Ausführung.
+ * Ist im reservierten Flash-Sektor ein gültiger Boot-Frame gespeichert, werden Länge und
+ * Pixeldaten übernommen und der Buffer zum Senden freigegeben.
  *
- * @return Der Programm-Rückgabewert (wird in diesem Fall nie erreicht).
+ * @param strip_index Der Index des Streifens.
  */
-int main(void)
+void ws2812b_load_boot_frame(int strip_index)
+{
+	ws2812b_strip *strip = &ws2812b_strips[strip_index];
+	const ws2812b_boot_frame *boot_frame =
+		(const ws2812b_boot_frame *)(XIP_BASE +
+					     WS2812B_BOOT_FRAME_OFFSET(
+						     strip_index));
+
+	if (boot_frame->magic != WS2812B_BOOT_FRAME_MAGIC ||
+	    boot_frame->count > WS2812B_BUFFER_SIZE) {
+		return;
+	}
+
+	strip->count = boot_frame->count;
+	memcpy(strip->buffer, boot_frame->pixel,
+	       strip->count * sizeof(ws2812b_pixel));
+	strip->ready = true;
+}
+
+/**
+ * @brief Initialisiert die Hardware, die Buffer der Streifen und zeigt die Boot-Frames an.
+ *
+ * Wird vor tusb_init() aufgerufen und ist von main() getrennt, damit der Host-Build
+ * (siehe host/) die Firmware ohne Endlosschleife initialisieren kann.
+ */
+void ws2812b_init(void)
 {
 	PIO pio = pio0;
-	int sm = 0;
 	uint offset = pio_add_program(pio, &ws2812_program);
 
-	ws2812b_buffer = calloc(WS2812B_BUFFER_SIZE, sizeof(ws2812b_pixel));
+	for (int s = 0; s < WS2812B_STRIP_COUNT; s++) {
+		ws2812b_strips[s] = (ws2812b_strip){
+			.buffer = calloc(WS2812B_BUFFER_SIZE,
+					 sizeof(ws2812b_pixel)),
+			.sm = s,
+		};
+	}
 
 	board_init();
-	tusb_init();
 
-	ws2812_program_init(pio, sm, offset, WS2812B_PIN, 800000);
+	for (int s = 0; s < WS2812B_STRIP_COUNT; s++) {
+		ws2812_program_init(pio, ws2812b_strips[s].sm, offset,
+				    WS2812B_PIN + s, 800000);
+	}
+
+	// Boot-Frames anzeigen, bevor der Host das Gerät enumeriert
+	for (int s = 0; s < WS2812B_STRIP_COUNT; s++) {
+		ws2812b_load_boot_frame(s);
+	}
+	ws2812b_task();
+}
+
+/**
+ * @brief Die Hauptfunktion des Programms.
+ *
+ * Initialisiert die Hardware, die Buffer und die Endlosschleife für die Programm-Ausführung.
+ *
+ * @return Der Programm-Rückgabewert (wird in diesem Fall nie erreicht).
+ */
+int main(void)
+{
+	ws2812b_init();
+
+	tusb_init();
 
 	while (1) {
 		tud_task();
@@ -129,24 +251,25 @@ int main(void)
  *
  * Nimmt den USB-Buffer und schreibt die Daten strukturiertin den WS2812B-Buffer.
  *
+ * @param strip Der Streifen, für den die Daten bestimmt sind.
  * @param usb_buffer Der USB-Buffer.
  */
-void fill_ws2812b_buffer(uint8_t *usb_buffer)
+void fill_ws2812b_buffer(ws2812b_strip *strip, uint8_t *usb_buffer)
 {
 	uint32_t i = 1;
 	while (i < (CFG_TUD_VENDOR_RX_BUFSIZE - 1) &&
-	       ws2812b_index < ws2812b_count) {
-		ws2812b_buffer[ws2812b_index].r = usb_buffer[i];
-		ws2812b_buffer[ws2812b_index].g = usb_buffer[i + 1];
-		ws2812b_buffer[ws2812b_index].b = usb_buffer[i + 2];
+	       strip->index < strip->count) {
+		strip->buffer[strip->index].r = usb_buffer[i];
+		strip->buffer[strip->index].g = usb_buffer[i + 1];
+		strip->buffer[strip->index].b = usb_buffer[i + 2];
 
-		ws2812b_index++;
+		strip->index++;
 		i += 3;
 	}
 
-	if (ws2812b_index == ws2812b_count) {
-		ws2812b_ready = true;
-		ws2812b_index = 0;
+	if (strip->index == strip->count) {
+		strip->ready = true;
+		strip->index = 0;
 	}
 }
 
@@ -155,51 +278,54 @@ void fill_ws2812b_buffer(uint8_t *usb_buffer)
  *
  * Nimmt den USB-Buffer, extrahiert die Länge und speichert diese.
  *
+ * @param strip Der Streifen, dessen Länge gesetzt wird.
  * @param usb_buffer Der USB-Buffer.
  */
-void set_ws2812b_length(uint8_t *usb_buffer)
+void set_ws2812b_length(ws2812b_strip *strip, uint8_t *usb_buffer)
 {
-	ws2812b_count = usb_buffer[1] << 8 | usb_buffer[2];
-	ws2812b_clear();
+	strip->count = usb_buffer[1] << 8 | usb_buffer[2];
+	ws2812b_clear(strip);
 }
 
 /**
  * @brief Diese Funktion wird bei Empfang des CTRL-Bit 0x02 ausgeführt.
  *
  * Schreibt die Länge des WS2812B-Buffer in den USB-Buffer.
- * 
+ *
+ * @param strip Der Streifen, dessen Länge geschrieben wird.
  * @param buffer_out Der USB-Buffer.
  */
-void get_ws2812b_length_usb_packet(uint8_t *buffer_out)
+void get_ws2812b_length_usb_packet(ws2812b_strip *strip, uint8_t *buffer_out)
 {
 	buffer_out[0] = 0x01;
-	buffer_out[1] = ws2812b_count >> 8;
-	buffer_out[2] = ws2812b_count & 0xFF;
+	buffer_out[1] = strip->count >> 8;
+	buffer_out[2] = strip->count & 0xFF;
 }
 
 /**
  * @brief Diese Funktion wird bei Empfang des CTRL-Bit 0x03 und 0x04 ausgeführt.
- * 
+ *
  * Schreibt die Daten des WS2812B-Buffer in den USB-Buffer.
- * 
+ *
+ * @param strip Der Streifen, dessen Daten geschrieben werden.
  * @param buffer_out Der USB-Buffer.
  */
-void get_ws2812b_buffer_usb_packet(uint8_t *buffer_out)
+void get_ws2812b_buffer_usb_packet(ws2812b_strip *strip, uint8_t *buffer_out)
 {
 	buffer_out[0] = 0x00;
 	uint32_t i = 0;
 	while (i < (CFG_TUD_VENDOR_TX_BUFSIZE - 1) &&
-	       ws2812b_send_index < ws2812b_count) {
-		buffer_out[i + 1] = ws2812b_buffer[ws2812b_send_index].r;
-		buffer_out[i + 2] = ws2812b_buffer[ws2812b_send_index].g;
-		buffer_out[i + 3] = ws2812b_buffer[ws2812b_send_index].b;
+	       strip->send_index < strip->count) {
+		buffer_out[i + 1] = strip->buffer[strip->send_index].r;
+		buffer_out[i + 2] = strip->buffer[strip->send_index].g;
+		buffer_out[i + 3] = strip->buffer[strip->send_index].b;
 
-		ws2812b_send_index++;
+		strip->send_index++;
 		i += 3;
 	}
 
-	if (ws2812b_send_index == ws2812b_count) {
-		ws2812b_send_index = 0;
+	if (strip->send_index == strip->count) {
+		strip->send_index = 0;
 	}
 }
 
@@ -210,30 +336,32 @@ void get_ws2812b_buffer_usb_packet(uint8_t *buffer_out)
  * It extracts the color data (red, green, blue) for each LED from the packet
  * and stores it in a buffer. The data is then used to update the state of the LEDs.
  *
+ * @param strip Pointer to the strip the packet was received for.
  * @param pixel_data_pkg Pointer to the WS2812 USB packet containing pixel data.
  *
  * @note The function processes up to 21 LEDs per packet and updates the LEDs
- *       if the end when data for all LEDs are received. It sets `ws2812b_ready` to true
+ *       if the end when data for all LEDs are received. It sets `ready` of the strip to true
  *       indicating that the LEDs are ready to be updated with new data.
  */
-void ws2812_handle_led_data_pkg(ws2812_usb_packet_pixeldata *pixel_data_pkg)
+void ws2812_handle_led_data_pkg(ws2812b_strip *strip,
+				ws2812_usb_packet_pixeldata *pixel_data_pkg)
 {
 	int i = 0;
-	while (i < 21 && ws2812b_index < ws2812b_count) {
-		ws2812b_buffer[ws2812b_index].r =
+	while (i < 21 && strip->index < strip->count) {
+		strip->buffer[strip->index].r =
 			pixel_data_pkg->color_data[i].red;
-		ws2812b_buffer[ws2812b_index].g =
+		strip->buffer[strip->index].g =
 			pixel_data_pkg->color_data[i].green;
-		ws2812b_buffer[ws2812b_index].b =
+		strip->buffer[strip->index].b =
 			pixel_data_pkg->color_data[i].blue;
 
-		ws2812b_index++;
+		strip->index++;
 		i++;
 	}
 
-	if (ws2812b_index == ws2812b_count) {
-		ws2812b_ready = true;
-		ws2812b_index = 0;
+	if (strip->index == strip->count) {
+		strip->ready = true;
+		strip->index = 0;
 	}
 }
 
@@ -241,61 +369,69 @@ void ws2812_handle_led_data_pkg(ws2812_usb_packet_pixeldata *pixel_data_pkg)
  * @brief Diese Funktion wird bei Empfang des CTRL-Bit 0x01 ausgeführt
  *
  * Nimmt das Paket, extrahiert die Länge und speichert diese.
- * 
+ *
+ * @param strip Der Streifen, dessen Länge gesetzt wird.
  * @param count_pkg Das empfangene Paket
  */
-void ws2812_handle_led_count_pkg(ws2812_usb_packet_count *count_pkg)
+void ws2812_handle_led_count_pkg(ws2812b_strip *strip,
+				 ws2812_usb_packet_count *count_pkg)
 {
 	// TOD: Check max size
-	ws2812b_count = count_pkg->led_count_H << 8 |
-			count_pkg->led_count_L & 0xFF;
-	ws2812b_clear();
+	strip->count = count_pkg->led_count_H << 8 |
+		       count_pkg->led_count_L & 0xFF;
+	ws2812b_clear(strip);
 }
 
 /**
  * @brief Handles LED count request packets.
  *
- * This function responds to requests for the current count of WS2812 LEDs and 
- * the maximum number of LEDs supported. It prepares a packet containing the 
- * current LED count and the maximum count, then sends this packet back to the 
+ * This function responds to requests for the current count of WS2812 LEDs and
+ * the maximum number of LEDs supported. It prepares a packet containing the
+ * current LED count and the maximum count, then sends this packet back to the
  * USB host.
  *
- * The packet includes both the current number of LEDs (`ws2812b_count`) and the 
- * maximum number of LEDs that can be handled (`WS2812B_BUFFER_SIZE`). These counts 
+ * The packet includes both the current number of LEDs (`count` of the strip) and the
+ * maximum number of LEDs that can be handled (`WS2812B_BUFFER_SIZE`). These counts
  * are split into high and low bytes before being sent.
+ *
+ * @param strip Pointer to the strip the request was received for.
+ * @param itf The vendor interface the answer is sent on.
  */
-void ws2812_handle_led_request_len_pkg()
+void ws2812_handle_led_request_len_pkg(ws2812b_strip *strip, uint8_t itf)
 {
 	ws2812_usb_packet_count count_pkg;
 	memset(&count_pkg, 0, sizeof(count_pkg));
 	count_pkg.ctrl = LED_COUNT;
-	count_pkg.led_count_H = ws2812b_count >> 8;
-	count_pkg.led_count_L = ws2812b_count & 0xFF;
+	count_pkg.led_count_H = strip->count >> 8;
+	count_pkg.led_count_L = strip->count & 0xFF;
 	uint16_t max_count = WS2812B_BUFFER_SIZE;
 	count_pkg.max_led_count_H = max_count >> 8;
 	count_pkg.max_led_count_L = max_count & 0xFF;
 
 	// sizeof(count_pkg) muss gleich CFG_TUD_VENDOR_TX_BUFSIZE sein!
-	tud_vendor_write(&count_pkg, CFG_TUD_VENDOR_TX_BUFSIZE);
+	tud_vendor_n_write(itf, &count_pkg, CFG_TUD_VENDOR_TX_BUFSIZE);
 }
 
 /**
  * @brief Handles requests for pixeldata.
  *
- * This function is called when a request for pixeldata is received. 
- * It constructs a packet containing the color data (red, green, blue) 
- * for a block of WS2812 LEDs starting from the specified index and sends this 
+ * This function is called when a request for pixeldata is received.
+ * It constructs a packet containing the color data (red, green, blue)
+ * for a block of WS2812 LEDs starting from the specified index and sends this
  * packet back to the USB host.
  *
- * The block index is extracted from the request packet and used to determine 
- * the starting index of the LED data in the `ws2812b_buffer`. The function then 
- * populates a pixel data packet with up to 21 LED's color data from this starting 
- * index and sends it using `tud_vendor_write`.
+ * The block index is extracted from the request packet and used to determine
+ * the starting index of the LED data in the buffer of the strip. The function then
+ * populates a pixel data packet with up to 21 LED's color data from this starting
+ * index and sends it using `tud_vendor_n_write`.
  *
- * @param request_led_data_pkg Pointer to the packet containing the request for 
+ * @param strip Pointer to the strip the request was received for.
+ * @param itf The vendor interface the answer is sent on.
+ * @param request_led_data_pkg Pointer to the packet containing the request for
  *                             LED data, including the starting block index.
  */
 void ws2812_handle_led_request_led_data_pkg(
+	ws2812b_strip *strip, uint8_t itf,
 	ws2812_usb_packet_request_led_data *request_led_data_pkg)
 {
 	uint16_t block_index = request_led_data_pkg->led_block_index_H << 8 |
@@ -306,29 +442,80 @@ void ws2812_handle_led_request_led_data_pkg(
 	pixel_pkg.ctrl = LED_DATA;
 	int start_index = 21 * block_index;
 	int i = 0;
-	while (i < 21 && start_index + i < ws2812b_count) {
-		pixel_pkg.color_data[i].red = ws2812b_buffer[start_index + i].r;
+	while (i < 21 && start_index + i < strip->count) {
+		pixel_pkg.color_data[i].red = strip->buffer[start_index + i].r;
 		pixel_pkg.color_data[i].green =
-			ws2812b_buffer[start_index + i].g;
+			strip->buffer[start_index + i].g;
 		pixel_pkg.color_data[i].blue =
-			ws2812b_buffer[start_index + i].b;
+			strip->buffer[start_index + i].b;
 		i++;
 	}
 	// sizeof(pixel_pkg) muss gleich CFG_TUD_VENDOR_TX_BUFSIZE sein!
-	tud_vendor_write(&pixel_pkg, CFG_TUD_VENDOR_TX_BUFSIZE);
+	tud_vendor_n_write(itf, &pixel_pkg, CFG_TUD_VENDOR_TX_BUFSIZE);
+}
+
+/**
+ * @brief Handles save boot frame packets.
+ *
+ * This function stores the current LED count and the pixeldata of the strip
+ * in the flash sector reserved for the strip, so the frame is shown directly
+ * after the next power-up.
+ *
+ * The page holding the header is programmed last. If the power fails while writing,
+ * the magic is missing and the broken frame is ignored at startup.
+ *
+ * @param strip_index Index of the strip the packet was received for.
+ *
+ * @note Interrupts are disabled while the sector is erased and programmed (some 10 ms),
+ *       the USB host retries the pending transfers afterwards.
+ */
+void ws2812_handle_save_boot_frame_pkg(int strip_index)
+{
+	static union {
+		ws2812b_boot_frame frame;
+		uint8_t bytes[WS2812B_BOOT_FRAME_PROGRAM_SIZE];
+	} boot_frame;
+	ws2812b_strip *strip = &ws2812b_strips[strip_index];
+	uint32_t flash_offset = WS2812B_BOOT_FRAME_OFFSET(strip_index);
+
+	if (strip->count > WS2812B_BUFFER_SIZE) {
+		return;
+	}
+
+	memset(&boot_frame, 0xFF, sizeof(boot_frame));
+	boot_frame.frame.magic = WS2812B_BOOT_FRAME_MAGIC;
+	boot_frame.frame.count = strip->count;
+	boot_frame.frame.reserved = 0;
+	memcpy(boot_frame.frame.pixel, strip->buffer,
+	       strip->count * sizeof(ws2812b_pixel));
+
+	uint32_t interrupts = save_and_disable_interrupts();
+	flash_range_erase(flash_offset, FLASH_SECTOR_SIZE);
+	flash_range_program(flash_offset + FLASH_PAGE_SIZE,
+			    boot_frame.bytes + FLASH_PAGE_SIZE,
+			    sizeof(boot_frame) - FLASH_PAGE_SIZE);
+	flash_range_program(flash_offset, boot_frame.bytes, FLASH_PAGE_SIZE);
+	restore_interrupts(interrupts);
 }
 
 /**
  * @brief Callback-Funktion für den Empfang von Vendor-Daten über USB.
  *
  * Diese Funktion verarbeitet empfangene Vendor-Daten, um die WS2812B-LEDs zu steuern.
+ * Jeder Streifen hat ein eigenes Vendor-Interface, der Index des Interfaces ist
+ * der Index des Streifens.
  *
  * @param ift Das USB-Interface, über das die Daten empfangen wurden.
  */
 void tud_vendor_rx_cb(uint8_t ift)
 {
+	if (ift >= WS2812B_STRIP_COUNT) {
+		return;
+	}
+	ws2812b_strip *strip = &ws2812b_strips[ift];
+
 	uint8_t buffer_in[CFG_TUD_VENDOR_RX_BUFSIZE];
-	tud_vendor_read(buffer_in, CFG_TUD_VENDOR_RX_BUFSIZE);
+	tud_vendor_n_read(ift, buffer_in, CFG_TUD_VENDOR_RX_BUFSIZE);
 
 	uint8_t buffer_out[CFG_TUD_VENDOR_TX_BUFSIZE];
 	memset(buffer_out, 0, CFG_TUD_VENDOR_TX_BUFSIZE);
@@ -337,35 +524,40 @@ void tud_vendor_rx_cb(uint8_t ift)
 
 	switch (ctrl) {
 	case LED_DATA:
-		//fill_ws2812b_buffer(buffer_in);
+		//fill_ws2812b_buffer(strip, buffer_in);
 		ws2812_handle_led_data_pkg(
-			(ws2812_usb_packet_pixeldata *)buffer_in);
+			strip, (ws2812_usb_packet_pixeldata *)buffer_in);
 
 		break;
 
 	case LED_COUNT:
 		ws2812_handle_led_count_pkg(
-			(ws2812_usb_packet_count *)buffer_in);
+			strip, (ws2812_usb_packet_count *)buffer_in);
 
 		break;
 
 	case REQUEST_LEN:
-		ws2812_handle_led_request_len_pkg();
-		//get_ws2812b_length_usb_packet(buffer_out);
+		ws2812_handle_led_request_len_pkg(strip, ift);
+		//get_ws2812b_length_usb_packet(strip, buffer_out);
 		break;
 
 	case REQUEST_LED_DATA:
 		ws2812_handle_led_request_led_data_pkg(
+			strip, ift,
 			(ws2812_usb_packet_request_led_data *)buffer_in);
 		break;
 
+	case SAVE_BOOT_FRAME:
+		ws2812_handle_save_boot_frame_pkg(ift);
+		break;
+
 	case LED_CLEAR:
-		ws2812b_clear();
+		ws2812b_clear(strip);
 
 		break;
 
 	default:
 		break;
 	}
-	tud_vendor_read_flush();
-}
\ No newline at end of file
+	tud_vendor_n_read_flush(ift);
+}
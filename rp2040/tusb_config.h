@@ -3,9 +3,12 @@
 
 #define CFG_USB_BULK_ENDPOINT_SIZE 64 //max 64 bytes
 
+// Anzahl der LED-Streifen, jeder Streifen bekommt ein eigenes Vendor-Interface (max. 4)
+#define WS2812B_STRIP_COUNT 1
+
 #define CFG_TUSB_RHPORT0_MODE (OPT_MODE_DEVICE | OPT_MODE_FULL_SPEED)
 #define CFG_TUD_VENDOR_RX_BUFSIZE CFG_USB_BULK_ENDPOINT_SIZE
 #define CFG_TUD_VENDOR_TX_BUFSIZE CFG_USB_BULK_ENDPOINT_SIZE
-#define CFG_TUD_VENDOR 1
+#define CFG_TUD_VENDOR WS2812B_STRIP_COUNT
 
 #endif /* _TUSB_CONFIG_H_ */
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include <string.h>
 #include <pico/unique_id.h>
 #include "tusb.h"
+#include "tusb_config.h"
 
 enum string_index {
 	RESERVED_IDX = 0,
@@ -61,22 +62,33 @@ uint8_t const *tud_descriptor_device_cb(void)
 	return (uint8_t const *)&device_descriptor;
 }
 
+/**
+ * @brief Structure representing the USB descriptors of one LED strip.
+ *
+ * Every strip gets its own vendor interface with a bulk IN and a bulk OUT endpoint,
+ * so the kernel module probes every strip as its own device. Packed like
+ * usb_descriptor_config_t, which embeds it.
+ */
+typedef struct __attribute__ ((packed)) {
+	tusb_desc_interface_t interface;      ///< USB interface descriptor
+	tusb_desc_endpoint_t bulk_in;         ///< USB bulk IN endpoint descriptor
+	tusb_desc_endpoint_t bulk_out;        ///< USB bulk OUT endpoint descriptor
+} usb_descriptor_strip_t;
+
 /**
  * @brief Structure representing the USB descriptor config.
  *
  * This structure defines the descriptors for a USB device.
  * It is packed to ensure the data structure aligns with the USB standard's 
- * strict byte alignment requirements. The structure includes the configuration,
- * interface, and endpoint descriptors.
+ * strict byte alignment requirements. The structure includes the configuration
+ * descriptor and the interface and endpoint descriptors of every strip.
  * 
  * @warning Das blöde Struct wird von Doxygen nicht erkannt, weil es ein Attribut hat.
  * Ich habe keine Lösung gefunden und mir ist es jetzt auch egal. Doxygen ist blöd.
  */
 typedef struct __attribute__ ((packed)) {
 	tusb_desc_configuration_t config;     ///< USB configuration descriptor
-	tusb_desc_interface_t interface;      ///< USB interface descriptor
-	tusb_desc_endpoint_t bulk_in;         ///< USB bulk IN endpoint descriptor
-	tusb_desc_endpoint_t bulk_out;        ///< USB bulk OUT endpoint descriptor
+	usb_descriptor_strip_t strip[WS2812B_STRIP_COUNT]; ///< Descriptors of the strips
 } usb_descriptor_config_t;
 
 
@@ -88,6 +100,26 @@ typedef struct __attribute__ ((packed)) {
 		.wMaxPacketSize = _size, .bInterval = _interval,  \
 	}
 
+// Strip n: interface n, bulk IN endpoint 0x81 + n, bulk OUT endpoint 0x02 + n
+#define USB_STRIP_DESCRIPTOR(_n)                                                    \
+	{                                                                           \
+		.interface = {                                                      \
+			.bLength = sizeof(tusb_desc_interface_t),                   \
+			.bDescriptorType = TUSB_DESC_INTERFACE,                     \
+			.bInterfaceNumber = _n,                                     \
+			.bAlternateSetting = 0,                                     \
+			.bNumEndpoints = 2,                                         \
+			.bInterfaceClass = TUSB_CLASS_VENDOR_SPECIFIC,              \
+			.bInterfaceSubClass = 0x00,                                 \
+			.bInterfaceProtocol = 0x00,                                 \
+			.iInterface = 0,                                            \
+		},                                                                  \
+		.bulk_in = USB_ENDPOINT_DESCRIPTOR(TUSB_XFER_BULK, 0x81 + (_n),     \
+						   CFG_USB_BULK_ENDPOINT_SIZE, 0),  \
+		.bulk_out = USB_ENDPOINT_DESCRIPTOR(TUSB_XFER_BULK, 0x02 + (_n),    \
+						    CFG_USB_BULK_ENDPOINT_SIZE, 0), \
+	}
+
 /**
  * @brief USB descriptor configuration for the device.
  *
@@ -100,29 +132,25 @@ usb_descriptor_config_t descriptor_config = {
         .bLength = sizeof(tusb_desc_configuration_t), /**< Size of the configuration descriptor */
         .bDescriptorType = TUSB_DESC_CONFIGURATION, /**< Descriptor type */
         .wTotalLength = sizeof(usb_descriptor_config_t), /**< Total length of the configuration */
-        .bNumInterfaces = 1, /**< Number of interfaces */
+        .bNumInterfaces = WS2812B_STRIP_COUNT, /**< Number of interfaces (one per strip) */
         .bConfigurationValue = 1, /**< Configuration value */
         .iConfiguration = 0, /**< Configuration string index */
         .bmAttributes = TU_BIT(7), /**< Attribute bitmask */
         .bMaxPower = 450 / 2, /**< Maximum power consumption (450mA) */
     },
 
-    .interface = {
-        .bLength = sizeof(tusb_desc_interface_t), /**< Size of the interface descriptor */
-        .bDescriptorType = TUSB_DESC_INTERFACE, /**< Descriptor type */
-        .bInterfaceNumber = 0, /**< Interface number */
-        .bAlternateSetting = 0, /**< Alternate setting */
-        .bNumEndpoints = 2, /**< Number of endpoints (Two interfaces) */
-        .bInterfaceClass = TUSB_CLASS_VENDOR_SPECIFIC, /**< Interface class */
-        .bInterfaceSubClass = 0x00, /**< Interface subclass */
-        .bInterfaceProtocol = 0x00, /**< Interface protocol */
-        .iInterface = 0, /**< Interface string index */
+    .strip = {
+        USB_STRIP_DESCRIPTOR(0), /**< Descriptors of strip 0 */
+#if WS2812B_STRIP_COUNT > 1
+        USB_STRIP_DESCRIPTOR(1), /**< Descriptors of strip 1 */
+#endif
+#if WS2812B_STRIP_COUNT > 2
+        USB_STRIP_DESCRIPTOR(2), /**< Descriptors of strip 2 */
+#endif
+#if WS2812B_STRIP_COUNT > 3
+        USB_STRIP_DESCRIPTOR(3), /**< Descriptors of strip 3 */
+#endif
     },
-    // Bulk input endpoint with address 0x81, receives 120 bits (5 LEDs at 24 bits each) of data
-    .bulk_in = USB_ENDPOINT_DESCRIPTOR(TUSB_XFER_BULK, 0x81, CFG_USB_BULK_ENDPOINT_SIZE, 0), /**< Bulk IN endpoint descriptor */
-
-    // Bulk output endpoint with address 0x02, transmits 120 bits (5 LEDs at 24 bits each) of data
-    .bulk_out = USB_ENDPOINT_DESCRIPTOR(TUSB_XFER_BULK, 0x02, CFG_USB_BULK_ENDPOINT_SIZE, 0) /**< Bulk OUT endpoint descriptor */
 };
 
 /**
@@ -204,6 +232,13 @@ uint16_t const *tud_descriptor_string_cb(uint8_t index, uint16_t langid)
 	if (index >= TU_ARRAY_SIZE(strings))
 		return NULL;
 
+	// Index 0 ist die Liste der Sprachen und kein String
+	if (index == 0) {
+		string_descriptor.bLength = 4;
+		string_descriptor.unicode_string[0] = (uint16_t)(uintptr_t)strings[0];
+		return (uint16_t *)&string_descriptor;
+	}
+
 	const char *str = strings[index];
 
 	if (SERIALNUMBER_IDX == index) {
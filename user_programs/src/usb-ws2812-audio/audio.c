@@ -0,0 +1,786 @@
+/**
+ * @file audio.c                                                               *
+ * @brief Audio spectrum visualizer: windowed FFTs over a sample ring buffer,  *
+ *        bands mapped to LED segments, with measured audio to light latency   *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#include <argp.h>
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "usb_ws2812_lib.h"
+
+/**
+ * @def AUDIO_BLOCK
+ * @brief Frames read and published at once, bounds how old the newest sample can be.
+ */
+#define AUDIO_BLOCK 256
+
+/**
+ * @def LATENCY_SAMPLES
+ * @brief Latencies kept per report interval for the percentiles.
+ */
+#define LATENCY_SAMPLES 65536
+
+/**
+ * @def BAND_MIN_HZ
+ * @brief Lower edge of the lowest band.
+ */
+#define BAND_MIN_HZ 40.0
+
+/**
+ * @def BAND_MAX_HZ
+ * @brief Upper edge of the highest band, at most half the sample rate.
+ */
+#define BAND_MAX_HZ 16000.0
+
+const char *argp_program_version = "usb-ws2812-audio";
+const char *argp_program_bug_address = "";
+static char doc[] =
+	"usb-ws2812-audio zeigt das Spektrum eines Audiosignals auf einem LED-Streifen. Gelesen wird "
+	"eine WAV-Datei oder rohes PCM (s16le, -s) aus einer Datei oder von stdin. Ein Lesethread "
+	"schreibt die Samples in einen Ringpuffer, der Hauptthread rechnet mit der höchsten Bildrate "
+	"des Streifens eine FFT mit Hann-Fenster über die neuesten Samples, fasst sie zu logarithmisch "
+	"verteilten Bändern zusammen und zeigt jedes Band geglättet als Balken auf einem Abschnitt "
+	"des Streifens. Dateien werden in Echtzeit gelesen, so als kämen sie von einer Soundkarte, "
+	"gemessen wird die Latenz vom neuesten Sample bis zur Ausgabe.\vBeispiel ohne Soundkarte: "
+	"usb-ws2812-audio -i musik.wav, live z. B. mit arecord -f S16_LE -r 48000 -c 2 -t wav | "
+	"usb-ws2812-audio -L";
+static char args_doc[] = "";
+
+static struct argp_option options[] = {
+	{ "device", 'd', "PATH", 0, "Gerätedatei oder usb:N (Standard /dev/usb_ws2812_0)", 0 },
+	{ "input", 'i', "FILE", 0, "Eingabe, - für stdin (Standard)", 0 },
+	{ "raw", 's', "RATE", 0, "Rohes PCM s16le mit dieser Abtastrate statt WAV lesen", 0 },
+	{ "channels", 'C', "NUM", 0, "Kanäle von rohem PCM (Standard 2)", 0 },
+	{ "live", 'L', 0, 0, "Eingabe kommt bereits in Echtzeit (nicht selbst takten)", 0 },
+	{ "leds", 'l', "NUM", 0, "Anzahl LEDs (Standard 300)", 0 },
+	{ "bands", 'b', "NUM", 0, "Anzahl Bänder bzw. Abschnitte (Standard 16)", 0 },
+	{ "fft", 'n', "NUM", 0, "FFT-Länge, Zweierpotenz von 256 bis 16384 (Standard 1024)", 0 },
+	{ "rate", 'f', "FPS", 0, "Bildrate, 0 die höchste des Streifens (Standard)", 0 },
+	{ "attack", 'A', "MS", 0, "Zeitkonstante beim Anstieg (Standard 10 ms)", 0 },
+	{ "decay", 'D', "MS", 0, "Zeitkonstante beim Abfall (Standard 250 ms)", 0 },
+	{ "range", 'g', "DB", 0, "Dynamikbereich eines Balkens unter Vollaussteuerung (Standard 60 dB)", 0 },
+	{ "report", 'R', "SEC", 0, "Latenz alle SEC Sekunden ausgeben, 0 nur am Ende (Standard 5)", 0 },
+	{ 0, 0, 0, 0, 0, 0 },
+};
+
+struct arguments {
+	const char *device;
+	const char *input;
+	long raw_rate;
+	long channels;
+	bool live;
+	long leds;
+	long bands;
+	long fft;
+	double rate;
+	double attack;
+	double decay;
+	double range;
+	long report;
+};
+
+static error_t parse_opt(int key, char *arg, struct argp_state *state)
+{
+	struct arguments *arg_s = state->input;
+	switch (key) {
+	case 'd':
+		arg_s->device = arg;
+		break;
+	case 'i':
+		arg_s->input = arg;
+		break;
+	case 's':
+		arg_s->raw_rate = strtol(arg, NULL, 10);
+		break;
+	case 'C':
+		arg_s->channels = strtol(arg, NULL, 10);
+		break;
+	case 'L':
+		arg_s->live = true;
+		break;
+	case 'l':
+		arg_s->leds = strtol(arg, NULL, 10);
+		break;
+	case 'b':
+		arg_s->bands = strtol(arg, NULL, 10);
+		break;
+	case 'n':
+		arg_s->fft = strtol(arg, NULL, 10);
+		break;
+	case 'f':
+		arg_s->rate = strtod(arg, NULL);
+		break;
+	case 'A':
+		arg_s->attack = strtod(arg, NULL);
+		break;
+	case 'D':
+		arg_s->decay = strtod(arg, NULL);
+		break;
+	case 'g':
+		arg_s->range = strtod(arg, NULL);
+		break;
+	case 'R':
+		arg_s->report = strtol(arg, NULL, 10);
+		break;
+	default:
+		return ARGP_ERR_UNKNOWN;
+	}
+	return 0;
+}
+
+static struct argp argp = { options, parse_opt, args_doc, doc, 0, 0, 0 };
+
+/**
+ * @brief Format der Eingabe.
+ */
+struct audio_format {
+	uint32_t rate;
+	uint16_t channels;
+	uint16_t bits; /**< 8, 16, 24 oder 32. */
+	bool is_float; /**< 32 Bit IEEE-Float statt Ganzzahl. */
+	size_t frame_size; /**< Bytes pro Frame (alle Kanäle). */
+};
+
+/**
+ * @brief Ringpuffer der Samples (Mono) zwischen Lesethread und Hauptthread.
+ */
+struct audio_ring {
+	float *samples;
+	size_t mask; /**< Größe - 1, die Größe ist eine Zweierpotenz. */
+	uint64_t written; /**< Anzahl geschriebener Samples. */
+	uint64_t written_ns; /**< Aufnahmezeitpunkt des neuesten Samples (CLOCK_MONOTONIC). */
+	pthread_mutex_t lock;
+	bool stop; /**< Hauptthread beendet. */
+	bool eof; /**< Eingabe zu Ende oder Lesefehler. */
+	bool finished; /**< Lesethread beendet. */
+};
+
+/**
+ * @brief Zustand des Lesethreads.
+ */
+struct reader {
+	FILE *input;
+	struct audio_format format;
+	bool live;
+	struct audio_ring ring;
+};
+
+/**
+ * @brief FFT mit vorberechneten Tabellen.
+ */
+struct fft {
+	size_t size;
+	unsigned int *reverse; /**< Bitumgekehrte Indizes. */
+	float *cos_table, *sin_table; /**< Drehfaktoren für size / 2 Winkel. */
+	float *window; /**< Hann-Fenster. */
+	float *re, *im;
+	double scale; /**< Vollaussteuerung eines Sinus ergibt Betrag 1. */
+};
+
+/**
+ * @brief Frequenzband und Abschnitt des Streifens.
+ */
+struct band {
+	unsigned int first_bin, last_bin; /**< Bins first_bin ... last_bin - 1. */
+	unsigned int first_led, leds;
+	uint8_t hue;
+	float level; /**< Geglätteter Pegel 0 ... 1. */
+};
+
+/**
+ * @brief Latenzen seit dem letzten Bericht.
+ */
+struct latency_stats {
+	double samples[LATENCY_SAMPLES]; /**< Latenzen in us. */
+	size_t count;
+	double max;
+	double sum;
+	uint64_t total;
+};
+
+static volatile sig_atomic_t running = 1;
+
+static void stop_handler(int sig)
+{
+	(void)sig;
+	running = 0;
+}
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static uint32_t get_le16(const uint8_t *p)
+{
+	return p[0] | p[1] << 8;
+}
+
+static uint32_t get_le32(const uint8_t *p)
+{
+	return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+/**
+ * @brief Überspringt Bytes, auch in einer Pipe.
+ */
+static int skip_bytes(FILE *in, uint32_t count)
+{
+	uint8_t scratch[256];
+	while (count) {
+		size_t n = count < sizeof(scratch) ? count : sizeof(scratch);
+		if (fread(scratch, 1, n, in) != n) {
+			return -1;
+		}
+		count -= n;
+	}
+	return 0;
+}
+
+/**
+ * @brief Liest den WAV-Kopf bis zum Beginn des data-Chunks.
+ *
+ * Chunks werden gelesen statt gesucht, damit auch eine Pipe funktioniert.
+ * Die Größe des data-Chunks wird ignoriert, gelesen wird bis zum Ende.
+ */
+static int parse_wav_header(FILE *in, struct audio_format *f)
+{
+	uint8_t header[12], chunk[8], fmt[40];
+	if (fread(header, sizeof(header), 1, in) != 1 ||
+	    memcmp(header, "RIFF", 4) != 0 || memcmp(header + 8, "WAVE", 4) != 0) {
+		printf("Keine WAV-Datei, für rohes PCM -s angeben\n");
+		return -1;
+	}
+
+	bool have_fmt = false;
+	for (;;) {
+		if (fread(chunk, sizeof(chunk), 1, in) != 1) {
+			printf("WAV-Datei ohne data-Chunk\n");
+			return -1;
+		}
+		uint32_t size = get_le32(chunk + 4);
+		if (memcmp(chunk, "data", 4) == 0) {
+			break;
+		}
+		if (memcmp(chunk, "fmt ", 4) != 0 || size < 16) {
+			if (skip_bytes(in, size + (size & 1)) < 0) {
+				return -1;
+			}
+			continue;
+		}
+
+		uint32_t n = size < sizeof(fmt) ? size : sizeof(fmt);
+		if (fread(fmt, n, 1, in) != 1 ||
+		    skip_bytes(in, size - n + (size & 1)) < 0) {
+			return -1;
+		}
+		uint32_t tag = get_le16(fmt);
+		if (tag == 0xfffe && n >= 26) {
+			// WAVE_FORMAT_EXTENSIBLE, das Format steht in der Sub-GUID
+			tag = get_le16(fmt + 24);
+		}
+		f->channels = get_le16(fmt + 2);
+		f->rate = get_le32(fmt + 4);
+		f->bits = get_le16(fmt + 14);
+		f->is_float = tag == 3;
+		if ((tag != 1 && tag != 3) || (f->is_float && f->bits != 32) ||
+		    (f->bits != 8 && f->bits != 16 && f->bits != 24 && f->bits != 32)) {
+			printf("Nicht unterstütztes WAV-Format %u mit %u Bit\n", tag,
+			       f->bits);
+			return -1;
+		}
+		have_fmt = true;
+	}
+	if (!have_fmt || !f->channels || !f->rate) {
+		printf("WAV-Datei ohne gültigen fmt-Chunk\n");
+		return -1;
+	}
+	f->frame_size = (size_t)f->channels * f->bits / 8;
+	return 0;
+}
+
+/**
+ * @brief Ein Sample im Format der Eingabe als -1 ... 1.
+ */
+static float decode_sample(const uint8_t *p, const struct audio_format *f)
+{
+	switch (f->bits) {
+	case 8:
+		return (p[0] - 128) / 128.0f;
+	case 16:
+		return (int16_t)get_le16(p) / 32768.0f;
+	case 24:
+		return (int32_t)(get_le32(p - 1) & 0xffffff00u) / 2147483648.0f;
+	default:
+		if (f->is_float) {
+			uint32_t bits = get_le32(p);
+			float value;
+			memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+		return (int32_t)get_le32(p) / 2147483648.0f;
+	}
+}
+
+/**
+ * @brief Lesethread: liest Blöcke, mischt sie zu Mono und schreibt sie in den Ring.
+ *
+ * Ohne -L wird jeder Block erst zu dem Zeitpunkt veröffentlicht, zu dem sein
+ * letztes Sample bei einer Soundkarte vorläge. Das Ergebnis verhält sich damit
+ * wie eine Aufnahme, auch wenn es aus einer Datei kommt.
+ */
+static void *reader_thread(void *arg)
+{
+	struct reader *rd = arg;
+	struct audio_ring *r = &rd->ring;
+	const struct audio_format *f = &rd->format;
+	// Ein Byte Vorlauf, damit 24-Bit-Samples als 32 Bit gelesen werden können
+	uint8_t *buffer = malloc(AUDIO_BLOCK * f->frame_size + 1);
+	uint64_t start_ns = 0, frames = 0;
+
+	while (buffer && running) {
+		pthread_mutex_lock(&r->lock);
+		bool stop = r->stop;
+		pthread_mutex_unlock(&r->lock);
+		if (stop) {
+			break;
+		}
+
+		size_t n = fread(buffer + 1, f->frame_size, AUDIO_BLOCK, rd->input);
+		if (n == 0) {
+			break;
+		}
+		if (frames == 0) {
+			start_ns = now_ns();
+		}
+
+		// Die Plätze hinter written liest der Hauptthread nicht
+		size_t bytes = f->bits / 8;
+		for (size_t i = 0; i < n; i++) {
+			const uint8_t *frame = buffer + 1 + i * f->frame_size;
+			float sum = 0;
+			for (unsigned int c = 0; c < f->channels; c++) {
+				sum += decode_sample(frame + c * bytes, f);
+			}
+			r->samples[(frames + i) & r->mask] = sum / f->channels;
+		}
+		frames += n;
+
+		uint64_t due = start_ns + frames * 1000000000ull / f->rate;
+		if (!rd->live) {
+			struct timespec ts = { due / 1000000000ull,
+					       due % 1000000000ull };
+			while (running && clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME,
+							  &ts, NULL) == EINTR) {
+			}
+		}
+		uint64_t now = now_ns();
+
+		pthread_mutex_lock(&r->lock);
+		r->written = frames;
+		r->written_ns = rd->live || now > due ? now : due;
+		pthread_mutex_unlock(&r->lock);
+		if (n < AUDIO_BLOCK) {
+			break;
+		}
+	}
+
+	free(buffer);
+	pthread_mutex_lock(&r->lock);
+	r->eof = true;
+	r->finished = true;
+	pthread_mutex_unlock(&r->lock);
+	return NULL;
+}
+
+static void fft_free(struct fft *fft)
+{
+	free(fft->reverse);
+	free(fft->cos_table);
+	free(fft->sin_table);
+	free(fft->window);
+	free(fft->re);
+	free(fft->im);
+}
+
+/**
+ * @brief Berechnet Bitumkehr, Drehfaktoren und Fenster einmal vorab.
+ */
+static int fft_init(struct fft *fft, size_t size)
+{
+	fft->size = size;
+	fft->reverse = malloc(size * sizeof(unsigned int));
+	fft->cos_table = malloc(size / 2 * sizeof(float));
+	fft->sin_table = malloc(size / 2 * sizeof(float));
+	fft->window = malloc(size * sizeof(float));
+	fft->re = malloc(size * sizeof(float));
+	fft->im = malloc(size * sizeof(float));
+	if (!fft->reverse || !fft->cos_table || !fft->sin_table ||
+	    !fft->window || !fft->re || !fft->im) {
+		return -1;
+	}
+
+	unsigned int bits = 0;
+	while ((1u << bits) < size) {
+		bits++;
+	}
+	double window_sum = 0;
+	for (size_t i = 0; i < size; i++) {
+		unsigned int rev = 0;
+		for (unsigned int b = 0; b < bits; b++) {
+			rev |= ((i >> b) & 1) << (bits - 1 - b);
+		}
+		fft->reverse[i] = rev;
+		fft->window[i] = 0.5 - 0.5 * cos(2 * M_PI * i / size);
+		window_sum += fft->window[i];
+	}
+	for (size_t i = 0; i < size / 2; i++) {
+		fft->cos_table[i] = cos(2 * M_PI * i / size);
+		fft->sin_table[i] = -sin(2 * M_PI * i / size);
+	}
+	fft->scale = 2 / window_sum;
+	return 0;
+}
+
+/**
+ * @brief Gefensterte FFT (Radix 2, iterativ) der Samples, Ergebnis in re/im.
+ */
+static void fft_run(struct fft *fft, const float *samples)
+{
+	size_t n = fft->size;
+	float *re = fft->re, *im = fft->im;
+
+	for (size_t i = 0; i < n; i++) {
+		re[fft->reverse[i]] = samples[i] * fft->window[i];
+		im[i] = 0;
+	}
+	for (size_t len = 2; len <= n; len <<= 1) {
+		size_t half = len / 2, step = n / len;
+		for (size_t start = 0; start < n; start += len) {
+			for (size_t k = 0; k < half; k++) {
+				float wr = fft->cos_table[k * step];
+				float wi = fft->sin_table[k * step];
+				size_t a = start + k, b = a + half;
+				float tr = re[b] * wr - im[b] * wi;
+				float ti = re[b] * wi + im[b] * wr;
+				re[b] = re[a] - tr;
+				im[b] = im[a] - ti;
+				re[a] += tr;
+				im[a] += ti;
+			}
+		}
+	}
+}
+
+/**
+ * @brief Verteilt die Bänder logarithmisch und die LEDs gleichmäßig.
+ *
+ * Jedes Band bekommt mindestens einen eigenen Bin.
+ *
+ * @return 0 bei Erfolg, -1 wenn die FFT zu wenige Bins für die Bänder hat.
+ */
+static int setup_bands(struct band *bands, unsigned int count, size_t fft_size,
+		       uint32_t rate, unsigned int leds)
+{
+	double bin_hz = (double)rate / fft_size;
+	double high = fmin(BAND_MAX_HZ, rate / 2.0);
+	unsigned int bins = fft_size / 2;
+	unsigned int edge = lround(BAND_MIN_HZ / bin_hz);
+	if (edge < 1) {
+		edge = 1;
+	}
+
+	for (unsigned int i = 0; i < count; i++) {
+		double hz = BAND_MIN_HZ * pow(high / BAND_MIN_HZ, (i + 1.0) / count);
+		unsigned int next = lround(hz / bin_hz);
+		bands[i].first_bin = edge;
+		bands[i].last_bin = next > edge ? next : edge + 1;
+		edge = bands[i].last_bin;
+		if (edge > bins) {
+			return -1;
+		}
+		bands[i].first_led = (uint64_t)i * leds / count;
+		bands[i].leds = (uint64_t)(i + 1) * leds / count - bands[i].first_led;
+		bands[i].hue = i * 192 / count;
+		bands[i].level = 0;
+	}
+	return 0;
+}
+
+/**
+ * @brief Zeichnet die Pegel als Balken, die letzte LED eines Balkens anteilig hell.
+ */
+static void render_bands(const struct band *bands, unsigned int count,
+			 ws2812_hsv *hsv)
+{
+	for (unsigned int i = 0; i < count; i++) {
+		const struct band *b = &bands[i];
+		float lit = b->level * b->leds;
+		for (unsigned int k = 0; k < b->leds; k++) {
+			float fill = fminf(fmaxf(lit - k, 0), 1);
+			hsv[b->first_led + k] =
+				(ws2812_hsv){ b->hue, 255, lroundf(fill * 255) };
+		}
+	}
+}
+
+static int compare_double(const void *a, const void *b)
+{
+	double x = *(const double *)a, y = *(const double *)b;
+	return (x > y) - (x < y);
+}
+
+/**
+ * @brief Gibt die Latenzen seit dem letzten Bericht aus und setzt sie zurück.
+ */
+static void report(struct latency_stats *stats, uint64_t frames,
+		   uint64_t start_ns)
+{
+	double seconds = (now_ns() - start_ns) / 1e9;
+	printf("%llu Frames (%.1f fps)", (unsigned long long)frames,
+	       seconds > 0 ? frames / seconds : 0.0);
+	if (stats->total) {
+		size_t count = stats->count;
+		qsort(stats->samples, count, sizeof(double), compare_double);
+		printf(", Latenz Audio bis Licht: Mittel %.2f ms, p50 %.2f ms, p99 %.2f ms, max %.2f ms",
+		       stats->sum / stats->total / 1e3,
+		       stats->samples[count / 2] / 1e3,
+		       stats->samples[count * 99 / 100] / 1e3, stats->max / 1e3);
+	}
+	printf("\n");
+	fflush(stdout);
+	stats->count = 0;
+	stats->max = 0;
+	stats->sum = 0;
+	stats->total = 0;
+}
+
+int main(int argc, char **argv)
+{
+	struct arguments arguments = {
+		.device = "/dev/usb_ws2812_0",
+		.input = "-",
+		.channels = 2,
+		.leds = 300,
+		.bands = 16,
+		.fft = 1024,
+		.attack = 10,
+		.decay = 250,
+		.range = 60,
+		.report = 5,
+	};
+	argp_parse(&argp, argc, argv, 0, 0, &arguments);
+	if (arguments.leds < 1 || arguments.leds > UINT16_MAX ||
+	    arguments.bands < 1 || arguments.bands > arguments.leds ||
+	    arguments.fft < 256 || arguments.fft > 16384 ||
+	    (arguments.fft & (arguments.fft - 1)) || arguments.rate < 0 ||
+	    arguments.attack < 0 || arguments.decay < 0 || arguments.range <= 0 ||
+	    arguments.channels < 1 || arguments.channels > UINT16_MAX ||
+	    arguments.raw_rate < 0) {
+		printf("Ungültige LED-, Band-, FFT- oder Zeitangaben\n");
+		return 1;
+	}
+
+	struct reader rd = {
+		.live = arguments.live,
+		.ring = { .lock = PTHREAD_MUTEX_INITIALIZER },
+	};
+	struct fft fft = { 0 };
+	struct band *bands = NULL;
+	struct latency_stats *latencies = NULL;
+	float *window = NULL;
+	ws2812_hsv *hsv = NULL;
+	led_pixel *pixels = NULL;
+	ws2812_handle *handle = NULL;
+	ws2812_shadow *shadow = NULL;
+	ws2812_scheduler *sched = NULL;
+	unsigned int length = arguments.leds;
+	size_t size = arguments.fft;
+	int ret = 1;
+
+	rd.input = strcmp(arguments.input, "-") == 0 ? stdin :
+						       fopen(arguments.input, "rb");
+	if (!rd.input) {
+		perror(arguments.input);
+		return 1;
+	}
+	struct audio_format *f = &rd.format;
+	if (arguments.raw_rate) {
+		*f = (struct audio_format){ arguments.raw_rate, arguments.channels,
+					    16, false, arguments.channels * 2 };
+	} else if (parse_wav_header(rd.input, f) < 0) {
+		goto out;
+	}
+
+	// Der Ring fasst ein Fenster und mehr als einen Block, die Größe ist eine Zweierpotenz
+	size_t ring_size = 1;
+	while (ring_size < 2 * size + AUDIO_BLOCK) {
+		ring_size <<= 1;
+	}
+	rd.ring.samples = calloc(ring_size, sizeof(float));
+	rd.ring.mask = ring_size - 1;
+	bands = calloc(arguments.bands, sizeof(struct band));
+	latencies = calloc(1, sizeof(struct latency_stats));
+	window = malloc(size * sizeof(float));
+	hsv = calloc(length, sizeof(ws2812_hsv));
+	pixels = calloc(length, sizeof(led_pixel));
+	if (!rd.ring.samples || !bands || !latencies || !window || !hsv ||
+	    !pixels || fft_init(&fft, size) < 0) {
+		perror("malloc");
+		goto out;
+	}
+	if (setup_bands(bands, arguments.bands, size, f->rate, length) < 0) {
+		printf("Zu viele Bänder für eine FFT der Länge %zu bei %u Hz\n", size,
+		       f->rate);
+		goto out;
+	}
+
+	handle = ws2812_open(arguments.device, length);
+	if (!handle) {
+		perror(arguments.device);
+		goto out;
+	}
+	if (ws2812_set_mode_static(handle) < 0 ||
+	    ws2812_set_length(handle, length) < 0) {
+		perror("ws2812_set_length");
+		goto out;
+	}
+	shadow = ws2812_shadow_create(handle, length);
+	sched = ws2812_scheduler_create(arguments.rate, length);
+	if (!shadow || !sched) {
+		perror("ws2812_scheduler_create");
+		goto out;
+	}
+
+	uint64_t period_ns = ws2812_scheduler_period_ns(sched);
+	printf("%u Hz, %u Kanäle, %u Bit%s, FFT %zu (%.1f ms), Block %.1f ms, %u LEDs, %ld Bänder, %.1f fps\n",
+	       f->rate, f->channels, f->bits, f->is_float ? " Float" : "", size,
+	       size * 1e3 / f->rate, AUDIO_BLOCK * 1e3 / f->rate, length,
+	       arguments.bands, 1e9 / period_ns);
+	fflush(stdout);
+
+	struct sigaction sa = { .sa_handler = stop_handler };
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+
+	pthread_t reader;
+	int err = pthread_create(&reader, NULL, reader_thread, &rd);
+	if (err) {
+		errno = err;
+		perror("pthread_create");
+		goto out;
+	}
+
+	// Glättung pro Frame aus den Zeitkonstanten
+	double dt = period_ns / 1e9;
+	float attack = arguments.attack > 0 ? 1 - exp(-dt * 1e3 / arguments.attack) : 1;
+	float decay = arguments.decay > 0 ? 1 - exp(-dt * 1e3 / arguments.decay) : 1;
+	float range = arguments.range;
+
+	uint64_t interval_ns = arguments.report * 1000000000ull;
+	uint64_t start_ns = now_ns();
+	uint64_t next_report = start_ns + interval_ns;
+	uint64_t frames = 0, errors = 0, last_written = 0;
+	struct audio_ring *r = &rd.ring;
+	while (running && ws2812_scheduler_wait(sched) > 0) {
+		// Die neuesten size Samples, davor liegende Nullen am Anfang
+		pthread_mutex_lock(&r->lock);
+		uint64_t written = r->written, written_ns = r->written_ns;
+		bool eof = r->eof;
+		for (size_t i = 0; i < size; i++) {
+			window[i] = r->samples[(written - size + i) & r->mask];
+		}
+		pthread_mutex_unlock(&r->lock);
+		if (eof && written == last_written) {
+			break;
+		}
+
+		fft_run(&fft, window);
+		for (long i = 0; i < arguments.bands; i++) {
+			struct band *b = &bands[i];
+			double power = 0;
+			for (unsigned int k = b->first_bin; k < b->last_bin; k++) {
+				power += fft.re[k] * fft.re[k] + fft.im[k] * fft.im[k];
+			}
+			float db = 10 * log10(power * fft.scale * fft.scale + 1e-20);
+			float target = fminf(fmaxf((db + range) / range, 0), 1);
+			b->level += (target > b->level ? attack : decay) *
+				    (target - b->level);
+		}
+		render_bands(bands, arguments.bands, hsv);
+		ws2812_hsv_to_rgb(pixels, hsv, length);
+		if (ws2812_shadow_submit(shadow, pixels) < 0 && errors++ == 0) {
+			perror("ws2812_shadow_submit");
+		}
+		ws2812_scheduler_frame_done(sched);
+		frames++;
+
+		// Latenz nur für Frames mit neuen Samples, vom neuesten Sample bis nach dem Senden
+		if (written != last_written) {
+			double latency = (now_ns() - written_ns) / 1e3;
+			if (latencies->count < LATENCY_SAMPLES) {
+				latencies->samples[latencies->count++] = latency;
+			}
+			if (latency > latencies->max) {
+				latencies->max = latency;
+			}
+			latencies->sum += latency;
+			latencies->total++;
+			last_written = written;
+		}
+		if (interval_ns && now_ns() >= next_report) {
+			report(latencies, frames, start_ns);
+			next_report += interval_ns;
+		}
+	}
+
+	// Den Lesethread auch aus einem blockierenden read() holen
+	pthread_mutex_lock(&r->lock);
+	r->stop = true;
+	bool finished = r->finished;
+	pthread_mutex_unlock(&r->lock);
+	while (!finished) {
+		pthread_kill(reader, SIGINT);
+		nanosleep(&(struct timespec){ 0, 10000000 }, NULL);
+		pthread_mutex_lock(&r->lock);
+		finished = r->finished;
+		pthread_mutex_unlock(&r->lock);
+	}
+	pthread_join(reader, NULL);
+
+	report(latencies, frames, start_ns);
+	ws2812_frame_stats stats;
+	ws2812_scheduler_get_stats(sched, &stats);
+	printf("Verpasste Takte: %llu, Überläufe: %llu, Fehler: %llu\n",
+	       (unsigned long long)stats.missed_deadlines,
+	       (unsigned long long)stats.overruns, (unsigned long long)errors);
+	ret = errors ? 1 : 0;
+
+out:
+	ws2812_scheduler_destroy(sched);
+	ws2812_shadow_free(shadow);
+	ws2812_close(handle);
+	fft_free(&fft);
+	free(pixels);
+	free(hsv);
+	free(window);
+	free(latencies);
+	free(bands);
+	free(rd.ring.samples);
+	if (rd.input != stdin) {
+		fclose(rd.input);
+	}
+	return ret;
+}
@@ -0,0 +1,184 @@
+/**
+ * @file bench_backend.c                                                       *
+ * @brief Compares the kernel module with the libusb backend: frame rate and   *
+ *        latency of complete frames                                           *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#include <argp.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "usb_ws2812_lib.h"
+
+const char *argp_program_version = "bench-backend";
+const char *argp_program_bug_address = "";
+static char doc[] =
+	"bench-backend sendet dieselben Frames einmal über das Kernelmodul und einmal über das "
+	"libusb-Backend (Pfad \"usb:N\") und vergleicht Bildrate und Latenz. Die Latenz reicht vom "
+	"Senden eines Frames bis zur Antwort des Controllers auf eine anschließende Längenabfrage, "
+	"also bis der Frame sicher übertragen wurde. Ein Pfad, der sich nicht öffnen lässt, wird "
+	"übersprungen.";
+static char args_doc[] = "";
+
+static struct argp_option options[] = {
+	{ "device", 'd', "PATH", 0, "Gerätedatei des Kernelmoduls (Standard /dev/usb_ws2812_0)", 0 },
+	{ "usb", 'u', "PATH", 0, "Pfad des libusb-Backends (Standard usb:0)", 0 },
+	{ "leds", 'l', "NUM", 0, "Länge des Streifens (Standard 300)", 0 },
+	{ "frames", 'f', "NUM", 0, "Frames pro Messung (Standard 1000)", 0 },
+	{ 0, 0, 0, 0, 0, 0 },
+};
+
+struct arguments {
+	const char *device;
+	const char *usb;
+	long leds;
+	long frames;
+};
+
+static error_t parse_opt(int key, char *arg, struct argp_state *state)
+{
+	struct arguments *arg_s = state->input;
+	switch (key) {
+	case 'd':
+		arg_s->device = arg;
+		break;
+	case 'u':
+		arg_s->usb = arg;
+		break;
+	case 'l':
+		arg_s->leds = strtol(arg, NULL, 10);
+		break;
+	case 'f':
+		arg_s->frames = strtol(arg, NULL, 10);
+		break;
+	default:
+		return ARGP_ERR_UNKNOWN;
+	}
+	return 0;
+}
+
+static struct argp argp = { options, parse_opt, args_doc, doc, 0, 0, 0 };
+
+static double now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+	double x = *(const double *)a, y = *(const double *)b;
+	return (x > y) - (x < y);
+}
+
+/**
+ * @brief Lauflicht, damit jeder Frame andere Pixel hat.
+ */
+static void render(led_pixel *frame, size_t count, long index)
+{
+	for (size_t i = 0; i < count; i++) {
+		uint8_t v = (i + index) % 32 == 0 ? 255 : 0;
+		frame[i] = (led_pixel){ v, v / 2, v / 4 };
+	}
+}
+
+/**
+ * @brief Misst einen Pfad und gibt das Ergebnis aus.
+ *
+ * @return 0 bei Erfolg, -1 bei einem Fehler während der Messung.
+ */
+static int bench_path(const char *name, const char *path, led_pixel *frame,
+		      size_t count, long frames, double *latencies)
+{
+	ws2812_handle *handle = ws2812_open(path, count);
+	if (!handle) {
+		printf("%-8s %s: übersprungen (%s)\n", name, path, strerror(errno));
+		return 0;
+	}
+	if (ws2812_set_mode_static(handle) < 0 ||
+	    ws2812_set_length(handle, count) < 0) {
+		perror("ws2812_set_length");
+		ws2812_close(handle);
+		return -1;
+	}
+
+	// Durchsatz: Frames ohne Warten senden, am Ende einmal synchronisieren
+	double start = now_ns();
+	for (long i = 0; i < frames; i++) {
+		render(frame, count, i);
+		if (ws2812_set_led_pixel(handle, 0, count, frame) < 0) {
+			perror("ws2812_set_led_pixel");
+			ws2812_close(handle);
+			return -1;
+		}
+	}
+	if (ws2812_refresh(handle) < 0) {
+		perror("ws2812_refresh");
+		ws2812_close(handle);
+		return -1;
+	}
+	double fps = frames / ((now_ns() - start) / 1e9);
+
+	// Latenz: jeder Frame einzeln bis zur Antwort des Controllers
+	for (long i = 0; i < frames; i++) {
+		render(frame, count, i);
+		start = now_ns();
+		if (ws2812_set_led_pixel(handle, 0, count, frame) < 0 ||
+		    ws2812_refresh(handle) < 0) {
+			perror("ws2812_set_led_pixel");
+			ws2812_close(handle);
+			return -1;
+		}
+		latencies[i] = (now_ns() - start) / 1e3;
+	}
+	qsort(latencies, frames, sizeof(double), compare_double);
+	double sum = 0;
+	for (long i = 0; i < frames; i++) {
+		sum += latencies[i];
+	}
+
+	printf("%-8s %s: %.1f Frames/s, Latenz Mittel %.1f us, p50 %.1f us, p99 %.1f us, max %.1f us\n",
+	       name, path, fps, sum / frames, latencies[frames / 2],
+	       latencies[frames * 99 / 100], latencies[frames - 1]);
+	ws2812_clear(handle);
+	ws2812_close(handle);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	struct arguments arguments = { "/dev/usb_ws2812_0", "usb:0", 300, 1000 };
+	argp_parse(&argp, argc, argv, 0, 0, &arguments);
+	if (arguments.leds <= 0 || arguments.leds > UINT16_MAX ||
+	    arguments.frames <= 0) {
+		printf("Länge und Frames müssen größer als 0 sein\n");
+		return 1;
+	}
+
+	size_t count = arguments.leds;
+	led_pixel *frame = malloc(count * sizeof(led_pixel));
+	double *latencies = malloc(arguments.frames * sizeof(double));
+	if (!frame || !latencies) {
+		perror("malloc");
+		return 1;
+	}
+
+	printf("LEDs: %zu, Frames: %ld\n", count, arguments.frames);
+	int ret = bench_path("Kernel", arguments.device, frame, count,
+			     arguments.frames, latencies);
+	// Das libusb-Backend löst das Kernelmodul für die Dauer der Messung
+	if (bench_path("libusb", arguments.usb, frame, count, arguments.frames,
+		       latencies) < 0) {
+		ret = -1;
+	}
+
+	free(latencies);
+	free(frame);
+	return ret < 0 ? 1 : 0;
+}
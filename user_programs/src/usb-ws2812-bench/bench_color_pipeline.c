@@ -0,0 +1,138 @@
+/**
+ * @file bench_color_pipeline.c                                                *
+ * @brief Throughput of the fused color pipeline per instruction set           *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#include <argp.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "usb_ws2812_lib.h"
+
+const char *argp_program_version = "bench-color-pipeline";
+const char *argp_program_bug_address = "";
+static char doc[] =
+	"bench-color-pipeline misst den Durchsatz von ws2812_color_apply() (Gamma, Helligkeit, Weißabgleich "
+	"und Kanalreihenfolge) für jeden Befehlssatz, den die CPU unterstützt, und vergleicht die Ergebnisse "
+	"mit dem skalaren Kern.";
+static char args_doc[] = "";
+
+static struct argp_option options[] = {
+	{ "leds", 'l', "NUM", 0, "Pixel pro Aufruf (Standard 1000)", 0 },
+	{ "iterations", 'i', "NUM", 0, "Anzahl der Aufrufe (Standard 100000)", 0 },
+	{ "gamma", 'g', "VALUE", 0, "Gamma-Exponent (Standard 2.2)", 0 },
+	{ 0, 0, 0, 0, 0, 0 },
+};
+
+struct arguments {
+	long leds;
+	long iterations;
+	double gamma;
+};
+
+static error_t parse_opt(int key, char *arg, struct argp_state *state)
+{
+	struct arguments *arg_s = state->input;
+	switch (key) {
+	case 'l':
+		arg_s->leds = strtol(arg, NULL, 10);
+		break;
+	case 'i':
+		arg_s->iterations = strtol(arg, NULL, 10);
+		break;
+	case 'g':
+		arg_s->gamma = strtod(arg, NULL);
+		break;
+	default:
+		return ARGP_ERR_UNKNOWN;
+	}
+	return 0;
+}
+
+static struct argp argp = { options, parse_opt, args_doc, doc, 0, 0, 0 };
+
+static double now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main(int argc, char **argv)
+{
+	struct arguments arguments = { 1000, 100000, 2.2 };
+	argp_parse(&argp, argc, argv, 0, 0, &arguments);
+	if (arguments.leds <= 0 || arguments.iterations <= 0) {
+		printf("Pixel und Aufrufe müssen größer als 0 sein\n");
+		return 1;
+	}
+
+	ws2812_color_config config = {
+		.gamma = arguments.gamma,
+		.brightness = 200,
+		.white_balance = { 255, 220, 180 },
+		.order = WS2812_ORDER_GRB,
+	};
+	ws2812_color_pipeline *pipeline = ws2812_color_create(&config);
+	if (!pipeline) {
+		perror("ws2812_color_create");
+		return 1;
+	}
+
+	size_t count = arguments.leds;
+	led_pixel *src = malloc(count * sizeof(led_pixel));
+	led_pixel *dst = malloc(count * sizeof(led_pixel));
+	led_pixel *ref = malloc(count * sizeof(led_pixel));
+	if (!src || !dst || !ref) {
+		perror("malloc");
+		return 1;
+	}
+	for (size_t i = 0; i < count; i++) {
+		src[i] = (led_pixel){ i * 7, i * 13 + 5, i * 29 + 11 };
+	}
+	ws2812_color_set_isa(pipeline, WS2812_ISA_SCALAR);
+	ws2812_color_apply(pipeline, ref, src, count);
+
+	printf("Pixel pro Aufruf: %zu, Aufrufe: %ld\n", count,
+	       arguments.iterations);
+	const ws2812_isa isas[] = { WS2812_ISA_SCALAR, WS2812_ISA_SSSE3,
+				    WS2812_ISA_AVX2, WS2812_ISA_NEON };
+	int ret = 0;
+	for (size_t n = 0; n < sizeof(isas) / sizeof(isas[0]); n++) {
+		if (ws2812_color_set_isa(pipeline, isas[n]) < 0) {
+			printf("%-8s nicht unterstützt\n",
+			       ws2812_isa_name(isas[n]));
+			continue;
+		}
+
+		double start = now_ns();
+		for (long i = 0; i < arguments.iterations; i++) {
+			ws2812_color_apply(pipeline, dst, src, count);
+			// Eingabe ändern, damit der Aufruf nicht wegoptimiert wird
+			src[i % count].red ^= 1;
+		}
+		double elapsed = now_ns() - start;
+
+		ws2812_color_apply(pipeline, dst, src, count);
+		ws2812_color_set_isa(pipeline, WS2812_ISA_SCALAR);
+		ws2812_color_apply(pipeline, ref, src, count);
+		bool equal = memcmp(dst, ref, count * sizeof(led_pixel)) == 0;
+		if (!equal) {
+			ret = 1;
+		}
+		printf("%-8s %8.3f Pixel/ns %s\n", ws2812_isa_name(isas[n]),
+		       count * arguments.iterations / elapsed,
+		       equal ? "" : "(weicht vom skalaren Kern ab!)");
+	}
+
+	free(ref);
+	free(dst);
+	free(src);
+	ws2812_color_free(pipeline);
+	return ret;
+}
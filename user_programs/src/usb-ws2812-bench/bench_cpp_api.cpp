@@ -0,0 +1,161 @@
+/**
+ * @file bench_cpp_api.cpp                                                     *
+ * @brief Compares the header-only C++ layer with the C API: packing a source  *
+ *        frame with gamma correction and submitting it.                      *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#include <argp.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <system_error>
+#include <vector>
+#include "usb_ws2812.hpp"
+
+/**
+ * @def BENCH_LEDS
+ * @brief Strip length of the benchmark (compile-time for ws2812::Strip).
+ */
+#define BENCH_LEDS 600
+
+const char *argp_program_version = "bench-cpp-api";
+const char *argp_program_bug_address = "";
+static char doc[] =
+	"bench-cpp-api vergleicht ws2812::Strip mit einer Schleife über die C-API: Umwandeln eines RGBX-Frames "
+	"mit Gamma-Tabelle (pack) und pack + Senden an das Gerät. "
+	"Ohne --device wird an /dev/null gesendet, dann wird nur der Aufwand in der Bibliothek und im Syscall gemessen.";
+static char args_doc[] = "";
+
+static struct argp_option options[] = {
+	{ "device", 'd', "FILE", 0, "Gerätedatei (Standard /dev/null)", 0 },
+	{ "frames", 'f', "NUM", 0, "Anzahl der Frames (Standard 100000)", 0 },
+	{ 0, 0, 0, 0, 0, 0 },
+};
+
+struct arguments {
+	const char *device;
+	long frames;
+};
+
+static error_t parse_opt(int key, char *arg, struct argp_state *state)
+{
+	struct arguments *arg_s = static_cast<struct arguments *>(state->input);
+	switch (key) {
+	case 'd':
+		arg_s->device = arg;
+		break;
+	case 'f':
+		arg_s->frames = std::strtol(arg, nullptr, 10);
+		break;
+	default:
+		return ARGP_ERR_UNKNOWN;
+	}
+	return 0;
+}
+
+static struct argp argp = { options, parse_opt, args_doc, doc, 0, 0, 0 };
+
+using bench_strip = ws2812::Strip<BENCH_LEDS, ws2812::Rgbx, ws2812::gamma22_lut>;
+
+/**
+ * @brief C-Variante: Länge, Kanalabstand und Tabelle sind Laufzeitwerte.
+ */
+static void __attribute__((noinline))
+pack_c(led_pixel *dst, const uint8_t *src, size_t count, size_t channels,
+       const uint8_t *lut)
+{
+	for (size_t i = 0; i < count; i++) {
+		dst[i].red = lut[src[i * channels + 0]];
+		dst[i].green = lut[src[i * channels + 1]];
+		dst[i].blue = lut[src[i * channels + 2]];
+	}
+}
+
+/**
+ * @brief Misst die Laufzeit von body() über frames Aufrufe.
+ *
+ * @return Nanosekunden pro Frame.
+ */
+template <class F> static double bench_ns_per_frame(long frames, F &&body)
+{
+	auto start = std::chrono::steady_clock::now();
+	for (long i = 0; i < frames; i++) {
+		body(i);
+	}
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(end - start).count() /
+	       frames;
+}
+
+int main(int argc, char **argv)
+{
+	struct arguments arguments = { "/dev/null", 100000 };
+	argp_parse(&argp, argc, argv, 0, 0, &arguments);
+	if (arguments.frames <= 0) {
+		std::printf("Die Anzahl der Frames muss größer als 0 sein\n");
+		return 1;
+	}
+
+	std::vector<uint8_t> source(bench_strip::source_bytes);
+	for (size_t i = 0; i < source.size(); i++) {
+		source[i] = static_cast<uint8_t>(i * 7);
+	}
+	std::span<const uint8_t, bench_strip::source_bytes> source_span(
+		source.data(), bench_strip::source_bytes);
+
+	try {
+		ws2812::Device device(arguments.device, BENCH_LEDS);
+		bench_strip strip;
+		std::vector<led_pixel> c_pixels(BENCH_LEDS);
+		const uint8_t *lut = ws2812::gamma22_lut.data();
+		volatile uint8_t sink = 0;
+
+		double c_pack = bench_ns_per_frame(arguments.frames, [&](long i) {
+			source[0] = static_cast<uint8_t>(i);
+			pack_c(c_pixels.data(), source.data(), BENCH_LEDS, 4, lut);
+			sink = c_pixels[BENCH_LEDS - 1].blue;
+		});
+		double cpp_pack =
+			bench_ns_per_frame(arguments.frames, [&](long i) {
+				source[0] = static_cast<uint8_t>(i);
+				strip.pack(source_span);
+				sink = strip.pixels()[BENCH_LEDS - 1].blue;
+			});
+		double c_submit =
+			bench_ns_per_frame(arguments.frames, [&](long i) {
+				source[0] = static_cast<uint8_t>(i);
+				pack_c(c_pixels.data(), source.data(),
+				       BENCH_LEDS, 4, lut);
+				if (ws2812_set_led_pixel(device.native(), 0,
+							 BENCH_LEDS,
+							 c_pixels.data()) < 0) {
+					ws2812::throw_errno(
+						"ws2812_set_led_pixel");
+				}
+			});
+		double cpp_submit =
+			bench_ns_per_frame(arguments.frames, [&](long i) {
+				source[0] = static_cast<uint8_t>(i);
+				strip.pack(source_span);
+				strip.submit(device);
+			});
+		(void)sink;
+
+		std::printf("LEDs pro Frame:        %d\n", BENCH_LEDS);
+		std::printf("Frames:                %ld\n", arguments.frames);
+		std::printf("pack C-API:            %.1f ns/Frame\n", c_pack);
+		std::printf("pack ws2812::Strip:    %.1f ns/Frame (%.2fx)\n",
+			    cpp_pack, c_pack / cpp_pack);
+		std::printf("pack+submit C-API:     %.1f ns/Frame\n", c_submit);
+		std::printf("pack+submit C++:       %.1f ns/Frame (%.2fx)\n",
+			    cpp_submit, c_submit / cpp_submit);
+	} catch (const std::system_error &e) {
+		std::printf("Fehler: %s\n", e.what());
+		return 1;
+	}
+	return 0;
+}
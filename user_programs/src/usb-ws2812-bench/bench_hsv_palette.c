@@ -0,0 +1,274 @@
+/**
+ * @file bench_hsv_palette.c                                                   *
+ * @brief Compares ws2812_hsv_to_rgb() and ws2812_palette_map() with naive     *
+ *        per-pixel implementations                                            *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#include <argp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "usb_ws2812_lib.h"
+
+const char *argp_program_version = "bench-hsv-palette";
+const char *argp_program_bug_address = "";
+static char doc[] =
+	"bench-hsv-palette vergleicht die Bulk-Funktionen der Bibliothek für HSV-Umrechnung und "
+	"Paletten-Verläufe mit einer naiven Umsetzung pro Pixel (Fallunterscheidung nach Farbsektor bzw. "
+	"Gleitkomma-Interpolation). Vorher wird geprüft, dass die SIMD-Kerne für alle Längen bis 100 "
+	"Pixel dasselbe Ergebnis liefern wie der skalare Kern.";
+static char args_doc[] = "";
+
+static struct argp_option options[] = {
+	{ "leds", 'l', "NUM", 0, "Pixel pro Aufruf (Standard 10000)", 0 },
+	{ "iterations", 'i', "NUM", 0, "Anzahl der Aufrufe (Standard 10000)", 0 },
+	{ 0, 0, 0, 0, 0, 0 },
+};
+
+struct arguments {
+	long leds;
+	long iterations;
+};
+
+static error_t parse_opt(int key, char *arg, struct argp_state *state)
+{
+	struct arguments *arg_s = state->input;
+	switch (key) {
+	case 'l':
+		arg_s->leds = strtol(arg, NULL, 10);
+		break;
+	case 'i':
+		arg_s->iterations = strtol(arg, NULL, 10);
+		break;
+	default:
+		return ARGP_ERR_UNKNOWN;
+	}
+	return 0;
+}
+
+static struct argp argp = { options, parse_opt, args_doc, doc, 0, 0, 0 };
+
+static double now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**
+ * @brief Übliche HSV-Umrechnung mit sechs Sektoren, wie sie in Effekten steht.
+ */
+static void __attribute__((noinline))
+naive_hsv_to_rgb(led_pixel *dst, const ws2812_hsv *src, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		uint8_t h = src[i].hue, s = src[i].saturation, v = src[i].value;
+		if (s == 0) {
+			dst[i] = (led_pixel){ v, v, v };
+			continue;
+		}
+		uint8_t region = h / 43;
+		uint8_t rem = (h - region * 43) * 6;
+		uint8_t p = (v * (255 - s)) >> 8;
+		uint8_t q = (v * (255 - ((s * rem) >> 8))) >> 8;
+		uint8_t t = (v * (255 - ((s * (255 - rem)) >> 8))) >> 8;
+		switch (region) {
+		case 0:
+			dst[i] = (led_pixel){ v, t, p };
+			break;
+		case 1:
+			dst[i] = (led_pixel){ q, v, p };
+			break;
+		case 2:
+			dst[i] = (led_pixel){ p, v, t };
+			break;
+		case 3:
+			dst[i] = (led_pixel){ p, q, v };
+			break;
+		case 4:
+			dst[i] = (led_pixel){ t, p, v };
+			break;
+		default:
+			dst[i] = (led_pixel){ v, p, q };
+			break;
+		}
+	}
+}
+
+/**
+ * @brief Paletten-Verlauf mit Gleitkomma-Interpolation.
+ */
+static void __attribute__((noinline))
+naive_palette_map(const led_pixel *colors, size_t color_count, led_pixel *dst,
+		  const uint16_t *positions, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		float x = positions[i] / 65536.0f * color_count;
+		size_t index = (size_t)x;
+		float f = x - index;
+		const led_pixel *a = &colors[index];
+		const led_pixel *b = &colors[(index + 1) % color_count];
+		dst[i].red = a->red + (b->red - a->red) * f;
+		dst[i].green = a->green + (b->green - a->green) * f;
+		dst[i].blue = a->blue + (b->blue - a->blue) * f;
+	}
+}
+
+/**
+ * @def CHECK_MAX_LENGTH
+ * @brief Längen 1 ... CHECK_MAX_LENGTH werden geprüft, auch alle Reste hinter den SIMD-Blöcken.
+ */
+#define CHECK_MAX_LENGTH 100
+
+/**
+ * @brief Vergleicht HSV und Paletten jeder unterstützten Befehlssatzstufe mit dem skalaren Kern.
+ *
+ * @return 0 wenn alle Kerne übereinstimmen, sonst -1.
+ */
+static int check_kernels(const led_pixel *colors, size_t color_count)
+{
+	ws2812_hsv hsv[CHECK_MAX_LENGTH];
+	uint16_t positions[CHECK_MAX_LENGTH];
+	led_pixel ref[CHECK_MAX_LENGTH], dst[CHECK_MAX_LENGTH];
+	ws2812_palette *palettes[2] = {
+		ws2812_palette_create(colors, color_count, false),
+		ws2812_palette_create(colors, color_count, true),
+	};
+	uint32_t seed = 1;
+	int ret = 0;
+
+	if (!palettes[0] || !palettes[1]) {
+		perror("ws2812_palette_create");
+		ret = -1;
+		goto out;
+	}
+	for (size_t i = 0; i < CHECK_MAX_LENGTH; i++) {
+		seed = seed * 1664525u + 1013904223u;
+		hsv[i] = (ws2812_hsv){ seed >> 24, seed >> 16, seed >> 8 };
+		positions[i] = seed;
+	}
+	// Ränder der Sektoren und des Verlaufs
+	hsv[0] = (ws2812_hsv){ 0, 255, 255 };
+	hsv[1] = (ws2812_hsv){ 255, 0, 255 };
+	positions[0] = 0;
+	positions[1] = 65535;
+
+	const ws2812_isa isas[] = { WS2812_ISA_SSSE3, WS2812_ISA_AVX2,
+				    WS2812_ISA_NEON };
+	for (size_t n = 0; n < sizeof(isas) / sizeof(isas[0]); n++) {
+		if (ws2812_isa_limit(isas[n]) < 0) {
+			printf("%-8s nicht unterstützt\n", ws2812_isa_name(isas[n]));
+			continue;
+		}
+		size_t mismatches = 0;
+		for (size_t length = 1; length <= CHECK_MAX_LENGTH; length++) {
+			ws2812_isa_limit(WS2812_ISA_SCALAR);
+			ws2812_hsv_to_rgb(ref, hsv, length);
+			ws2812_isa_limit(isas[n]);
+			ws2812_hsv_to_rgb(dst, hsv, length);
+			mismatches += memcmp(dst, ref, length * sizeof(led_pixel)) != 0;
+
+			for (int p = 0; p < 2; p++) {
+				ws2812_isa_limit(WS2812_ISA_SCALAR);
+				ws2812_palette_map(palettes[p], ref, positions, length);
+				ws2812_isa_limit(isas[n]);
+				ws2812_palette_map(palettes[p], dst, positions, length);
+				mismatches += memcmp(dst, ref,
+						     length * sizeof(led_pixel)) != 0;
+			}
+		}
+		printf("%-8s %s\n", ws2812_isa_name(isas[n]),
+		       mismatches ? "weicht vom skalaren Kern ab!" :
+				    "gleich dem skalaren Kern");
+		if (mismatches) {
+			ret = -1;
+		}
+	}
+	ws2812_isa_limit(WS2812_ISA_AUTO);
+
+out:
+	ws2812_palette_free(palettes[1]);
+	ws2812_palette_free(palettes[0]);
+	return ret;
+}
+
+int main(int argc, char **argv)
+{
+	struct arguments arguments = { 10000, 10000 };
+	argp_parse(&argp, argc, argv, 0, 0, &arguments);
+	if (arguments.leds <= 0 || arguments.iterations <= 0) {
+		printf("Pixel und Aufrufe müssen größer als 0 sein\n");
+		return 1;
+	}
+
+	size_t count = arguments.leds;
+	long iterations = arguments.iterations;
+	ws2812_hsv *hsv = malloc(count * sizeof(ws2812_hsv));
+	uint16_t *positions = malloc(count * sizeof(uint16_t));
+	led_pixel *dst = malloc(count * sizeof(led_pixel));
+	if (!hsv || !positions || !dst) {
+		perror("malloc");
+		return 1;
+	}
+	// Regenbogen über den Streifen, wie bei einem Farbdurchlauf
+	for (size_t i = 0; i < count; i++) {
+		hsv[i] = (ws2812_hsv){ i * 256 / count, 255 - i % 64, 200 };
+		positions[i] = i * 65536 / count;
+	}
+	const led_pixel colors[] = { { 255, 0, 0 },   { 255, 160, 0 },
+				     { 0, 255, 40 },  { 0, 60, 255 },
+				     { 180, 0, 255 }, { 255, 255, 255 } };
+	size_t color_count = sizeof(colors) / sizeof(colors[0]);
+	ws2812_palette *palette = ws2812_palette_create(colors, color_count, true);
+	if (!palette) {
+		perror("ws2812_palette_create");
+		return 1;
+	}
+	int ret = check_kernels(colors, color_count) < 0 ? 1 : 0;
+
+	double start = now_ns();
+	for (long i = 0; i < iterations; i++) {
+		hsv[i % count].hue++;
+		naive_hsv_to_rgb(dst, hsv, count);
+	}
+	double hsv_naive = (now_ns() - start) / iterations / count;
+
+	start = now_ns();
+	for (long i = 0; i < iterations; i++) {
+		hsv[i % count].hue++;
+		ws2812_hsv_to_rgb(dst, hsv, count);
+	}
+	double hsv_lib = (now_ns() - start) / iterations / count;
+
+	start = now_ns();
+	for (long i = 0; i < iterations; i++) {
+		positions[i % count]++;
+		naive_palette_map(colors, color_count, dst, positions, count);
+	}
+	double palette_naive = (now_ns() - start) / iterations / count;
+
+	start = now_ns();
+	for (long i = 0; i < iterations; i++) {
+		positions[i % count]++;
+		ws2812_palette_map(palette, dst, positions, count);
+	}
+	double palette_lib = (now_ns() - start) / iterations / count;
+
+	printf("Pixel pro Aufruf: %zu, Aufrufe: %ld\n", count, iterations);
+	printf("HSV naiv:              %.3f ns/Pixel\n", hsv_naive);
+	printf("ws2812_hsv_to_rgb:     %.3f ns/Pixel (%.1fx)\n", hsv_lib,
+	       hsv_naive / hsv_lib);
+	printf("Palette naiv:          %.3f ns/Pixel\n", palette_naive);
+	printf("ws2812_palette_map:    %.3f ns/Pixel (%.1fx)\n", palette_lib,
+	       palette_naive / palette_lib);
+
+	ws2812_palette_free(palette);
+	free(dst);
+	free(positions);
+	free(hsv);
+	return ret;
+}
@@ -0,0 +1,508 @@
+/**
+ * @file compositor.c                                                          *
+ * @brief Compositing daemon: owns a strip and blends the shared-memory layers *
+ *        of its clients once per frame                                        *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#include <argp.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "compositor_packets.h"
+#include "usb_ws2812_lib.h"
+
+const char *argp_program_version = "usb-ws2812-compositor";
+const char *argp_program_bug_address = "";
+static char doc[] =
+	"usb-ws2812-compositor übernimmt einen LED-Streifen und stellt mehreren Prozessen Ebenen zur "
+	"Verfügung. Jeder Client verbindet sich mit dem Socket (ws2812_layer_connect()) und erhält eine "
+	"Ebene im gemeinsamen Speicher (memfd), in die er direkt zeichnet. Der Daemon mischt alle Ebenen "
+	"in fester Bildrate nach Reihenfolge (z), Mischmodus und Deckkraft und sendet einmal pro Takt "
+	"einen Frame. Nach jedem Frame wird der eventfd jedes Clients erhöht.";
+static char args_doc[] = "";
+
+static struct argp_option options[] = {
+	{ "device", 'd', "PATH", 0, "Gerätedatei oder usb:N (Standard /dev/usb_ws2812_0)", 0 },
+	{ "socket", 's', "PATH", 0, "Socket für die Clients (Standard " WS2812_COMPOSITOR_SOCKET ")", 0 },
+	{ "rate", 'r', "FPS", 0, "Bildrate (Standard 60)", 0 },
+	{ "leds", 'l', "NUM", 0, "Länge des Streifens setzen (Standard: aktuelle Länge)", 0 },
+	{ "max-layers", 'm', "NUM", 0, "Höchstzahl gleichzeitiger Ebenen (Standard 16)", 0 },
+	{ 0, 0, 0, 0, 0, 0 },
+};
+
+struct arguments {
+	const char *device;
+	const char *socket;
+	double rate;
+	long leds;
+	long max_layers;
+};
+
+static error_t parse_opt(int key, char *arg, struct argp_state *state)
+{
+	struct arguments *arg_s = state->input;
+	switch (key) {
+	case 'd':
+		arg_s->device = arg;
+		break;
+	case 's':
+		arg_s->socket = arg;
+		break;
+	case 'r':
+		arg_s->rate = strtod(arg, NULL);
+		break;
+	case 'l':
+		arg_s->leds = strtol(arg, NULL, 10);
+		break;
+	case 'm':
+		arg_s->max_layers = strtol(arg, NULL, 10);
+		break;
+	default:
+		return ARGP_ERR_UNKNOWN;
+	}
+	return 0;
+}
+
+static struct argp argp = { options, parse_opt, args_doc, doc, 0, 0, 0 };
+
+/**
+ * @brief Ebene eines verbundenen Clients.
+ */
+struct layer {
+	int socket_fd; /**< Verbindung, ihr Ende entfernt die Ebene. */
+	int event_fd; /**< Frame-Takt des Clients. */
+	compositor_layer_shm *shm; /**< Gemeinsamer Speicher. */
+	size_t size; /**< Größe des gemeinsamen Speichers. */
+	uint64_t id; /**< Reihenfolge der Verbindungen, bei gleichem z unten zuerst. */
+};
+
+/**
+ * @brief Zustand des Daemons.
+ */
+struct compositor {
+	ws2812_handle *handle;
+	ws2812_scheduler *sched;
+	ws2812_planar_frame *output; /**< Gemischter Frame. */
+	int epoll_fd;
+	int listen_fd;
+	struct layer **layers; /**< Verbundene Ebenen. */
+	size_t layer_count;
+	size_t max_layers;
+	uint64_t next_id;
+	uint32_t stride; /**< Bytes pro Farbkanal einer Ebene im gemeinsamen Speicher. */
+	uint64_t frames; /**< Gesendete Frames. */
+	uint64_t errors; /**< Fehlgeschlagene Frames. */
+};
+
+static volatile sig_atomic_t running = 1;
+
+static void stop_handler(int sig)
+{
+	(void)sig;
+	running = 0;
+}
+
+/**
+ * @brief Sendet die Ankündigung der Ebene mit memfd und eventfd.
+ */
+static int send_layer(int socket_fd, const compositor_layer_info *info,
+		      int memfd, int event_fd)
+{
+	union {
+		struct cmsghdr header;
+		char buf[CMSG_SPACE(2 * sizeof(int))];
+	} control;
+	struct iovec iov = { .iov_base = (void *)info, .iov_len = sizeof(*info) };
+	struct msghdr msg = {
+		.msg_iov = &iov,
+		.msg_iovlen = 1,
+		.msg_control = control.buf,
+		.msg_controllen = sizeof(control.buf),
+	};
+	memset(&control, 0, sizeof(control));
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(2 * sizeof(int));
+	int fds[2] = { memfd, event_fd };
+	memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+	return sendmsg(socket_fd, &msg, MSG_NOSIGNAL) < 0 ? -1 : 0;
+}
+
+static void layer_free(struct layer *layer)
+{
+	if (layer->shm) {
+		munmap(layer->shm, layer->size);
+	}
+	if (layer->event_fd >= 0) {
+		close(layer->event_fd);
+	}
+	close(layer->socket_fd);
+	free(layer);
+}
+
+/**
+ * @brief Nimmt einen Client an und legt seine Ebene an.
+ */
+static void accept_client(struct compositor *comp)
+{
+	int socket_fd = accept4(comp->listen_fd, NULL, NULL, SOCK_CLOEXEC);
+	if (socket_fd < 0) {
+		perror("accept4");
+		return;
+	}
+	if (comp->layer_count == comp->max_layers) {
+		fprintf(stderr, "Client abgewiesen: höchstens %zu Ebenen\n",
+			comp->max_layers);
+		close(socket_fd);
+		return;
+	}
+
+	struct layer *layer = calloc(1, sizeof(struct layer));
+	if (!layer) {
+		close(socket_fd);
+		return;
+	}
+	layer->socket_fd = socket_fd;
+	layer->event_fd = -1;
+	layer->id = comp->next_id++;
+	layer->size = COMPOSITOR_LAYER_HEADER_SIZE +
+		      (size_t)COMPOSITOR_LAYER_BUFFERS *
+			      COMPOSITOR_LAYER_PLANES * comp->stride;
+
+	// Größe versiegeln, ein Client kann den Speicher nicht verkleinern (SIGBUS im Daemon)
+	int memfd = memfd_create("ws2812-layer", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if (memfd < 0 || ftruncate(memfd, layer->size) < 0 ||
+	    fcntl(memfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) <
+		    0) {
+		perror("memfd");
+		goto fail;
+	}
+	void *shm = mmap(NULL, layer->size, PROT_READ | PROT_WRITE, MAP_SHARED,
+			 memfd, 0);
+	if (shm == MAP_FAILED) {
+		perror("mmap");
+		goto fail;
+	}
+	layer->shm = shm;
+	layer->event_fd = eventfd(0, EFD_CLOEXEC);
+	if (layer->event_fd < 0) {
+		perror("eventfd");
+		goto fail;
+	}
+
+	// Neue Ebenen sind deckend, bis zur ersten Veröffentlichung aber unsichtbar
+	uint16_t length = comp->output->length;
+	*layer->shm = (compositor_layer_shm){
+		.magic = COMPOSITOR_MAGIC,
+		.version = COMPOSITOR_VERSION,
+		.length = length,
+		.stride = comp->stride,
+		.blend = WS2812_BLEND_NORMAL,
+		.opacity = 255,
+	};
+	uint8_t *planes = (uint8_t *)shm + COMPOSITOR_LAYER_HEADER_SIZE;
+	for (int b = 0; b < COMPOSITOR_LAYER_BUFFERS; b++) {
+		memset(planes + (b * COMPOSITOR_LAYER_PLANES + 3) * comp->stride,
+		       255, comp->stride);
+	}
+
+	compositor_layer_info info = {
+		.magic = COMPOSITOR_MAGIC,
+		.version = COMPOSITOR_VERSION,
+		.length = length,
+		.stride = comp->stride,
+		.size = layer->size,
+	};
+	if (send_layer(socket_fd, &info, memfd, layer->event_fd) < 0) {
+		perror("sendmsg");
+		goto fail;
+	}
+	close(memfd);
+	memfd = -1;
+
+	struct epoll_event ev = { .events = EPOLLIN | EPOLLRDHUP,
+				  .data.ptr = layer };
+	if (epoll_ctl(comp->epoll_fd, EPOLL_CTL_ADD, socket_fd, &ev) < 0) {
+		perror("epoll_ctl");
+		goto fail;
+	}
+	comp->layers[comp->layer_count++] = layer;
+	return;
+
+fail:
+	if (memfd >= 0) {
+		close(memfd);
+	}
+	layer_free(layer);
+}
+
+/**
+ * @brief Entfernt die Ebene eines Clients, der die Verbindung beendet hat.
+ */
+static void remove_client(struct compositor *comp, struct layer *layer)
+{
+	for (size_t i = 0; i < comp->layer_count; i++) {
+		if (comp->layers[i] == layer) {
+			comp->layers[i] = comp->layers[--comp->layer_count];
+			break;
+		}
+	}
+	epoll_ctl(comp->epoll_fd, EPOLL_CTL_DEL, layer->socket_fd, NULL);
+	layer_free(layer);
+}
+
+/**
+ * @brief Ebenen nach z sortieren, bei gleichem z nach Verbindungsreihenfolge.
+ *
+ * Einfügesortierung: wenige Ebenen, die Reihenfolge ändert sich selten.
+ */
+static void sort_layers(struct layer **layers, const int16_t *z, size_t count,
+			struct layer **sorted)
+{
+	int16_t sorted_z[count ? count : 1];
+
+	for (size_t i = 0; i < count; i++) {
+		size_t j = i;
+		while (j > 0 && (sorted_z[j - 1] > z[i] ||
+				 (sorted_z[j - 1] == z[i] &&
+				  sorted[j - 1]->id > layers[i]->id))) {
+			sorted[j] = sorted[j - 1];
+			sorted_z[j] = sorted_z[j - 1];
+			j--;
+		}
+		sorted[j] = layers[i];
+		sorted_z[j] = z[i];
+	}
+}
+
+/**
+ * @brief Mischt alle Ebenen, sendet den Frame und gibt den Takt an die Clients.
+ */
+static void composite(struct compositor *comp)
+{
+	ws2812_planar_frame *out = comp->output;
+	size_t count = comp->layer_count;
+	struct layer *sorted[count ? count : 1];
+	int16_t z[count ? count : 1];
+
+	for (size_t i = 0; i < count; i++) {
+		z[i] = __atomic_load_n(&comp->layers[i]->shm->z, __ATOMIC_RELAXED);
+	}
+	sort_layers(comp->layers, z, count, sorted);
+
+	// Ebenen 0 (unten) bis count - 1 (oben) auf Schwarz mischen
+	memset(out->red, 0, 3 * out->stride);
+	for (size_t i = 0; i < count; i++) {
+		compositor_layer_shm *shm = sorted[i]->shm;
+		uint32_t published = __atomic_load_n(&shm->published,
+						     __ATOMIC_ACQUIRE);
+		if (published == 0) {
+			continue;
+		}
+		uint32_t front = __atomic_load_n(&shm->front, __ATOMIC_ACQUIRE) %
+				 COMPOSITOR_LAYER_BUFFERS;
+		uint8_t blend = __atomic_load_n(&shm->blend, __ATOMIC_RELAXED);
+		uint8_t opacity = __atomic_load_n(&shm->opacity, __ATOMIC_RELAXED);
+		uint8_t *buffer = (uint8_t *)shm + COMPOSITOR_LAYER_HEADER_SIZE +
+				  front * COMPOSITOR_LAYER_PLANES * comp->stride;
+		ws2812_planar_frame src = {
+			.length = out->length,
+			.stride = comp->stride,
+			.red = buffer,
+			.green = buffer + comp->stride,
+			.blue = buffer + 2 * comp->stride,
+		};
+		ws2812_planar_blend(out, &src, buffer + 3 * comp->stride,
+				    opacity,
+				    blend < WS2812_BLEND_MODE_LENGTH ?
+					    blend :
+					    WS2812_BLEND_NORMAL);
+		// Ab jetzt darf der Client in den vorher veröffentlichten Puffer zeichnen
+		__atomic_store_n(&shm->consumed, published, __ATOMIC_RELEASE);
+	}
+
+	if (ws2812_planar_submit(comp->handle, 0, out) < 0) {
+		if (comp->errors++ == 0) {
+			perror("ws2812_planar_submit");
+		}
+	}
+	comp->frames++;
+
+	uint64_t one = 1;
+	for (size_t i = 0; i < count; i++) {
+		__atomic_store_n(&comp->layers[i]->shm->frame, comp->frames,
+				 __ATOMIC_RELEASE);
+		if (write(comp->layers[i]->event_fd, &one, sizeof(one)) < 0) {
+			perror("eventfd");
+		}
+	}
+}
+
+/**
+ * @brief Öffnet den Socket der Clients.
+ */
+static int listen_socket(const char *path)
+{
+	struct sockaddr_un addr = { .sun_family = AF_UNIX };
+	if (strlen(path) >= sizeof(addr.sun_path)) {
+		fprintf(stderr, "Socketpfad zu lang: %s\n", path);
+		return -1;
+	}
+	strcpy(addr.sun_path, path);
+
+	int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	if (fd < 0) {
+		perror("socket");
+		return -1;
+	}
+	// Socket eines beendeten Daemons ersetzen
+	unlink(path);
+	if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+	    listen(fd, 16) < 0) {
+		perror(path);
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+static int run(struct compositor *comp)
+{
+	struct epoll_event ev = { .events = EPOLLIN, .data.ptr = &comp->listen_fd };
+	if (epoll_ctl(comp->epoll_fd, EPOLL_CTL_ADD, comp->listen_fd, &ev) < 0) {
+		perror("epoll_ctl");
+		return -1;
+	}
+	ev.data.ptr = comp->sched;
+	if (epoll_ctl(comp->epoll_fd, EPOLL_CTL_ADD,
+		      ws2812_scheduler_fd(comp->sched), &ev) < 0) {
+		perror("epoll_ctl");
+		return -1;
+	}
+
+	while (running) {
+		struct epoll_event events[16];
+		int n = epoll_wait(comp->epoll_fd, events, 16, -1);
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			perror("epoll_wait");
+			return -1;
+		}
+		// Erst Verbindungen bearbeiten, dann mischen: ein entfernter Client
+		// darf nicht mehr in der Liste stehen
+		bool tick = false;
+		for (int i = 0; i < n; i++) {
+			void *ptr = events[i].data.ptr;
+			if (ptr == &comp->listen_fd) {
+				accept_client(comp);
+			} else if (ptr == comp->sched) {
+				tick = true;
+			} else {
+				// Clients senden nichts, jedes Ereignis ist das Ende der Verbindung
+				remove_client(comp, ptr);
+			}
+		}
+		if (tick && ws2812_scheduler_wait(comp->sched) > 0) {
+			composite(comp);
+			ws2812_scheduler_frame_done(comp->sched);
+		}
+	}
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	struct arguments arguments = { "/dev/usb_ws2812_0",
+				       WS2812_COMPOSITOR_SOCKET, 60, 0, 16 };
+	argp_parse(&argp, argc, argv, 0, 0, &arguments);
+	if (arguments.rate <= 0 || arguments.leds < 0 ||
+	    arguments.leds > UINT16_MAX || arguments.max_layers <= 0) {
+		printf("Ungültige Bildrate, Länge oder Anzahl Ebenen\n");
+		return 1;
+	}
+
+	struct compositor comp = { .epoll_fd = -1, .listen_fd = -1,
+				   .max_layers = arguments.max_layers };
+	int ret = 1;
+	comp.handle = ws2812_open(arguments.device, 0);
+	if (!comp.handle) {
+		perror(arguments.device);
+		return 1;
+	}
+	if (ws2812_set_mode_static(comp.handle) < 0 ||
+	    (arguments.leds && ws2812_set_length(comp.handle, arguments.leds) < 0)) {
+		perror("ws2812_set_length");
+		goto out;
+	}
+	int length = ws2812_get_length(comp.handle);
+	if (length <= 0) {
+		printf("Der Streifen hat keine Länge, mit -l setzen\n");
+		goto out;
+	}
+
+	comp.output = ws2812_planar_create(length);
+	comp.sched = ws2812_scheduler_create(arguments.rate, length);
+	comp.layers = calloc(comp.max_layers, sizeof(struct layer *));
+	if (!comp.output || !comp.sched || !comp.layers) {
+		perror("ws2812_scheduler_create");
+		goto out;
+	}
+	comp.stride = comp.output->stride;
+	comp.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	comp.listen_fd = listen_socket(arguments.socket);
+	if (comp.epoll_fd < 0 || comp.listen_fd < 0) {
+		goto out;
+	}
+
+	struct sigaction sa = { .sa_handler = stop_handler };
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+
+	printf("%d LEDs, %.1f Hz, Socket %s\n", length, arguments.rate,
+	       arguments.socket);
+	if (run(&comp) == 0) {
+		ret = 0;
+	}
+
+	ws2812_frame_stats stats;
+	ws2812_scheduler_get_stats(comp.sched, &stats);
+	printf("Frames: %llu (%.1f/s), verpasste Takte: %llu, Überläufe: %llu, Fehler: %llu\n",
+	       (unsigned long long)comp.frames, stats.achieved_fps,
+	       (unsigned long long)stats.missed_deadlines,
+	       (unsigned long long)stats.overruns,
+	       (unsigned long long)comp.errors);
+
+out:
+	if (comp.listen_fd >= 0) {
+		close(comp.listen_fd);
+		unlink(arguments.socket);
+	}
+	for (size_t i = 0; i < comp.layer_count; i++) {
+		layer_free(comp.layers[i]);
+	}
+	if (comp.epoll_fd >= 0) {
+		close(comp.epoll_fd);
+	}
+	free(comp.layers);
+	if (comp.sched) {
+		ws2812_scheduler_destroy(comp.sched);
+	}
+	ws2812_planar_free(comp.output);
+	ws2812_close(comp.handle);
+	return ret;
+}
@@ -0,0 +1,87 @@
+/**
+ * @file anim_format.h                                                         *
+ * @brief Layout of animation files: header, frame data and frame index        *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#ifndef ANIM_FORMAT_H
+#define ANIM_FORMAT_H
+
+#include <stdint.h>
+
+/**
+ * @def ANIM_MAGIC
+ * @brief First word of an animation file ("WS2A").
+ */
+#define ANIM_MAGIC 0x41325357
+
+/**
+ * @def ANIM_VERSION
+ * @brief Version of the format, changed with every incompatible change.
+ */
+#define ANIM_VERSION 1
+
+/**
+ * @def ANIM_FLAG_LOOP
+ * @brief The animation is meant to be repeated.
+ */
+#define ANIM_FLAG_LOOP 0x0001
+
+/**
+ * @brief Header at the start of an animation file.
+ *
+ * All fields are little endian. The frame data follows the header, the index
+ * (frame_count anim_index_entry) is at index_offset, behind the frame data. A
+ * frame is found by its number without reading any other frame.
+ */
+typedef struct anim_header_s {
+	uint32_t magic; /**< ANIM_MAGIC. */
+	uint16_t version; /**< ANIM_VERSION. */
+	uint16_t flags; /**< ANIM_FLAG_*. */
+	uint16_t length; /**< Pixels per frame. */
+	uint16_t keyframe_interval; /**< Largest distance between two key frames, informational. */
+	uint32_t frame_count; /**< Entries in the index. */
+	uint64_t index_offset; /**< File offset of the index. */
+	uint64_t duration_us; /**< Sum of all frame durations. */
+	uint8_t reserved[32]; /**< Zero. */
+} anim_header;
+
+/**
+ * @brief Encoding of a frame.
+ */
+typedef enum anim_encoding_e {
+	ANIM_ENCODING_RAW = 0, /**< length led_pixel. */
+	ANIM_ENCODING_RLE = 1, /**< Runs of a count (1 to 255) and one led_pixel. */
+	ANIM_ENCODING_DELTA = 2, /**< Changes to the previous frame, see anim_delta_record. */
+} anim_encoding;
+
+/**
+ * @brief Entry of the frame index.
+ *
+ * RAW and RLE frames are key frames, they decode on their own. A DELTA frame is
+ * applied to the frame before it, keyframe is the key frame its chain starts at.
+ */
+typedef struct anim_index_entry_s {
+	uint64_t offset; /**< File offset of the frame data. */
+	uint32_t size; /**< Bytes of frame data. */
+	uint32_t duration_us; /**< Display time of the frame. */
+	uint32_t keyframe; /**< Key frame to decode from, the frame itself for RAW and RLE. */
+	uint8_t encoding; /**< anim_encoding. */
+	uint8_t reserved[3]; /**< Zero. */
+} anim_index_entry;
+
+/**
+ * @brief Record of a DELTA frame, followed by count led_pixel.
+ *
+ * skip unchanged pixels follow the previous record (the start of the frame for
+ * the first one), then count pixels are replaced. Records follow each other up
+ * to the size of the frame.
+ */
+typedef struct anim_delta_record_s {
+	uint16_t skip; /**< Unchanged pixels before the record. */
+	uint16_t count; /**< Replaced pixels. */
+} anim_delta_record;
+
+#endif
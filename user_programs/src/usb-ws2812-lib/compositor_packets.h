@@ -0,0 +1,88 @@
+/**
+ * @file compositor_packets.h                                                  *
+ * @brief Protocol between the compositing daemon and its clients: the         *
+ *        announcement of a layer and the layout of its shared memory          *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#ifndef COMPOSITOR_PACKETS_H
+#define COMPOSITOR_PACKETS_H
+
+#include <stdint.h>
+
+/**
+ * @def COMPOSITOR_MAGIC
+ * @brief First word of the announcement and of the shared memory ("WS2L").
+ */
+#define COMPOSITOR_MAGIC 0x4c325357
+
+/**
+ * @def COMPOSITOR_VERSION
+ * @brief Version of the protocol, changed with every incompatible change.
+ */
+#define COMPOSITOR_VERSION 2
+
+/**
+ * @def COMPOSITOR_LAYER_BUFFERS
+ * @brief Buffers per layer: one is published (read by the daemon), the client renders the other one.
+ */
+#define COMPOSITOR_LAYER_BUFFERS 2
+
+/**
+ * @def COMPOSITOR_LAYER_PLANES
+ * @brief Planes per buffer: red, green, blue and alpha.
+ */
+#define COMPOSITOR_LAYER_PLANES 4
+
+/**
+ * @def COMPOSITOR_LAYER_HEADER_SIZE
+ * @brief Bytes before the first plane, keeps the planes WS2812_PLANAR_ALIGN aligned.
+ */
+#define COMPOSITOR_LAYER_HEADER_SIZE 64
+
+/**
+ * @brief Announcement of a new layer, sent by the daemon after accept().
+ *
+ * The message carries two file descriptors as SCM_RIGHTS: the memfd with the
+ * shared memory of the layer (compositor_layer_shm) and an eventfd that is
+ * incremented after every composited frame. The layer exists as long as the
+ * connection is open.
+ */
+typedef struct compositor_layer_info_s {
+	uint32_t magic; /**< COMPOSITOR_MAGIC. */
+	uint32_t version; /**< COMPOSITOR_VERSION. */
+	uint16_t length; /**< Pixels of the layer (length of the strip). */
+	uint32_t stride; /**< Bytes per plane, see ws2812_planar_frame. */
+	uint64_t size; /**< Size of the shared memory. */
+} compositor_layer_info;
+
+/**
+ * @brief Header at the start of the shared memory of a layer.
+ *
+ * COMPOSITOR_LAYER_HEADER_SIZE bytes behind its start follow the planes: plane p
+ * (red, green, blue, alpha) of buffer b is at
+ * COMPOSITOR_LAYER_HEADER_SIZE + (b * COMPOSITOR_LAYER_PLANES + p) * stride.
+ * Fields written by one side and read by the other are accessed atomically.
+ *
+ * The client stores front before published, the daemon loads published before
+ * front and stores it as consumed once it has blended the buffer. When consumed
+ * has reached the count of a publication, the daemon no longer reads the buffer
+ * published before it.
+ */
+typedef struct compositor_layer_shm_s {
+	uint32_t magic; /**< COMPOSITOR_MAGIC. */
+	uint32_t version; /**< COMPOSITOR_VERSION. */
+	uint16_t length; /**< Pixels per plane. */
+	uint32_t stride; /**< Bytes per plane. */
+	uint32_t front; /**< Published buffer, written by the client. */
+	uint32_t published; /**< Number of publications, the layer is hidden while it is 0. */
+	uint32_t consumed; /**< Value of published when the daemon last finished reading front, written by the daemon. */
+	int16_t z; /**< Stacking order, higher values are on top. Written by the client. */
+	uint8_t blend; /**< ws2812_blend_mode, written by the client. */
+	uint8_t opacity; /**< Opacity of the layer, written by the client. */
+	uint64_t frame; /**< Number of composited frames, written by the daemon. */
+} compositor_layer_shm;
+
+#endif
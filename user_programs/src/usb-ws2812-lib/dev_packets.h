@@ -18,7 +18,8 @@ typedef enum LED_CTRL_E {
 	CHAR_LED_PIXEL_DATA, /**<  Package ID for LED pixel data. */
 	CHAR_LED_SET_MODE, /**<  Package ID for setting LED mode. */
 	CHAR_LED_CLEAR, /**<  Package ID for clearing LED data. */
-	CHAR_LED_GET_DATA /**<  Package ID for getting LED data. */
+	CHAR_LED_GET_DATA, /**<  Package ID for getting LED data. */
+	CHAR_LED_SAVE_BOOT_FRAME /**<  Package ID for saving the current frame as boot frame. */
 } LED_CTRL;
 
 /**
@@ -168,6 +169,17 @@ typedef struct led_get_data_s {
 	uint8_t p_len; /**< Packet length for the request. This field is unused. */
 } led_get_data;
 
+/**
+ * @brief Structure representing the packet for saving the boot frame of the WS2812 controller.
+ *
+ * This structure defines a packet used to store the LED data currently shown by the WS2812 controller,
+ * together with the LED count, in the flash of the controller. The controller shows this frame directly
+ * after power-up, before the USB connection to the host is established.
+ */
+typedef struct led_save_boot_frame_s {
+	uint8_t ctrl; /**< Control byte for the save boot frame packet (0x05 or CHAR_LED_SAVE_BOOT_FRAME). */
+} led_save_boot_frame;
+
 #define MAKE_LED_CLEAR(struct_ptr) *(struct_ptr) = { .ctrl = LED_CLEAR }
 
 #endif
\ No newline at end of file
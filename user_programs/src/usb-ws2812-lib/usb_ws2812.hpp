@@ -0,0 +1,338 @@
+/**
+ * @file usb_ws2812.hpp                                                        *
+ * @brief Header-only C++20 layer over the user library                        *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#ifndef USB_WS2812_HPP
+#define USB_WS2812_HPP
+
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <system_error>
+#include <utility>
+#include "usb_ws2812_lib.h"
+
+namespace ws2812
+{
+
+/**
+ * @brief Lookup table that maps a channel value to its output value.
+ */
+using Lut = std::array<std::uint8_t, 256>;
+
+namespace detail
+{
+
+/**
+ * @brief Natural logarithm for constant evaluation (std::log isn't constexpr).
+ *
+ * The argument is reduced to [0.5, 1] and the atanh series is used there.
+ */
+constexpr double log(double x)
+{
+	constexpr double ln2 = 0.693147180559945309417;
+	int k = 0;
+	while (x < 0.5) {
+		x *= 2;
+		k++;
+	}
+	double t = (x - 1) / (x + 1);
+	double t2 = t * t;
+	double term = t;
+	double sum = 0;
+	for (int n = 1; n < 80; n += 2) {
+		sum += term / n;
+		term *= t2;
+	}
+	return 2 * sum - k * ln2;
+}
+
+/**
+ * @brief Exponential function for constant evaluation, x <= 0.
+ *
+ * The argument is halved until it is small, the Taylor series result is squared back.
+ */
+constexpr double exp(double x)
+{
+	int halvings = 0;
+	while (x < -0.5) {
+		x /= 2;
+		halvings++;
+	}
+	double term = 1;
+	double sum = 1;
+	for (int n = 1; n < 30; n++) {
+		term *= x / n;
+		sum += term;
+	}
+	for (int i = 0; i < halvings; i++) {
+		sum *= sum;
+	}
+	return sum;
+}
+
+} // namespace detail
+
+/**
+ * @brief Generates a gamma correction table with brightness scaling.
+ *
+ * out = round(brightness * (in / 255) ^ gamma), evaluated at compile time if the
+ * result is constexpr.
+ *
+ * @param gamma Gamma exponent (2.2 ... 2.8 for WS2812).
+ * @param brightness Output for the input 255.
+ * @return The table.
+ */
+constexpr Lut make_gamma_lut(double gamma, std::uint8_t brightness = 255)
+{
+	Lut lut{};
+	for (int i = 1; i < 256; i++) {
+		double v = detail::exp(gamma * detail::log(i / 255.0));
+		lut[i] = static_cast<std::uint8_t>(v * brightness + 0.5);
+	}
+	return lut;
+}
+
+/**
+ * @brief Identity table (no correction).
+ */
+inline constexpr Lut linear_lut = [] {
+	Lut lut{};
+	for (int i = 0; i < 256; i++) {
+		lut[i] = static_cast<std::uint8_t>(i);
+	}
+	return lut;
+}();
+
+/**
+ * @brief Gamma 2.2 table at full brightness.
+ */
+inline constexpr Lut gamma22_lut = make_gamma_lut(2.2);
+
+/**
+ * @brief Gamma 2.8 table at full brightness.
+ */
+inline constexpr Lut gamma28_lut = make_gamma_lut(2.8);
+
+/**
+ * @brief Byte layout of source pixels, the channel indices are compile-time constants.
+ */
+template <std::size_t Channels, std::size_t R, std::size_t G, std::size_t B>
+struct Format {
+	static constexpr std::size_t channels = Channels; ///< Bytes per source pixel
+	static constexpr std::size_t r = R; ///< Index of red
+	static constexpr std::size_t g = G; ///< Index of green
+	static constexpr std::size_t b = B; ///< Index of blue
+};
+
+using Rgb = Format<3, 0, 1, 2>; ///< R, G, B
+using Grb = Format<3, 1, 0, 2>; ///< G, R, B (order on the wire of the WS2812)
+using Bgr = Format<3, 2, 1, 0>; ///< B, G, R
+using Rgbx = Format<4, 0, 1, 2>; ///< R, G, B, unused (32 bit framebuffers)
+using Bgrx = Format<4, 2, 1, 0>; ///< B, G, R, unused (little endian XRGB8888)
+
+/**
+ * @brief Throws the current errno as std::system_error.
+ */
+[[noreturn]] inline void throw_errno(const char *what)
+{
+	throw std::system_error(errno, std::generic_category(), what);
+}
+
+/**
+ * @brief Opened WS2812 device, closes the handle on destruction.
+ *
+ * All functions throw std::system_error if the C function fails.
+ */
+class Device
+{
+    public:
+	/**
+	 * @brief Opens a device file, see ws2812_open().
+	 */
+	explicit Device(const char *path, std::uint16_t max_leds = 0)
+		: handle_(ws2812_open(path, max_leds))
+	{
+		if (!handle_) {
+			throw_errno("ws2812_open");
+		}
+	}
+
+	Device(const Device &) = delete;
+	Device &operator=(const Device &) = delete;
+
+	Device(Device &&other) noexcept
+		: handle_(std::exchange(other.handle_, nullptr))
+	{
+	}
+
+	Device &operator=(Device &&other) noexcept
+	{
+		if (this != &other) {
+			ws2812_close(handle_);
+			handle_ = std::exchange(other.handle_, nullptr);
+		}
+		return *this;
+	}
+
+	~Device()
+	{
+		ws2812_close(handle_);
+	}
+
+	/**
+	 * @brief Returns the C handle for functions without a C++ wrapper.
+	 */
+	ws2812_handle *native() const noexcept
+	{
+		return handle_;
+	}
+
+	void set_length(std::uint16_t length)
+	{
+		check(ws2812_set_length(handle_, length), "ws2812_set_length");
+	}
+
+	void clear()
+	{
+		check(ws2812_clear(handle_), "ws2812_clear");
+	}
+
+	void set_mode_static()
+	{
+		check(ws2812_set_mode_static(handle_),
+		      "ws2812_set_mode_static");
+	}
+
+	void save_boot_frame()
+	{
+		check(ws2812_save_boot_frame(handle_),
+		      "ws2812_save_boot_frame");
+	}
+
+	std::uint16_t length()
+	{
+		return static_cast<std::uint16_t>(
+			check(ws2812_get_length(handle_), "ws2812_get_length"));
+	}
+
+	/**
+	 * @brief Sends pixels starting at start, the span is passed to writev() without a copy.
+	 *
+	 * A span of more than 65535 pixels throws EINVAL instead of being truncated.
+	 */
+	void set_pixels(std::uint16_t start, std::span<const led_pixel> pixels)
+	{
+		if (pixels.size() > 0xFFFF) {
+			throw std::system_error(EINVAL, std::generic_category(),
+						"ws2812_set_led_pixel");
+		}
+		check(ws2812_set_led_pixel(
+			      handle_, start,
+			      static_cast<std::uint16_t>(pixels.size()),
+			      pixels.data()),
+		      "ws2812_set_led_pixel");
+	}
+
+	/**
+	 * @brief Sends several regions with one writev(), see ws2812_set_led_regions().
+	 */
+	void set_regions(std::span<const ws2812_region> regions)
+	{
+		check(ws2812_set_led_regions(handle_, regions.data(),
+					     regions.size()),
+		      "ws2812_set_led_regions");
+	}
+
+    private:
+	static int check(int ret, const char *what)
+	{
+		if (ret < 0) {
+			throw_errno(what);
+		}
+		return ret;
+	}
+
+	ws2812_handle *handle_;
+};
+
+/**
+ * @brief Frame buffer of a strip with compile-time length, source format and table.
+ *
+ * Because N, the channel indices and the table are constants, pack() compiles to a
+ * fixed-length loop without branches, which the compiler unrolls and vectorizes.
+ *
+ * @tparam N Number of LEDs.
+ * @tparam Fmt Byte layout of the source pixels passed to pack().
+ * @tparam Table Correction table applied to every channel.
+ */
+template <std::size_t N, class Fmt = Rgb, const Lut &Table = linear_lut>
+class Strip
+{
+	static_assert(N > 0 && N <= 0xFFFF, "strip length must fit in 16 bit");
+
+    public:
+	static constexpr std::size_t size = N; ///< Number of LEDs
+	static constexpr std::size_t source_bytes = N * Fmt::channels; ///< Bytes per source frame
+
+	/**
+	 * @brief Converts a source frame into the frame buffer.
+	 */
+	void pack(std::span<const std::uint8_t, source_bytes> src) noexcept
+	{
+		const std::uint8_t *in = src.data();
+		for (std::size_t i = 0; i < N; i++) {
+			pixels_[i].red = Table[in[i * Fmt::channels + Fmt::r]];
+			pixels_[i].green = Table[in[i * Fmt::channels + Fmt::g]];
+			pixels_[i].blue = Table[in[i * Fmt::channels + Fmt::b]];
+		}
+	}
+
+	/**
+	 * @brief Sets one LED, the table is applied.
+	 */
+	void set(std::size_t index, std::uint8_t r, std::uint8_t g,
+		 std::uint8_t b) noexcept
+	{
+		pixels_[index] = { Table[r], Table[g], Table[b] };
+	}
+
+	/**
+	 * @brief Sets all LEDs to one color, the table is applied.
+	 */
+	void fill(std::uint8_t r, std::uint8_t g, std::uint8_t b) noexcept
+	{
+		pixels_.fill({ Table[r], Table[g], Table[b] });
+	}
+
+	std::span<const led_pixel, N> pixels() const noexcept
+	{
+		return pixels_;
+	}
+
+	std::span<led_pixel, N> pixels() noexcept
+	{
+		return pixels_;
+	}
+
+	/**
+	 * @brief Sends the whole frame buffer to the device without a copy.
+	 */
+	void submit(Device &device) const
+	{
+		device.set_pixels(0, pixels_);
+	}
+
+    private:
+	std::array<led_pixel, N> pixels_{};
+};
+
+} // namespace ws2812
+
+#endif
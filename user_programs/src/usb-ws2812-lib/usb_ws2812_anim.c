@@ -0,0 +1,620 @@
+/**
+ * @file usb_ws2812_anim.c                                                     *
+ * @brief Animation files: memory-mapped reader with random access and writer  *
+ *        with RLE and delta compression                                       *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#include "usb_ws2812_lib.h"
+#include "anim_format.h"
+#include <endian.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief Frame of an opened animation, taken from the index.
+ */
+typedef struct ws2812_anim_frame_s {
+	const uint8_t *data; /**< Frame data in the mapping. */
+	uint32_t size; /**< Bytes of frame data. */
+	uint32_t duration_us; /**< Display time. */
+	uint64_t start_us; /**< Sum of the durations of all frames before. */
+	uint32_t keyframe; /**< Key frame the frame decodes from. */
+	uint8_t encoding; /**< anim_encoding. */
+} ws2812_anim_frame;
+
+/**
+ * @brief Opened animation file.
+ */
+struct ws2812_anim_s {
+	const uint8_t *map; /**< The mapped file. */
+	size_t map_size; /**< Size of the mapping. */
+	ws2812_anim_info info; /**< Header data. */
+	ws2812_anim_frame *frames; /**< Index, frame_count entries. */
+	led_pixel *current; /**< Last decoded frame. */
+	uint32_t current_frame; /**< Number of current, UINT32_MAX if it is invalid. */
+};
+
+/**
+ * @brief Animation file being written.
+ */
+struct ws2812_anim_writer_s {
+	FILE *file; /**< The file. */
+	uint16_t length; /**< Pixels per frame. */
+	uint16_t keyframe_interval; /**< Largest distance between key frames. */
+	uint16_t flags; /**< ANIM_FLAG_*. */
+	led_pixel *previous; /**< Last frame added, base of the next delta. */
+	uint8_t *scratch; /**< Encoded frame. */
+	anim_index_entry *index; /**< Index in file byte order. */
+	uint32_t frame_count; /**< Frames added. */
+	uint32_t index_capacity; /**< Entries allocated in index. */
+	uint32_t keyframe; /**< Last key frame. */
+	uint64_t offset; /**< File offset of the next frame. */
+	uint64_t duration_us; /**< Sum of the durations. */
+	bool failed; /**< A write failed, finish reports the error. */
+};
+
+/**
+ * @brief Reads a little endian 16 bit value from frame data.
+ */
+static inline uint16_t ws2812_anim_get16(const uint8_t *p)
+{
+	return (uint16_t)(p[0] | p[1] << 8);
+}
+
+/**
+ * @brief Validates the index of a mapped file and copies it into anim->frames.
+ *
+ * @return 0 on success, -1 if the file is corrupt.
+ */
+static int ws2812_anim_load_index(ws2812_anim *anim, const anim_header *header)
+{
+	uint64_t data_end = le64toh(header->index_offset);
+	uint32_t count = anim->info.frame_count;
+	size_t frame_bytes = (size_t)anim->info.length * sizeof(led_pixel);
+
+	for (uint32_t i = 0; i < count; i++) {
+		anim_index_entry entry;
+		memcpy(&entry, anim->map + data_end + i * sizeof(entry),
+		       sizeof(entry));
+		uint64_t offset = le64toh(entry.offset);
+		uint32_t size = le32toh(entry.size);
+		uint32_t keyframe = le32toh(entry.keyframe);
+		if (offset < sizeof(anim_header) || offset > data_end ||
+		    size > data_end - offset) {
+			return -1;
+		}
+		// Ketten müssen bei einem Schlüsselbild beginnen und lückenlos sein
+		switch (entry.encoding) {
+		case ANIM_ENCODING_RAW:
+			if (size != frame_bytes || keyframe != i) {
+				return -1;
+			}
+			break;
+		case ANIM_ENCODING_RLE:
+			if (keyframe != i) {
+				return -1;
+			}
+			break;
+		case ANIM_ENCODING_DELTA:
+			if (i == 0 || keyframe != anim->frames[i - 1].keyframe) {
+				return -1;
+			}
+			break;
+		default:
+			return -1;
+		}
+		anim->frames[i] = (ws2812_anim_frame){
+			.data = anim->map + offset,
+			.size = size,
+			.duration_us = le32toh(entry.duration_us),
+			.start_us = i ? anim->frames[i - 1].start_us +
+						anim->frames[i - 1].duration_us :
+					0,
+			.keyframe = keyframe,
+			.encoding = entry.encoding,
+		};
+	}
+	if (count) {
+		anim->info.duration_us = anim->frames[count - 1].start_us +
+					 anim->frames[count - 1].duration_us;
+	}
+	return 0;
+}
+
+/**
+ * @brief Opens an animation file.
+ *
+ * The file is mapped read-only, the header and index are validated once and
+ * frames are decoded directly from the mapping, see ws2812_anim_decode().
+ *
+ * @param path Path of the file.
+ * @return The animation, or NULL on error (check errno for specific error,
+ *         EBADMSG if the file is not a valid animation).
+ */
+ws2812_anim *ws2812_anim_open(const char *path)
+{
+	int fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		return NULL;
+	}
+	struct stat st;
+	if (fstat(fd, &st) < 0) {
+		close(fd);
+		return NULL;
+	}
+	if ((size_t)st.st_size < sizeof(anim_header)) {
+		close(fd);
+		errno = EBADMSG;
+		return NULL;
+	}
+	void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		return NULL;
+	}
+	// Wiedergabe liest vorwärts, der Kernel soll früh vorauslesen
+	madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+	ws2812_anim *anim = calloc(1, sizeof(ws2812_anim));
+	if (!anim) {
+		munmap(map, st.st_size);
+		return NULL;
+	}
+	anim->map = map;
+	anim->map_size = st.st_size;
+	anim->current_frame = UINT32_MAX;
+
+	anim_header header;
+	memcpy(&header, map, sizeof(header));
+	anim->info.length = le16toh(header.length);
+	anim->info.frame_count = le32toh(header.frame_count);
+	anim->info.loop = le16toh(header.flags) & ANIM_FLAG_LOOP;
+	uint64_t index_offset = le64toh(header.index_offset);
+	// Index vor dem Anlegen der Tabelle prüfen, frame_count kann beliebig sein
+	if (le32toh(header.magic) != ANIM_MAGIC ||
+	    le16toh(header.version) != ANIM_VERSION ||
+	    index_offset < sizeof(anim_header) || index_offset > anim->map_size ||
+	    (anim->map_size - index_offset) / sizeof(anim_index_entry) <
+		    anim->info.frame_count) {
+		ws2812_anim_close(anim);
+		errno = EBADMSG;
+		return NULL;
+	}
+	anim->frames = calloc(anim->info.frame_count ? anim->info.frame_count : 1,
+			      sizeof(ws2812_anim_frame));
+	anim->current = calloc(anim->info.length ? anim->info.length : 1,
+			       sizeof(led_pixel));
+	if (!anim->frames || !anim->current) {
+		ws2812_anim_close(anim);
+		errno = ENOMEM;
+		return NULL;
+	}
+	if (ws2812_anim_load_index(anim, &header) < 0) {
+		ws2812_anim_close(anim);
+		errno = EBADMSG;
+		return NULL;
+	}
+	return anim;
+}
+
+/**
+ * @brief Closes an animation file.
+ *
+ * @param anim The animation, may be NULL.
+ */
+void ws2812_anim_close(ws2812_anim *anim)
+{
+	if (!anim) {
+		return;
+	}
+	munmap((void *)anim->map, anim->map_size);
+	free(anim->frames);
+	free(anim->current);
+	free(anim);
+}
+
+/**
+ * @brief Returns the header data of an animation.
+ *
+ * @param anim The animation.
+ * @param info Receives length, number of frames, total duration and loop flag.
+ */
+void ws2812_anim_get_info(const ws2812_anim *anim, ws2812_anim_info *info)
+{
+	*info = anim->info;
+}
+
+/**
+ * @brief Returns the display time of a frame.
+ *
+ * @param anim The animation.
+ * @param frame Number of the frame, must be below the frame count.
+ * @return The duration in microseconds.
+ */
+uint32_t ws2812_anim_frame_duration(const ws2812_anim *anim, uint32_t frame)
+{
+	return anim->frames[frame].duration_us;
+}
+
+/**
+ * @brief Returns the frame shown at a point in time (binary search in the index).
+ *
+ * @param anim The animation.
+ * @param time_us Time since the start of the animation.
+ * @return Number of the frame, the last frame if time_us is beyond the end.
+ */
+uint32_t ws2812_anim_frame_at(const ws2812_anim *anim, uint64_t time_us)
+{
+	uint32_t lo = 0;
+	uint32_t hi = anim->info.frame_count;
+
+	while (hi - lo > 1) {
+		uint32_t mid = lo + (hi - lo) / 2;
+		if (anim->frames[mid].start_us <= time_us) {
+			lo = mid;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+/**
+ * @brief Decodes an RLE frame, the runs must cover exactly length pixels.
+ */
+static int ws2812_anim_decode_rle(const uint8_t *p, size_t size,
+				  led_pixel *pixels, size_t length)
+{
+	size_t pos = 0;
+
+	if (size % 4) {
+		return -1;
+	}
+	for (size_t i = 0; i < size; i += 4) {
+		size_t run = p[i];
+		if (run == 0 || run > length - pos) {
+			return -1;
+		}
+		led_pixel pixel = { p[i + 1], p[i + 2], p[i + 3] };
+		while (run--) {
+			pixels[pos++] = pixel;
+		}
+	}
+	return pos == length ? 0 : -1;
+}
+
+/**
+ * @brief Applies the records of a DELTA frame to the previous frame.
+ */
+static int ws2812_anim_decode_delta(const uint8_t *p, size_t size,
+				    led_pixel *pixels, size_t length)
+{
+	size_t pos = 0;
+	size_t i = 0;
+
+	while (i < size) {
+		if (size - i < sizeof(anim_delta_record)) {
+			return -1;
+		}
+		size_t skip = ws2812_anim_get16(p + i);
+		size_t count = ws2812_anim_get16(p + i + 2);
+		i += sizeof(anim_delta_record);
+		if (skip > length - pos || count > length - pos - skip ||
+		    count * sizeof(led_pixel) > size - i) {
+			return -1;
+		}
+		pos += skip;
+		memcpy(pixels + pos, p + i, count * sizeof(led_pixel));
+		pos += count;
+		i += count * sizeof(led_pixel);
+	}
+	return 0;
+}
+
+/**
+ * @brief Decodes one frame into the internal frame of the animation.
+ */
+static int ws2812_anim_apply(ws2812_anim *anim, uint32_t frame)
+{
+	const ws2812_anim_frame *f = &anim->frames[frame];
+
+	switch (f->encoding) {
+	case ANIM_ENCODING_RAW:
+		memcpy(anim->current, f->data, f->size);
+		return 0;
+	case ANIM_ENCODING_RLE:
+		return ws2812_anim_decode_rle(f->data, f->size, anim->current,
+					      anim->info.length);
+	default:
+		return ws2812_anim_decode_delta(f->data, f->size, anim->current,
+						anim->info.length);
+	}
+}
+
+/**
+ * @brief Decodes a frame.
+ *
+ * The next frame after the previously decoded one costs one decode step. Any
+ * other frame is found through the index in constant time and decoded from its
+ * key frame, at most keyframe_interval steps. An animation must not be decoded
+ * by several threads at once.
+ *
+ * @param anim The animation.
+ * @param frame Number of the frame.
+ * @param pixels Receives the length pixels of the frame.
+ * @return 0 on success, -1 on error (check errno for specific error).
+ */
+int ws2812_anim_decode(ws2812_anim *anim, uint32_t frame, led_pixel *pixels)
+{
+	if (frame >= anim->info.frame_count) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	uint32_t keyframe = anim->frames[frame].keyframe;
+	uint32_t next = keyframe;
+	// Ab dem zuletzt dekodierten Frame weitermachen, wenn er in der Kette liegt
+	if (anim->current_frame != UINT32_MAX &&
+	    anim->current_frame >= keyframe && anim->current_frame <= frame) {
+		next = anim->current_frame + 1;
+	}
+	for (; next <= frame; next++) {
+		if (ws2812_anim_apply(anim, next) < 0) {
+			anim->current_frame = UINT32_MAX;
+			errno = EBADMSG;
+			return -1;
+		}
+		anim->current_frame = next;
+	}
+	memcpy(pixels, anim->current, anim->info.length * sizeof(led_pixel));
+	return 0;
+}
+
+/**
+ * @brief Creates an animation file.
+ *
+ * Frames are added with ws2812_anim_writer_add(), ws2812_anim_writer_finish()
+ * writes the index and closes the file.
+ *
+ * @param path Path of the file, an existing file is replaced.
+ * @param length Pixels per frame.
+ * @param keyframe_interval Largest number of frames between two key frames, 0 for
+ *        only key frames. Smaller values make seeking cheaper, larger ones the file smaller.
+ * @param loop Mark the animation to be repeated.
+ * @return The writer, or NULL on error (check errno for specific error).
+ */
+ws2812_anim_writer *ws2812_anim_writer_create(const char *path, uint16_t length,
+					      uint16_t keyframe_interval,
+					      bool loop)
+{
+	if (length == 0) {
+		errno = EINVAL;
+		return NULL;
+	}
+	ws2812_anim_writer *writer = calloc(1, sizeof(ws2812_anim_writer));
+	if (!writer) {
+		return NULL;
+	}
+	writer->length = length;
+	writer->keyframe_interval = keyframe_interval;
+	writer->flags = loop ? ANIM_FLAG_LOOP : 0;
+	writer->offset = sizeof(anim_header);
+	writer->previous = calloc(length, sizeof(led_pixel));
+	// Delta im schlechtesten Fall: ein Record pro zweitem Pixel
+	writer->scratch = malloc((size_t)length * 4 * sizeof(led_pixel));
+	if (!writer->previous || !writer->scratch) {
+		goto err;
+	}
+	writer->file = fopen(path, "wbe");
+	if (!writer->file) {
+		goto err;
+	}
+	// Der Kopf wird von ws2812_anim_writer_finish() geschrieben
+	anim_header header = { 0 };
+	if (fwrite(&header, sizeof(header), 1, writer->file) != 1) {
+		fclose(writer->file);
+		goto err;
+	}
+	return writer;
+
+err:
+	free(writer->previous);
+	free(writer->scratch);
+	free(writer);
+	return NULL;
+}
+
+/**
+ * @brief RLE-encodes a frame.
+ *
+ * @return Encoded size.
+ */
+static size_t ws2812_anim_encode_rle(uint8_t *out, const led_pixel *pixels,
+				     size_t length)
+{
+	size_t size = 0;
+
+	for (size_t i = 0; i < length;) {
+		size_t run = 1;
+		while (run < 255 && i + run < length &&
+		       memcmp(&pixels[i + run], &pixels[i], sizeof(led_pixel)) ==
+			       0) {
+			run++;
+		}
+		out[size++] = run;
+		memcpy(out + size, &pixels[i], sizeof(led_pixel));
+		size += sizeof(led_pixel);
+		i += run;
+	}
+	return size;
+}
+
+/**
+ * @brief Delta-encodes a frame against the previous one.
+ *
+ * Runs separated by a single unchanged pixel are merged, a new record costs more
+ * than the pixel.
+ *
+ * @return Encoded size.
+ */
+static size_t ws2812_anim_encode_delta(uint8_t *out, const led_pixel *pixels,
+				       const led_pixel *previous, size_t length)
+{
+	size_t size = 0;
+	size_t pos = 0;
+
+	for (size_t i = 0; i < length;) {
+		if (memcmp(&pixels[i], &previous[i], sizeof(led_pixel)) == 0) {
+			i++;
+			continue;
+		}
+		size_t end = i + 1;
+		while (end < length &&
+		       (memcmp(&pixels[end], &previous[end], sizeof(led_pixel)) ||
+			(end + 1 < length &&
+			 memcmp(&pixels[end + 1], &previous[end + 1],
+				sizeof(led_pixel))))) {
+			end++;
+		}
+		size_t skip = i - pos;
+		size_t count = end - i;
+		out[size++] = skip & 0xff;
+		out[size++] = skip >> 8;
+		out[size++] = count & 0xff;
+		out[size++] = count >> 8;
+		memcpy(out + size, &pixels[i], count * sizeof(led_pixel));
+		size += count * sizeof(led_pixel);
+		pos = i = end;
+	}
+	return size;
+}
+
+/**
+ * @brief Appends a frame.
+ *
+ * The frame is stored as a delta to the previous frame if that is smaller and the
+ * key frame interval allows it, otherwise as a key frame, RLE-compressed if that
+ * is smaller than the raw pixels.
+ *
+ * @param writer The writer.
+ * @param pixels length pixels.
+ * @param duration_us Display time of the frame.
+ * @return 0 on success, -1 on error (check errno for specific error).
+ */
+int ws2812_anim_writer_add(ws2812_anim_writer *writer, const led_pixel *pixels,
+			   uint32_t duration_us)
+{
+	size_t raw_size = (size_t)writer->length * sizeof(led_pixel);
+	const uint8_t *data = (const uint8_t *)pixels;
+	size_t size = raw_size;
+	uint8_t encoding = ANIM_ENCODING_RAW;
+	uint32_t frame = writer->frame_count;
+
+	if (writer->failed) {
+		errno = EIO;
+		return -1;
+	}
+	if (frame == UINT32_MAX) {
+		errno = EFBIG;
+		return -1;
+	}
+	if (frame == writer->index_capacity) {
+		uint32_t capacity = writer->index_capacity ?
+					    writer->index_capacity * 2 :
+					    256;
+		anim_index_entry *index = realloc(
+			writer->index, (size_t)capacity * sizeof(anim_index_entry));
+		if (!index) {
+			return -1;
+		}
+		writer->index = index;
+		writer->index_capacity = capacity;
+	}
+
+	if (frame > 0 && frame - writer->keyframe <= writer->keyframe_interval) {
+		size_t delta = ws2812_anim_encode_delta(
+			writer->scratch, pixels, writer->previous, writer->length);
+		if (delta < raw_size) {
+			data = writer->scratch;
+			size = delta;
+			encoding = ANIM_ENCODING_DELTA;
+		}
+	}
+	if (encoding == ANIM_ENCODING_RAW) {
+		size_t rle = ws2812_anim_encode_rle(writer->scratch, pixels,
+						    writer->length);
+		if (rle < raw_size) {
+			data = writer->scratch;
+			size = rle;
+			encoding = ANIM_ENCODING_RLE;
+		}
+		writer->keyframe = frame;
+	}
+
+	if (size && fwrite(data, size, 1, writer->file) != 1) {
+		writer->failed = true;
+		return -1;
+	}
+	writer->index[frame] = (anim_index_entry){
+		.offset = htole64(writer->offset),
+		.size = htole32(size),
+		.duration_us = htole32(duration_us),
+		.keyframe = htole32(writer->keyframe),
+		.encoding = encoding,
+	};
+	writer->offset += size;
+	writer->duration_us += duration_us;
+	writer->frame_count++;
+	memcpy(writer->previous, pixels, raw_size);
+	return 0;
+}
+
+/**
+ * @brief Writes the index and the header, closes the file and frees the writer.
+ *
+ * @param writer The writer.
+ * @return 0 on success, -1 on error (check errno for specific error).
+ */
+int ws2812_anim_writer_finish(ws2812_anim_writer *writer)
+{
+	anim_header header = {
+		.magic = htole32(ANIM_MAGIC),
+		.version = htole16(ANIM_VERSION),
+		.flags = htole16(writer->flags),
+		.length = htole16(writer->length),
+		.keyframe_interval = htole16(writer->keyframe_interval),
+		.frame_count = htole32(writer->frame_count),
+		.index_offset = htole64(writer->offset),
+		.duration_us = htole64(writer->duration_us),
+	};
+	bool ok = !writer->failed &&
+		  (writer->frame_count == 0 ||
+		   fwrite(writer->index, sizeof(anim_index_entry),
+			  writer->frame_count,
+			  writer->file) == writer->frame_count) &&
+		  fseek(writer->file, 0, SEEK_SET) == 0 &&
+		  fwrite(&header, sizeof(header), 1, writer->file) == 1;
+	int err = errno;
+	if (fclose(writer->file) != 0 && ok) {
+		ok = false;
+		err = errno;
+	}
+	free(writer->index);
+	free(writer->previous);
+	free(writer->scratch);
+	free(writer);
+	if (!ok) {
+		errno = err ? err : EIO;
+		return -1;
+	}
+	return 0;
+}
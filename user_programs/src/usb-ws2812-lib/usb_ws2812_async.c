@@ -0,0 +1,626 @@
+/**
+ * @file usb_ws2812_async.c                                                    *
+ * @brief Non-blocking library API with completions for event loops           *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#include "usb_ws2812_lib.h"
+#include "usb_ws2812_private.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+/**
+ * @brief Operations that can be executed asynchronously.
+ */
+typedef enum ws2812_async_op_e {
+	ASYNC_SET_LENGTH,
+	ASYNC_CLEAR,
+	ASYNC_SET_MODE_STATIC,
+	ASYNC_SET_MODE_BLINK,
+	ASYNC_SET_LED_PIXEL,
+	ASYNC_SUBMIT_BATCH,
+	ASYNC_GET_LENGTH,
+	ASYNC_GET_MODE,
+} ws2812_async_op;
+
+/**
+ * @brief A queued, running or completed operation.
+ */
+typedef struct ws2812_async_job_s {
+	struct ws2812_async_job_s *next; /**< Next job in the list the job is in. */
+	ws2812_async_op op; /**< The operation. */
+	ws2812_handle *handle; /**< The device. */
+	ws2812_async_cb cb; /**< Completion callback, may be NULL. */
+	void *user_data; /**< Passed to cb. */
+	int result; /**< Return value of the operation. */
+	int error; /**< errno of the operation if result < 0. */
+	union {
+		uint16_t length;
+		struct {
+			uint16_t pattern_count;
+			uint16_t pattern_len;
+			uint16_t delay;
+		} blink;
+		struct {
+			uint16_t start_index;
+			uint16_t length;
+			const led_pixel *pixel_data;
+		} pixel;
+		ws2812_batch *batch;
+		led_set_mode *mode;
+	} args; /**< Arguments of the operation. */
+} ws2812_async_job;
+
+/**
+ * @brief Singly linked FIFO of jobs.
+ */
+typedef struct ws2812_async_list_s {
+	ws2812_async_job *head;
+	ws2812_async_job *tail;
+} ws2812_async_list;
+
+/**
+ * @brief Asynchronous execution context.
+ */
+struct ws2812_async_s {
+	pthread_mutex_t lock; /**< Protects all lists and running. */
+	pthread_cond_t work; /**< Signalled when a job is queued or on shutdown. */
+	bool shutdown; /**< Workers exit if set. */
+	int event_fd; /**< Readable while completions are pending. */
+	ws2812_async_job jobs[WS2812_ASYNC_QUEUE_DEPTH]; /**< Job pool. */
+	ws2812_async_list free_jobs; /**< Unused jobs. */
+	ws2812_async_list queued; /**< Jobs waiting for a worker. */
+	ws2812_async_list completed; /**< Jobs waiting for ws2812_async_process_events(). */
+	unsigned int worker_count; /**< Number of worker threads. */
+	pthread_t *workers; /**< The worker threads. */
+	ws2812_handle **running; /**< Handle of the job of each worker, NULL if idle. */
+};
+
+static void ws2812_async_list_push(ws2812_async_list *list,
+				   ws2812_async_job *job)
+{
+	job->next = NULL;
+	if (list->tail) {
+		list->tail->next = job;
+	} else {
+		list->head = job;
+	}
+	list->tail = job;
+}
+
+static ws2812_async_job *ws2812_async_list_pop(ws2812_async_list *list)
+{
+	ws2812_async_job *job = list->head;
+	if (job) {
+		list->head = job->next;
+		if (!list->head) {
+			list->tail = NULL;
+		}
+	}
+	return job;
+}
+
+/**
+ * @brief Returns true if a worker is executing a job of the handle, lock must be held.
+ */
+static bool ws2812_async_handle_running(ws2812_async *ctx,
+					ws2812_handle *handle)
+{
+	for (unsigned int i = 0; i < ctx->worker_count; i++) {
+		if (ctx->running[i] == handle) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief Removes the first queued job whose handle isn't in use by another worker.
+ *
+ * Jobs of the same handle are executed one after the other in the order they were
+ * queued, jobs of different handles in parallel. The lock must be held.
+ *
+ * @return The job, or NULL if no job can be executed now.
+ */
+static ws2812_async_job *ws2812_async_take_job(ws2812_async *ctx)
+{
+	ws2812_async_job *prev = NULL;
+	for (ws2812_async_job *job = ctx->queued.head; job;
+	     prev = job, job = job->next) {
+		if (ws2812_async_handle_running(ctx, job->handle)) {
+			continue;
+		}
+		if (prev) {
+			prev->next = job->next;
+		} else {
+			ctx->queued.head = job->next;
+		}
+		if (ctx->queued.tail == job) {
+			ctx->queued.tail = prev;
+		}
+		return job;
+	}
+	return NULL;
+}
+
+/**
+ * @brief Executes a job with the blocking library functions.
+ */
+static void ws2812_async_execute(ws2812_async_job *job)
+{
+	ws2812_handle *handle = job->handle;
+
+	errno = 0;
+	switch (job->op) {
+	case ASYNC_SET_LENGTH:
+		job->result = ws2812_set_length(handle, job->args.length);
+		break;
+	case ASYNC_CLEAR:
+		job->result = ws2812_clear(handle);
+		break;
+	case ASYNC_SET_MODE_STATIC:
+		job->result = ws2812_set_mode_static(handle);
+		break;
+	case ASYNC_SET_MODE_BLINK:
+		job->result = ws2812_set_mode_blink(
+			handle, job->args.blink.pattern_count,
+			job->args.blink.pattern_len, job->args.blink.delay);
+		break;
+	case ASYNC_SET_LED_PIXEL:
+		job->result = ws2812_set_led_pixel(handle,
+						   job->args.pixel.start_index,
+						   job->args.pixel.length,
+						   job->args.pixel.pixel_data);
+		break;
+	case ASYNC_SUBMIT_BATCH:
+		job->result = ws2812_batch_submit(job->args.batch);
+		break;
+	case ASYNC_GET_LENGTH:
+		job->result = ws2812_get_length(handle);
+		break;
+	case ASYNC_GET_MODE:
+		job->result = ws2812_get_mode(handle, job->args.mode);
+		break;
+	}
+	job->error = job->result < 0 ? errno : 0;
+}
+
+/**
+ * @brief Worker thread, executes queued jobs until shutdown.
+ */
+static void *ws2812_async_worker(void *arg)
+{
+	ws2812_async *ctx = arg;
+	// Slot des Workers in running bestimmen
+	pthread_mutex_lock(&ctx->lock);
+	unsigned int slot = 0;
+	while (!pthread_equal(ctx->workers[slot], pthread_self())) {
+		slot++;
+	}
+
+	for (;;) {
+		ws2812_async_job *job = NULL;
+		while (!ctx->shutdown && !(job = ws2812_async_take_job(ctx))) {
+			pthread_cond_wait(&ctx->work, &ctx->lock);
+		}
+		if (!job) {
+			// Beenden, die wartenden Jobs bricht ws2812_async_destroy() ab
+			break;
+		}
+		ctx->running[slot] = job->handle;
+		pthread_mutex_unlock(&ctx->lock);
+
+		ws2812_async_execute(job);
+
+		pthread_mutex_lock(&ctx->lock);
+		ctx->running[slot] = NULL;
+		ws2812_async_list_push(&ctx->completed, job);
+		// Jobs dieses Handles koennen jetzt von anderen Workern ausgefuehrt werden
+		pthread_cond_broadcast(&ctx->work);
+		uint64_t one = 1;
+		if (write(ctx->event_fd, &one, sizeof(one)) < 0) {
+			// Zaehler voll, das fd ist trotzdem lesbar
+		}
+	}
+	pthread_mutex_unlock(&ctx->lock);
+	return NULL;
+}
+
+/**
+ * @brief Creates a context for asynchronous requests.
+ *
+ * The context owns a fixed number of worker threads, which execute the requests of
+ * all handles submitted to it. Requests of the same handle are executed in the order
+ * they were submitted, requests of different handles in parallel. A single event loop
+ * thread can drive many strips with a few workers:
+ *
+ * 1. Add ws2812_async_fd() to the loop (epoll, poll, libuv, ...) for readability.
+ * 2. Start requests with the ws2812_async_* functions, they return immediately.
+ * 3. When the fd is readable, call ws2812_async_process_events(), which calls the
+ *    completion callbacks of all finished requests in the calling thread.
+ *
+ * @param workers Number of worker threads, at most this many handles are served in
+ *                parallel. 0 for WS2812_ASYNC_DEFAULT_WORKERS.
+ * @return The context, or NULL on error (check errno for specific error).
+ */
+ws2812_async *ws2812_async_create(unsigned int workers)
+{
+	if (workers == 0) {
+		workers = WS2812_ASYNC_DEFAULT_WORKERS;
+	}
+
+	ws2812_async *ctx = calloc(1, sizeof(ws2812_async));
+	if (!ctx) {
+		return NULL;
+	}
+	ctx->workers = calloc(workers, sizeof(pthread_t));
+	ctx->running = calloc(workers, sizeof(ws2812_handle *));
+	if (!ctx->workers || !ctx->running) {
+		goto err_free;
+	}
+	ctx->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (ctx->event_fd < 0) {
+		goto err_free;
+	}
+	for (int i = 0; i < WS2812_ASYNC_QUEUE_DEPTH; i++) {
+		ws2812_async_list_push(&ctx->free_jobs, &ctx->jobs[i]);
+	}
+	pthread_mutex_init(&ctx->lock, NULL);
+	pthread_cond_init(&ctx->work, NULL);
+
+	// Die Worker warten auf den Lock, bis alle Thread-IDs eingetragen sind
+	pthread_mutex_lock(&ctx->lock);
+	for (unsigned int i = 0; i < workers; i++) {
+		int err = pthread_create(&ctx->workers[i], NULL,
+					 ws2812_async_worker, ctx);
+		if (err) {
+			ctx->shutdown = true;
+			pthread_mutex_unlock(&ctx->lock);
+			for (unsigned int j = 0; j < i; j++) {
+				pthread_join(ctx->workers[j], NULL);
+			}
+			pthread_cond_destroy(&ctx->work);
+			pthread_mutex_destroy(&ctx->lock);
+			close(ctx->event_fd);
+			errno = err;
+			goto err_free;
+		}
+		ctx->worker_count++;
+	}
+	pthread_mutex_unlock(&ctx->lock);
+	return ctx;
+
+err_free:
+	free(ctx->running);
+	free(ctx->workers);
+	free(ctx);
+	return NULL;
+}
+
+/**
+ * @brief Destroys a context.
+ *
+ * Requests that are executed at the moment are finished. Every request still gets
+ * its callback, in the calling thread: finished requests that were not processed
+ * with their result, queued requests with -1 and errno ECANCELED. The callbacks can
+ * free their user_data, new requests fail with ECANCELED.
+ *
+ * @param ctx The context, may be NULL.
+ */
+void ws2812_async_destroy(ws2812_async *ctx)
+{
+	if (!ctx) {
+		return;
+	}
+	pthread_mutex_lock(&ctx->lock);
+	ctx->shutdown = true;
+	pthread_cond_broadcast(&ctx->work);
+	pthread_mutex_unlock(&ctx->lock);
+
+	for (unsigned int i = 0; i < ctx->worker_count; i++) {
+		pthread_join(ctx->workers[i], NULL);
+	}
+
+	ws2812_async_process_events(ctx);
+	ws2812_async_job *job;
+	while ((job = ws2812_async_list_pop(&ctx->queued))) {
+		if (job->cb) {
+			errno = ECANCELED;
+			job->cb(job->handle, -1, job->user_data);
+		}
+	}
+	pthread_cond_destroy(&ctx->work);
+	pthread_mutex_destroy(&ctx->lock);
+	close(ctx->event_fd);
+	free(ctx->running);
+	free(ctx->workers);
+	free(ctx);
+}
+
+/**
+ * @brief Returns the file descriptor to wait on.
+ *
+ * The fd is readable while finished requests wait for ws2812_async_process_events().
+ * It must only be polled, not read or closed by the caller.
+ *
+ * @param ctx The context.
+ * @return The file descriptor (an eventfd).
+ */
+int ws2812_async_fd(ws2812_async *ctx)
+{
+	return ctx->event_fd;
+}
+
+/**
+ * @brief Calls the callbacks of all finished requests.
+ *
+ * The callbacks are called in the calling thread without any lock held, they may
+ * start new requests.
+ *
+ * @param ctx The context.
+ * @return Number of callbacks processed.
+ */
+int ws2812_async_process_events(ws2812_async *ctx)
+{
+	uint64_t count;
+	if (read(ctx->event_fd, &count, sizeof(count)) < 0) {
+		// EAGAIN: nichts fertig, die Liste wird trotzdem geprueft
+	}
+
+	pthread_mutex_lock(&ctx->lock);
+	ws2812_async_job *done = ctx->completed.head;
+	ctx->completed.head = NULL;
+	ctx->completed.tail = NULL;
+	pthread_mutex_unlock(&ctx->lock);
+
+	int processed = 0;
+	while (done) {
+		ws2812_async_job *job = done;
+		done = job->next;
+		if (job->cb) {
+			errno = job->error;
+			job->cb(job->handle, job->result, job->user_data);
+		}
+		pthread_mutex_lock(&ctx->lock);
+		ws2812_async_list_push(&ctx->free_jobs, job);
+		pthread_mutex_unlock(&ctx->lock);
+		processed++;
+	}
+	return processed;
+}
+
+/**
+ * @brief Takes a job from the pool, lock must not be held.
+ *
+ * @return The job, or NULL with errno set to EAGAIN if WS2812_ASYNC_QUEUE_DEPTH
+ *         requests are pending, ECANCELED if the context is destroyed.
+ */
+static ws2812_async_job *ws2812_async_job_get(ws2812_async *ctx,
+					      ws2812_async_op op,
+					      ws2812_handle *handle,
+					      ws2812_async_cb cb,
+					      void *user_data)
+{
+	pthread_mutex_lock(&ctx->lock);
+	if (ctx->shutdown) {
+		pthread_mutex_unlock(&ctx->lock);
+		errno = ECANCELED;
+		return NULL;
+	}
+	ws2812_async_job *job = ws2812_async_list_pop(&ctx->free_jobs);
+	pthread_mutex_unlock(&ctx->lock);
+	if (!job) {
+		errno = EAGAIN;
+		return NULL;
+	}
+	job->op = op;
+	job->handle = handle;
+	job->cb = cb;
+	job->user_data = user_data;
+	job->result = 0;
+	job->error = 0;
+	return job;
+}
+
+/**
+ * @brief Queues a job and wakes a worker.
+ */
+static int ws2812_async_job_queue(ws2812_async *ctx, ws2812_async_job *job)
+{
+	pthread_mutex_lock(&ctx->lock);
+	ws2812_async_list_push(&ctx->queued, job);
+	pthread_cond_signal(&ctx->work);
+	pthread_mutex_unlock(&ctx->lock);
+	return 0;
+}
+
+/**
+ * @brief Starts ws2812_set_length() asynchronously.
+ *
+ * @param ctx The context.
+ * @param handle The WS2812 device.
+ * @param length Length (in LED's) of the LED strip.
+ * @param cb Called with the return value of ws2812_set_length(), may be NULL.
+ * @param user_data Passed to cb.
+ * @return 0 if the request was queued, -1 on error (check errno for specific error).
+ */
+int ws2812_async_set_length(ws2812_async *ctx, ws2812_handle *handle,
+			    uint16_t length, ws2812_async_cb cb,
+			    void *user_data)
+{
+	ws2812_async_job *job = ws2812_async_job_get(ctx, ASYNC_SET_LENGTH,
+						     handle, cb, user_data);
+	if (!job) {
+		return -1;
+	}
+	job->args.length = length;
+	return ws2812_async_job_queue(ctx, job);
+}
+
+/**
+ * @brief Starts ws2812_clear() asynchronously.
+ *
+ * @param ctx The context.
+ * @param handle The WS2812 device.
+ * @param cb Called with the return value of ws2812_clear(), may be NULL.
+ * @param user_data Passed to cb.
+ * @return 0 if the request was queued, -1 on error (check errno for specific error).
+ */
+int ws2812_async_clear(ws2812_async *ctx, ws2812_handle *handle,
+		       ws2812_async_cb cb, void *user_data)
+{
+	ws2812_async_job *job =
+		ws2812_async_job_get(ctx, ASYNC_CLEAR, handle, cb, user_data);
+	if (!job) {
+		return -1;
+	}
+	return ws2812_async_job_queue(ctx, job);
+}
+
+/**
+ * @brief Starts ws2812_set_mode_static() asynchronously.
+ *
+ * @param ctx The context.
+ * @param handle The WS2812 device.
+ * @param cb Called with the return value of ws2812_set_mode_static(), may be NULL.
+ * @param user_data Passed to cb.
+ * @return 0 if the request was queued, -1 on error (check errno for specific error).
+ */
+int ws2812_async_set_mode_static(ws2812_async *ctx, ws2812_handle *handle,
+				 ws2812_async_cb cb, void *user_data)
+{
+	ws2812_async_job *job = ws2812_async_job_get(
+		ctx, ASYNC_SET_MODE_STATIC, handle, cb, user_data);
+	if (!job) {
+		return -1;
+	}
+	return ws2812_async_job_queue(ctx, job);
+}
+
+/**
+ * @brief Starts ws2812_set_mode_blink() asynchronously.
+ *
+ * @param ctx The context.
+ * @param handle The WS2812 device.
+ * @param pattern_count Number of blinking patterns.
+ * @param pattern_len Length of each blinking pattern.
+ * @param delay Delay between each blink in milliseconds.
+ * @param cb Called with the return value of ws2812_set_mode_blink(), may be NULL.
+ * @param user_data Passed to cb.
+ * @return 0 if the request was queued, -1 on error (check errno for specific error).
+ */
+int ws2812_async_set_mode_blink(ws2812_async *ctx, ws2812_handle *handle,
+				uint16_t pattern_count, uint16_t pattern_len,
+				uint16_t delay, ws2812_async_cb cb,
+				void *user_data)
+{
+	ws2812_async_job *job = ws2812_async_job_get(
+		ctx, ASYNC_SET_MODE_BLINK, handle, cb, user_data);
+	if (!job) {
+		return -1;
+	}
+	job->args.blink.pattern_count = pattern_count;
+	job->args.blink.pattern_len = pattern_len;
+	job->args.blink.delay = delay;
+	return ws2812_async_job_queue(ctx, job);
+}
+
+/**
+ * @brief Starts ws2812_set_led_pixel() asynchronously.
+ *
+ * @param ctx The context.
+ * @param handle The WS2812 device.
+ * @param start_index Starting index to set LED pixels.
+ * @param length Number of LED pixels to set.
+ * @param pixel_data Pixels to set, must stay valid and unchanged until cb is called.
+ * @param cb Called with the return value of ws2812_set_led_pixel(), may be NULL.
+ * @param user_data Passed to cb.
+ * @return 0 if the request was queued, -1 on error (check errno for specific error).
+ */
+int ws2812_async_set_led_pixel(ws2812_async *ctx, ws2812_handle *handle,
+			       uint16_t start_index, uint16_t length,
+			       const led_pixel *pixel_data, ws2812_async_cb cb,
+			       void *user_data)
+{
+	ws2812_async_job *job = ws2812_async_job_get(ctx, ASYNC_SET_LED_PIXEL,
+						     handle, cb, user_data);
+	if (!job) {
+		return -1;
+	}
+	job->args.pixel.start_index = start_index;
+	job->args.pixel.length = length;
+	job->args.pixel.pixel_data = pixel_data;
+	return ws2812_async_job_queue(ctx, job);
+}
+
+/**
+ * @brief Starts ws2812_batch_submit() asynchronously.
+ *
+ * @param ctx The context.
+ * @param batch The batch, must not be used until cb is called. It is empty afterwards.
+ * @param cb Called with the return value of ws2812_batch_submit(), may be NULL.
+ * @param user_data Passed to cb.
+ * @return 0 if the request was queued, -1 on error (check errno for specific error).
+ */
+int ws2812_async_submit_batch(ws2812_async *ctx, ws2812_batch *batch,
+			      ws2812_async_cb cb, void *user_data)
+{
+	ws2812_async_job *job =
+		ws2812_async_job_get(ctx, ASYNC_SUBMIT_BATCH,
+				     ws2812_batch_handle(batch), cb, user_data);
+	if (!job) {
+		return -1;
+	}
+	job->args.batch = batch;
+	return ws2812_async_job_queue(ctx, job);
+}
+
+/**
+ * @brief Starts ws2812_get_length() asynchronously.
+ *
+ * @param ctx The context.
+ * @param handle The WS2812 device.
+ * @param cb Called with the length of the LED strip as result, or -1 on error.
+ * @param user_data Passed to cb.
+ * @return 0 if the request was queued, -1 on error (check errno for specific error).
+ */
+int ws2812_async_get_length(ws2812_async *ctx, ws2812_handle *handle,
+			    ws2812_async_cb cb, void *user_data)
+{
+	ws2812_async_job *job = ws2812_async_job_get(ctx, ASYNC_GET_LENGTH,
+						     handle, cb, user_data);
+	if (!job) {
+		return -1;
+	}
+	return ws2812_async_job_queue(ctx, job);
+}
+
+/**
+ * @brief Starts ws2812_get_mode() asynchronously.
+ *
+ * @param ctx The context.
+ * @param handle The WS2812 device.
+ * @param result Receives the mode packet, must stay valid until cb is called.
+ * @param cb Called with the mode id as result, or -1 on error.
+ * @param user_data Passed to cb.
+ * @return 0 if the request was queued, -1 on error (check errno for specific error).
+ */
+int ws2812_async_get_mode(ws2812_async *ctx, ws2812_handle *handle,
+			  led_set_mode *result, ws2812_async_cb cb,
+			  void *user_data)
+{
+	ws2812_async_job *job = ws2812_async_job_get(ctx, ASYNC_GET_MODE,
+						     handle, cb, user_data);
+	if (!job) {
+		return -1;
+	}
+	job->args.mode = result;
+	return ws2812_async_job_queue(ctx, job);
+}
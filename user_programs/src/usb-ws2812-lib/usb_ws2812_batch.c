@@ -0,0 +1,284 @@
+/**
+ * @file usb_ws2812_batch.c                                                    *
+ * @brief Batch builder: many packets in a single write() to the kernel module *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#include "usb_ws2812_lib.h"
+#include "usb_ws2812_private.h"
+#include "dev_packets.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Packet buffer of a batch.
+ */
+struct ws2812_batch_s {
+	ws2812_handle *handle; /**< The device the batch is submitted to. */
+	uint8_t *buf; /**< Concatenated packets. */
+	size_t len; /**< Number of bytes used in buf. */
+	size_t size; /**< Size of buf in bytes. */
+	bool control; /**< buf contains packets that may change length or mode. */
+};
+
+/**
+ * @brief Creates an empty batch for a device.
+ *
+ * A batch collects length, mode, pixel and clear packets in one buffer and sends
+ * them to the kernel module with a single write(). The kernel module transfers the
+ * pixel buffer once for all consecutive pixel packets, so updating several regions
+ * of a strip costs one syscall and one USB transfer of the strip per frame.
+ *
+ * The buffer is sized for one packet with max_leds pixels of the handle and grows
+ * if needed. It is kept after ws2812_batch_submit(), so a batch that is reused
+ * every frame doesn't allocate memory in the steady state.
+ *
+ * @param handle The WS2812 device.
+ * @return The batch, or NULL on error (check errno for specific error).
+ *
+ * @note A batch must only be used by one thread at a time, the handle may be shared.
+ */
+ws2812_batch *ws2812_batch_create(ws2812_handle *handle)
+{
+	ws2812_batch *batch = calloc(1, sizeof(ws2812_batch));
+	if (!batch) {
+		return NULL;
+	}
+	batch->handle = handle;
+	// Die Arena kann gleichzeitig in einem anderen Thread wachsen
+	pthread_mutex_lock(&handle->lock);
+	batch->size = handle->arena_size;
+	pthread_mutex_unlock(&handle->lock);
+	batch->buf = malloc(batch->size);
+	if (!batch->buf) {
+		free(batch);
+		return NULL;
+	}
+	return batch;
+}
+
+/**
+ * @brief Frees a batch, packets that were not submitted are discarded.
+ *
+ * @param batch The batch, may be NULL.
+ */
+void ws2812_batch_free(ws2812_batch *batch)
+{
+	if (!batch) {
+		return;
+	}
+	free(batch->buf);
+	free(batch);
+}
+
+/**
+ * @brief Discards all packets of the batch without sending them.
+ *
+ * @param batch The batch.
+ */
+void ws2812_batch_reset(ws2812_batch *batch)
+{
+	batch->len = 0;
+	batch->control = false;
+}
+
+/**
+ * @brief Returns the device a batch is submitted to.
+ *
+ * @param batch The batch.
+ * @return The handle passed to ws2812_batch_create().
+ */
+ws2812_handle *ws2812_batch_handle(const ws2812_batch *batch)
+{
+	return batch->handle;
+}
+
+/**
+ * @brief Returns the number of bytes the next ws2812_batch_submit() writes.
+ *
+ * @param batch The batch.
+ * @return Length of all packets in bytes.
+ */
+size_t ws2812_batch_length(const ws2812_batch *batch)
+{
+	return batch->len;
+}
+
+/**
+ * @brief Reserves space for a packet at the end of the batch.
+ *
+ * @param batch The batch.
+ * @param len Length of the packet.
+ * @return Pointer to the packet, or NULL if the buffer could not grow.
+ */
+static uint8_t *ws2812_batch_reserve(ws2812_batch *batch, size_t len)
+{
+	if (batch->size - batch->len < len) {
+		size_t new_size = batch->size * 2;
+		if (new_size < batch->len + len) {
+			new_size = batch->len + len;
+		}
+		uint8_t *new_buf = realloc(batch->buf, new_size);
+		if (!new_buf) {
+			return NULL;
+		}
+		batch->buf = new_buf;
+		batch->size = new_size;
+	}
+	uint8_t *packet = batch->buf + batch->len;
+	batch->len += len;
+	return packet;
+}
+
+/**
+ * @brief Appends a control packet to the batch.
+ *
+ * @param batch The batch.
+ * @param packet The packet.
+ * @param len Length of the packet.
+ * @return 0 on success, -1 on error (check errno for specific error).
+ */
+static int ws2812_batch_append(ws2812_batch *batch, const void *packet,
+			       size_t len)
+{
+	uint8_t *dest = ws2812_batch_reserve(batch, len);
+	if (!dest) {
+		return -1;
+	}
+	memcpy(dest, packet, len);
+	batch->control = true;
+	return 0;
+}
+
+/**
+ * @brief Appends a length packet, see ws2812_set_length().
+ *
+ * @param batch The batch.
+ * @param length Length (in LED's) of the LED strip.
+ * @return 0 on success, -1 on error (check errno for specific error).
+ */
+int ws2812_batch_set_length(ws2812_batch *batch, uint16_t length)
+{
+	led_len len_p = {
+		.ctrl = CHAR_LED_LEN,
+		.len = length,
+	};
+
+	return ws2812_batch_append(batch, &len_p, sizeof(led_len));
+}
+
+/**
+ * @brief Appends a clear packet, see ws2812_clear().
+ *
+ * @param batch The batch.
+ * @return 0 on success, -1 on error (check errno for specific error).
+ */
+int ws2812_batch_clear(ws2812_batch *batch)
+{
+	led_clear clear_p = { .ctrl = CHAR_LED_CLEAR };
+
+	return ws2812_batch_append(batch, &clear_p, sizeof(led_clear));
+}
+
+/**
+ * @brief Appends a packet that sets the static mode, see ws2812_set_mode_static().
+ *
+ * @param batch The batch.
+ * @return 0 on success, -1 on error (check errno for specific error).
+ */
+int ws2812_batch_set_mode_static(ws2812_batch *batch)
+{
+	led_set_mode_static set_mode_static_p = {
+		.ctrl = CHAR_LED_SET_MODE,
+		.mode = CHAR_LED_MODE_STATIC,
+	};
+
+	return ws2812_batch_append(batch, &set_mode_static_p,
+				   sizeof(led_set_mode_static));
+}
+
+/**
+ * @brief Appends a packet that sets the blink mode, see ws2812_set_mode_blink().
+ *
+ * @param batch The batch.
+ * @param pattern_count Number of blinking patterns.
+ * @param pattern_len Length of each blinking pattern.
+ * @param delay Delay between each blink in milliseconds.
+ * @return 0 on success, -1 on error (check errno for specific error).
+ */
+int ws2812_batch_set_mode_blink(ws2812_batch *batch, uint16_t pattern_count,
+				uint16_t pattern_len, uint16_t delay)
+{
+	led_set_mode_blink set_mode_blink_p = {
+		.ctrl = CHAR_LED_SET_MODE,
+		.mode = CHAR_LED_MODE_BLINK,
+		.pattern_count = pattern_count,
+		.pattern_len = pattern_len,
+		.blink_period = delay,
+	};
+
+	return ws2812_batch_append(batch, &set_mode_blink_p,
+				   sizeof(led_set_mode_blink));
+}
+
+/**
+ * @brief Appends a pixel data packet for a range of LEDs, see ws2812_set_led_pixel().
+ *
+ * The pixels are copied into the batch, pixel_data may be reused directly after
+ * the call.
+ *
+ * @param batch The batch.
+ * @param start_index Index of the first LED of the range.
+ * @param length Number of LED pixels in the range.
+ * @param pixel_data Pointer to an array of length LED pixels.
+ * @return 0 on success, -1 on error (check errno for specific error).
+ */
+int ws2812_batch_set_led_pixel(ws2812_batch *batch, uint16_t start_index,
+			       uint16_t length, const led_pixel *pixel_data)
+{
+	size_t pixel_len = length * sizeof(led_pixel);
+	uint8_t *packet =
+		ws2812_batch_reserve(batch, sizeof(led_pixel_data) + pixel_len);
+	if (!packet) {
+		return -1;
+	}
+
+	led_pixel_data pixel_header = {
+		.ctrl = CHAR_LED_PIXEL_DATA,
+		.offset = start_index,
+		.led_count = length,
+	};
+
+	memcpy(packet, &pixel_header, sizeof(led_pixel_data));
+	memcpy(packet + sizeof(led_pixel_data), pixel_data, pixel_len);
+	return 0;
+}
+
+/**
+ * @brief Sends all packets of the batch with a single write() and empties it.
+ *
+ * The packets are processed by the kernel module in the order they were appended.
+ * The batch is emptied in any case, also if the write() failed.
+ *
+ * @param batch The batch.
+ * @return Number of bytes written (0 for an empty batch), or -1 on error (check errno for specific error).
+ */
+int ws2812_batch_submit(ws2812_batch *batch)
+{
+	if (batch->len == 0) {
+		return 0;
+	}
+
+	ws2812_handle *handle = batch->handle;
+	pthread_mutex_lock(&handle->lock);
+	if (batch->control) {
+		ws2812_cache_invalidate(handle);
+	}
+	int ret = ws2812_io_write(handle, batch->buf, batch->len);
+	pthread_mutex_unlock(&handle->lock);
+
+	ws2812_batch_reset(batch);
+	return ret;
+}
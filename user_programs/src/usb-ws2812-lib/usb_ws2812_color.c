@@ -0,0 +1,620 @@
+/**
+ * @file usb_ws2812_color.c                                                    *
+ * @brief Fused color pipeline: gamma, brightness, white balance and channel   *
+ *        order in one pass, with SIMD kernels selected at runtime             *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#include "usb_ws2812_lib.h"
+#include "usb_ws2812_private.h"
+#include <errno.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define WS2812_COLOR_X86
+#endif
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+/**
+ * @def WS2812_COLOR_SEGMENTS
+ * @brief Number of linear segments of the gamma curve (one 16 byte table lookup).
+ */
+#define WS2812_COLOR_SEGMENTS 16
+
+/**
+ * @def WS2812_COLOR_FULL
+ * @brief Output value 255 in the 8.8 fixed point format of the gamma curve.
+ */
+#define WS2812_COLOR_FULL (255 << 8)
+
+/**
+ * @brief Color pipeline.
+ *
+ * The gamma curve is piecewise linear with 16 segments of 16 input values:
+ * y = base[x >> 4] + 4 * slope[x >> 4] * (x & 15) in 8.8 fixed point. The gain of a
+ * channel (brightness * white balance) is a 0.16 factor, the output is
+ * (((y * gain) >> 16) + 128) >> 8. Every kernel computes exactly this, the scalar
+ * kernel via tables built from the same formula, so all kernels give identical results.
+ */
+struct ws2812_color_pipeline_s {
+	ws2812_isa isa; /**< Kernel used by ws2812_color_apply(). */
+	bool reorder; /**< Channel order isn't RGB. */
+	uint8_t perm[3]; /**< Input channel of output channel 0, 1 and 2. */
+	uint16_t gain[3]; /**< Gain of the red, green and blue input channel. */
+	uint8_t lut[3][256]; /**< Output of an input channel value (scalar kernel). */
+	uint8_t base_lo[WS2812_COLOR_SEGMENTS]; /**< Low byte of the segment start. */
+	uint8_t base_hi[WS2812_COLOR_SEGMENTS]; /**< High byte of the segment start. */
+	uint8_t slope[WS2812_COLOR_SEGMENTS]; /**< Slope of the segment / 4. */
+	uint16_t lane_gain[3][16]; /**< Gain of the 16 bytes of vector k of a 48 byte block. */
+	uint8_t shuffle[3][3][16]; /**< pshufb masks: output vector k from input vector j. */
+};
+
+/**
+ * @brief Input channel of the output channels for each ws2812_channel_order.
+ */
+static const uint8_t ws2812_color_orders[][3] = {
+	[WS2812_ORDER_RGB] = { 0, 1, 2 }, [WS2812_ORDER_RBG] = { 0, 2, 1 },
+	[WS2812_ORDER_GRB] = { 1, 0, 2 }, [WS2812_ORDER_GBR] = { 1, 2, 0 },
+	[WS2812_ORDER_BRG] = { 2, 0, 1 }, [WS2812_ORDER_BGR] = { 2, 1, 0 },
+};
+
+/**
+ * @brief Returns the name of an instruction set.
+ *
+ * @param isa The instruction set.
+ * @return The name, "unknown" for invalid values.
+ */
+const char *ws2812_isa_name(ws2812_isa isa)
+{
+	switch (isa) {
+	case WS2812_ISA_AUTO:
+		return "auto";
+	case WS2812_ISA_SCALAR:
+		return "scalar";
+	case WS2812_ISA_SSSE3:
+		return "ssse3";
+	case WS2812_ISA_AVX2:
+		return "avx2";
+	case WS2812_ISA_NEON:
+		return "neon";
+	}
+	return "unknown";
+}
+
+/**
+ * @brief Highest instruction set of the library kernels, see ws2812_isa_limit().
+ */
+static ws2812_isa ws2812_isa_max = WS2812_ISA_AUTO;
+
+static bool ws2812_isa_cpu_supported(ws2812_isa isa)
+{
+	switch (isa) {
+	case WS2812_ISA_SCALAR:
+		return true;
+#ifdef WS2812_COLOR_X86
+	case WS2812_ISA_SSSE3:
+		return __builtin_cpu_supports("ssse3");
+	case WS2812_ISA_AVX2:
+		return __builtin_cpu_supports("avx2");
+#endif
+#if defined(__aarch64__)
+	case WS2812_ISA_NEON:
+		return true;
+#endif
+	default:
+		return false;
+	}
+}
+
+bool ws2812_isa_supported(ws2812_isa isa)
+{
+	ws2812_isa max = __atomic_load_n(&ws2812_isa_max, __ATOMIC_RELAXED);
+
+	if (max != WS2812_ISA_AUTO && isa > max) {
+		return false;
+	}
+	return ws2812_isa_cpu_supported(isa);
+}
+
+/**
+ * @brief Limits the kernels of the whole library to an instruction set.
+ *
+ * Meant for tests and benchmarks that compare the SIMD kernels of the bulk
+ * functions (ws2812_hsv_to_rgb(), ws2812_palette_map(), the planar functions,
+ * new color pipelines) with their scalar reference. Kernels of a higher
+ * instruction set are treated as unsupported, lower ones stay in use: with
+ * WS2812_ISA_SSSE3, AVX2 kernels fall back to SSSE3 or scalar code.
+ *
+ * @param isa The highest instruction set, WS2812_ISA_AUTO removes the limit.
+ * @return 0 on success, or -1 if the CPU doesn't support it (errno ENOTSUP).
+ */
+int ws2812_isa_limit(ws2812_isa isa)
+{
+	if (isa != WS2812_ISA_AUTO && !ws2812_isa_cpu_supported(isa)) {
+		errno = ENOTSUP;
+		return -1;
+	}
+	__atomic_store_n(&ws2812_isa_max, isa, __ATOMIC_RELAXED);
+	return 0;
+}
+
+/**
+ * @brief Builds the gamma segments.
+ */
+static void ws2812_color_build_curve(ws2812_color_pipeline *pipeline,
+				     double gamma)
+{
+	for (int s = 0; s < WS2812_COLOR_SEGMENTS; s++) {
+		int x = s * 16;
+		int end_x = s == WS2812_COLOR_SEGMENTS - 1 ? 255 : x + 16;
+		int base = lround(WS2812_COLOR_FULL * pow(x / 255.0, gamma));
+		int end = lround(WS2812_COLOR_FULL * pow(end_x / 255.0, gamma));
+		int slope = lround((end - base) / (4.0 * (end_x - x)));
+
+		// Das Segmentende darf nicht über 255 hinausgehen
+		while (slope > 0 && base + 4 * slope * 15 > WS2812_COLOR_FULL) {
+			slope--;
+		}
+		pipeline->base_lo[s] = base & 0xFF;
+		pipeline->base_hi[s] = base >> 8;
+		pipeline->slope[s] = slope;
+	}
+}
+
+/**
+ * @brief Evaluates the pipeline for one channel value, the reference for all kernels.
+ */
+static uint8_t ws2812_color_eval(const ws2812_color_pipeline *pipeline,
+				 uint8_t value, uint16_t gain)
+{
+	int s = value >> 4;
+	uint32_t y = (pipeline->base_lo[s] | pipeline->base_hi[s] << 8) +
+		     4 * pipeline->slope[s] * (value & 15);
+
+	return (((y * gain) >> 16) + 128) >> 8;
+}
+
+/**
+ * @brief Builds the pshufb masks for the channel order.
+ *
+ * A 48 byte block holds 16 whole pixels in three vectors. Output byte i of vector k
+ * comes from input byte 3 * pixel + perm[channel], which is in vector k - 1, k or k + 1.
+ * Bytes taken from another vector have the mask 0x80 (zero).
+ */
+static void ws2812_color_build_shuffle(ws2812_color_pipeline *pipeline)
+{
+	memset(pipeline->shuffle, 0x80, sizeof(pipeline->shuffle));
+	for (int k = 0; k < 3; k++) {
+		for (int i = 0; i < 16; i++) {
+			int pos = 16 * k + i;
+			int src = pos - pos % 3 + pipeline->perm[pos % 3];
+			pipeline->shuffle[k][src / 16][i] = src % 16;
+		}
+	}
+}
+
+/**
+ * @brief Creates a color pipeline.
+ *
+ * The pipeline applies gamma correction, global brightness, white balance and the
+ * output channel order in one pass. Gamma is approximated by 16 linear segments, the
+ * output differs from round(255 * gain * (x / 255) ^ gamma) by at most 2. The fastest
+ * kernel the CPU supports is selected, see ws2812_color_set_isa().
+ *
+ * @param config The configuration, gamma must be in [1, 4].
+ * @return The pipeline, or NULL on error (check errno for specific error).
+ */
+ws2812_color_pipeline *ws2812_color_create(const ws2812_color_config *config)
+{
+	if (!(config->gamma >= 1.0 && config->gamma <= 4.0) ||
+	    (unsigned int)config->order > WS2812_ORDER_BGR) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	ws2812_color_pipeline *pipeline = calloc(1, sizeof(ws2812_color_pipeline));
+	if (!pipeline) {
+		return NULL;
+	}
+
+	memcpy(pipeline->perm, ws2812_color_orders[config->order], 3);
+	pipeline->reorder = config->order != WS2812_ORDER_RGB;
+	ws2812_color_build_curve(pipeline, config->gamma);
+	ws2812_color_build_shuffle(pipeline);
+
+	for (int c = 0; c < 3; c++) {
+		pipeline->gain[c] = (65535u * config->brightness *
+					     config->white_balance[c] +
+				     255 * 255 / 2) /
+				    (255 * 255);
+		for (int x = 0; x < 256; x++) {
+			pipeline->lut[c][x] =
+				ws2812_color_eval(pipeline, x, pipeline->gain[c]);
+		}
+	}
+	for (int k = 0; k < 3; k++) {
+		for (int i = 0; i < 16; i++) {
+			pipeline->lane_gain[k][i] =
+				pipeline->gain[(16 * k + i) % 3];
+		}
+	}
+
+	ws2812_color_set_isa(pipeline, WS2812_ISA_AUTO);
+	return pipeline;
+}
+
+/**
+ * @brief Frees a color pipeline.
+ *
+ * @param pipeline The pipeline, may be NULL.
+ */
+void ws2812_color_free(ws2812_color_pipeline *pipeline)
+{
+	free(pipeline);
+}
+
+/**
+ * @brief Selects the kernel of a pipeline.
+ *
+ * @param pipeline The pipeline.
+ * @param isa The instruction set, WS2812_ISA_AUTO for the fastest supported one.
+ * @return 0 on success, or -1 if the CPU doesn't support it (errno ENOTSUP).
+ */
+int ws2812_color_set_isa(ws2812_color_pipeline *pipeline, ws2812_isa isa)
+{
+	if (isa == WS2812_ISA_AUTO) {
+		static const ws2812_isa order[] = { WS2812_ISA_AVX2,
+						    WS2812_ISA_NEON,
+						    WS2812_ISA_SSSE3 };
+		isa = WS2812_ISA_SCALAR;
+		for (size_t i = 0; i < sizeof(order) / sizeof(order[0]); i++) {
+			if (ws2812_isa_supported(order[i])) {
+				isa = order[i];
+				break;
+			}
+		}
+	}
+	if (!ws2812_isa_supported(isa)) {
+		errno = ENOTSUP;
+		return -1;
+	}
+	pipeline->isa = isa;
+	return 0;
+}
+
+/**
+ * @brief Returns the kernel used by a pipeline.
+ *
+ * @param pipeline The pipeline.
+ * @return The instruction set.
+ */
+ws2812_isa ws2812_color_get_isa(const ws2812_color_pipeline *pipeline)
+{
+	return pipeline->isa;
+}
+
+/**
+ * @brief Scalar kernel, one table lookup per channel.
+ */
+static void ws2812_color_scalar(const ws2812_color_pipeline *pipeline,
+				led_pixel *dst, const led_pixel *src,
+				size_t count)
+{
+	const uint8_t *p = pipeline->perm;
+
+	for (size_t i = 0; i < count; i++) {
+		uint8_t in[3] = { src[i].red, src[i].green, src[i].blue };
+		dst[i].red = pipeline->lut[p[0]][in[p[0]]];
+		dst[i].green = pipeline->lut[p[1]][in[p[1]]];
+		dst[i].blue = pipeline->lut[p[2]][in[p[2]]];
+	}
+}
+
+#ifdef WS2812_COLOR_X86
+
+/**
+ * @brief Gamma and gain of 16 bytes (SSSE3).
+ */
+__attribute__((target("ssse3"))) static inline __m128i
+ws2812_color_ssse3_curve(__m128i x, __m128i base_lo, __m128i base_hi,
+			 __m128i slope, const uint16_t *gain)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i nibble = _mm_set1_epi8(0x0F);
+	const __m128i round = _mm_set1_epi16(128);
+	__m128i s = _mm_and_si128(_mm_srli_epi16(x, 4), nibble);
+	__m128i f = _mm_and_si128(x, nibble);
+	__m128i bl = _mm_shuffle_epi8(base_lo, s);
+	__m128i bh = _mm_shuffle_epi8(base_hi, s);
+	__m128i sl = _mm_shuffle_epi8(slope, s);
+
+	__m128i y_lo = _mm_add_epi16(
+		_mm_unpacklo_epi8(bl, bh),
+		_mm_slli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(sl, zero),
+					       _mm_unpacklo_epi8(f, zero)),
+			       2));
+	__m128i y_hi = _mm_add_epi16(
+		_mm_unpackhi_epi8(bl, bh),
+		_mm_slli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(sl, zero),
+					       _mm_unpackhi_epi8(f, zero)),
+			       2));
+	y_lo = _mm_mulhi_epu16(y_lo, _mm_loadu_si128((const __m128i *)gain));
+	y_hi = _mm_mulhi_epu16(y_hi,
+			       _mm_loadu_si128((const __m128i *)(gain + 8)));
+	y_lo = _mm_srli_epi16(_mm_add_epi16(y_lo, round), 8);
+	y_hi = _mm_srli_epi16(_mm_add_epi16(y_hi, round), 8);
+	return _mm_packus_epi16(y_lo, y_hi);
+}
+
+/**
+ * @brief SSSE3 kernel, 16 pixels (48 bytes) per iteration.
+ */
+__attribute__((target("ssse3"))) static void
+ws2812_color_ssse3(const ws2812_color_pipeline *pipeline, led_pixel *dst,
+		   const led_pixel *src, size_t count)
+{
+	const __m128i base_lo = _mm_loadu_si128((const __m128i *)pipeline->base_lo);
+	const __m128i base_hi = _mm_loadu_si128((const __m128i *)pipeline->base_hi);
+	const __m128i slope = _mm_loadu_si128((const __m128i *)pipeline->slope);
+	__m128i m[3][3];
+	size_t i = 0;
+
+	for (int k = 0; k < 3; k++) {
+		for (int j = 0; j < 3; j++) {
+			m[k][j] = _mm_loadu_si128(
+				(const __m128i *)pipeline->shuffle[k][j]);
+		}
+	}
+
+	for (; i + 16 <= count; i += 16) {
+		const __m128i *in = (const __m128i *)(src + i);
+		__m128i *out = (__m128i *)(dst + i);
+		__m128i v0 = ws2812_color_ssse3_curve(_mm_loadu_si128(in), base_lo,
+						      base_hi, slope,
+						      pipeline->lane_gain[0]);
+		__m128i v1 = ws2812_color_ssse3_curve(_mm_loadu_si128(in + 1),
+						      base_lo, base_hi, slope,
+						      pipeline->lane_gain[1]);
+		__m128i v2 = ws2812_color_ssse3_curve(_mm_loadu_si128(in + 2),
+						      base_lo, base_hi, slope,
+						      pipeline->lane_gain[2]);
+		if (pipeline->reorder) {
+			__m128i o0 = _mm_or_si128(
+				_mm_shuffle_epi8(v0, m[0][0]),
+				_mm_shuffle_epi8(v1, m[0][1]));
+			__m128i o1 = _mm_or_si128(
+				_mm_or_si128(_mm_shuffle_epi8(
+						     v0, m[1][0]),
+					     _mm_shuffle_epi8(
+						     v1, m[1][1])),
+				_mm_shuffle_epi8(v2, m[1][2]));
+			__m128i o2 = _mm_or_si128(
+				_mm_shuffle_epi8(v1, m[2][1]),
+				_mm_shuffle_epi8(v2, m[2][2]));
+			v0 = o0;
+			v1 = o1;
+			v2 = o2;
+		}
+		_mm_storeu_si128(out, v0);
+		_mm_storeu_si128(out + 1, v1);
+		_mm_storeu_si128(out + 2, v2);
+	}
+	ws2812_color_scalar(pipeline, dst + i, src + i, count - i);
+}
+
+/**
+ * @brief Gamma and gain of two 16 byte lanes (AVX2).
+ */
+__attribute__((target("avx2"))) static inline __m256i
+ws2812_color_avx2_curve(__m256i x, __m256i base_lo, __m256i base_hi,
+			__m256i slope, __m256i gain_lo, __m256i gain_hi)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i nibble = _mm256_set1_epi8(0x0F);
+	const __m256i round = _mm256_set1_epi16(128);
+	__m256i s = _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble);
+	__m256i f = _mm256_and_si256(x, nibble);
+	__m256i bl = _mm256_shuffle_epi8(base_lo, s);
+	__m256i bh = _mm256_shuffle_epi8(base_hi, s);
+	__m256i sl = _mm256_shuffle_epi8(slope, s);
+
+	__m256i y_lo = _mm256_add_epi16(
+		_mm256_unpacklo_epi8(bl, bh),
+		_mm256_slli_epi16(
+			_mm256_mullo_epi16(_mm256_unpacklo_epi8(sl, zero),
+					   _mm256_unpacklo_epi8(f, zero)),
+			2));
+	__m256i y_hi = _mm256_add_epi16(
+		_mm256_unpackhi_epi8(bl, bh),
+		_mm256_slli_epi16(
+			_mm256_mullo_epi16(_mm256_unpackhi_epi8(sl, zero),
+					   _mm256_unpackhi_epi8(f, zero)),
+			2));
+	y_lo = _mm256_srli_epi16(
+		_mm256_add_epi16(_mm256_mulhi_epu16(y_lo, gain_lo), round), 8);
+	y_hi = _mm256_srli_epi16(
+		_mm256_add_epi16(_mm256_mulhi_epu16(y_hi, gain_hi), round), 8);
+	return _mm256_packus_epi16(y_lo, y_hi);
+}
+
+/**
+ * @brief Loads vector k of two consecutive 48 byte blocks into the two lanes.
+ */
+__attribute__((target("avx2"))) static inline __m256i
+ws2812_color_avx2_load(const led_pixel *block, int k)
+{
+	const __m128i *in = (const __m128i *)block;
+	return _mm256_inserti128_si256(
+		_mm256_castsi128_si256(_mm_loadu_si128(in + k)),
+		_mm_loadu_si128(in + 3 + k), 1);
+}
+
+/**
+ * @brief Stores the two lanes as vector k of two consecutive 48 byte blocks.
+ */
+__attribute__((target("avx2"))) static inline void
+ws2812_color_avx2_store(led_pixel *block, int k, __m256i v)
+{
+	__m128i *out = (__m128i *)block;
+	_mm_storeu_si128(out + k, _mm256_castsi256_si128(v));
+	_mm_storeu_si128(out + 3 + k, _mm256_extracti128_si256(v, 1));
+}
+
+/**
+ * @brief AVX2 kernel, 32 pixels per iteration.
+ *
+ * pshufb and unpack work within 128 bit lanes, so each lane processes one 48 byte
+ * block exactly like the SSSE3 kernel and all tables are the same in both lanes.
+ */
+__attribute__((target("avx2"))) static void
+ws2812_color_avx2(const ws2812_color_pipeline *pipeline, led_pixel *dst,
+		  const led_pixel *src, size_t count)
+{
+#define WS2812_BCAST(p) \
+	_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(p)))
+	const __m256i base_lo = WS2812_BCAST(pipeline->base_lo);
+	const __m256i base_hi = WS2812_BCAST(pipeline->base_hi);
+	const __m256i slope = WS2812_BCAST(pipeline->slope);
+	__m256i gain[3][2];
+	__m256i m[3][3];
+	size_t i = 0;
+
+	for (int k = 0; k < 3; k++) {
+		gain[k][0] = WS2812_BCAST(pipeline->lane_gain[k]);
+		gain[k][1] = WS2812_BCAST(pipeline->lane_gain[k] + 8);
+		for (int j = 0; j < 3; j++) {
+			m[k][j] = WS2812_BCAST(pipeline->shuffle[k][j]);
+		}
+	}
+#undef WS2812_BCAST
+
+	for (; i + 32 <= count; i += 32) {
+		__m256i v[3];
+		for (int k = 0; k < 3; k++) {
+			v[k] = ws2812_color_avx2_curve(
+				ws2812_color_avx2_load(src + i, k), base_lo,
+				base_hi, slope, gain[k][0], gain[k][1]);
+		}
+		if (pipeline->reorder) {
+			__m256i o0 = _mm256_or_si256(
+				_mm256_shuffle_epi8(v[0], m[0][0]),
+				_mm256_shuffle_epi8(v[1], m[0][1]));
+			__m256i o1 = _mm256_or_si256(
+				_mm256_or_si256(_mm256_shuffle_epi8(v[0], m[1][0]),
+						_mm256_shuffle_epi8(v[1], m[1][1])),
+				_mm256_shuffle_epi8(v[2], m[1][2]));
+			__m256i o2 = _mm256_or_si256(
+				_mm256_shuffle_epi8(v[1], m[2][1]),
+				_mm256_shuffle_epi8(v[2], m[2][2]));
+			v[0] = o0;
+			v[1] = o1;
+			v[2] = o2;
+		}
+		for (int k = 0; k < 3; k++) {
+			ws2812_color_avx2_store(dst + i, k, v[k]);
+		}
+	}
+	ws2812_color_ssse3(pipeline, dst + i, src + i, count - i);
+}
+
+#endif
+
+#if defined(__aarch64__)
+
+/**
+ * @brief Gamma and gain of 16 values of one channel (NEON).
+ */
+static inline uint8x16_t ws2812_color_neon_curve(uint8x16_t x, uint8x16_t base_lo,
+						 uint8x16_t base_hi,
+						 uint8x16_t slope, uint16_t gain)
+{
+	uint8x16_t s = vshrq_n_u8(x, 4);
+	uint8x16_t f = vandq_u8(x, vdupq_n_u8(0x0F));
+	uint8x16_t bl = vqtbl1q_u8(base_lo, s);
+	uint8x16_t bh = vqtbl1q_u8(base_hi, s);
+	uint8x16_t sl = vqtbl1q_u8(slope, s);
+	uint16x8_t g = vdupq_n_u16(gain);
+
+	uint16x8_t y_lo = vaddq_u16(vreinterpretq_u16_u8(vzip1q_u8(bl, bh)),
+				    vshlq_n_u16(vmull_u8(vget_low_u8(sl),
+							 vget_low_u8(f)),
+						2));
+	uint16x8_t y_hi = vaddq_u16(vreinterpretq_u16_u8(vzip2q_u8(bl, bh)),
+				    vshlq_n_u16(vmull_high_u8(sl, f), 2));
+	// Oberes Halbwort von y * gain
+	y_lo = vcombine_u16(
+		vshrn_n_u32(vmull_u16(vget_low_u16(y_lo), vget_low_u16(g)), 16),
+		vshrn_n_u32(vmull_high_u16(y_lo, g), 16));
+	y_hi = vcombine_u16(
+		vshrn_n_u32(vmull_u16(vget_low_u16(y_hi), vget_low_u16(g)), 16),
+		vshrn_n_u32(vmull_high_u16(y_hi, g), 16));
+	return vcombine_u8(vrshrn_n_u16(y_lo, 8), vrshrn_n_u16(y_hi, 8));
+}
+
+/**
+ * @brief NEON kernel, 16 pixels per iteration.
+ *
+ * vld3q/vst3q split the pixels into channel planes, so the channel order is just
+ * the order of the planes on store.
+ */
+static void ws2812_color_neon(const ws2812_color_pipeline *pipeline,
+			      led_pixel *dst, const led_pixel *src, size_t count)
+{
+	const uint8x16_t base_lo = vld1q_u8(pipeline->base_lo);
+	const uint8x16_t base_hi = vld1q_u8(pipeline->base_hi);
+	const uint8x16_t slope = vld1q_u8(pipeline->slope);
+	const uint8_t *p = pipeline->perm;
+	size_t i = 0;
+
+	for (; i + 16 <= count; i += 16) {
+		uint8x16x3_t in = vld3q_u8((const uint8_t *)(src + i));
+		uint8x16x3_t out;
+		for (int c = 0; c < 3; c++) {
+			out.val[c] = ws2812_color_neon_curve(in.val[p[c]], base_lo,
+							     base_hi, slope,
+							     pipeline->gain[p[c]]);
+		}
+		vst3q_u8((uint8_t *)(dst + i), out);
+	}
+	ws2812_color_scalar(pipeline, dst + i, src + i, count - i);
+}
+
+#endif
+
+/**
+ * @brief Applies the pipeline to pixels.
+ *
+ * @param pipeline The pipeline.
+ * @param dst Receives the output, may be src (in place) but must not overlap it otherwise.
+ * @param src The input pixels.
+ * @param count Number of pixels.
+ */
+void ws2812_color_apply(const ws2812_color_pipeline *pipeline, led_pixel *dst,
+			const led_pixel *src, size_t count)
+{
+	switch (pipeline->isa) {
+#ifdef WS2812_COLOR_X86
+	case WS2812_ISA_AVX2:
+		ws2812_color_avx2(pipeline, dst, src, count);
+		break;
+	case WS2812_ISA_SSSE3:
+		ws2812_color_ssse3(pipeline, dst, src, count);
+		break;
+#endif
+#if defined(__aarch64__)
+	case WS2812_ISA_NEON:
+		ws2812_color_neon(pipeline, dst, src, count);
+		break;
+#endif
+	default:
+		ws2812_color_scalar(pipeline, dst, src, count);
+		break;
+	}
+}
@@ -0,0 +1,276 @@
+/**
+ * @file usb_ws2812_diff.c                                                     *
+ * @brief Shadow frame: sends only the ranges that changed since the last frame*
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#include "usb_ws2812_lib.h"
+#include "usb_ws2812_private.h"
+#include "dev_packets.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * @brief Last frame submitted to a device.
+ */
+struct ws2812_shadow_s {
+	ws2812_handle *handle; /**< The device. */
+	uint16_t length; /**< Number of LEDs of a frame. */
+	bool valid; /**< shadow holds the frame shown by the device. */
+	led_pixel *shadow; /**< The last submitted frame. */
+	ws2812_shadow_stats stats; /**< Statistics. */
+};
+
+/**
+ * @brief Creates a shadow frame for a device.
+ *
+ * The first ws2812_shadow_submit() sends the full frame, every further one only
+ * the ranges that differ from the previous frame, or the full frame if that is cheaper.
+ * The shadow assumes that it is the only writer of pixel data to the device, call
+ * ws2812_shadow_invalidate() after other functions changed the pixels.
+ *
+ * @param handle The WS2812 device.
+ * @param length Number of LEDs of a frame.
+ * @return The shadow, or NULL on error (check errno for specific error).
+ */
+ws2812_shadow *ws2812_shadow_create(ws2812_handle *handle, uint16_t length)
+{
+	ws2812_shadow *shadow = calloc(1, sizeof(ws2812_shadow));
+	if (!shadow) {
+		return NULL;
+	}
+	shadow->handle = handle;
+	shadow->length = length;
+	shadow->shadow = calloc(length ? length : 1, sizeof(led_pixel));
+	if (!shadow->shadow) {
+		free(shadow);
+		return NULL;
+	}
+	return shadow;
+}
+
+/**
+ * @brief Frees a shadow frame.
+ *
+ * @param shadow The shadow, may be NULL.
+ */
+void ws2812_shadow_free(ws2812_shadow *shadow)
+{
+	if (!shadow) {
+		return;
+	}
+	free(shadow->shadow);
+	free(shadow);
+}
+
+/**
+ * @brief Forces the next ws2812_shadow_submit() to send the full frame.
+ *
+ * @param shadow The shadow.
+ */
+void ws2812_shadow_invalidate(ws2812_shadow *shadow)
+{
+	shadow->valid = false;
+}
+
+/**
+ * @brief Returns the statistics of a shadow frame.
+ *
+ * @param shadow The shadow.
+ * @param stats Receives the statistics.
+ */
+void ws2812_shadow_get_stats(const ws2812_shadow *shadow,
+			     ws2812_shadow_stats *stats)
+{
+	*stats = shadow->stats;
+}
+
+/**
+ * @def WS2812_DIFF_PIXEL_BITS
+ * @brief Bit of the first byte of each of the 16 pixels in a 48-bit byte mask.
+ */
+#define WS2812_DIFF_PIXEL_BITS 0x249249249249ull
+
+/**
+ * @brief Compares a block of 16 pixels (48 bytes), bit i is set if byte i is equal.
+ *
+ * With SSE2 three compares and movemasks, the scalar fallback compares byte by byte.
+ */
+static uint64_t ws2812_equal_bytes(const uint8_t *qa, const uint8_t *qb)
+{
+#ifdef __SSE2__
+	uint64_t m0 = (uint16_t)_mm_movemask_epi8(
+		_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)qa),
+			       _mm_loadu_si128((const __m128i *)qb)));
+	uint64_t m1 = (uint16_t)_mm_movemask_epi8(
+		_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(qa + 16)),
+			       _mm_loadu_si128((const __m128i *)(qb + 16))));
+	uint64_t m2 = (uint16_t)_mm_movemask_epi8(
+		_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(qa + 32)),
+			       _mm_loadu_si128((const __m128i *)(qb + 32))));
+	return m0 | m1 << 16 | m2 << 32;
+#else
+	uint64_t mask = 0;
+	for (int i = 0; i < 16 * (int)sizeof(led_pixel); i++) {
+		mask |= (uint64_t)(qa[i] == qb[i]) << i;
+	}
+	return mask;
+#endif
+}
+
+/**
+ * @brief Returns the index of the first pixel >= from that differs, or count.
+ *
+ * Blocks of 16 pixels are compared with ws2812_equal_bytes(), the first unequal
+ * byte of a block gives the pixel directly.
+ */
+static size_t ws2812_next_diff(const led_pixel *a, const led_pixel *b,
+			       size_t from, size_t count)
+{
+	const uint8_t *pa = (const uint8_t *)a;
+	const uint8_t *pb = (const uint8_t *)b;
+
+	while (from + 16 <= count) {
+		uint64_t diff = ~ws2812_equal_bytes(pa + from * sizeof(led_pixel),
+						    pb + from * sizeof(led_pixel)) &
+				((1ull << (16 * sizeof(led_pixel))) - 1);
+		if (diff) {
+			return from + __builtin_ctzll(diff) / sizeof(led_pixel);
+		}
+		from += 16;
+	}
+
+	for (; from < count; from++) {
+		if (memcmp(&a[from], &b[from], sizeof(led_pixel)) != 0) {
+			break;
+		}
+	}
+	return from;
+}
+
+/**
+ * @brief Returns the index of the first pixel >= from that is equal, or count.
+ *
+ * Like ws2812_next_diff(), a pixel is equal if all three of its bits in the byte
+ * mask are set.
+ */
+static size_t ws2812_next_equal(const led_pixel *a, const led_pixel *b,
+				size_t from, size_t count)
+{
+	const uint8_t *pa = (const uint8_t *)a;
+	const uint8_t *pb = (const uint8_t *)b;
+
+	while (from + 16 <= count) {
+		uint64_t eq = ws2812_equal_bytes(pa + from * sizeof(led_pixel),
+						 pb + from * sizeof(led_pixel));
+		eq &= eq >> 1 & eq >> 2 & WS2812_DIFF_PIXEL_BITS;
+		if (eq) {
+			return from + __builtin_ctzll(eq) / sizeof(led_pixel);
+		}
+		from += 16;
+	}
+
+	for (; from < count; from++) {
+		if (memcmp(&a[from], &b[from], sizeof(led_pixel)) == 0) {
+			break;
+		}
+	}
+	return from;
+}
+
+/**
+ * @brief Submits a frame, only the changed ranges are sent.
+ *
+ * The new frame is compared with the last submitted one. Changed runs whose gap is
+ * smaller than the cost of an additional packet are merged. The remaining ranges
+ * are sent as pixel data packets with one writev() from the memory of frame. If
+ * the ranges with their headers are not smaller than the full frame, or there are
+ * more than WS2812_MAX_REGIONS of them, the full frame is sent instead.
+ *
+ * @param shadow The shadow.
+ * @param frame The new frame with the length given to ws2812_shadow_create().
+ * @return Number of bytes written (0 if nothing changed), or -1 on error (check errno for specific error).
+ */
+int ws2812_shadow_submit(ws2812_shadow *shadow, const led_pixel *frame)
+{
+	size_t count = shadow->length;
+	size_t gap_max = WS2812_DIFF_PACKET_COST / sizeof(led_pixel);
+	size_t full_bytes = sizeof(led_pixel_data) + count * sizeof(led_pixel);
+	ws2812_region regions[WS2812_MAX_REGIONS];
+	size_t region_count = 0;
+	size_t diff_bytes = 0;
+	bool full = !shadow->valid;
+
+	size_t pos = full ? count :
+			    ws2812_next_diff(frame, shadow->shadow, 0, count);
+	while (pos < count) {
+		size_t end = ws2812_next_equal(frame, shadow->shadow, pos, count);
+		// Folgende Änderungen anhängen, solange die Lücke billiger als ein Paket ist
+		for (;;) {
+			size_t next = ws2812_next_diff(frame, shadow->shadow,
+						       end, count);
+			if (next == count || next - end > gap_max) {
+				if (region_count == WS2812_MAX_REGIONS) {
+					full = true;
+					break;
+				}
+				regions[region_count++] = (ws2812_region){
+					.start_index = pos,
+					.length = end - pos,
+					.pixel_data = frame + pos,
+				};
+				diff_bytes += sizeof(led_pixel_data) +
+					      (end - pos) * sizeof(led_pixel);
+				pos = next;
+				break;
+			}
+			end = ws2812_next_equal(frame, shadow->shadow, next,
+						count);
+		}
+		if (full || diff_bytes >= full_bytes) {
+			full = true;
+			break;
+		}
+	}
+
+	int ret;
+	if (full) {
+		ret = ws2812_set_led_pixel(shadow->handle, 0, count, frame);
+		if (ret >= 0) {
+			memcpy(shadow->shadow, frame, count * sizeof(led_pixel));
+			shadow->valid = true;
+			shadow->stats.full_frames++;
+			shadow->stats.bytes_sent += ret;
+		}
+	} else if (region_count == 0) {
+		shadow->stats.skipped_frames++;
+		shadow->stats.bytes_full += full_bytes;
+		return 0;
+	} else {
+		ret = ws2812_set_led_regions(shadow->handle, regions,
+					     region_count);
+		if (ret >= 0) {
+			for (size_t i = 0; i < region_count; i++) {
+				memcpy(shadow->shadow + regions[i].start_index,
+				       regions[i].pixel_data,
+				       regions[i].length * sizeof(led_pixel));
+			}
+			shadow->stats.diff_frames++;
+			shadow->stats.regions_sent += region_count;
+			shadow->stats.bytes_sent += ret;
+		}
+	}
+	if (ret < 0) {
+		// Unklar was angekommen ist, beim nächsten Mal alles senden
+		shadow->valid = false;
+		return -1;
+	}
+	shadow->stats.bytes_full += full_bytes;
+	return ret;
+}
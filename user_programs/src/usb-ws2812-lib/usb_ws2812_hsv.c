@@ -0,0 +1,399 @@
+/**
+ * @file usb_ws2812_hsv.c                                                      *
+ * @brief Bulk HSV to RGB conversion and palette gradients with fixed point    *
+ *        SIMD kernels                                                         *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#include "usb_ws2812_lib.h"
+#include "usb_ws2812_private.h"
+#include "usb_ws2812_simd.h"
+#include <errno.h>
+#include <stdlib.h>
+
+/**
+ * @brief Color palette for gradients.
+ *
+ * Entries are stored as 0x00BBGGRR so two of them can be loaded per pixel with one
+ * 32 bit gather each. There is one entry more than segments, the end of the last
+ * segment (the first color for wrapping palettes).
+ */
+struct ws2812_palette_s {
+	uint32_t segments; /**< Number of gradient segments. */
+	uint32_t *entries; /**< segments + 1 colors. */
+};
+
+/**
+ * @brief Converts one channel ramp (0 ... 255 over the hue) with saturation and value.
+ */
+static inline uint8_t ws2812_hsv_channel(int ramp, int s, int v)
+{
+	ramp = ramp < 0 ? 0 : ramp > 255 ? 255 : ramp;
+	return ws2812_div255(v * (255 - ws2812_div255(s * (255 - ramp))));
+}
+
+/**
+ * @brief Scalar HSV kernel, the reference for the SIMD kernels.
+ */
+static void ws2812_hsv_scalar(led_pixel *dst, const ws2812_hsv *src,
+			      size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		int h6 = src[i].hue * 6;
+		int s = src[i].saturation;
+		int v = src[i].value;
+
+		dst[i].red = ws2812_hsv_channel(abs(h6 - 768) - 256, s, v);
+		dst[i].green = ws2812_hsv_channel(512 - abs(h6 - 512), s, v);
+		dst[i].blue = ws2812_hsv_channel(512 - abs(h6 - 1024), s, v);
+	}
+}
+
+#ifdef WS2812_SIMD_X86
+
+/**
+ * @brief ws2812_div255() of 8 16 bit lanes.
+ */
+__attribute__((target("ssse3"))) static inline __m128i
+ws2812_div255_ssse3(__m128i x)
+{
+	x = _mm_add_epi16(x, _mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+/**
+ * @brief ws2812_hsv_channel() of 8 16 bit lanes.
+ */
+__attribute__((target("ssse3"))) static inline __m128i
+ws2812_hsv_channel_ssse3(__m128i ramp, __m128i s, __m128i v)
+{
+	const __m128i full = _mm_set1_epi16(255);
+
+	ramp = _mm_min_epi16(_mm_max_epi16(ramp, _mm_setzero_si128()), full);
+	__m128i white = ws2812_div255_ssse3(
+		_mm_mullo_epi16(s, _mm_sub_epi16(full, ramp)));
+	return ws2812_div255_ssse3(_mm_mullo_epi16(v, _mm_sub_epi16(full, white)));
+}
+
+/**
+ * @brief Converts 8 pixels given as 16 bit lanes of hue, saturation and value.
+ */
+__attribute__((target("ssse3"))) static inline void
+ws2812_hsv_lanes_ssse3(__m128i h, __m128i s, __m128i v, __m128i rgb[3])
+{
+	__m128i h6 = _mm_mullo_epi16(h, _mm_set1_epi16(6));
+
+	rgb[0] = ws2812_hsv_channel_ssse3(
+		_mm_sub_epi16(_mm_abs_epi16(_mm_sub_epi16(h6, _mm_set1_epi16(768))),
+			      _mm_set1_epi16(256)),
+		s, v);
+	rgb[1] = ws2812_hsv_channel_ssse3(
+		_mm_sub_epi16(_mm_set1_epi16(512),
+			      _mm_abs_epi16(_mm_sub_epi16(h6, _mm_set1_epi16(512)))),
+		s, v);
+	rgb[2] = ws2812_hsv_channel_ssse3(
+		_mm_sub_epi16(_mm_set1_epi16(512),
+			      _mm_abs_epi16(_mm_sub_epi16(h6, _mm_set1_epi16(1024)))),
+		s, v);
+}
+
+/**
+ * @brief SSSE3 HSV kernel, 16 pixels per iteration.
+ */
+__attribute__((target("ssse3"))) static void
+ws2812_hsv_ssse3(led_pixel *dst, const ws2812_hsv *src, size_t count)
+{
+	const __m128i zero = _mm_setzero_si128();
+	size_t i = 0;
+
+	for (; i + 16 <= count; i += 16) {
+		__m128i hsv[3], lo[3], hi[3], rgb[3];
+
+		ws2812_simd_deinterleave_ssse3(src + i, hsv);
+		ws2812_hsv_lanes_ssse3(_mm_unpacklo_epi8(hsv[0], zero),
+				       _mm_unpacklo_epi8(hsv[1], zero),
+				       _mm_unpacklo_epi8(hsv[2], zero), lo);
+		ws2812_hsv_lanes_ssse3(_mm_unpackhi_epi8(hsv[0], zero),
+				       _mm_unpackhi_epi8(hsv[1], zero),
+				       _mm_unpackhi_epi8(hsv[2], zero), hi);
+		for (int c = 0; c < 3; c++) {
+			rgb[c] = _mm_packus_epi16(lo[c], hi[c]);
+		}
+		ws2812_simd_interleave_ssse3(dst + i, rgb);
+	}
+	ws2812_hsv_scalar(dst + i, src + i, count - i);
+}
+
+/**
+ * @brief ws2812_div255() of 16 16 bit lanes.
+ */
+__attribute__((target("avx2"))) static inline __m256i
+ws2812_div255_avx2(__m256i x)
+{
+	x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+	return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+
+/**
+ * @brief ws2812_hsv_channel() of 16 16 bit lanes.
+ */
+__attribute__((target("avx2"))) static inline __m256i
+ws2812_hsv_channel_avx2(__m256i ramp, __m256i s, __m256i v)
+{
+	const __m256i full = _mm256_set1_epi16(255);
+
+	ramp = _mm256_min_epi16(_mm256_max_epi16(ramp, _mm256_setzero_si256()),
+				full);
+	__m256i white = ws2812_div255_avx2(
+		_mm256_mullo_epi16(s, _mm256_sub_epi16(full, ramp)));
+	return ws2812_div255_avx2(
+		_mm256_mullo_epi16(v, _mm256_sub_epi16(full, white)));
+}
+
+/**
+ * @brief Converts 16 pixels given as 16 bit lanes of hue, saturation and value.
+ */
+__attribute__((target("avx2"))) static inline void
+ws2812_hsv_lanes_avx2(__m256i h, __m256i s, __m256i v, __m256i rgb[3])
+{
+	__m256i h6 = _mm256_mullo_epi16(h, _mm256_set1_epi16(6));
+
+	rgb[0] = ws2812_hsv_channel_avx2(
+		_mm256_sub_epi16(
+			_mm256_abs_epi16(_mm256_sub_epi16(h6, _mm256_set1_epi16(768))),
+			_mm256_set1_epi16(256)),
+		s, v);
+	rgb[1] = ws2812_hsv_channel_avx2(
+		_mm256_sub_epi16(
+			_mm256_set1_epi16(512),
+			_mm256_abs_epi16(_mm256_sub_epi16(h6, _mm256_set1_epi16(512)))),
+		s, v);
+	rgb[2] = ws2812_hsv_channel_avx2(
+		_mm256_sub_epi16(_mm256_set1_epi16(512),
+				 _mm256_abs_epi16(_mm256_sub_epi16(
+					 h6, _mm256_set1_epi16(1024)))),
+		s, v);
+}
+
+/**
+ * @brief AVX2 HSV kernel, 32 pixels per iteration.
+ *
+ * unpack and pack work within 128 bit lanes, so the pixels stay in the lane layout
+ * of ws2812_simd_deinterleave_avx2() throughout.
+ */
+__attribute__((target("avx2"))) static void
+ws2812_hsv_avx2(led_pixel *dst, const ws2812_hsv *src, size_t count)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	size_t i = 0;
+
+	for (; i + 32 <= count; i += 32) {
+		__m256i hsv[3], lo[3], hi[3], rgb[3];
+
+		ws2812_simd_deinterleave_avx2(src + i, hsv);
+		ws2812_hsv_lanes_avx2(_mm256_unpacklo_epi8(hsv[0], zero),
+				      _mm256_unpacklo_epi8(hsv[1], zero),
+				      _mm256_unpacklo_epi8(hsv[2], zero), lo);
+		ws2812_hsv_lanes_avx2(_mm256_unpackhi_epi8(hsv[0], zero),
+				      _mm256_unpackhi_epi8(hsv[1], zero),
+				      _mm256_unpackhi_epi8(hsv[2], zero), hi);
+		for (int c = 0; c < 3; c++) {
+			rgb[c] = _mm256_packus_epi16(lo[c], hi[c]);
+		}
+		ws2812_simd_interleave_avx2(dst + i, rgb);
+	}
+	ws2812_hsv_ssse3(dst + i, src + i, count - i);
+}
+
+#endif
+
+/**
+ * @brief Converts HSV values to pixels.
+ *
+ * Hue 0 ... 255 is one turn of 256 steps (0 red, ~85 green, ~171 blue). Each
+ * channel follows a trapezoid ramp over the hue, that is scaled by saturation
+ * and value in 8 bit fixed point without branches. The kernel (AVX2, SSSE3 or
+ * scalar) is selected at runtime, all give identical results.
+ *
+ * @param dst Receives the pixels, must not overlap src unless it is the same memory.
+ * @param src The HSV values.
+ * @param count Number of pixels.
+ */
+void ws2812_hsv_to_rgb(led_pixel *dst, const ws2812_hsv *src, size_t count)
+{
+#ifdef WS2812_SIMD_X86
+	if (ws2812_isa_supported(WS2812_ISA_AVX2)) {
+		ws2812_hsv_avx2(dst, src, count);
+		return;
+	}
+	if (ws2812_isa_supported(WS2812_ISA_SSSE3)) {
+		ws2812_hsv_ssse3(dst, src, count);
+		return;
+	}
+#endif
+	ws2812_hsv_scalar(dst, src, count);
+}
+
+/**
+ * @brief Creates a palette for gradients.
+ *
+ * @param colors The colors, evenly spaced over the positions 0 ... 65535.
+ * @param count Number of colors (1 ... 256).
+ * @param wrap The last color blends back into the first one (for hue cycles).
+ * @return The palette, or NULL on error (check errno for specific error).
+ */
+ws2812_palette *ws2812_palette_create(const led_pixel *colors, size_t count,
+				      bool wrap)
+{
+	if (count == 0 || count > 256) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	ws2812_palette *palette = calloc(1, sizeof(ws2812_palette));
+	if (!palette) {
+		return NULL;
+	}
+	palette->segments = wrap ? count : count - 1;
+	palette->entries = calloc(count + 1, sizeof(uint32_t));
+	if (!palette->entries) {
+		free(palette);
+		return NULL;
+	}
+	for (size_t i = 0; i <= count; i++) {
+		const led_pixel *c = &colors[i < count ? i : wrap ? 0 : count - 1];
+		palette->entries[i] = c->red | c->green << 8 | (uint32_t)c->blue << 16;
+	}
+	return palette;
+}
+
+/**
+ * @brief Frees a palette.
+ *
+ * @param palette The palette, may be NULL.
+ */
+void ws2812_palette_free(ws2812_palette *palette)
+{
+	if (!palette) {
+		return;
+	}
+	free(palette->entries);
+	free(palette);
+}
+
+/**
+ * @brief Scalar palette kernel, the reference for the SIMD kernel.
+ */
+static void ws2812_palette_scalar(const ws2812_palette *palette, led_pixel *dst,
+				  const uint16_t *positions, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		uint32_t scaled = positions[i] * palette->segments;
+		uint32_t index = scaled >> 16;
+		uint32_t f = (scaled >> 8) & 0xFF;
+		uint32_t a = palette->entries[index];
+		uint32_t b = palette->entries[index + 1];
+
+		dst[i].red = ((a & 0xFF) * (256 - f) + (b & 0xFF) * f) >> 8;
+		dst[i].green = (((a >> 8) & 0xFF) * (256 - f) +
+				((b >> 8) & 0xFF) * f) >>
+			       8;
+		dst[i].blue = (((a >> 16) & 0xFF) * (256 - f) +
+			       ((b >> 16) & 0xFF) * f) >>
+			      8;
+	}
+}
+
+#ifdef WS2812_SIMD_X86
+
+/**
+ * @brief AVX2 palette kernel, 8 pixels per iteration.
+ *
+ * Both colors of a pixel are fetched with a gather. Red and blue share one 32 bit
+ * lane as two 16 bit values, so one 16 bit multiply blends both. The 32 bit pixels
+ * are packed to 12 bytes per lane, each store writes 4 bytes past its pixels which
+ * the next store (or iteration) overwrites, so the loop stops 2 pixels early.
+ */
+__attribute__((target("avx2"))) static void
+ws2812_palette_avx2(const ws2812_palette *palette, led_pixel *dst,
+		    const uint16_t *positions, size_t count)
+{
+	const __m256i segments = _mm256_set1_epi32(palette->segments);
+	const __m256i byte_mask = _mm256_set1_epi32(0xFF);
+	const __m256i rb_mask = _mm256_set1_epi32(0x00FF00FF);
+	const __m256i one = _mm256_set1_epi16(256);
+	const __m256i pack = _mm256_setr_epi8(
+		0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1, 0, 1, 2,
+		4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+	const int *entries = (const int *)palette->entries;
+	size_t i = 0;
+
+	for (; i + 10 <= count; i += 8) {
+		__m256i scaled = _mm256_mullo_epi32(
+			_mm256_cvtepu16_epi32(
+				_mm_loadu_si128((const __m128i *)(positions + i))),
+			segments);
+		__m256i index = _mm256_srli_epi32(scaled, 16);
+		__m256i f = _mm256_and_si256(_mm256_srli_epi32(scaled, 8),
+					     byte_mask);
+		__m256i a = _mm256_i32gather_epi32(entries, index, 4);
+		__m256i b = _mm256_i32gather_epi32(entries + 1, index, 4);
+
+		f = _mm256_or_si256(f, _mm256_slli_epi32(f, 16));
+		__m256i inv = _mm256_sub_epi16(one, f);
+		__m256i rb = _mm256_srli_epi16(
+			_mm256_add_epi16(
+				_mm256_mullo_epi16(_mm256_and_si256(a, rb_mask),
+						   inv),
+				_mm256_mullo_epi16(_mm256_and_si256(b, rb_mask),
+						   f)),
+			8);
+		__m256i g = _mm256_srli_epi16(
+			_mm256_add_epi16(
+				_mm256_mullo_epi16(
+					_mm256_and_si256(_mm256_srli_epi32(a, 8),
+							 rb_mask),
+					inv),
+				_mm256_mullo_epi16(
+					_mm256_and_si256(_mm256_srli_epi32(b, 8),
+							 rb_mask),
+					f)),
+			8);
+		__m256i px = _mm256_shuffle_epi8(
+			_mm256_or_si256(rb, _mm256_slli_epi32(g, 8)), pack);
+
+		_mm_storeu_si128((__m128i *)(dst + i), _mm256_castsi256_si128(px));
+		_mm_storeu_si128((__m128i *)(dst + i + 4),
+				 _mm256_extracti128_si256(px, 1));
+	}
+	ws2812_palette_scalar(palette, dst + i, positions + i, count - i);
+}
+
+#endif
+
+/**
+ * @brief Maps gradient positions to pixels.
+ *
+ * Position 0 is the first color. Between two colors the channels are blended
+ * linearly in 1/256 steps, so 65535 is one step short of the last color (254
+ * for a 0 -> 255 gradient), or of the first one for wrapping palettes. The
+ * kernel (AVX2 or scalar) is selected at runtime, both give identical results.
+ *
+ * @param palette The palette.
+ * @param dst Receives the pixels.
+ * @param positions Gradient position of every pixel.
+ * @param count Number of pixels.
+ */
+void ws2812_palette_map(const ws2812_palette *palette, led_pixel *dst,
+			const uint16_t *positions, size_t count)
+{
+#ifdef WS2812_SIMD_X86
+	if (ws2812_isa_supported(WS2812_ISA_AVX2)) {
+		ws2812_palette_avx2(palette, dst, positions, count);
+		return;
+	}
+#endif
+	ws2812_palette_scalar(palette, dst, positions, count);
+}
@@ -0,0 +1,305 @@
+/**
+ * @file usb_ws2812_layer.c                                                    *
+ * @brief Client side of the compositing daemon: layers in shared memory       *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#include "usb_ws2812_lib.h"
+#include "compositor_packets.h"
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/**
+ * @brief State of a layer.
+ */
+struct ws2812_layer_s {
+	int socket_fd; /**< Connection to the daemon, the layer lives as long as it is open. */
+	int event_fd; /**< Frame tick of the daemon. */
+	compositor_layer_shm *shm; /**< Mapped shared memory. */
+	size_t size; /**< Size of the mapping. */
+	uint32_t back; /**< Buffer the client renders. */
+	uint32_t published; /**< Count of the last publication. */
+	ws2812_planar_frame frames[COMPOSITOR_LAYER_BUFFERS]; /**< Views of the buffers. */
+	uint8_t *alpha[COMPOSITOR_LAYER_BUFFERS]; /**< Alpha planes of the buffers. */
+};
+
+/**
+ * @brief Receives the announcement of the layer and its two file descriptors.
+ *
+ * @return 0 on success, -1 on error (check errno for specific error).
+ */
+static int ws2812_layer_receive(int socket_fd, compositor_layer_info *info,
+				int fds[2])
+{
+	union {
+		struct cmsghdr header;
+		char buf[CMSG_SPACE(2 * sizeof(int))];
+	} control;
+	struct iovec iov = { .iov_base = info, .iov_len = sizeof(*info) };
+	struct msghdr msg = {
+		.msg_iov = &iov,
+		.msg_iovlen = 1,
+		.msg_control = control.buf,
+		.msg_controllen = sizeof(control.buf),
+	};
+
+	ssize_t ret;
+	do {
+		ret = recvmsg(socket_fd, &msg, MSG_CMSG_CLOEXEC);
+	} while (ret < 0 && errno == EINTR);
+	if (ret < 0) {
+		return -1;
+	}
+
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+	if (!cmsg || cmsg->cmsg_level != SOL_SOCKET ||
+	    cmsg->cmsg_type != SCM_RIGHTS ||
+	    cmsg->cmsg_len != CMSG_LEN(2 * sizeof(int))) {
+		errno = EPROTO;
+		return -1;
+	}
+	memcpy(fds, CMSG_DATA(cmsg), 2 * sizeof(int));
+	if ((size_t)ret != sizeof(*info) || info->magic != COMPOSITOR_MAGIC ||
+	    info->version != COMPOSITOR_VERSION) {
+		close(fds[0]);
+		close(fds[1]);
+		errno = EPROTO;
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * @brief Connects to the compositing daemon and creates a new layer.
+ *
+ * The layer covers the whole strip of the daemon. Its pixels are written directly
+ * into shared memory: render into ws2812_layer_frame() and ws2812_layer_alpha(),
+ * then make the frame visible with ws2812_layer_publish(). The daemon composites
+ * all layers once per frame period, nothing is copied between the processes.
+ *
+ * A new layer is hidden until it is published for the first time. Its alpha is
+ * 255 (opaque), z is 0, the blend mode WS2812_BLEND_NORMAL and the opacity 255.
+ *
+ * @param socket_path Socket of the daemon, NULL for WS2812_COMPOSITOR_SOCKET.
+ * @return The layer, or NULL on error (check errno for specific error).
+ */
+ws2812_layer *ws2812_layer_connect(const char *socket_path)
+{
+	struct sockaddr_un addr = { .sun_family = AF_UNIX };
+
+	if (!socket_path) {
+		socket_path = WS2812_COMPOSITOR_SOCKET;
+	}
+	if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+		errno = ENAMETOOLONG;
+		return NULL;
+	}
+	strcpy(addr.sun_path, socket_path);
+
+	ws2812_layer *layer = calloc(1, sizeof(ws2812_layer));
+	if (!layer) {
+		return NULL;
+	}
+	layer->event_fd = -1;
+	layer->socket_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	if (layer->socket_fd < 0 ||
+	    connect(layer->socket_fd, (struct sockaddr *)&addr, sizeof(addr)) <
+		    0) {
+		ws2812_layer_close(layer);
+		return NULL;
+	}
+
+	compositor_layer_info info;
+	int fds[2];
+	if (ws2812_layer_receive(layer->socket_fd, &info, fds) < 0) {
+		ws2812_layer_close(layer);
+		return NULL;
+	}
+	layer->event_fd = fds[1];
+	void *shm = mmap(NULL, info.size, PROT_READ | PROT_WRITE, MAP_SHARED,
+			 fds[0], 0);
+	close(fds[0]);
+	if (shm == MAP_FAILED) {
+		ws2812_layer_close(layer);
+		return NULL;
+	}
+	layer->shm = shm;
+	layer->size = info.size;
+
+	uint8_t *planes = (uint8_t *)shm + COMPOSITOR_LAYER_HEADER_SIZE;
+	for (uint32_t b = 0; b < COMPOSITOR_LAYER_BUFFERS; b++) {
+		uint8_t *buffer = planes + b * COMPOSITOR_LAYER_PLANES * info.stride;
+		layer->frames[b] = (ws2812_planar_frame){
+			.length = info.length,
+			.stride = info.stride,
+			.red = buffer,
+			.green = buffer + info.stride,
+			.blue = buffer + 2 * info.stride,
+		};
+		layer->alpha[b] = buffer + 3 * info.stride;
+	}
+	layer->back = 1 - __atomic_load_n(&layer->shm->front, __ATOMIC_ACQUIRE);
+	return layer;
+}
+
+/**
+ * @brief Removes the layer from the daemon and frees it.
+ *
+ * @param layer The layer, may be NULL.
+ */
+void ws2812_layer_close(ws2812_layer *layer)
+{
+	if (!layer) {
+		return;
+	}
+	if (layer->shm) {
+		munmap(layer->shm, layer->size);
+	}
+	if (layer->event_fd >= 0) {
+		close(layer->event_fd);
+	}
+	if (layer->socket_fd >= 0) {
+		close(layer->socket_fd);
+	}
+	free(layer);
+}
+
+/**
+ * @brief Returns the buffer the client renders into.
+ *
+ * The planes point into shared memory. After ws2812_layer_publish() the other
+ * buffer is returned, it still holds the frame published before the last one.
+ * The daemon may still read it until ws2812_layer_wait() returns.
+ *
+ * @param layer The layer.
+ * @return The frame, valid until the layer is closed.
+ */
+ws2812_planar_frame *ws2812_layer_frame(ws2812_layer *layer)
+{
+	return &layer->frames[layer->back];
+}
+
+/**
+ * @brief Returns the alpha plane of the buffer the client renders into.
+ *
+ * 0 is transparent, 255 opaque. Like the color planes it is part of the buffer
+ * and switches with ws2812_layer_publish().
+ *
+ * @param layer The layer.
+ * @return ws2812_layer_frame()->stride bytes.
+ */
+uint8_t *ws2812_layer_alpha(ws2812_layer *layer)
+{
+	return layer->alpha[layer->back];
+}
+
+/**
+ * @brief Publishes the rendered buffer, the next frame of the daemon shows it.
+ *
+ * The buffers are swapped. The daemon may still be reading the previous buffer,
+ * call ws2812_layer_wait() before rendering into the new one: it returns once
+ * the daemon has composited a frame from this publication.
+ *
+ * @param layer The layer.
+ */
+void ws2812_layer_publish(ws2812_layer *layer)
+{
+	__atomic_store_n(&layer->shm->front, layer->back, __ATOMIC_RELEASE);
+	layer->published = __atomic_add_fetch(&layer->shm->published, 1,
+					      __ATOMIC_RELEASE);
+	layer->back = 1 - layer->back;
+}
+
+/**
+ * @brief Sets the stacking order of the layer, takes effect with the next frame.
+ *
+ * @param layer The layer.
+ * @param z Layers with higher values are drawn on top, equal values in the order they were created.
+ */
+void ws2812_layer_set_order(ws2812_layer *layer, int16_t z)
+{
+	__atomic_store_n(&layer->shm->z, z, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Sets how the layer is blended onto the layers below it.
+ *
+ * @param layer The layer.
+ * @param mode Blend mode.
+ * @param opacity Opacity of the whole layer (multiplied with its alpha), 0 hides it.
+ */
+void ws2812_layer_set_blend(ws2812_layer *layer, ws2812_blend_mode mode,
+			    uint8_t opacity)
+{
+	__atomic_store_n(&layer->shm->blend, mode, __ATOMIC_RELAXED);
+	__atomic_store_n(&layer->shm->opacity, opacity, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Returns the eventfd of the frame tick.
+ *
+ * The fd is readable after the daemon composited a frame, event loops can poll
+ * it and call ws2812_layer_wait() then. It only blocks if the tick belongs to a
+ * frame composited before the last ws2812_layer_publish(), until the next one.
+ *
+ * @param layer The layer.
+ * @return The file descriptor, must not be read or closed by the caller.
+ */
+int ws2812_layer_fd(const ws2812_layer *layer)
+{
+	return layer->event_fd;
+}
+
+/**
+ * @brief Waits for the next frame tick in which the daemon read the last publication.
+ *
+ * Ticks left over from frames composited before the last ws2812_layer_publish()
+ * are consumed without returning. Afterwards the daemon no longer reads the
+ * buffer returned by ws2812_layer_frame().
+ *
+ * @param layer The layer.
+ * @return Number of frames composited since the last call, or -1 on error
+ *         (check errno for specific error, EPIPE if the daemon ended).
+ */
+int64_t ws2812_layer_wait(ws2812_layer *layer)
+{
+	struct pollfd fds[2] = {
+		{ .fd = layer->event_fd, .events = POLLIN },
+		{ .fd = layer->socket_fd, .events = POLLIN },
+	};
+	int64_t total = 0;
+
+	do {
+		uint64_t ticks;
+
+		// Ohne Daemon kommt kein Takt mehr, das Ende der Verbindung abbrechen lassen
+		fds[0].revents = 0;
+		while (!(fds[0].revents & POLLIN)) {
+			if (poll(fds, 2, -1) < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				return -1;
+			}
+			if (fds[1].revents & (POLLIN | POLLHUP | POLLERR)) {
+				errno = EPIPE;
+				return -1;
+			}
+		}
+		if (read(layer->event_fd, &ticks, sizeof(ticks)) < 0) {
+			return -1;
+		}
+		total += ticks;
+	} while ((int32_t)(__atomic_load_n(&layer->shm->consumed,
+					   __ATOMIC_ACQUIRE) -
+			   layer->published) < 0);
+	return total;
+}
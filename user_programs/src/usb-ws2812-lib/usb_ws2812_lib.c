@@ -7,44 +7,193 @@
  */
 
 #include "usb_ws2812_lib.h"
+#include "usb_ws2812_private.h"
 #include "dev_packets.h"
 #include <stdio.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <stdint.h>
 #include <string.h>
 #include <stdlib.h>
 
-static uint8_t *transfer_buffer = NULL;
-static size_t transfer_buffer_size = 0;
+/**
+ * @brief Opens a WS2812 device file.
+ *
+ * This function opens the device file and allocates the handle with its transfer
+ * arena. The arena is sized for max_leds pixels, so reading up to max_leds pixels
+ * back doesn't allocate memory afterwards (pixels are sent from the memory of the
+ * caller and never need the arena). Each handle has its own
+ * lock and arena, different handles can be used from different threads without
+ * synchronisation, a single handle may be shared between threads.
+ *
+ * A path starting with WS2812_USB_PATH_PREFIX ("usb:0", "usb:1", ...) opens the
+ * strip with that index directly through libusb instead of the kernel module, see
+ * ws2812_usb_open(). All functions of the library work the same on such a handle.
+ *
+ * @param path Path of the device file (e.g. /dev/usb_ws2812_0) or "usb:<strip>".
+ * @param max_leds Largest number of pixels per request, 0 for WS2812_DEFAULT_MAX_LEDS.
+ * @return The handle, or NULL on error (check errno for specific error).
+ */
+ws2812_handle *ws2812_open(const char *path, uint16_t max_leds)
+{
+	if (strncmp(path, WS2812_USB_PATH_PREFIX,
+		    strlen(WS2812_USB_PATH_PREFIX)) == 0) {
+		return ws2812_usb_open(path + strlen(WS2812_USB_PATH_PREFIX),
+				       max_leds);
+	}
+
+	int fd = open(path, O_RDWR | O_CLOEXEC);
+	if (fd < 0) {
+		return NULL;
+	}
+
+	ws2812_handle *handle = ws2812_open_fd(fd, max_leds);
+	if (!handle) {
+		int err = errno;
+		close(fd);
+		errno = err;
+		return NULL;
+	}
+	handle->owns_fd = true;
+	return handle;
+}
 
 /**
- * @brief Initializes the WS2812 userspace library.
+ * @brief Creates a handle for an already opened device file.
  *
- * This function allocates memory for the transfer buffer used for communication
- * with the kernel module.
+ * Like ws2812_open(), but the file descriptor stays owned by the caller and is
+ * not closed by ws2812_close().
  *
- * @return 1 on success, 0 on failure.
+ * @param fd File descriptor (device file) for the WS2812 LED strip.
+ * @param max_leds Largest number of pixels per request, 0 for WS2812_DEFAULT_MAX_LEDS.
+ * @return The handle, or NULL on error (check errno for specific error).
  */
-int ws2812_init()
+ws2812_handle *ws2812_open_fd(int fd, uint16_t max_leds)
 {
-	transfer_buffer =
-		malloc(sizeof(led_pixel_data) + 100 * sizeof(led_pixel));
-	if (!transfer_buffer) {
-		return 0;
+	if (fd < 0) {
+		errno = EBADF;
+		return NULL;
+	}
+
+	ws2812_handle *handle = ws2812_handle_alloc(max_leds);
+	if (!handle) {
+		return NULL;
+	}
+	handle->fd = fd;
+	return handle;
+}
+
+ws2812_handle *ws2812_handle_alloc(uint16_t max_leds)
+{
+	if (max_leds == 0) {
+		max_leds = WS2812_DEFAULT_MAX_LEDS;
+	}
+
+	ws2812_handle *handle = calloc(1, sizeof(ws2812_handle));
+	if (!handle) {
+		return NULL;
+	}
+	handle->fd = -1;
+	handle->max_leds = max_leds;
+	handle->arena_size = sizeof(led_pixel_data) + max_leds * sizeof(led_pixel);
+	handle->arena = malloc(handle->arena_size);
+	if (!handle->arena) {
+		free(handle);
+		return NULL;
+	}
+	pthread_mutex_init(&handle->lock, NULL);
+	return handle;
+}
+
+/**
+ * @brief Closes a WS2812 device.
+ *
+ * This function frees the handle and its arena and closes the device file if it
+ * was opened by ws2812_open(). The handle must not be used by other threads anymore.
+ *
+ * @param handle The device, may be NULL.
+ */
+void ws2812_close(ws2812_handle *handle)
+{
+	if (!handle) {
+		return;
+	}
+	if (handle->backend) {
+		handle->backend->close(handle);
+	}
+	if (handle->owns_fd) {
+		close(handle->fd);
+	}
+	pthread_mutex_destroy(&handle->lock);
+	free(handle->arena);
+	free(handle);
+}
+
+/**
+ * @brief Returns the file descriptor of the device file.
+ *
+ * @param handle The device.
+ * @return The file descriptor, -1 for a handle of the libusb backend.
+ */
+int ws2812_fd(ws2812_handle *handle)
+{
+	return handle->fd;
+}
+
+uint8_t *ws2812_arena_reserve(ws2812_handle *handle, size_t size)
+{
+	if (handle->arena_size < size) {
+		uint8_t *new_arena = realloc(handle->arena, size);
+		if (new_arena == NULL) {
+			return NULL;
+		}
+		handle->arena = new_arena;
+		handle->arena_size = size;
+	}
+	return handle->arena;
+}
+
+ssize_t ws2812_io_write(ws2812_handle *handle, const void *buf, size_t len)
+{
+	if (handle->backend) {
+		struct iovec iov = { .iov_base = (void *)buf, .iov_len = len };
+		return handle->backend->writev(handle, &iov, 1);
+	}
+	return write(handle->fd, buf, len);
+}
+
+ssize_t ws2812_io_writev(ws2812_handle *handle, const struct iovec *iov,
+			 int iovcnt)
+{
+	if (handle->backend) {
+		return handle->backend->writev(handle, iov, iovcnt);
 	}
-	transfer_buffer_size = sizeof(led_pixel_data) + 100 * sizeof(led_pixel);
-	return 1;
+	return writev(handle->fd, iov, iovcnt);
+}
+
+ssize_t ws2812_io_read(ws2812_handle *handle, void *buf, size_t len)
+{
+	if (handle->backend) {
+		return handle->backend->read(handle, buf, len);
+	}
+	return read(handle->fd, buf, len);
 }
 
 /**
- * @brief Deinitializes the WS2812 userspace library.
+ * @brief Sends a control packet with the lock of the handle held.
  *
- * This function frees the memory allocated for the transfer buffer.
+ * Control packets may change length and mode of the device, so the cache is
+ * invalidated (also if the write failed, the state is unknown then).
  */
-void ws2812_deinit()
+static int ws2812_write_packet(ws2812_handle *handle, const void *buf,
+			       size_t len)
 {
-	free(transfer_buffer);
+	pthread_mutex_lock(&handle->lock);
+	ws2812_cache_invalidate(handle);
+	int ret = ws2812_io_write(handle, buf, len);
+	pthread_mutex_unlock(&handle->lock);
+	return ret;
 }
 
 /**
@@ -53,18 +202,18 @@ void ws2812_deinit()
  * This function sends a command to the kernel module via the device file descriptor
  * to set the length of the LED strip.
  *
- * @param fd File descriptor (device file) for the WS2812 LED strip.
+ * @param handle The WS2812 device.
  * @param length Length (in LED's) of the LED strip.
  * @return Number of bytes written, or -1 on error. (check errno for specific error).
  */
-int ws2812_set_length(int fd, uint16_t length)
+int ws2812_set_length(ws2812_handle *handle, uint16_t length)
 {
 	led_len len_p = {
 		.ctrl = CHAR_LED_LEN,
 		.len = length,
 	};
 
-	return write(fd, &len_p, sizeof(led_len));
+	return ws2812_write_packet(handle, &len_p, sizeof(led_len));
 }
 
 /**
@@ -73,14 +222,33 @@ int ws2812_set_length(int fd, uint16_t length)
  * This function sends a command to the kernel module via the device file descriptor
  * to clear the LED strip.
  *
- * @param fd File descriptor (device file) for the WS2812 LED strip.
+ * @param handle The WS2812 device.
  * @return Number of bytes written, or -1 on error (check errno for specific error).
  */
-int ws2812_clear(int fd)
+int ws2812_clear(ws2812_handle *handle)
 {
 	led_clear clear_p = { .ctrl = CHAR_LED_CLEAR };
 
-	return write(fd, &clear_p, sizeof(led_clear));
+	return ws2812_write_packet(handle, &clear_p, sizeof(led_clear));
+}
+
+/**
+ * @brief Stores the current frame of the WS2812 LED strip as boot frame.
+ *
+ * This function sends a command to the kernel module via the device file descriptor
+ * to store the LED count and pixel data currently shown by the controller in its flash.
+ * The controller shows this frame directly after power-up, before the host has
+ * loaded the kernel module.
+ *
+ * @param handle The WS2812 device.
+ * @return Number of bytes written, or -1 on error (check errno for specific error).
+ */
+int ws2812_save_boot_frame(ws2812_handle *handle)
+{
+	led_save_boot_frame save_p = { .ctrl = CHAR_LED_SAVE_BOOT_FRAME };
+
+	return ws2812_write_packet(handle, &save_p,
+				   sizeof(led_save_boot_frame));
 }
 
 /**
@@ -89,17 +257,18 @@ int ws2812_clear(int fd)
  * This function sends a command to the kernel module via the device file descriptor
  * to set the LED strip to a static mode.
  *
- * @param fd File descriptor (device file) for the WS2812 LED strip.
+ * @param handle The WS2812 device.
  * @return Number of bytes written, or -1 on error (check errno for specific error).
  */
-int ws2812_set_mode_static(int fd)
+int ws2812_set_mode_static(ws2812_handle *handle)
 {
 	led_set_mode_static set_mode_static_p = {
 		.ctrl = CHAR_LED_SET_MODE,
 		.mode = CHAR_LED_MODE_STATIC,
 	};
 
-	return write(fd, &set_mode_static_p, sizeof(led_set_mode_static));
+	return ws2812_write_packet(handle, &set_mode_static_p,
+				   sizeof(led_set_mode_static));
 }
 
 /**
@@ -108,14 +277,14 @@ int ws2812_set_mode_static(int fd)
  * This function sends a command to the kernel module via the device file descriptor
  * to set the LED strip to a blinking mode with specified parameters.
  *
- * @param fd File descriptor (device file) for the WS2812 LED strip.
+ * @param handle The WS2812 device.
  * @param pattern_count Number of blinking patterns.
  * @param pattern_len Length of each blinking pattern.
  * @param delay Delay between each blink in milliseconds.
  * @return Number of bytes written, or -1 on error (check errno for specific error).
  */
-int ws2812_set_mode_blink(int fd, uint16_t pattern_count, uint16_t pattern_len,
-			  uint16_t delay)
+int ws2812_set_mode_blink(ws2812_handle *handle, uint16_t pattern_count,
+			  uint16_t pattern_len, uint16_t delay)
 {
 	led_set_mode_blink set_mode_blink_p = {
 		.ctrl = CHAR_LED_SET_MODE,
@@ -125,7 +294,32 @@ int ws2812_set_mode_blink(int fd, uint16_t pattern_count, uint16_t pattern_len,
 		.blink_period = delay,
 	};
 
-	return write(fd, &set_mode_blink_p, sizeof(led_set_mode_blink));
+	return ws2812_write_packet(handle, &set_mode_blink_p,
+				   sizeof(led_set_mode_blink));
+}
+
+/**
+ * @brief Sends a pixel data packet, the lock of the handle must be held.
+ *
+ * The header and the pixels of the caller are sent with writev(), the pixels
+ * are not copied in the library.
+ */
+static int ws2812_set_led_pixel_locked(ws2812_handle *handle,
+				       uint16_t start_index, uint16_t length,
+				       const led_pixel *pixel_data)
+{
+	led_pixel_data pixel_header = {
+		.ctrl = CHAR_LED_PIXEL_DATA,
+		.offset = start_index,
+		.led_count = length,
+	};
+	struct iovec iov[2] = {
+		{ .iov_base = &pixel_header, .iov_len = sizeof(led_pixel_data) },
+		{ .iov_base = (void *)pixel_data,
+		  .iov_len = length * sizeof(led_pixel) },
+	};
+
+	return ws2812_io_writev(handle, iov, 2);
 }
 
 /**
@@ -134,77 +328,66 @@ int ws2812_set_mode_blink(int fd, uint16_t pattern_count, uint16_t pattern_len,
  * This function sends a command to the kernel module via the device file descriptor
  * to set LED pixels on the LED strip starting from the specified index.
  *
- * @param fd File descriptor (device file) for the WS2812 LED strip.
+ * @param handle The WS2812 device.
  * @param start_index Starting index to set LED pixels.
  * @param length Number of LED pixels to set.
  * @param pixel_data Pointer to an array of LED pixels to set.
  * @return Number of bytes written, or -1 on error (check errno for specific error).
+ *
+ * @note The pixels are passed to the kernel module with writev(), without a copy
+ *       or memory allocation in the library.
  */
-int ws2812_set_led_pixel(int fd, uint16_t start_index, uint16_t length,
-			 led_pixel *pixel_data)
+int ws2812_set_led_pixel(ws2812_handle *handle, uint16_t start_index,
+			 uint16_t length, const led_pixel *pixel_data)
 {
-	size_t required_buffer_size =
-		sizeof(led_pixel_data) + length * sizeof(led_pixel);
-	if (transfer_buffer_size < required_buffer_size) {
-		uint8_t *new_transfer_buffer =
-			realloc(transfer_buffer, required_buffer_size);
-		if (new_transfer_buffer == NULL) {
-			return -1;
-		}
-		transfer_buffer = new_transfer_buffer;
-	}
-
-	led_pixel_data pixel_header = {
-		.ctrl = CHAR_LED_PIXEL_DATA,
-		.offset = start_index,
-		.led_count = length,
-	};
-
-	memcpy(transfer_buffer, &pixel_header, sizeof(led_pixel_data));
-	memcpy(transfer_buffer + sizeof(led_pixel_data), pixel_data,
-	       length * sizeof(led_pixel));
-
-	return write(fd, transfer_buffer, required_buffer_size);
+	pthread_mutex_lock(&handle->lock);
+	int ret = ws2812_set_led_pixel_locked(handle, start_index, length,
+					      pixel_data);
+	pthread_mutex_unlock(&handle->lock);
+	return ret;
 }
 
 /**
- * @brief Sets the blinking pattern for the WS2812 LED strip.
+ * @brief Sets several ranges of LED pixels with a single writev().
  *
- * This function sets the blinking pattern for the LED strip if it's currently in blinking mode.
- * It checks if the provided pattern fits inside the current pattern buffer of the kernel module
- * and if the blink mode is active.
+ * The pixel data of every region stays in the memory of the caller, only the packet
+ * headers are built by the library. The kernel module sends the pixel buffer to the
+ * controller once for all regions.
  *
- * @param fd File descriptor (device file) for the WS2812 LED strip.
- * @param pattern Pointer to the blinking pattern to set.
- * @return 0 on success, -1 on error (check errno for specific error).
+ * @param handle The WS2812 device.
+ * @param regions The ranges and their pixel data.
+ * @param count Number of regions, at most WS2812_MAX_REGIONS.
+ * @return Number of bytes written, or -1 on error (check errno for specific error).
  */
-int ws2812_set_blink_pattern(int fd, ws2812_pattern *pattern)
+int ws2812_set_led_regions(ws2812_handle *handle, const ws2812_region *regions,
+			   size_t count)
 {
-	// Check mode
-	led_set_mode mode_data;
-	LED_MODE mode = ws2812_get_mode(fd, &mode_data);
-	if (CHAR_LED_MODE_BLINK != mode) {
-		printf("Blink mode is not active.\n");
-		return -1; // nicht im richtigen Modus
-	}
-
-	// check pattern parameter
-	if (pattern->length != mode_data.set_blink.pattern_len) {
-		printf("Pattern length mismatch: driver %d, new pattern %d\n",
-		       mode_data.set_blink.pattern_len, pattern->length);
+	if (count > WS2812_MAX_REGIONS) {
 		errno = EINVAL;
 		return -1;
 	}
-	if (pattern->pattern_states != mode_data.set_blink.pattern_count) {
-		printf("Pattern state mismatch: driver %d, new pattern %d\n",
-		       mode_data.set_blink.pattern_count,
-		       pattern->pattern_states);
-		errno = EINVAL;
-		return -1;
+	if (count == 0) {
+		return 0;
 	}
 
-	uint16_t data_len = pattern->length * pattern->pattern_states;
-	return ws2812_set_led_pixel(fd, 0, data_len, pattern->pattern_data);
+	led_pixel_data headers[WS2812_MAX_REGIONS];
+	struct iovec iov[2 * WS2812_MAX_REGIONS];
+	for (size_t i = 0; i < count; i++) {
+		headers[i] = (led_pixel_data){
+			.ctrl = CHAR_LED_PIXEL_DATA,
+			.offset = regions[i].start_index,
+			.led_count = regions[i].length,
+		};
+		iov[2 * i].iov_base = &headers[i];
+		iov[2 * i].iov_len = sizeof(led_pixel_data);
+		iov[2 * i + 1].iov_base = (void *)regions[i].pixel_data;
+		iov[2 * i + 1].iov_len = regions[i].length * sizeof(led_pixel);
+	}
+
+	pthread_mutex_lock(&handle->lock);
+	int ret = ws2812_io_writev(handle, iov, 2 * count);
+	pthread_mutex_unlock(&handle->lock);
+	return ret;
 }
 
 /**
@@ -214,11 +397,11 @@ int ws2812_set_blink_pattern(int fd, ws2812_pattern *pattern)
  * to retrieve LED data of the specified type. If successful, the kernel module will prepare to return the
  * requested data upon the next read operation.
  *
- * @param fd File descriptor (device file) for the WS2812 LED strip.
+ * @param handle The WS2812 device, the lock must be held until the answer is read.
  * @param data_type Type of LED data to retrieve.
  * @return 0 on success, -1 on error (check errno for specific error).
  */
-static int ws2812_send_get_data(int fd, LED_DATA_ID data_type)
+static int ws2812_send_get_data(ws2812_handle *handle, LED_DATA_ID data_type)
 {
 	// Construct the LED data request
 	led_get_data get_len = {
@@ -228,80 +411,62 @@ static int ws2812_send_get_data(int fd, LED_DATA_ID data_type)
 	};
 
 	// Send the request to the kernel module
-	if (write(fd, &get_len, sizeof(led_get_data)) < 0) {
+	if (ws2812_io_write(handle, &get_len, sizeof(led_get_data)) < 0) {
 		return -1;
 	}
 	return 0;
 }
 
 /**
- * @brief Retrieves the current operation mode of the WS2812 LED strip from the kernel module.
- *
- * This function sends a request to the kernel module via the provided device file descriptor
- * to retrieve the current operation mode of the WS2812 LED strip. It reads the response from the kernel
- * module and stores it in the provided structure.
- *
- * @param fd File descriptor (device file) for the WS2812 LED strip.
- * @param result Pointer to the structure where the result will be stored.
- * @return The operation mode id on success, -1 on error (check errno for specific error).
- *
- * @note The operation modes determine how the kernel module controls the WS2812 LED strip.
- * The mode ID is represented by the enum constant DATA_MODE defined in dev_packets.h.
+ * @brief ws2812_get_mode() with the lock of the handle held.
  */
-int ws2812_get_mode(int fd, led_set_mode *result)
+static int ws2812_get_mode_locked(ws2812_handle *handle, led_set_mode *result)
 {
-	if (ws2812_send_get_data(fd, DATA_MODE)) {
-		return -1;
-	}
+	if (!handle->mode_valid) {
+		if (ws2812_send_get_data(handle, DATA_MODE)) {
+			return -1;
+		}
 
-	if (read(fd, result, sizeof(led_set_mode)) < 0) {
-		return -1;
+		if (ws2812_io_read(handle, &handle->mode,
+				   sizeof(led_set_mode)) < 0) {
+			return -1;
+		}
+		handle->mode_valid = true;
 	}
 
+	*result = handle->mode;
 	return result->set_mode.mode;
 }
 
 /**
- * @brief Retrieves the length of the WS2812 LED strip from the kernel module.
- *
- * This function sends a request to the kernel module via the provided device file descriptor
- * to retrieve the length of the WS2812 LED strip. It reads the response from the kernel
- * module and returns the length of the LED strip.
- *
- * @param fd File descriptor (device file) for the WS2812 LED strip.
- * @return The length of the LED strip on success, -1 on error (check errno for specific error).
+ * @brief ws2812_get_length() with the lock of the handle held.
  */
-extern int ws2812_get_length(int fd)
+static int ws2812_get_length_locked(ws2812_handle *handle)
 {
-	if (ws2812_send_get_data(fd, DATA_LEN)) {
-		return -1;
-	}
+	if (!handle->length_valid) {
+		if (ws2812_send_get_data(handle, DATA_LEN)) {
+			return -1;
+		}
 
-	led_len result;
+		led_len result;
 
-	if (read(fd, &result, sizeof(led_len)) < 0) {
-		return -1;
+		if (ws2812_io_read(handle, &result, sizeof(led_len)) < 0) {
+			return -1;
+		}
+		handle->length = result.len;
+		handle->length_valid = true;
 	}
 
-	return result.len;
+	return handle->length;
 }
 
 /**
- * @brief Retrieves the length of the internal data buffer corresponding to the current mode of the WS2812 LED strip.
- *
- * This function retrieves the length of the internal data buffer corresponding to the current mode of the WS2812 LED strip
- * from the kernel module. The length depends on the current mode of operation, where the static mode saves the pixel data
- * of the LED strip, and the blink mode saves the pattern data.
- *
- * @param fd File descriptor (device file) for the WS2812 LED strip.
- * @return The length of the internal data buffer corresponding to the current mode on success, -1 on error or invalid mode.
- *
- * @note This function determines the appropriate data length based on the current mode of the LED strip.
+ * @brief ws2812_get_mode_data_length() with the lock of the handle held.
  */
-int ws2812_get_mode_data_length(int fd)
+static int ws2812_get_mode_data_length_locked(ws2812_handle *handle)
 {
 	led_set_mode mode;
-	int mode_id = ws2812_get_mode(fd, &mode);
+	int mode_id = ws2812_get_mode_locked(handle, &mode);
 	if (mode_id < 0) {
 		return mode_id; // error
 	}
@@ -309,7 +474,7 @@ int ws2812_get_mode_data_length(int fd)
 	int length = 0;
 	switch (mode_id) {
 	case CHAR_LED_MODE_STATIC:
-		length = ws2812_get_length(fd);
+		length = ws2812_get_length_locked(handle);
 		break;
 	case CHAR_LED_MODE_BLINK:
 		length = mode.set_blink.pattern_count *
@@ -323,52 +488,32 @@ int ws2812_get_mode_data_length(int fd)
 }
 
 /**
- * @brief Requests LED pixel data from the WS2812 LED strip (USB device).
- *
- * This function sends a request to the kernel module via the provided device file descriptor
- * to obtain LED pixel data from the WS2812 LED strip (USB device). It retrieves the length
- * of the LED strip to ensure correct buffer sizes, sends the request to the kernel module,
- * and reads the received data into the result buffer.
- *
- * @param fd File descriptor (device file) for the WS2812 LED strip.
- * @param result Pointer to the structure where the LED pixel data will be stored.
- * @return 0 on success, -1 on error (check errno for specific error).
- *
- * @note Ensure that the size of the result buffer matches the length of the LED strip.
- * 		 This function communicates with the USB device to retrieve LED pixel data. 
- * 	     If the buffer length of the result does not match the length of the LED strip, 
- *       the function returns an error.
+ * @brief Reads pixel data of the given type into result, the lock must be held.
  */
-int ws2812_get_data(int fd, ws2812_pixel_buffer *result)
+static int ws2812_read_pixel_data_locked(ws2812_handle *handle,
+					 LED_DATA_ID data_type, int length,
+					 ws2812_pixel_buffer *result)
 {
-	int length = ws2812_get_length(fd);
-	if (length < 0) {
-		return length;
-	}
-
 	if (result->length != length) {
 		errno = EINVAL;
 		printf("Pixelbuffersize doesn't match!\n");
 		return -1;
 	}
 
-	if (ws2812_send_get_data(fd, DATA_PIXEL)) {
-		return -1;
-	}
 	size_t required_transfer_buffer_size =
 		sizeof(led_pixel_data) + sizeof(led_pixel) * length;
+	uint8_t *transfer_buffer =
+		ws2812_arena_reserve(handle, required_transfer_buffer_size);
+	if (transfer_buffer == NULL) {
+		return -1;
+	}
 
-	if (transfer_buffer_size < required_transfer_buffer_size) {
-		uint8_t *new_transfer_buffer =
-			realloc(transfer_buffer, required_transfer_buffer_size);
-		if (new_transfer_buffer == NULL) {
-			return -1;
-		}
-		transfer_buffer = new_transfer_buffer;
+	if (ws2812_send_get_data(handle, data_type)) {
+		return -1;
 	}
 
-	int read_count =
-		read(fd, transfer_buffer, required_transfer_buffer_size);
+	int read_count = ws2812_io_read(handle, transfer_buffer,
+					required_transfer_buffer_size);
 	if (read_count < 0) {
 		return -1;
 	}
@@ -381,6 +526,168 @@ int ws2812_get_data(int fd, ws2812_pixel_buffer *result)
 	return 0;
 }
 
+/**
+ * @brief Reloads the cached length and mode from the device.
+ *
+ * The library caches length and mode after the first query and only invalidates
+ * them on its own writes. Call this function if another program or a write to
+ * ws2812_fd() may have changed them.
+ *
+ * @param handle The WS2812 device.
+ * @return 0 on success, -1 on error (check errno for specific error).
+ */
+int ws2812_refresh(ws2812_handle *handle)
+{
+	led_set_mode mode;
+	int ret = -1;
+
+	pthread_mutex_lock(&handle->lock);
+	ws2812_cache_invalidate(handle);
+	if (ws2812_get_length_locked(handle) >= 0 &&
+	    ws2812_get_mode_locked(handle, &mode) >= 0) {
+		ret = 0;
+	}
+	pthread_mutex_unlock(&handle->lock);
+	return ret;
+}
+
+/**
+ * @brief Sets the blinking pattern for the WS2812 LED strip.
+ *
+ * This function sets the blinking pattern for the LED strip if it's currently in blinking mode.
+ * It checks if the provided pattern fits inside the current pattern buffer of the kernel module
+ * and if the blink mode is active.
+ *
+ * @param handle The WS2812 device.
+ * @param pattern Pointer to the blinking pattern to set.
+ * @return 0 on success, -1 on error (check errno for specific error).
+ */
+int ws2812_set_blink_pattern(ws2812_handle *handle, ws2812_pattern *pattern)
+{
+	int ret = -1;
+
+	pthread_mutex_lock(&handle->lock);
+
+	// Check mode
+	led_set_mode mode_data;
+	LED_MODE mode = ws2812_get_mode_locked(handle, &mode_data);
+	if (CHAR_LED_MODE_BLINK != mode) {
+		printf("Blink mode is not active.\n");
+		goto out; // nicht im richtigen Modus
+	}
+
+	// check pattern parameter
+	if (pattern->length != mode_data.set_blink.pattern_len) {
+		printf("Pattern length mismatch: driver %d, new pattern %d\n",
+		       mode_data.set_blink.pattern_len, pattern->length);
+		errno = EINVAL;
+		goto out;
+	}
+	if (pattern->pattern_states != mode_data.set_blink.pattern_count) {
+		printf("Pattern state mismatch: driver %d, new pattern %d\n",
+		       mode_data.set_blink.pattern_count,
+		       pattern->pattern_states);
+		errno = EINVAL;
+		goto out;
+	}
+
+	uint16_t data_len = pattern->length * pattern->pattern_states;
+	ret = ws2812_set_led_pixel_locked(handle, 0, data_len,
+					  pattern->pattern_data);
+out:
+	pthread_mutex_unlock(&handle->lock);
+	return ret;
+}
+
+/**
+ * @brief Retrieves the current operation mode of the WS2812 LED strip from the kernel module.
+ *
+ * This function sends a request to the kernel module via the provided device file descriptor
+ * to retrieve the current operation mode of the WS2812 LED strip. It reads the response from the kernel
+ * module and stores it in the provided structure.
+ *
+ * @param handle The WS2812 device.
+ * @param result Pointer to the structure where the result will be stored.
+ * @return The operation mode id on success, -1 on error (check errno for specific error).
+ *
+ * @note The operation modes determine how the kernel module controls the WS2812 LED strip.
+ * The mode ID is represented by the enum constant DATA_MODE defined in dev_packets.h.
+ */
+int ws2812_get_mode(ws2812_handle *handle, led_set_mode *result)
+{
+	pthread_mutex_lock(&handle->lock);
+	int ret = ws2812_get_mode_locked(handle, result);
+	pthread_mutex_unlock(&handle->lock);
+	return ret;
+}
+
+/**
+ * @brief Retrieves the length of the WS2812 LED strip from the kernel module.
+ *
+ * This function sends a request to the kernel module via the provided device file descriptor
+ * to retrieve the length of the WS2812 LED strip. It reads the response from the kernel
+ * module and returns the length of the LED strip.
+ *
+ * @param handle The WS2812 device.
+ * @return The length of the LED strip on success, -1 on error (check errno for specific error).
+ */
+int ws2812_get_length(ws2812_handle *handle)
+{
+	pthread_mutex_lock(&handle->lock);
+	int ret = ws2812_get_length_locked(handle);
+	pthread_mutex_unlock(&handle->lock);
+	return ret;
+}
+
+/**
+ * @brief Retrieves the length of the internal data buffer corresponding to the current mode of the WS2812 LED strip.
+ *
+ * This function retrieves the length of the internal data buffer corresponding to the current mode of the WS2812 LED strip
+ * from the kernel module. The length depends on the current mode of operation, where the static mode saves the pixel data
+ * of the LED strip, and the blink mode saves the pattern data.
+ *
+ * @param handle The WS2812 device.
+ * @return The length of the internal data buffer corresponding to the current mode on success, -1 on error or invalid mode.
+ *
+ * @note This function determines the appropriate data length based on the current mode of the LED strip.
+ */
+int ws2812_get_mode_data_length(ws2812_handle *handle)
+{
+	pthread_mutex_lock(&handle->lock);
+	int ret = ws2812_get_mode_data_length_locked(handle);
+	pthread_mutex_unlock(&handle->lock);
+	return ret;
+}
+
+/**
+ * @brief Requests LED pixel data from the WS2812 LED strip (USB device).
+ *
+ * This function sends a request to the kernel module via the provided device file descriptor
+ * to obtain LED pixel data from the WS2812 LED strip (USB device). It retrieves the length
+ * of the LED strip to ensure correct buffer sizes, sends the request to the kernel module,
+ * and reads the received data into the result buffer.
+ *
+ * @param handle The WS2812 device.
+ * @param result Pointer to the structure where the LED pixel data will be stored.
+ * @return 0 on success, -1 on error (check errno for specific error).
+ *
+ * @note Ensure that the size of the result buffer matches the length of the LED strip.
+ * 		 This function communicates with the USB device to retrieve LED pixel data.
+ * 	     If the buffer length of the result does not match the length of the LED strip,
+ *       the function returns an error.
+ */
+int ws2812_get_data(ws2812_handle *handle, ws2812_pixel_buffer *result)
+{
+	pthread_mutex_lock(&handle->lock);
+	int ret = ws2812_get_length_locked(handle);
+	if (ret >= 0) {
+		ret = ws2812_read_pixel_data_locked(handle, DATA_PIXEL, ret,
+						    result);
+	}
+	pthread_mutex_unlock(&handle->lock);
+	return ret;
+}
+
 /**
  * @brief Requests mode-specific data from the kernel module.
  *
@@ -389,7 +696,7 @@ int ws2812_get_data(int fd, ws2812_pixel_buffer *result)
  * of the mode-specific data to ensure correct buffer sizes, sends the request to the kernel module,
  * and reads the received data into the result buffer.
  *
- * @param fd File descriptor (device file) for the WS2812 LED strip.
+ * @param handle The WS2812 device.
  * @param result Pointer to the structure where the mode-specific data will be stored.
  * @return 0 on success, -1 on error (check errno for specific error).
  *
@@ -397,44 +704,14 @@ int ws2812_get_data(int fd, ws2812_pixel_buffer *result)
  *       stored inside the kernel module for the static mode. Ensure that the size of the result buffer
  *       matches the length of the mode-specific data.
  */
-int ws2812_get_mode_data(int fd, ws2812_pixel_buffer *result)
+int ws2812_get_mode_data(ws2812_handle *handle, ws2812_pixel_buffer *result)
 {
-	int length = ws2812_get_mode_data_length(fd);
-	if (length < 0) {
-		return length;
-	}
-
-	if (result->length != length) {
-		errno = EINVAL;
-		printf("Pixelbuffersize doesn't match!\n");
-		return -1;
-	}
-
-	if (ws2812_send_get_data(fd, DATA_MODE_PIXEL)) {
-		return -1;
-	}
-	size_t required_transfer_buffer_size =
-		sizeof(led_pixel_data) + sizeof(led_pixel) * length;
-
-	if (transfer_buffer_size < required_transfer_buffer_size) {
-		uint8_t *new_transfer_buffer =
-			realloc(transfer_buffer, required_transfer_buffer_size);
-		if (new_transfer_buffer == NULL) {
-			return -1;
-		}
-		transfer_buffer = new_transfer_buffer;
-	}
-
-	int read_count =
-		read(fd, transfer_buffer, required_transfer_buffer_size);
-	if (read_count < 0) {
-		return -1;
+	pthread_mutex_lock(&handle->lock);
+	int ret = ws2812_get_mode_data_length_locked(handle);
+	if (ret >= 0) {
+		ret = ws2812_read_pixel_data_locked(handle, DATA_MODE_PIXEL,
+						    ret, result);
 	}
-
-	memcpy(result->pixel_data, transfer_buffer + sizeof(led_pixel_data),
-	       required_transfer_buffer_size - sizeof(led_pixel_data));
-	led_pixel_data *header = (led_pixel_data *)transfer_buffer;
-	printf("Got led_pixel_data{ offset=%d, count=%d}\n", header->offset,
-	       header->led_count);
-	return 0;
-}
\ No newline at end of file
+	pthread_mutex_unlock(&handle->lock);
+	return ret;
+}
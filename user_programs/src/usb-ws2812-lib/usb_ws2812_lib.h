@@ -9,9 +9,15 @@
 #ifndef USB_WS2812_H
 #define USB_WS2812_H
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include "dev_packets.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /**
  * @brief Structure representing a pattern for the WS2812 LED strip.
  */
@@ -29,21 +35,509 @@ typedef struct ws2812_pixel_buffer_s {
 	led_pixel *pixel_data; // Pointer to the pixel data array.
 } ws2812_pixel_buffer;
 
-extern int ws2812_init();
-extern void ws2812_deinit();
-extern int ws2812_set_length(int fd, uint16_t length);
-extern int ws2812_clear(int fd);
-extern int ws2812_set_mode_static(int fd);
-extern int ws2812_set_mode_blink(int fd, uint16_t pattern_count,
+/**
+ * @brief Range of LED pixels for ws2812_set_led_regions().
+ */
+typedef struct ws2812_region_s {
+	uint16_t start_index; // Index of the first LED of the range.
+	uint16_t length; // Number of LEDs in the range.
+	const led_pixel *pixel_data; // Pixel data of the range, owned by the caller.
+} ws2812_region;
+
+/**
+ * @def WS2812_MAX_REGIONS
+ * @brief Largest number of regions per ws2812_set_led_regions() call (two iovecs per region).
+ */
+#define WS2812_MAX_REGIONS 64
+
+/**
+ * @def WS2812_DEFAULT_MAX_LEDS
+ * @brief Arena size used by ws2812_open() if max_leds is 0 (buffer size of the controller).
+ */
+#define WS2812_DEFAULT_MAX_LEDS 1000
+
+/**
+ * @def WS2812_USB_PATH_PREFIX
+ * @brief Path prefix of ws2812_open() for the libusb backend ("usb:0" is the first strip).
+ */
+#define WS2812_USB_PATH_PREFIX "usb:"
+
+/**
+ * @brief Opaque handle of an opened WS2812 device, see ws2812_open().
+ */
+typedef struct ws2812_handle_s ws2812_handle;
+
+extern ws2812_handle *ws2812_open(const char *path, uint16_t max_leds);
+extern ws2812_handle *ws2812_open_fd(int fd, uint16_t max_leds);
+extern void ws2812_close(ws2812_handle *handle);
+extern int ws2812_fd(ws2812_handle *handle);
+extern int ws2812_refresh(ws2812_handle *handle);
+
+extern int ws2812_set_length(ws2812_handle *handle, uint16_t length);
+extern int ws2812_clear(ws2812_handle *handle);
+extern int ws2812_save_boot_frame(ws2812_handle *handle);
+extern int ws2812_set_mode_static(ws2812_handle *handle);
+extern int ws2812_set_mode_blink(ws2812_handle *handle, uint16_t pattern_count,
 				 uint16_t pattern_len, uint16_t delay);
-extern int ws2812_set_led_pixel(int fd, uint16_t start_index, uint16_t length,
-				led_pixel *pixel_data);
-extern int ws2812_set_blink_pattern(int fd, ws2812_pattern *pattern);
+extern int ws2812_set_led_pixel(ws2812_handle *handle, uint16_t start_index,
+				uint16_t length, const led_pixel *pixel_data);
+extern int ws2812_set_led_regions(ws2812_handle *handle,
+				  const ws2812_region *regions, size_t count);
+extern int ws2812_set_blink_pattern(ws2812_handle *handle,
+				    ws2812_pattern *pattern);
+
+extern int ws2812_get_length(ws2812_handle *handle);
+extern int ws2812_get_mode_data_length(ws2812_handle *handle);
+extern int ws2812_get_data(ws2812_handle *handle, ws2812_pixel_buffer *result);
+extern int ws2812_get_mode_data(ws2812_handle *handle,
+				ws2812_pixel_buffer *result);
+extern int ws2812_get_mode(ws2812_handle *handle, led_set_mode *result);
+
+/**
+ * @brief Opaque batch of packets that is sent with a single write(), see ws2812_batch_create().
+ */
+typedef struct ws2812_batch_s ws2812_batch;
+
+extern ws2812_batch *ws2812_batch_create(ws2812_handle *handle);
+extern void ws2812_batch_free(ws2812_batch *batch);
+extern void ws2812_batch_reset(ws2812_batch *batch);
+extern ws2812_handle *ws2812_batch_handle(const ws2812_batch *batch);
+extern size_t ws2812_batch_length(const ws2812_batch *batch);
+extern int ws2812_batch_set_length(ws2812_batch *batch, uint16_t length);
+extern int ws2812_batch_clear(ws2812_batch *batch);
+extern int ws2812_batch_set_mode_static(ws2812_batch *batch);
+extern int ws2812_batch_set_mode_blink(ws2812_batch *batch,
+				       uint16_t pattern_count,
+				       uint16_t pattern_len, uint16_t delay);
+extern int ws2812_batch_set_led_pixel(ws2812_batch *batch, uint16_t start_index,
+				      uint16_t length,
+				      const led_pixel *pixel_data);
+extern int ws2812_batch_submit(ws2812_batch *batch);
+
+/**
+ * @brief Statistics of a shadow frame, see ws2812_shadow_get_stats().
+ */
+typedef struct ws2812_shadow_stats_s {
+	uint64_t full_frames; // Frames sent completely.
+	uint64_t diff_frames; // Frames sent as changed ranges.
+	uint64_t skipped_frames; // Frames without changes (nothing sent).
+	uint64_t regions_sent; // Ranges sent in diff frames.
+	uint64_t bytes_sent; // Bytes written to the kernel module.
+	uint64_t bytes_full; // Bytes that full frames would have needed.
+} ws2812_shadow_stats;
+
+/**
+ * @brief Opaque shadow of the last submitted frame, see ws2812_shadow_create().
+ */
+typedef struct ws2812_shadow_s ws2812_shadow;
+
+extern ws2812_shadow *ws2812_shadow_create(ws2812_handle *handle,
+					   uint16_t length);
+extern void ws2812_shadow_free(ws2812_shadow *shadow);
+extern void ws2812_shadow_invalidate(ws2812_shadow *shadow);
+extern int ws2812_shadow_submit(ws2812_shadow *shadow, const led_pixel *frame);
+extern void ws2812_shadow_get_stats(const ws2812_shadow *shadow,
+				    ws2812_shadow_stats *stats);
+
+/**
+ * @brief Policy of ws2812_queue_publish() if the frame queue is full.
+ */
+typedef enum ws2812_queue_policy_e {
+	WS2812_QUEUE_DROP_OLDEST, /**< Remove the oldest queued frame (lowest latency). */
+	WS2812_QUEUE_DROP_NEWEST, /**< Discard the published frame. */
+	WS2812_QUEUE_BLOCK /**< Wait until the sender took a frame. */
+} ws2812_queue_policy;
+
+/**
+ * @brief Timing of one stage of the frame queue.
+ */
+typedef struct ws2812_stage_stats_s {
+	uint64_t count; // Number of measurements.
+	uint64_t total_ns; // Sum of all measurements.
+	uint64_t max_ns; // Longest measurement.
+} ws2812_stage_stats;
+
+/**
+ * @brief Statistics of a frame queue, see ws2812_queue_get_stats().
+ */
+typedef struct ws2812_queue_stats_s {
+	ws2812_stage_stats render; // From ws2812_queue_acquire() to ws2812_queue_publish().
+	ws2812_stage_stats queue; // From publishing until the sender took the frame.
+	ws2812_stage_stats submit; // Write of the frame to the kernel module.
+	uint64_t published; // Frames queued.
+	uint64_t dropped; // Frames dropped because the queue was full.
+	uint64_t errors; // Frames the sender failed to write.
+} ws2812_queue_stats;
+
+/**
+ * @brief Opaque frame queue with a sender thread, see ws2812_queue_create().
+ */
+typedef struct ws2812_frame_queue_s ws2812_frame_queue;
+
+extern ws2812_frame_queue *ws2812_queue_create(ws2812_handle *handle,
+					       uint16_t length, uint32_t slots,
+					       ws2812_queue_policy policy);
+extern void ws2812_queue_destroy(ws2812_frame_queue *queue);
+extern led_pixel *ws2812_queue_acquire(ws2812_frame_queue *queue);
+extern int ws2812_queue_publish(ws2812_frame_queue *queue);
+extern void ws2812_queue_get_stats(ws2812_frame_queue *queue,
+				   ws2812_queue_stats *stats);
+
+/**
+ * @brief Output channel order of a color pipeline.
+ *
+ * Names the input channels written to the red, green and blue field of led_pixel,
+ * for strips whose LEDs expect another order than the controller sends.
+ */
+typedef enum ws2812_channel_order_e {
+	WS2812_ORDER_RGB,
+	WS2812_ORDER_RBG,
+	WS2812_ORDER_GRB,
+	WS2812_ORDER_GBR,
+	WS2812_ORDER_BRG,
+	WS2812_ORDER_BGR
+} ws2812_channel_order;
+
+/**
+ * @brief Instruction set of a color pipeline kernel.
+ */
+typedef enum ws2812_isa_e {
+	WS2812_ISA_AUTO, /**< Fastest one the CPU supports. */
+	WS2812_ISA_SCALAR,
+	WS2812_ISA_SSSE3,
+	WS2812_ISA_AVX2,
+	WS2812_ISA_NEON
+} ws2812_isa;
+
+/**
+ * @brief Configuration of a color pipeline.
+ */
+typedef struct ws2812_color_config_s {
+	double gamma; // Gamma exponent, 1.0 (linear) ... 4.0.
+	uint8_t brightness; // Global brightness, 255 = full.
+	uint8_t white_balance[3]; // Gain of red, green and blue, 255 = full.
+	ws2812_channel_order order; // Output channel order.
+} ws2812_color_config;
+
+/**
+ * @brief Opaque color pipeline, see ws2812_color_create().
+ */
+typedef struct ws2812_color_pipeline_s ws2812_color_pipeline;
+
+extern ws2812_color_pipeline *
+ws2812_color_create(const ws2812_color_config *config);
+extern void ws2812_color_free(ws2812_color_pipeline *pipeline);
+extern int ws2812_color_set_isa(ws2812_color_pipeline *pipeline,
+				ws2812_isa isa);
+extern ws2812_isa ws2812_color_get_isa(const ws2812_color_pipeline *pipeline);
+extern const char *ws2812_isa_name(ws2812_isa isa);
+extern int ws2812_isa_limit(ws2812_isa isa);
+extern void ws2812_color_apply(const ws2812_color_pipeline *pipeline,
+			       led_pixel *dst, const led_pixel *src,
+			       size_t count);
+
+/**
+ * @brief Color in HSV, same size and layout as led_pixel.
+ */
+typedef struct ws2812_hsv_s {
+	uint8_t hue; // 0 ... 255 is one turn of 256 steps (0 red, ~85 green, ~171 blue).
+	uint8_t saturation; // 0 white ... 255 full color.
+	uint8_t value; // Brightness, 0 off ... 255 full.
+} ws2812_hsv;
+
+/**
+ * @brief Opaque color palette for gradients, see ws2812_palette_create().
+ */
+typedef struct ws2812_palette_s ws2812_palette;
+
+extern void ws2812_hsv_to_rgb(led_pixel *dst, const ws2812_hsv *src,
+			      size_t count);
+extern ws2812_palette *ws2812_palette_create(const led_pixel *colors,
+					     size_t count, bool wrap);
+extern void ws2812_palette_free(ws2812_palette *palette);
+extern void ws2812_palette_map(const ws2812_palette *palette, led_pixel *dst,
+			       const uint16_t *positions, size_t count);
+
+/**
+ * @def WS2812_PLANAR_ALIGN
+ * @brief Alignment and padding of the planes of a ws2812_planar_frame (one cache line).
+ */
+#define WS2812_PLANAR_ALIGN 64
+
+/**
+ * @brief Frame with one array per channel, see ws2812_planar_create().
+ *
+ * Effects can process the planes with vector instructions without handling
+ * 3 byte pixels. Each plane is WS2812_PLANAR_ALIGN aligned and holds stride bytes,
+ * values behind length are padding and never sent.
+ */
+typedef struct ws2812_planar_frame_s {
+	uint16_t length; // Number of LEDs.
+	size_t stride; // Bytes per plane, length rounded up to WS2812_PLANAR_ALIGN.
+	uint8_t *red; // Red plane.
+	uint8_t *green; // Green plane.
+	uint8_t *blue; // Blue plane.
+} ws2812_planar_frame;
+
+extern ws2812_planar_frame *ws2812_planar_create(uint16_t length);
+extern void ws2812_planar_free(ws2812_planar_frame *frame);
+extern void ws2812_planar_to_pixels(const ws2812_planar_frame *frame,
+				    led_pixel *dst);
+extern void ws2812_planar_from_pixels(ws2812_planar_frame *frame,
+				      const led_pixel *src);
+extern int ws2812_planar_submit(ws2812_handle *handle, uint16_t start_index,
+				const ws2812_planar_frame *frame);
+
+/**
+ * @brief Blend mode of ws2812_planar_blend().
+ *
+ * Every mode computes a target color from the destination d and the source s,
+ * the destination is then moved towards it by the opacity of the pixel.
+ */
+typedef enum ws2812_blend_mode_e {
+	WS2812_BLEND_NORMAL, /**< s, the source covers the destination. */
+	WS2812_BLEND_ADD, /**< d + s, saturated at 255. */
+	WS2812_BLEND_MULTIPLY, /**< d * s / 255, darkens. */
+	WS2812_BLEND_SCREEN, /**< 255 - (255 - d) * (255 - s) / 255, brightens. */
+	WS2812_BLEND_MODE_LENGTH /**< Number of blend modes. */
+} ws2812_blend_mode;
+
+extern void ws2812_planar_blend(ws2812_planar_frame *dst,
+				const ws2812_planar_frame *src,
+				const uint8_t *alpha, uint8_t opacity,
+				ws2812_blend_mode mode);
+
+/**
+ * @brief Color matrix and range of ws2812_planar_from_yuv().
+ */
+typedef enum ws2812_yuv_matrix_e {
+	WS2812_YUV_BT601, /**< SD video, limited range (Y 16 ... 235). */
+	WS2812_YUV_BT709, /**< HD video, limited range. */
+	WS2812_YUV_BT601_FULL, /**< SD video or JPEG, full range (Y 0 ... 255). */
+	WS2812_YUV_BT709_FULL, /**< HD video, full range. */
+	WS2812_YUV_MATRIX_LENGTH /**< Number of matrices, other values convert as WS2812_YUV_BT601. */
+} ws2812_yuv_matrix;
+
+extern void ws2812_planar_from_yuv(ws2812_planar_frame *frame,
+				   const uint8_t *y, const uint8_t *u,
+				   const uint8_t *v, ws2812_yuv_matrix matrix);
+
+/**
+ * @def WS2812_COMPOSITOR_SOCKET
+ * @brief Default socket of the compositing daemon (usb-ws2812-compositor).
+ */
+#define WS2812_COMPOSITOR_SOCKET "/run/usb_ws2812_0.sock"
+
+/**
+ * @brief Opaque layer of the compositing daemon, see ws2812_layer_connect().
+ */
+typedef struct ws2812_layer_s ws2812_layer;
+
+extern ws2812_layer *ws2812_layer_connect(const char *socket_path);
+extern void ws2812_layer_close(ws2812_layer *layer);
+extern ws2812_planar_frame *ws2812_layer_frame(ws2812_layer *layer);
+extern uint8_t *ws2812_layer_alpha(ws2812_layer *layer);
+extern void ws2812_layer_publish(ws2812_layer *layer);
+extern void ws2812_layer_set_order(ws2812_layer *layer, int16_t z);
+extern void ws2812_layer_set_blend(ws2812_layer *layer, ws2812_blend_mode mode,
+				   uint8_t opacity);
+extern int ws2812_layer_fd(const ws2812_layer *layer);
+extern int64_t ws2812_layer_wait(ws2812_layer *layer);
+
+/**
+ * @brief Order in which LEDs (inside a panel) or panels (of a display) are chained.
+ *
+ * Seen from the front in the orientation of the layout, starting at the top left.
+ */
+typedef enum ws2812_matrix_order_e {
+	WS2812_MATRIX_ROWS, /**< Row by row, every row left to right. */
+	WS2812_MATRIX_SERPENTINE_ROWS, /**< Row by row, every second row right to left. */
+	WS2812_MATRIX_COLUMNS, /**< Column by column, every column top to bottom. */
+	WS2812_MATRIX_SERPENTINE_COLUMNS, /**< Column by column, every second column bottom to top. */
+} ws2812_matrix_order;
+
+/**
+ * @brief Clockwise rotation of a panel relative to its wiring order.
+ */
+typedef enum ws2812_matrix_rotation_e {
+	WS2812_MATRIX_ROTATE_0,
+	WS2812_MATRIX_ROTATE_90,
+	WS2812_MATRIX_ROTATE_180,
+	WS2812_MATRIX_ROTATE_270,
+} ws2812_matrix_rotation;
+
+/**
+ * @brief Physical layout of a matrix, see ws2812_matrix_create().
+ *
+ * The display consists of tiles_x * tiles_y equal panels. Each panel is wired in
+ * order and mounted turned by rotation, panel_width and panel_height are its size
+ * on the display. The panels are chained in tile_order, the first LED of the first
+ * panel has index start_index on the strip.
+ */
+typedef struct ws2812_matrix_layout_s {
+	uint16_t panel_width; // LEDs per row of a panel on the display.
+	uint16_t panel_height; // LEDs per column of a panel on the display.
+	ws2812_matrix_order order; // Wiring inside a panel.
+	ws2812_matrix_rotation rotation; // Rotation of every panel.
+	uint16_t tiles_x; // Panels per row of the display (0 is treated as 1).
+	uint16_t tiles_y; // Panels per column of the display (0 is treated as 1).
+	ws2812_matrix_order tile_order; // Order in which the panels are chained.
+	uint16_t start_index; // Strip index of the first LED.
+} ws2812_matrix_layout;
+
+/**
+ * @def WS2812_MATRIX_MAX_DIRTY
+ * @brief Number of dirty rectangles tracked before they are merged into one.
+ */
+#define WS2812_MATRIX_MAX_DIRTY 16
+
+/**
+ * @brief Opaque LED matrix, see ws2812_matrix_create().
+ */
+typedef struct ws2812_matrix_s ws2812_matrix;
+
+extern ws2812_matrix *ws2812_matrix_create(ws2812_handle *handle,
+					   const ws2812_matrix_layout *layout);
+extern void ws2812_matrix_free(ws2812_matrix *matrix);
+extern uint16_t ws2812_matrix_width(const ws2812_matrix *matrix);
+extern uint16_t ws2812_matrix_height(const ws2812_matrix *matrix);
+extern int ws2812_matrix_index(const ws2812_matrix *matrix, int x, int y);
+extern void ws2812_matrix_set(ws2812_matrix *matrix, int x, int y,
+			      led_pixel color);
+extern led_pixel ws2812_matrix_get(const ws2812_matrix *matrix, int x, int y);
+extern void ws2812_matrix_fill(ws2812_matrix *matrix, int x, int y, int width,
+			       int height, led_pixel color);
+extern void ws2812_matrix_blit(ws2812_matrix *matrix, int x, int y,
+			       const led_pixel *src, int width, int height,
+			       size_t src_stride);
+extern void ws2812_matrix_scroll(ws2812_matrix *matrix, int dx, int dy,
+				 led_pixel fill);
+extern void ws2812_matrix_invalidate(ws2812_matrix *matrix);
+extern int ws2812_matrix_flush(ws2812_matrix *matrix);
+
+/**
+ * @brief Header data of an animation file, see ws2812_anim_get_info().
+ */
+typedef struct ws2812_anim_info_s {
+	uint16_t length; // Pixels per frame.
+	uint32_t frame_count; // Number of frames.
+	uint64_t duration_us; // Sum of all frame durations.
+	bool loop; // The animation is meant to be repeated.
+} ws2812_anim_info;
+
+/**
+ * @brief Opaque animation file opened for playback, see ws2812_anim_open().
+ */
+typedef struct ws2812_anim_s ws2812_anim;
+
+/**
+ * @brief Opaque animation file being written, see ws2812_anim_writer_create().
+ */
+typedef struct ws2812_anim_writer_s ws2812_anim_writer;
+
+extern ws2812_anim *ws2812_anim_open(const char *path);
+extern void ws2812_anim_close(ws2812_anim *anim);
+extern void ws2812_anim_get_info(const ws2812_anim *anim,
+				 ws2812_anim_info *info);
+extern uint32_t ws2812_anim_frame_duration(const ws2812_anim *anim,
+					   uint32_t frame);
+extern uint32_t ws2812_anim_frame_at(const ws2812_anim *anim,
+				     uint64_t time_us);
+extern int ws2812_anim_decode(ws2812_anim *anim, uint32_t frame,
+			      led_pixel *pixels);
+extern ws2812_anim_writer *ws2812_anim_writer_create(const char *path,
+						     uint16_t length,
+						     uint16_t keyframe_interval,
+						     bool loop);
+extern int ws2812_anim_writer_add(ws2812_anim_writer *writer,
+				  const led_pixel *pixels,
+				  uint32_t duration_us);
+extern int ws2812_anim_writer_finish(ws2812_anim_writer *writer);
+
+/**
+ * @brief Statistics of a frame scheduler, see ws2812_scheduler_get_stats().
+ */
+typedef struct ws2812_frame_stats_s {
+	uint64_t frames; // Number of frames started (ws2812_scheduler_wait() calls).
+	uint64_t missed_deadlines; // Deadlines that passed without a frame.
+	uint64_t overruns; // Frames that took longer than the period to render and submit.
+	uint64_t max_render_ns; // Longest time between ws2812_scheduler_wait() and ws2812_scheduler_frame_done().
+	double achieved_fps; // Frames per second since the scheduler was created.
+} ws2812_frame_stats;
+
+/**
+ * @brief Opaque frame scheduler, see ws2812_scheduler_create().
+ */
+typedef struct ws2812_scheduler_s ws2812_scheduler;
+
+extern uint64_t ws2812_frame_time_ns(uint16_t led_count);
+extern ws2812_scheduler *ws2812_scheduler_create(double fps,
+						 uint16_t led_count);
+extern void ws2812_scheduler_destroy(ws2812_scheduler *sched);
+extern uint64_t ws2812_scheduler_period_ns(const ws2812_scheduler *sched);
+extern int ws2812_scheduler_fd(const ws2812_scheduler *sched);
+extern int ws2812_scheduler_wait(ws2812_scheduler *sched);
+extern void ws2812_scheduler_frame_done(ws2812_scheduler *sched);
+extern void ws2812_scheduler_get_stats(const ws2812_scheduler *sched,
+				       ws2812_frame_stats *stats);
+
+/**
+ * @def WS2812_ASYNC_QUEUE_DEPTH
+ * @brief Largest number of pending requests (queued, running or not yet processed) per async context.
+ */
+#define WS2812_ASYNC_QUEUE_DEPTH 256
+
+/**
+ * @def WS2812_ASYNC_DEFAULT_WORKERS
+ * @brief Worker threads of ws2812_async_create(0), requests of this many handles run in parallel.
+ */
+#define WS2812_ASYNC_DEFAULT_WORKERS 4
+
+/**
+ * @brief Opaque context for asynchronous requests, see ws2812_async_create().
+ */
+typedef struct ws2812_async_s ws2812_async;
+
+/**
+ * @brief Completion callback of an asynchronous request.
+ *
+ * @param handle The device of the request.
+ * @param result Return value of the blocking function, errno is set if it is negative.
+ * @param user_data Pointer passed when the request was started.
+ */
+typedef void (*ws2812_async_cb)(ws2812_handle *handle, int result,
+				void *user_data);
+
+extern ws2812_async *ws2812_async_create(unsigned int workers);
+extern void ws2812_async_destroy(ws2812_async *ctx);
+extern int ws2812_async_fd(ws2812_async *ctx);
+extern int ws2812_async_process_events(ws2812_async *ctx);
+extern int ws2812_async_set_length(ws2812_async *ctx, ws2812_handle *handle,
+				   uint16_t length, ws2812_async_cb cb,
+				   void *user_data);
+extern int ws2812_async_clear(ws2812_async *ctx, ws2812_handle *handle,
+			      ws2812_async_cb cb, void *user_data);
+extern int ws2812_async_set_mode_static(ws2812_async *ctx,
+					ws2812_handle *handle,
+					ws2812_async_cb cb, void *user_data);
+extern int ws2812_async_set_mode_blink(ws2812_async *ctx, ws2812_handle *handle,
+				       uint16_t pattern_count,
+				       uint16_t pattern_len, uint16_t delay,
+				       ws2812_async_cb cb, void *user_data);
+extern int ws2812_async_set_led_pixel(ws2812_async *ctx, ws2812_handle *handle,
+				      uint16_t start_index, uint16_t length,
+				      const led_pixel *pixel_data,
+				      ws2812_async_cb cb, void *user_data);
+extern int ws2812_async_submit_batch(ws2812_async *ctx, ws2812_batch *batch,
+				     ws2812_async_cb cb, void *user_data);
+extern int ws2812_async_get_length(ws2812_async *ctx, ws2812_handle *handle,
+				   ws2812_async_cb cb, void *user_data);
+extern int ws2812_async_get_mode(ws2812_async *ctx, ws2812_handle *handle,
+				 led_set_mode *result, ws2812_async_cb cb,
+				 void *user_data);
 
-extern int ws2812_get_length(int fd);
-extern int ws2812_get_mode_data_length(int fd);
-extern int ws2812_get_data(int fd, ws2812_pixel_buffer *result);
-extern int ws2812_get_mode_data(int fd, ws2812_pixel_buffer *result);
-extern int ws2812_get_mode(int fd, led_set_mode *result);
+#ifdef __cplusplus
+}
+#endif
 
-#endif
\ No newline at end of file
+#endif
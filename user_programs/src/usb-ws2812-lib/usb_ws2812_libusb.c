@@ -0,0 +1,939 @@
+/**
+ * @file usb_ws2812_libusb.c                                                   *
+ * @brief libusb backend: drives the controller from user space, without the   *
+ *        kernel module                                                        *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#include "usb_ws2812_lib.h"
+#include "usb_ws2812_private.h"
+#include "dev_packets.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef WS2812_HAVE_LIBUSB
+
+#include <libusb.h>
+#include <stdint.h>
+#include <time.h>
+#include "usb_packets.h"
+
+#define WS2812_USB_VENDOR_ID 0xcafe
+#define WS2812_USB_PRODUCT_ID 0x1234
+
+/**
+ * @def WS2812_USB_PIXELS_PER_PACKET
+ * @brief Pixels of a LED_DATA packet.
+ */
+#define WS2812_USB_PIXELS_PER_PACKET 21
+
+/**
+ * @def WS2812_USB_TRANSFERS
+ * @brief Bulk OUT transfers that may be in flight at the same time.
+ */
+#define WS2812_USB_TRANSFERS 8
+
+/**
+ * @def WS2812_USB_TRANSFER_PACKETS
+ * @brief 64 byte packets per bulk OUT transfer.
+ *
+ * The host controller sends them as separate USB packets, the controller sees
+ * the same packets as from the kernel module (one URB per packet).
+ */
+#define WS2812_USB_TRANSFER_PACKETS 16
+
+/**
+ * @def WS2812_USB_TIMEOUT_MS
+ * @brief Timeout of a transfer, as in the kernel module.
+ */
+#define WS2812_USB_TIMEOUT_MS 1000
+
+/**
+ * @def WS2812_USB_MAX_REQUESTS
+ * @brief CHAR_LED_GET_DATA requests that may wait for their read().
+ */
+#define WS2812_USB_MAX_REQUESTS 16
+
+struct ws2812_usb_s;
+
+/**
+ * @brief A bulk OUT transfer of the ring and its buffer.
+ */
+typedef struct ws2812_usb_transfer_s {
+	struct libusb_transfer *transfer; /**< The libusb transfer. */
+	struct ws2812_usb_s *usb; /**< The backend. */
+	int completed; /**< Set by the callback, for libusb_handle_events_completed(). */
+	bool busy; /**< Submitted and not yet completed. */
+	uint8_t buffer[WS2812_USB_TRANSFER_PACKETS * sizeof(ws2812_usb_packet)];
+} ws2812_usb_transfer;
+
+/**
+ * @brief State of the libusb backend.
+ *
+ * Everything the kernel module keeps per device: pixel buffer, mode with its
+ * blink thread and the queue of data requests. All members are protected by lock,
+ * the lock of the handle isn't enough because the blink thread sends frames on its own.
+ */
+typedef struct ws2812_usb_s {
+	libusb_context *ctx; /**< Own libusb context. */
+	libusb_device_handle *dev; /**< The opened controller. */
+	int interface; /**< Interface of the strip (claimed). */
+	uint8_t ep_out; /**< Bulk OUT endpoint of the interface. */
+	uint8_t ep_in; /**< Bulk IN endpoint of the interface. */
+	pthread_mutex_t lock; /**< Protects the backend. */
+	ws2812_usb_transfer transfers[WS2812_USB_TRANSFERS]; /**< Ring of bulk OUT transfers. */
+	size_t next; /**< Transfer that is filled next. */
+	size_t fill; /**< Bytes in the buffer of transfers[next]. */
+	int error; /**< First error of a completed transfer (errno), reported by the next write. */
+	uint8_t *scratch; /**< Gathered buffers of a writev() with several buffers. */
+	size_t scratch_size; /**< Size of scratch. */
+	led_pixel *pixels; /**< Pixel buffer (like the one of the kernel module). */
+	uint16_t length; /**< Length of the strip. */
+	bool dirty; /**< pixels changed, sent at the end of the write. */
+	led_set_mode mode; /**< Current mode. */
+	led_pixel *pattern; /**< Patterns of the blink mode. */
+	size_t pattern_length; /**< pattern_count * pattern_len of the blink mode. */
+	pthread_t blink_thread; /**< Sends the blink patterns. */
+	bool blink_running; /**< blink_thread was started. */
+	bool blink_stop; /**< Asks blink_thread to end. */
+	pthread_cond_t blink_cond; /**< Wakes blink_thread for blink_stop. */
+	uint8_t requests[WS2812_USB_MAX_REQUESTS]; /**< Data types of pending requests. */
+	size_t request_first; /**< Oldest pending request. */
+	size_t request_count; /**< Number of pending requests. */
+} ws2812_usb;
+
+/**
+ * @brief Converts a libusb error code to an errno value.
+ */
+static int ws2812_usb_errno(int rc)
+{
+	switch (rc) {
+	case LIBUSB_ERROR_INVALID_PARAM:
+		return EINVAL;
+	case LIBUSB_ERROR_ACCESS:
+		return EACCES;
+	case LIBUSB_ERROR_NO_DEVICE:
+		return ENODEV;
+	case LIBUSB_ERROR_NOT_FOUND:
+		return ENOENT;
+	case LIBUSB_ERROR_BUSY:
+		return EBUSY;
+	case LIBUSB_ERROR_TIMEOUT:
+		return ETIMEDOUT;
+	case LIBUSB_ERROR_OVERFLOW:
+		return EOVERFLOW;
+	case LIBUSB_ERROR_PIPE:
+		return EPIPE;
+	case LIBUSB_ERROR_INTERRUPTED:
+		return EINTR;
+	case LIBUSB_ERROR_NO_MEM:
+		return ENOMEM;
+	case LIBUSB_ERROR_NOT_SUPPORTED:
+		return ENOTSUP;
+	default:
+		return EIO;
+	}
+}
+
+/**
+ * @brief Completion of a bulk OUT transfer, runs in libusb_handle_events_completed().
+ */
+static void LIBUSB_CALL ws2812_usb_transfer_done(struct libusb_transfer *transfer)
+{
+	ws2812_usb_transfer *slot = transfer->user_data;
+	ws2812_usb *usb = slot->usb;
+
+	if (transfer->status != LIBUSB_TRANSFER_COMPLETED && usb->error == 0) {
+		switch (transfer->status) {
+		case LIBUSB_TRANSFER_NO_DEVICE:
+			usb->error = ENODEV;
+			break;
+		case LIBUSB_TRANSFER_TIMED_OUT:
+			usb->error = ETIMEDOUT;
+			break;
+		case LIBUSB_TRANSFER_STALL:
+			usb->error = EPIPE;
+			break;
+		default:
+			usb->error = EIO;
+			break;
+		}
+	}
+	slot->busy = false;
+	slot->completed = 1;
+}
+
+/**
+ * @brief Waits until a transfer of the ring completed, lock held.
+ */
+static void ws2812_usb_wait(ws2812_usb *usb, ws2812_usb_transfer *slot)
+{
+	while (slot->busy) {
+		if (libusb_handle_events_completed(usb->ctx, &slot->completed) <
+			    0 &&
+		    slot->busy) {
+			// Ereignisbehandlung gestört, Transfer abbrechen und weiter warten
+			libusb_cancel_transfer(slot->transfer);
+		}
+	}
+}
+
+/**
+ * @brief Submits the transfer that is being filled, lock held.
+ *
+ * @return 0 on success, -1 on error (check errno for specific error).
+ */
+static int ws2812_usb_submit(ws2812_usb *usb)
+{
+	ws2812_usb_transfer *slot = &usb->transfers[usb->next];
+
+	if (usb->fill == 0) {
+		return 0;
+	}
+	libusb_fill_bulk_transfer(slot->transfer, usb->dev, usb->ep_out,
+				  slot->buffer, usb->fill,
+				  ws2812_usb_transfer_done, slot,
+				  WS2812_USB_TIMEOUT_MS);
+	slot->busy = true;
+	slot->completed = 0;
+	usb->fill = 0;
+	int rc = libusb_submit_transfer(slot->transfer);
+	if (rc < 0) {
+		slot->busy = false;
+		errno = ws2812_usb_errno(rc);
+		return -1;
+	}
+	usb->next = (usb->next + 1) % WS2812_USB_TRANSFERS;
+	return 0;
+}
+
+/**
+ * @brief Appends a 64 byte packet to the ring, lock held.
+ *
+ * A full transfer is submitted immediately, so up to WS2812_USB_TRANSFERS transfers
+ * are in flight while the following packets are prepared. Only if the ring is full
+ * the oldest transfer is waited for.
+ *
+ * @return 0 on success, -1 on error (check errno for specific error).
+ */
+static int ws2812_usb_queue(ws2812_usb *usb, const void *packet)
+{
+	ws2812_usb_transfer *slot = &usb->transfers[usb->next];
+
+	if (usb->fill == 0) {
+		ws2812_usb_wait(usb, slot);
+	}
+	memcpy(slot->buffer + usb->fill, packet, sizeof(ws2812_usb_packet));
+	usb->fill += sizeof(ws2812_usb_packet);
+	if (usb->fill == sizeof(slot->buffer)) {
+		return ws2812_usb_submit(usb);
+	}
+	return 0;
+}
+
+/**
+ * @brief Sends the whole pixel buffer as LED_DATA packets, lock held.
+ */
+static int ws2812_usb_queue_pixels(ws2812_usb *usb)
+{
+	for (size_t index = 0; index < usb->length;
+	     index += WS2812_USB_PIXELS_PER_PACKET) {
+		ws2812_usb_packet_pixeldata packet;
+		size_t count = usb->length - index;
+		if (count > WS2812_USB_PIXELS_PER_PACKET) {
+			count = WS2812_USB_PIXELS_PER_PACKET;
+		}
+		memset(&packet, 0, sizeof(packet));
+		packet.ctrl = LED_DATA;
+		memcpy(packet.color_data, usb->pixels + index,
+		       count * sizeof(led_pixel));
+		if (ws2812_usb_queue(usb, &packet) < 0) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * @brief Queues a packet that only consists of its control byte, lock held.
+ */
+static int ws2812_usb_queue_ctrl(ws2812_usb *usb, uint8_t ctrl)
+{
+	ws2812_usb_packet packet;
+	memset(&packet, 0, sizeof(packet));
+	packet.ctrl = ctrl;
+	return ws2812_usb_queue(usb, &packet);
+}
+
+/**
+ * @brief Sends the pixel buffer if it changed, lock held.
+ */
+static int ws2812_usb_flush_pixels(ws2812_usb *usb)
+{
+	if (!usb->dirty) {
+		return 0;
+	}
+	usb->dirty = false;
+	return ws2812_usb_queue_pixels(usb);
+}
+
+/**
+ * @brief Sends a request and receives the 64 byte answer, lock held.
+ *
+ * The request is queued behind all packets in flight (the endpoint keeps the
+ * order), the answer is read synchronously.
+ *
+ * @return 0 on success, -1 on error (check errno for specific error).
+ */
+static int ws2812_usb_transceive(ws2812_usb *usb, const ws2812_usb_packet *request,
+				 ws2812_usb_packet *answer)
+{
+	int transferred;
+
+	if (ws2812_usb_queue(usb, request) < 0 || ws2812_usb_submit(usb) < 0) {
+		return -1;
+	}
+	int rc = libusb_bulk_transfer(usb->dev, usb->ep_in, (uint8_t *)answer,
+				      sizeof(ws2812_usb_packet), &transferred,
+				      WS2812_USB_TIMEOUT_MS);
+	if (rc < 0) {
+		errno = ws2812_usb_errno(rc);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * @brief Reads the length of the strip from the controller, lock held.
+ *
+ * @return The length, or -1 on error (check errno for specific error).
+ */
+static int ws2812_usb_request_length(ws2812_usb *usb)
+{
+	ws2812_usb_packet request, answer;
+
+	memset(&request, 0, sizeof(request));
+	request.ctrl = REQUEST_LEN;
+	if (ws2812_usb_transceive(usb, &request, &answer) < 0) {
+		return -1;
+	}
+	ws2812_usb_packet_count *count = (ws2812_usb_packet_count *)&answer;
+	return count->led_count_H << 8 | count->led_count_L;
+}
+
+/**
+ * @brief Resizes the pixel buffer, new pixels are off, lock held.
+ */
+static int ws2812_usb_resize(ws2812_usb *usb, uint16_t length)
+{
+	led_pixel *pixels =
+		realloc(usb->pixels, (length ? length : 1) * sizeof(led_pixel));
+	if (!pixels) {
+		return -1;
+	}
+	if (length > usb->length) {
+		memset(pixels + usb->length, 0,
+		       (length - usb->length) * sizeof(led_pixel));
+	}
+	usb->pixels = pixels;
+	usb->length = length;
+	return 0;
+}
+
+/**
+ * @brief Blink mode: shows the patterns one after another, like the thread of the kernel module.
+ */
+static void *ws2812_usb_blink_thread(void *arg)
+{
+	ws2812_usb *usb = arg;
+	size_t pattern_index = 0;
+
+	pthread_mutex_lock(&usb->lock);
+	while (!usb->blink_stop) {
+		struct timespec deadline;
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		uint64_t ns = deadline.tv_nsec +
+			      usb->mode.set_blink.blink_period * 1000000ULL;
+		deadline.tv_sec += ns / 1000000000;
+		deadline.tv_nsec = ns % 1000000000;
+		while (!usb->blink_stop &&
+		       pthread_cond_timedwait(&usb->blink_cond, &usb->lock,
+					      &deadline) != ETIMEDOUT) {
+		}
+		size_t pattern_len = usb->mode.set_blink.pattern_len;
+		size_t pattern_count = usb->mode.set_blink.pattern_count;
+		if (usb->blink_stop || pattern_len == 0 || pattern_count == 0) {
+			continue;
+		}
+
+		// Muster über den ganzen Streifen wiederholen
+		const led_pixel *pattern =
+			usb->pattern + pattern_index * pattern_len;
+		for (size_t i = 0; i < usb->length; i++) {
+			usb->pixels[i] = pattern[i % pattern_len];
+		}
+		if (ws2812_usb_queue_pixels(usb) == 0) {
+			ws2812_usb_submit(usb);
+		}
+		pattern_index = (pattern_index + 1) % pattern_count;
+	}
+	pthread_mutex_unlock(&usb->lock);
+	return NULL;
+}
+
+/**
+ * @brief Ends the blink mode if it is active, lock held.
+ */
+static void ws2812_usb_stop_mode(ws2812_usb *usb)
+{
+	if (usb->blink_running) {
+		usb->blink_stop = true;
+		pthread_cond_signal(&usb->blink_cond);
+		pthread_mutex_unlock(&usb->lock);
+		pthread_join(usb->blink_thread, NULL);
+		pthread_mutex_lock(&usb->lock);
+		usb->blink_running = false;
+		usb->blink_stop = false;
+	}
+	free(usb->pattern);
+	usb->pattern = NULL;
+	usb->pattern_length = 0;
+	usb->mode.set_static = (led_set_mode_static){
+		.ctrl = CHAR_LED_SET_MODE,
+		.mode = CHAR_LED_MODE_STATIC,
+	};
+}
+
+/**
+ * @brief Switches to a new mode, lock held.
+ */
+static int ws2812_usb_start_mode(ws2812_usb *usb, const led_set_mode *mode)
+{
+	ws2812_usb_stop_mode(usb);
+	if (mode->set_mode.mode != CHAR_LED_MODE_BLINK) {
+		return 0;
+	}
+
+	size_t length = (size_t)mode->set_blink.pattern_count *
+			mode->set_blink.pattern_len;
+	usb->pattern = calloc(length ? length : 1, sizeof(led_pixel));
+	if (!usb->pattern) {
+		return -1;
+	}
+	usb->pattern_length = length;
+	usb->mode.set_blink = mode->set_blink;
+	int err = pthread_create(&usb->blink_thread, NULL,
+				 ws2812_usb_blink_thread, usb);
+	if (err) {
+		ws2812_usb_stop_mode(usb);
+		errno = err;
+		return -1;
+	}
+	usb->blink_running = true;
+	return 0;
+}
+
+/**
+ * @brief Handles one packet of dev_packets.h like the kernel module, lock held.
+ *
+ * @return Length of the packet, or -1 on error (check errno for specific error).
+ */
+static ssize_t ws2812_usb_parse_packet(ws2812_usb *usb, const uint8_t *buf,
+				       size_t len)
+{
+	uint8_t ctrl = buf[0];
+
+	// Aufeinanderfolgende Pixelpakete werden zusammen gesendet, vor allen
+	// anderen Paketen müssen sie aber raus (Reihenfolge bleibt erhalten)
+	if (ctrl != CHAR_LED_PIXEL_DATA && ws2812_usb_flush_pixels(usb) < 0) {
+		return -1;
+	}
+
+	switch (ctrl) {
+	case CHAR_LED_LEN: {
+		led_len packet;
+		if (len < sizeof(packet)) {
+			break;
+		}
+		memcpy(&packet, buf, sizeof(packet));
+		if (ws2812_usb_resize(usb, packet.len) < 0) {
+			return -1;
+		}
+		ws2812_usb_packet_count count;
+		memset(&count, 0, sizeof(count));
+		count.ctrl = LED_COUNT;
+		count.led_count_H = packet.len >> 8;
+		count.led_count_L = packet.len & 0xFF;
+		if (ws2812_usb_queue(usb, &count) < 0) {
+			return -1;
+		}
+		// Der Controller löscht beim Setzen der Länge, im statischen Modus den Puffer erneut senden
+		if (usb->mode.set_mode.mode == CHAR_LED_MODE_STATIC &&
+		    ws2812_usb_queue_pixels(usb) < 0) {
+			return -1;
+		}
+		return sizeof(packet);
+	}
+	case CHAR_LED_PIXEL_DATA: {
+		led_pixel_data header;
+		if (len < sizeof(header)) {
+			break;
+		}
+		memcpy(&header, buf, sizeof(header));
+		size_t data_len = header.led_count * sizeof(led_pixel);
+		if (data_len > len - sizeof(header)) {
+			break;
+		}
+		bool blink = usb->mode.set_mode.mode == CHAR_LED_MODE_BLINK;
+		led_pixel *dst = blink ? usb->pattern : usb->pixels;
+		size_t dst_len = blink ? usb->pattern_length : usb->length;
+		if ((size_t)header.offset + header.led_count > dst_len) {
+			errno = EMSGSIZE;
+			return -1;
+		}
+		memcpy(dst + header.offset, buf + sizeof(header), data_len);
+		usb->dirty |= !blink;
+		return sizeof(header) + data_len;
+	}
+	case CHAR_LED_CLEAR:
+		if (len < sizeof(led_clear)) {
+			break;
+		}
+		ws2812_usb_stop_mode(usb);
+		if (ws2812_usb_queue_ctrl(usb, LED_CLEAR) < 0) {
+			return -1;
+		}
+		return sizeof(led_clear);
+	case CHAR_LED_SET_MODE: {
+		led_set_mode mode;
+		if (len < sizeof(led_set_mode_s)) {
+			break;
+		}
+		size_t packet_len = 0;
+		if (buf[1] == CHAR_LED_MODE_STATIC) {
+			packet_len = sizeof(led_set_mode_static);
+		} else if (buf[1] == CHAR_LED_MODE_BLINK) {
+			packet_len = sizeof(led_set_mode_blink);
+		}
+		if (packet_len == 0) {
+			errno = EBADRQC;
+			return -1;
+		}
+		if (len < packet_len) {
+			break;
+		}
+		memcpy(&mode, buf, packet_len);
+		if (ws2812_usb_start_mode(usb, &mode) < 0) {
+			return -1;
+		}
+		return packet_len;
+	}
+	case CHAR_LED_GET_DATA: {
+		led_get_data request;
+		if (len < sizeof(request)) {
+			break;
+		}
+		memcpy(&request, buf, sizeof(request));
+		if (usb->request_count == WS2812_USB_MAX_REQUESTS) {
+			errno = ENOBUFS;
+			return -1;
+		}
+		usb->requests[(usb->request_first + usb->request_count++) %
+			      WS2812_USB_MAX_REQUESTS] = request.data_type;
+		return sizeof(request);
+	}
+	case CHAR_LED_SAVE_BOOT_FRAME:
+		if (len < sizeof(led_save_boot_frame)) {
+			break;
+		}
+		if (ws2812_usb_queue_ctrl(usb, SAVE_BOOT_FRAME) < 0) {
+			return -1;
+		}
+		return sizeof(led_save_boot_frame);
+	default:
+		errno = EBADRQC;
+		return -1;
+	}
+	// Kein vollständiges Paket
+	errno = EBADMSG;
+	return -1;
+}
+
+static ssize_t ws2812_usb_writev(ws2812_handle *handle, const struct iovec *iov,
+				 int iovcnt)
+{
+	ws2812_usb *usb = handle->backend_data;
+	const uint8_t *buf = iov[0].iov_base;
+	size_t len = 0;
+
+	for (int i = 0; i < iovcnt; i++) {
+		len += iov[i].iov_len;
+	}
+	if (len == 0) {
+		return 0;
+	}
+
+	pthread_mutex_lock(&usb->lock);
+	if (usb->error) {
+		// Fehler eines früheren Transfers melden
+		errno = usb->error;
+		usb->error = 0;
+		pthread_mutex_unlock(&usb->lock);
+		return -1;
+	}
+	if (iovcnt > 1) {
+		if (usb->scratch_size < len) {
+			uint8_t *scratch = realloc(usb->scratch, len);
+			if (!scratch) {
+				pthread_mutex_unlock(&usb->lock);
+				return -1;
+			}
+			usb->scratch = scratch;
+			usb->scratch_size = len;
+		}
+		size_t pos = 0;
+		for (int i = 0; i < iovcnt; i++) {
+			memcpy(usb->scratch + pos, iov[i].iov_base,
+			       iov[i].iov_len);
+			pos += iov[i].iov_len;
+		}
+		buf = usb->scratch;
+	}
+
+	ssize_t ret = len;
+	for (size_t pos = 0; pos < len;) {
+		ssize_t packet_len =
+			ws2812_usb_parse_packet(usb, buf + pos, len - pos);
+		if (packet_len < 0) {
+			ret = -1;
+			break;
+		}
+		pos += packet_len;
+	}
+	// Pixeldaten aller Pakete dieses write() nur einmal senden
+	int err = errno;
+	if (ws2812_usb_flush_pixels(usb) < 0 || ws2812_usb_submit(usb) < 0) {
+		ret = -1;
+	} else if (ret < 0) {
+		errno = err;
+	}
+	pthread_mutex_unlock(&usb->lock);
+	return ret;
+}
+
+/**
+ * @brief Answers a DATA_PIXEL request with the buffer of the controller, lock held.
+ */
+static ssize_t ws2812_usb_read_pixels(ws2812_usb *usb, uint8_t *buf, size_t len)
+{
+	int length = ws2812_usb_request_length(usb);
+	if (length < 0) {
+		return -1;
+	}
+	if (length != usb->length && ws2812_usb_resize(usb, length) < 0) {
+		return -1;
+	}
+
+	size_t packet_len = sizeof(led_pixel_data) + length * sizeof(led_pixel);
+	if (len < packet_len) {
+		errno = ENOBUFS;
+		return -1;
+	}
+	led_pixel_data header = {
+		.ctrl = CHAR_LED_PIXEL_DATA,
+		.led_count = length,
+		.offset = 0,
+	};
+	memcpy(buf, &header, sizeof(header));
+
+	led_pixel *dst = (led_pixel *)(buf + sizeof(header));
+	for (size_t block = 0; block * WS2812_USB_PIXELS_PER_PACKET < (size_t)length;
+	     block++) {
+		ws2812_usb_packet_request_led_data request;
+		ws2812_usb_packet_pixeldata answer;
+		memset(&request, 0, sizeof(request));
+		request.ctrl = REQUEST_LED_DATA;
+		request.led_block_index_H = block >> 8;
+		request.led_block_index_L = block & 0xFF;
+		if (ws2812_usb_transceive(usb, (ws2812_usb_packet *)&request,
+					  (ws2812_usb_packet *)&answer) < 0) {
+			return -1;
+		}
+		size_t first = block * WS2812_USB_PIXELS_PER_PACKET;
+		size_t count = length - first;
+		if (count > WS2812_USB_PIXELS_PER_PACKET) {
+			count = WS2812_USB_PIXELS_PER_PACKET;
+		}
+		memcpy(dst + first, answer.color_data, count * sizeof(led_pixel));
+	}
+	return packet_len;
+}
+
+static ssize_t ws2812_usb_read(ws2812_handle *handle, void *buf, size_t len)
+{
+	ws2812_usb *usb = handle->backend_data;
+	ssize_t ret = -1;
+
+	pthread_mutex_lock(&usb->lock);
+	if (usb->request_count == 0) {
+		pthread_mutex_unlock(&usb->lock);
+		return 0;
+	}
+	uint8_t type = usb->requests[usb->request_first];
+	usb->request_first = (usb->request_first + 1) % WS2812_USB_MAX_REQUESTS;
+	usb->request_count--;
+
+	switch (type) {
+	case DATA_LEN: {
+		int length = ws2812_usb_request_length(usb);
+		led_len packet = { .ctrl = CHAR_LED_LEN, .len = length };
+		if (length < 0) {
+			break;
+		}
+		if (len < sizeof(packet)) {
+			errno = ENOBUFS;
+			break;
+		}
+		memcpy(buf, &packet, sizeof(packet));
+		ret = sizeof(packet);
+		break;
+	}
+	case DATA_MODE: {
+		size_t packet_len = usb->mode.set_mode.mode == CHAR_LED_MODE_BLINK ?
+					    sizeof(led_set_mode_blink) :
+					    sizeof(led_set_mode_static);
+		if (len < packet_len) {
+			errno = ENOBUFS;
+			break;
+		}
+		memcpy(buf, &usb->mode, packet_len);
+		ret = packet_len;
+		break;
+	}
+	case DATA_PIXEL:
+		ret = ws2812_usb_read_pixels(usb, buf, len);
+		break;
+	case DATA_MODE_PIXEL: {
+		bool blink = usb->mode.set_mode.mode == CHAR_LED_MODE_BLINK;
+		const led_pixel *src = blink ? usb->pattern : usb->pixels;
+		size_t count = blink ? usb->pattern_length : usb->length;
+		led_pixel_data header = {
+			.ctrl = CHAR_LED_PIXEL_DATA,
+			.led_count = count,
+			.offset = 0,
+		};
+		if (len < sizeof(header) + count * sizeof(led_pixel)) {
+			errno = ENOBUFS;
+			break;
+		}
+		memcpy(buf, &header, sizeof(header));
+		memcpy((uint8_t *)buf + sizeof(header), src,
+		       count * sizeof(led_pixel));
+		ret = sizeof(header) + count * sizeof(led_pixel);
+		break;
+	}
+	default:
+		errno = EINVAL;
+		break;
+	}
+	pthread_mutex_unlock(&usb->lock);
+	return ret;
+}
+
+/**
+ * @brief Frees the backend, called with the lock of the handle held or unused.
+ */
+static void ws2812_usb_free(ws2812_usb *usb)
+{
+	if (usb->dev) {
+		pthread_mutex_lock(&usb->lock);
+		ws2812_usb_stop_mode(usb);
+		ws2812_usb_submit(usb);
+		for (size_t i = 0; i < WS2812_USB_TRANSFERS; i++) {
+			ws2812_usb_wait(usb, &usb->transfers[i]);
+		}
+		pthread_mutex_unlock(&usb->lock);
+		libusb_release_interface(usb->dev, usb->interface);
+		libusb_close(usb->dev);
+	}
+	for (size_t i = 0; i < WS2812_USB_TRANSFERS; i++) {
+		libusb_free_transfer(usb->transfers[i].transfer);
+	}
+	if (usb->ctx) {
+		libusb_exit(usb->ctx);
+	}
+	pthread_cond_destroy(&usb->blink_cond);
+	pthread_mutex_destroy(&usb->lock);
+	free(usb->scratch);
+	free(usb->pattern);
+	free(usb->pixels);
+	free(usb);
+}
+
+static void ws2812_usb_close(ws2812_handle *handle)
+{
+	ws2812_usb_free(handle->backend_data);
+	handle->backend_data = NULL;
+}
+
+/**
+ * @brief Backend functions of a libusb handle.
+ */
+static const ws2812_backend ws2812_usb_backend = {
+	.writev = ws2812_usb_writev,
+	.read = ws2812_usb_read,
+	.close = ws2812_usb_close,
+};
+
+/**
+ * @brief Opens the strip with index strip and claims its interface.
+ *
+ * The strips of all controllers are counted in the order of the device list,
+ * each vendor interface of a controller is one strip (like /dev/usb_ws2812_N).
+ *
+ * @return 0 on success, a libusb error code on error.
+ */
+static int ws2812_usb_find(ws2812_usb *usb, long strip)
+{
+	libusb_device **list;
+	ssize_t count = libusb_get_device_list(usb->ctx, &list);
+	int rc = LIBUSB_ERROR_NOT_FOUND;
+
+	if (count < 0) {
+		return count;
+	}
+	for (ssize_t i = 0; i < count && rc == LIBUSB_ERROR_NOT_FOUND; i++) {
+		struct libusb_device_descriptor desc;
+		struct libusb_config_descriptor *config;
+		if (libusb_get_device_descriptor(list[i], &desc) < 0 ||
+		    desc.idVendor != WS2812_USB_VENDOR_ID ||
+		    desc.idProduct != WS2812_USB_PRODUCT_ID ||
+		    libusb_get_active_config_descriptor(list[i], &config) < 0) {
+			continue;
+		}
+		if (strip >= config->bNumInterfaces) {
+			strip -= config->bNumInterfaces;
+			libusb_free_config_descriptor(config);
+			continue;
+		}
+
+		const struct libusb_interface_descriptor *itf =
+			&config->interface[strip].altsetting[0];
+		usb->interface = itf->bInterfaceNumber;
+		for (int e = 0; e < itf->bNumEndpoints; e++) {
+			const struct libusb_endpoint_descriptor *ep =
+				&itf->endpoint[e];
+			if ((ep->bmAttributes & LIBUSB_TRANSFER_TYPE_MASK) !=
+			    LIBUSB_TRANSFER_TYPE_BULK) {
+				continue;
+			}
+			if (ep->bEndpointAddress & LIBUSB_ENDPOINT_IN) {
+				usb->ep_in = ep->bEndpointAddress;
+			} else {
+				usb->ep_out = ep->bEndpointAddress;
+			}
+		}
+		libusb_free_config_descriptor(config);
+		if (!usb->ep_in || !usb->ep_out) {
+			break;
+		}
+
+		rc = libusb_open(list[i], &usb->dev);
+		if (rc < 0) {
+			break;
+		}
+		// Ein geladenes Kernelmodul für die Dauer der Verbindung lösen
+		libusb_set_auto_detach_kernel_driver(usb->dev, 1);
+		rc = libusb_claim_interface(usb->dev, usb->interface);
+		if (rc < 0) {
+			libusb_close(usb->dev);
+			usb->dev = NULL;
+		}
+	}
+	libusb_free_device_list(list, 1);
+	return rc;
+}
+
+/**
+ * @brief Opens a strip through libusb, see ws2812_open().
+ *
+ * The backend does in user space what the kernel module does: it keeps the pixel
+ * buffer, converts the packets of the library into 64 byte USB packets (21 pixels
+ * each) and runs the blink mode in a thread. Bulk OUT packets are collected into
+ * transfers of WS2812_USB_TRANSFER_PACKETS packets, up to WS2812_USB_TRANSFERS of them
+ * are in flight asynchronously, so a write returns as soon as the last transfer
+ * was submitted. Errors of such a transfer are reported by the next write.
+ * Requests with an answer (length, pixel data) are synchronous.
+ *
+ * The pixel buffer starts with the length reported by the controller. A loaded
+ * kernel module is detached from the interface while the handle is open.
+ */
+ws2812_handle *ws2812_usb_open(const char *strip, uint16_t max_leds)
+{
+	char *end;
+	long index = strtol(strip, &end, 10);
+	if (*end || index < 0) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	ws2812_usb *usb = calloc(1, sizeof(ws2812_usb));
+	if (!usb) {
+		return NULL;
+	}
+	pthread_mutex_init(&usb->lock, NULL);
+	pthread_cond_init(&usb->blink_cond, NULL);
+	usb->mode.set_static = (led_set_mode_static){
+		.ctrl = CHAR_LED_SET_MODE,
+		.mode = CHAR_LED_MODE_STATIC,
+	};
+
+	int rc = libusb_init(&usb->ctx);
+	if (rc == 0) {
+		rc = ws2812_usb_find(usb, index);
+	}
+	for (size_t i = 0; rc == 0 && i < WS2812_USB_TRANSFERS; i++) {
+		usb->transfers[i].usb = usb;
+		usb->transfers[i].transfer = libusb_alloc_transfer(0);
+		if (!usb->transfers[i].transfer) {
+			rc = LIBUSB_ERROR_NO_MEM;
+		}
+	}
+	if (rc < 0) {
+		ws2812_usb_free(usb);
+		errno = ws2812_usb_errno(rc);
+		return NULL;
+	}
+
+	pthread_mutex_lock(&usb->lock);
+	int length = ws2812_usb_request_length(usb);
+	if (length >= 0) {
+		length = ws2812_usb_resize(usb, length);
+	}
+	pthread_mutex_unlock(&usb->lock);
+	ws2812_handle *handle = length < 0 ? NULL : ws2812_handle_alloc(max_leds);
+	if (!handle) {
+		int err = errno;
+		ws2812_usb_free(usb);
+		errno = err;
+		return NULL;
+	}
+	handle->backend = &ws2812_usb_backend;
+	handle->backend_data = usb;
+	return handle;
+}
+
+#else
+
+ws2812_handle *ws2812_usb_open(const char *strip, uint16_t max_leds)
+{
+	(void)strip;
+	(void)max_leds;
+	errno = ENOTSUP;
+	return NULL;
+}
+
+#endif
@@ -0,0 +1,517 @@
+/**
+ * @file usb_ws2812_matrix.c                                                   *
+ * @brief LED matrices: coordinate mapping with a lookup table and submission  *
+ *        of the dirty rectangles                                              *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#include "usb_ws2812_lib.h"
+#include "usb_ws2812_private.h"
+#include "dev_packets.h"
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Rectangle of display coordinates, x1 and y1 are exclusive.
+ */
+typedef struct ws2812_matrix_rect_s {
+	uint16_t x0;
+	uint16_t y0;
+	uint16_t x1;
+	uint16_t y1;
+} ws2812_matrix_rect;
+
+/**
+ * @brief LED matrix with its frame in strip order.
+ */
+struct ws2812_matrix_s {
+	ws2812_handle *handle; /**< The device. */
+	uint16_t width; /**< Width of the display in LEDs. */
+	uint16_t height; /**< Height of the display in LEDs. */
+	uint16_t start_index; /**< Strip index of pixels[0]. */
+	size_t count; /**< Number of LEDs (width * height). */
+	uint16_t *map; /**< Offset in pixels of every display pixel, row by row. */
+	led_pixel *pixels; /**< The frame in strip order. */
+	uint64_t *dirty_bits; /**< Scratch bitmap of ws2812_matrix_flush(), one bit per LED. */
+	ws2812_matrix_rect dirty[WS2812_MATRIX_MAX_DIRTY]; /**< Changed since the last flush. */
+	size_t dirty_count; /**< Number of entries in dirty. */
+};
+
+/**
+ * @brief Position of (x, y) in a w * h grid chained in order.
+ */
+static size_t ws2812_matrix_order_index(ws2812_matrix_order order, size_t x,
+					size_t y, size_t w, size_t h)
+{
+	switch (order) {
+	case WS2812_MATRIX_SERPENTINE_ROWS:
+		return y * w + (y & 1 ? w - 1 - x : x);
+	case WS2812_MATRIX_COLUMNS:
+		return x * h + y;
+	case WS2812_MATRIX_SERPENTINE_COLUMNS:
+		return x * h + (x & 1 ? h - 1 - y : y);
+	default:
+		return y * w + x;
+	}
+}
+
+/**
+ * @brief Offset of display position (x, y) inside a panel.
+ *
+ * The display position is turned back by the rotation of the panel, the result
+ * is the position in the wiring of the panel, whose size is swapped by 90 and 270
+ * degrees.
+ */
+static size_t ws2812_matrix_panel_index(const ws2812_matrix_layout *layout,
+					size_t x, size_t y)
+{
+	size_t w = layout->panel_width;
+	size_t h = layout->panel_height;
+
+	switch (layout->rotation) {
+	case WS2812_MATRIX_ROTATE_90:
+		return ws2812_matrix_order_index(layout->order, y, w - 1 - x, h,
+						 w);
+	case WS2812_MATRIX_ROTATE_180:
+		return ws2812_matrix_order_index(layout->order, w - 1 - x,
+						 h - 1 - y, w, h);
+	case WS2812_MATRIX_ROTATE_270:
+		return ws2812_matrix_order_index(layout->order, h - 1 - y, x, h,
+						 w);
+	default:
+		return ws2812_matrix_order_index(layout->order, x, y, w, h);
+	}
+}
+
+/**
+ * @brief Creates a matrix.
+ *
+ * The layout is compiled into a table with the strip index of every display
+ * position, drawing doesn't evaluate the layout again. The frame is kept in strip
+ * order, so ws2812_matrix_flush() can send it without reordering. All pixels are
+ * off and the whole matrix is dirty initially.
+ *
+ * @param handle The WS2812 device.
+ * @param layout The physical layout.
+ * @return The matrix, or NULL on error (check errno for specific error).
+ *         EINVAL if the layout is invalid or doesn't fit on a strip of 65535 LEDs.
+ */
+ws2812_matrix *ws2812_matrix_create(ws2812_handle *handle,
+				    const ws2812_matrix_layout *layout)
+{
+	size_t tiles_x = layout->tiles_x ? layout->tiles_x : 1;
+	size_t tiles_y = layout->tiles_y ? layout->tiles_y : 1;
+	size_t panel_count = (size_t)layout->panel_width * layout->panel_height;
+	size_t width = layout->panel_width * tiles_x;
+	size_t height = layout->panel_height * tiles_y;
+
+	if (panel_count == 0 || width > UINT16_MAX || height > UINT16_MAX ||
+	    layout->start_index + width * height > UINT16_MAX ||
+	    (unsigned)layout->order > WS2812_MATRIX_SERPENTINE_COLUMNS ||
+	    (unsigned)layout->tile_order > WS2812_MATRIX_SERPENTINE_COLUMNS ||
+	    (unsigned)layout->rotation > WS2812_MATRIX_ROTATE_270) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	ws2812_matrix *matrix = calloc(1, sizeof(ws2812_matrix));
+	if (!matrix) {
+		return NULL;
+	}
+	matrix->handle = handle;
+	matrix->width = width;
+	matrix->height = height;
+	matrix->start_index = layout->start_index;
+	matrix->count = width * height;
+	matrix->map = malloc(matrix->count * sizeof(uint16_t));
+	matrix->pixels = calloc(matrix->count, sizeof(led_pixel));
+	matrix->dirty_bits = calloc((matrix->count + 63) / 64, sizeof(uint64_t));
+	if (!matrix->map || !matrix->pixels || !matrix->dirty_bits) {
+		ws2812_matrix_free(matrix);
+		errno = ENOMEM;
+		return NULL;
+	}
+
+	for (size_t y = 0; y < height; y++) {
+		for (size_t x = 0; x < width; x++) {
+			size_t tile = ws2812_matrix_order_index(
+				layout->tile_order, x / layout->panel_width,
+				y / layout->panel_height, tiles_x, tiles_y);
+			matrix->map[y * width + x] =
+				tile * panel_count +
+				ws2812_matrix_panel_index(layout,
+							  x % layout->panel_width,
+							  y % layout->panel_height);
+		}
+	}
+	ws2812_matrix_invalidate(matrix);
+	return matrix;
+}
+
+/**
+ * @brief Frees a matrix.
+ *
+ * @param matrix The matrix, may be NULL.
+ */
+void ws2812_matrix_free(ws2812_matrix *matrix)
+{
+	if (!matrix) {
+		return;
+	}
+	free(matrix->dirty_bits);
+	free(matrix->pixels);
+	free(matrix->map);
+	free(matrix);
+}
+
+/**
+ * @brief Returns the width of the display.
+ *
+ * @param matrix The matrix.
+ * @return Width in LEDs.
+ */
+uint16_t ws2812_matrix_width(const ws2812_matrix *matrix)
+{
+	return matrix->width;
+}
+
+/**
+ * @brief Returns the height of the display.
+ *
+ * @param matrix The matrix.
+ * @return Height in LEDs.
+ */
+uint16_t ws2812_matrix_height(const ws2812_matrix *matrix)
+{
+	return matrix->height;
+}
+
+/**
+ * @brief Returns the strip index of a display position.
+ *
+ * @param matrix The matrix.
+ * @param x Column, 0 is left.
+ * @param y Row, 0 is top.
+ * @return Index of the LED on the strip, or -1 if (x, y) is outside of the display.
+ */
+int ws2812_matrix_index(const ws2812_matrix *matrix, int x, int y)
+{
+	if (x < 0 || y < 0 || x >= matrix->width || y >= matrix->height) {
+		return -1;
+	}
+	return matrix->start_index + matrix->map[y * matrix->width + x];
+}
+
+/**
+ * @brief Adds a rectangle to the dirty rectangles.
+ *
+ * Rectangles inside an existing one are dropped. If all slots are used, all
+ * rectangles are merged into their bounding box.
+ */
+static void ws2812_matrix_add_dirty(ws2812_matrix *matrix, ws2812_matrix_rect rect)
+{
+	if (rect.x0 >= rect.x1 || rect.y0 >= rect.y1) {
+		return;
+	}
+	for (size_t i = 0; i < matrix->dirty_count; i++) {
+		const ws2812_matrix_rect *r = &matrix->dirty[i];
+		if (r->x0 <= rect.x0 && r->y0 <= rect.y0 && r->x1 >= rect.x1 &&
+		    r->y1 >= rect.y1) {
+			return;
+		}
+	}
+	if (matrix->dirty_count < WS2812_MATRIX_MAX_DIRTY) {
+		matrix->dirty[matrix->dirty_count++] = rect;
+		return;
+	}
+
+	for (size_t i = 0; i < matrix->dirty_count; i++) {
+		const ws2812_matrix_rect *r = &matrix->dirty[i];
+		rect.x0 = r->x0 < rect.x0 ? r->x0 : rect.x0;
+		rect.y0 = r->y0 < rect.y0 ? r->y0 : rect.y0;
+		rect.x1 = r->x1 > rect.x1 ? r->x1 : rect.x1;
+		rect.y1 = r->y1 > rect.y1 ? r->y1 : rect.y1;
+	}
+	matrix->dirty[0] = rect;
+	matrix->dirty_count = 1;
+}
+
+/**
+ * @brief Clips a rectangle to the display.
+ *
+ * @param skip_x Receives the number of columns cut off at the left, may be NULL.
+ * @param skip_y Receives the number of rows cut off at the top, may be NULL.
+ * @return The clipped rectangle, empty if nothing is visible.
+ */
+static ws2812_matrix_rect ws2812_matrix_clip(const ws2812_matrix *matrix, int x,
+					     int y, int width, int height,
+					     size_t *skip_x, size_t *skip_y)
+{
+	long x0 = x, y0 = y;
+	long x1 = x0 + (width > 0 ? width : 0);
+	long y1 = y0 + (height > 0 ? height : 0);
+
+	x0 = x0 < 0 ? 0 : x0;
+	y0 = y0 < 0 ? 0 : y0;
+	x1 = x1 > matrix->width ? matrix->width : x1;
+	y1 = y1 > matrix->height ? matrix->height : y1;
+	if (x0 >= x1 || y0 >= y1) {
+		return (ws2812_matrix_rect){ 0, 0, 0, 0 };
+	}
+	if (skip_x) {
+		*skip_x = x0 - x;
+	}
+	if (skip_y) {
+		*skip_y = y0 - y;
+	}
+	return (ws2812_matrix_rect){ x0, y0, x1, y1 };
+}
+
+/**
+ * @brief Sets one pixel, positions outside of the display are ignored.
+ *
+ * @param matrix The matrix.
+ * @param x Column, 0 is left.
+ * @param y Row, 0 is top.
+ * @param color The color.
+ */
+void ws2812_matrix_set(ws2812_matrix *matrix, int x, int y, led_pixel color)
+{
+	ws2812_matrix_fill(matrix, x, y, 1, 1, color);
+}
+
+/**
+ * @brief Returns one pixel of the frame.
+ *
+ * @param matrix The matrix.
+ * @param x Column, 0 is left.
+ * @param y Row, 0 is top.
+ * @return The color, black outside of the display.
+ */
+led_pixel ws2812_matrix_get(const ws2812_matrix *matrix, int x, int y)
+{
+	if (x < 0 || y < 0 || x >= matrix->width || y >= matrix->height) {
+		return (led_pixel){ 0, 0, 0 };
+	}
+	return matrix->pixels[matrix->map[y * matrix->width + x]];
+}
+
+/**
+ * @brief Fills a rectangle with one color.
+ *
+ * The rectangle is clipped to the display.
+ *
+ * @param matrix The matrix.
+ * @param x Left column, may be negative.
+ * @param y Top row, may be negative.
+ * @param width Width of the rectangle.
+ * @param height Height of the rectangle.
+ * @param color The color.
+ */
+void ws2812_matrix_fill(ws2812_matrix *matrix, int x, int y, int width,
+			int height, led_pixel color)
+{
+	ws2812_matrix_rect rect =
+		ws2812_matrix_clip(matrix, x, y, width, height, NULL, NULL);
+
+	for (size_t row = rect.y0; row < rect.y1; row++) {
+		const uint16_t *map = matrix->map + row * matrix->width;
+		for (size_t col = rect.x0; col < rect.x1; col++) {
+			matrix->pixels[map[col]] = color;
+		}
+	}
+	ws2812_matrix_add_dirty(matrix, rect);
+}
+
+/**
+ * @brief Copies an image onto the display.
+ *
+ * The image is clipped to the display.
+ *
+ * @param matrix The matrix.
+ * @param x Display column of the left edge of the image, may be negative.
+ * @param y Display row of the top edge of the image, may be negative.
+ * @param src The image, row by row.
+ * @param width Width of the image.
+ * @param height Height of the image.
+ * @param src_stride Pixels from one row of src to the next, 0 for width.
+ */
+void ws2812_matrix_blit(ws2812_matrix *matrix, int x, int y,
+			const led_pixel *src, int width, int height,
+			size_t src_stride)
+{
+	size_t skip_x = 0, skip_y = 0;
+	ws2812_matrix_rect rect =
+		ws2812_matrix_clip(matrix, x, y, width, height, &skip_x, &skip_y);
+
+	if (src_stride == 0) {
+		src_stride = width;
+	}
+	for (size_t row = rect.y0; row < rect.y1; row++) {
+		const uint16_t *map = matrix->map + row * matrix->width;
+		const led_pixel *line =
+			src + (skip_y + row - rect.y0) * src_stride + skip_x;
+		for (size_t col = rect.x0; col < rect.x1; col++) {
+			matrix->pixels[map[col]] = line[col - rect.x0];
+		}
+	}
+	ws2812_matrix_add_dirty(matrix, rect);
+}
+
+/**
+ * @brief Moves the content of the display.
+ *
+ * The content is moved in place. Pixels moved off the display are lost, the
+ * uncovered area is filled with fill.
+ *
+ * @param matrix The matrix.
+ * @param dx Columns to move to the right (negative: to the left).
+ * @param dy Rows to move down (negative: up).
+ * @param fill Color of the uncovered area.
+ */
+void ws2812_matrix_scroll(ws2812_matrix *matrix, int dx, int dy, led_pixel fill)
+{
+	long w = matrix->width, h = matrix->height;
+
+	if (dx == 0 && dy == 0) {
+		return;
+	}
+	// Ziele in Gegenrichtung durchlaufen, damit keine Quelle vorher überschrieben wird
+	long y_first = dy > 0 ? h - 1 : 0, y_step = dy > 0 ? -1 : 1;
+	long x_first = dx > 0 ? w - 1 : 0, x_step = dx > 0 ? -1 : 1;
+	for (long y = y_first; y >= 0 && y < h; y += y_step) {
+		const uint16_t *map = matrix->map + y * w;
+		long sy = y - dy;
+		for (long x = x_first; x >= 0 && x < w; x += x_step) {
+			long sx = x - dx;
+			led_pixel color = fill;
+			if (sx >= 0 && sx < w && sy >= 0 && sy < h) {
+				color = matrix->pixels[matrix->map[sy * w + sx]];
+			}
+			matrix->pixels[map[x]] = color;
+		}
+	}
+	ws2812_matrix_invalidate(matrix);
+}
+
+/**
+ * @brief Marks the whole display as dirty, the next flush sends every pixel.
+ *
+ * @param matrix The matrix.
+ */
+void ws2812_matrix_invalidate(ws2812_matrix *matrix)
+{
+	matrix->dirty[0] =
+		(ws2812_matrix_rect){ 0, 0, matrix->width, matrix->height };
+	matrix->dirty_count = 1;
+}
+
+/**
+ * @brief Returns the index of the first bit >= from that equals value, or count.
+ */
+static size_t ws2812_matrix_next_bit(const uint64_t *bits, size_t from,
+				     size_t count, bool value)
+{
+	while (from < count) {
+		uint64_t word = bits[from / 64];
+		if (!value) {
+			word = ~word;
+		}
+		word &= ~0ULL << (from % 64);
+		if (word) {
+			from = from / 64 * 64 + __builtin_ctzll(word);
+			break;
+		}
+		from = (from / 64 + 1) * 64;
+	}
+	return from < count ? from : count;
+}
+
+/**
+ * @brief Sends the dirty rectangles to the device.
+ *
+ * The dirty rectangles are mapped to strip indices, which may be scattered over
+ * the strip for rotated or serpentine layouts. Runs of dirty LEDs whose gap is
+ * smaller than the cost of an additional packet are merged, the remaining ranges
+ * are sent like with ws2812_set_led_regions() with one writev() from the frame of
+ * the matrix. If the ranges with their headers are not smaller than the full
+ * frame, or there are more than WS2812_MAX_REGIONS of them, the full frame is
+ * sent with ws2812_set_led_pixel().
+ *
+ * @param matrix The matrix.
+ * @return Number of bytes written (0 if nothing is dirty), or -1 on error (check errno for specific error).
+ *         After an error the whole display is dirty.
+ */
+int ws2812_matrix_flush(ws2812_matrix *matrix)
+{
+	size_t count = matrix->count;
+	size_t gap_max = WS2812_DIFF_PACKET_COST / sizeof(led_pixel);
+	size_t full_bytes = sizeof(led_pixel_data) + count * sizeof(led_pixel);
+	ws2812_region regions[WS2812_MAX_REGIONS];
+	size_t region_count = 0;
+	size_t region_bytes = 0;
+	bool full = false;
+
+	if (matrix->dirty_count == 0) {
+		return 0;
+	}
+	for (size_t i = 0; i < matrix->dirty_count; i++) {
+		const ws2812_matrix_rect *r = &matrix->dirty[i];
+		for (size_t y = r->y0; y < r->y1; y++) {
+			const uint16_t *map = matrix->map + y * matrix->width;
+			for (size_t x = r->x0; x < r->x1; x++) {
+				matrix->dirty_bits[map[x] / 64] |= 1ULL
+								   << (map[x] % 64);
+			}
+		}
+	}
+
+	size_t pos = ws2812_matrix_next_bit(matrix->dirty_bits, 0, count, true);
+	while (pos < count) {
+		size_t end = ws2812_matrix_next_bit(matrix->dirty_bits, pos,
+						    count, false);
+		// Folgende Läufe anhängen, solange die Lücke billiger als ein Paket ist
+		size_t next = ws2812_matrix_next_bit(matrix->dirty_bits, end,
+						     count, true);
+		while (next < count && next - end <= gap_max) {
+			end = ws2812_matrix_next_bit(matrix->dirty_bits, next,
+						     count, false);
+			next = ws2812_matrix_next_bit(matrix->dirty_bits, end,
+						      count, true);
+		}
+		region_bytes += sizeof(led_pixel_data) +
+				(end - pos) * sizeof(led_pixel);
+		if (region_count == WS2812_MAX_REGIONS ||
+		    region_bytes >= full_bytes) {
+			full = true;
+			break;
+		}
+		regions[region_count++] = (ws2812_region){
+			.start_index = matrix->start_index + pos,
+			.length = end - pos,
+			.pixel_data = matrix->pixels + pos,
+		};
+		pos = next;
+	}
+	memset(matrix->dirty_bits, 0, (count + 63) / 64 * sizeof(uint64_t));
+
+	int ret;
+	if (full) {
+		ret = ws2812_set_led_pixel(matrix->handle, matrix->start_index,
+					   count, matrix->pixels);
+	} else {
+		ret = ws2812_set_led_regions(matrix->handle, regions,
+					     region_count);
+	}
+	if (ret < 0) {
+		// Unklar was angekommen ist, beim nächsten Mal alles senden
+		ws2812_matrix_invalidate(matrix);
+		return -1;
+	}
+	matrix->dirty_count = 0;
+	return ret;
+}
@@ -0,0 +1,778 @@
+/**
+ * @file usb_ws2812_planar.c                                                   *
+ * @brief Planar frames (one array per channel) and their conversion to the    *
+ *        packed pixel format                                                  *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#include "usb_ws2812_lib.h"
+#include "usb_ws2812_private.h"
+#include "usb_ws2812_simd.h"
+#include "dev_packets.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+/**
+ * @brief Creates a planar frame.
+ *
+ * The three planes are allocated in one block, each starts at a multiple of
+ * WS2812_PLANAR_ALIGN and is padded to stride bytes. Effects may process whole
+ * vectors up to stride without a tail loop, the padding is never sent. All values
+ * are 0 initially.
+ *
+ * @param length Number of LEDs.
+ * @return The frame, or NULL on error (check errno for specific error).
+ */
+ws2812_planar_frame *ws2812_planar_create(uint16_t length)
+{
+	ws2812_planar_frame *frame = calloc(1, sizeof(ws2812_planar_frame));
+	if (!frame) {
+		return NULL;
+	}
+
+	frame->length = length;
+	frame->stride = (length + WS2812_PLANAR_ALIGN - 1) /
+			WS2812_PLANAR_ALIGN * WS2812_PLANAR_ALIGN;
+	if (frame->stride == 0) {
+		frame->stride = WS2812_PLANAR_ALIGN;
+	}
+
+	void *planes;
+	int err = posix_memalign(&planes, WS2812_PLANAR_ALIGN, 3 * frame->stride);
+	if (err) {
+		free(frame);
+		errno = err;
+		return NULL;
+	}
+	memset(planes, 0, 3 * frame->stride);
+	frame->red = planes;
+	frame->green = frame->red + frame->stride;
+	frame->blue = frame->green + frame->stride;
+	return frame;
+}
+
+/**
+ * @brief Frees a planar frame.
+ *
+ * @param frame The frame, may be NULL.
+ */
+void ws2812_planar_free(ws2812_planar_frame *frame)
+{
+	if (!frame) {
+		return;
+	}
+	free(frame->red);
+	free(frame);
+}
+
+/**
+ * @brief Scalar interleave of the pixels from..count.
+ */
+static void ws2812_planar_interleave_scalar(const ws2812_planar_frame *frame,
+					    led_pixel *dst, size_t from,
+					    size_t count)
+{
+	for (size_t i = from; i < count; i++) {
+		dst[i].red = frame->red[i];
+		dst[i].green = frame->green[i];
+		dst[i].blue = frame->blue[i];
+	}
+}
+
+/**
+ * @brief Scalar deinterleave of the pixels from..count.
+ */
+static void ws2812_planar_deinterleave_scalar(ws2812_planar_frame *frame,
+					      const led_pixel *src, size_t from,
+					      size_t count)
+{
+	for (size_t i = from; i < count; i++) {
+		frame->red[i] = src[i].red;
+		frame->green[i] = src[i].green;
+		frame->blue[i] = src[i].blue;
+	}
+}
+
+#ifdef WS2812_SIMD_X86
+
+/**
+ * @brief SSSE3 interleave of the pixels from..count, 16 per iteration.
+ */
+__attribute__((target("ssse3"))) static void
+ws2812_planar_interleave_ssse3(const ws2812_planar_frame *frame,
+			       led_pixel *dst, size_t from, size_t count)
+{
+	size_t i = from;
+
+	for (; i + 16 <= count; i += 16) {
+		__m128i planes[3] = {
+			_mm_load_si128((const __m128i *)(frame->red + i)),
+			_mm_load_si128((const __m128i *)(frame->green + i)),
+			_mm_load_si128((const __m128i *)(frame->blue + i)),
+		};
+		ws2812_simd_interleave_ssse3(dst + i, planes);
+	}
+	ws2812_planar_interleave_scalar(frame, dst, i, count);
+}
+
+/**
+ * @brief AVX2 interleave of the pixels from..count, 32 per iteration.
+ *
+ * A 32 byte load of a plane already is the lane layout of
+ * ws2812_simd_interleave_avx2(): pixels 0..15 in the low lane, 16..31 in the high one.
+ */
+__attribute__((target("avx2"))) static void
+ws2812_planar_interleave_avx2(const ws2812_planar_frame *frame, led_pixel *dst,
+			      size_t from, size_t count)
+{
+	size_t i = from;
+
+	for (; i + 32 <= count; i += 32) {
+		__m256i planes[3] = {
+			_mm256_load_si256((const __m256i *)(frame->red + i)),
+			_mm256_load_si256((const __m256i *)(frame->green + i)),
+			_mm256_load_si256((const __m256i *)(frame->blue + i)),
+		};
+		ws2812_simd_interleave_avx2(dst + i, planes);
+	}
+	ws2812_planar_interleave_ssse3(frame, dst, i, count);
+}
+
+/**
+ * @brief SSSE3 deinterleave of the pixels from..count, 16 per iteration.
+ */
+__attribute__((target("ssse3"))) static void
+ws2812_planar_deinterleave_ssse3(ws2812_planar_frame *frame,
+				 const led_pixel *src, size_t from, size_t count)
+{
+	size_t i = from;
+
+	for (; i + 16 <= count; i += 16) {
+		__m128i planes[3];
+		ws2812_simd_deinterleave_ssse3(src + i, planes);
+		_mm_store_si128((__m128i *)(frame->red + i), planes[0]);
+		_mm_store_si128((__m128i *)(frame->green + i), planes[1]);
+		_mm_store_si128((__m128i *)(frame->blue + i), planes[2]);
+	}
+	ws2812_planar_deinterleave_scalar(frame, src, i, count);
+}
+
+/**
+ * @brief AVX2 deinterleave of the pixels from..count, 32 per iteration.
+ */
+__attribute__((target("avx2"))) static void
+ws2812_planar_deinterleave_avx2(ws2812_planar_frame *frame,
+				const led_pixel *src, size_t from, size_t count)
+{
+	size_t i = from;
+
+	for (; i + 32 <= count; i += 32) {
+		__m256i planes[3];
+		ws2812_simd_deinterleave_avx2(src + i, planes);
+		_mm256_store_si256((__m256i *)(frame->red + i), planes[0]);
+		_mm256_store_si256((__m256i *)(frame->green + i), planes[1]);
+		_mm256_store_si256((__m256i *)(frame->blue + i), planes[2]);
+	}
+	ws2812_planar_deinterleave_ssse3(frame, src, i, count);
+}
+
+#endif
+
+/**
+ * @brief Converts a planar frame into packed pixels.
+ *
+ * @param frame The frame.
+ * @param dst Receives frame->length pixels.
+ */
+void ws2812_planar_to_pixels(const ws2812_planar_frame *frame, led_pixel *dst)
+{
+	size_t count = frame->length;
+
+#ifdef WS2812_SIMD_X86
+	if (ws2812_isa_supported(WS2812_ISA_AVX2)) {
+		ws2812_planar_interleave_avx2(frame, dst, 0, count);
+		return;
+	}
+	if (ws2812_isa_supported(WS2812_ISA_SSSE3)) {
+		ws2812_planar_interleave_ssse3(frame, dst, 0, count);
+		return;
+	}
+#elif defined(__aarch64__)
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16) {
+		uint8x16x3_t planes = { { vld1q_u8(frame->red + i),
+					  vld1q_u8(frame->green + i),
+					  vld1q_u8(frame->blue + i) } };
+		vst3q_u8((uint8_t *)(dst + i), planes);
+	}
+	ws2812_planar_interleave_scalar(frame, dst, i, count);
+	return;
+#endif
+	ws2812_planar_interleave_scalar(frame, dst, 0, count);
+}
+
+/**
+ * @brief Fills a planar frame from packed pixels.
+ *
+ * @param frame The frame.
+ * @param src frame->length pixels.
+ */
+void ws2812_planar_from_pixels(ws2812_planar_frame *frame, const led_pixel *src)
+{
+	size_t count = frame->length;
+
+#ifdef WS2812_SIMD_X86
+	if (ws2812_isa_supported(WS2812_ISA_AVX2)) {
+		ws2812_planar_deinterleave_avx2(frame, src, 0, count);
+		return;
+	}
+	if (ws2812_isa_supported(WS2812_ISA_SSSE3)) {
+		ws2812_planar_deinterleave_ssse3(frame, src, 0, count);
+		return;
+	}
+#elif defined(__aarch64__)
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16) {
+		uint8x16x3_t planes = vld3q_u8((const uint8_t *)(src + i));
+		vst1q_u8(frame->red + i, planes.val[0]);
+		vst1q_u8(frame->green + i, planes.val[1]);
+		vst1q_u8(frame->blue + i, planes.val[2]);
+	}
+	ws2812_planar_deinterleave_scalar(frame, src, i, count);
+	return;
+#endif
+	ws2812_planar_deinterleave_scalar(frame, src, 0, count);
+}
+
+/**
+ * @brief Sends a planar frame to the device.
+ *
+ * The pixels are interleaved directly behind the packet header in the transfer
+ * buffer of the handle and sent with one write(), there is no intermediate
+ * led_pixel buffer.
+ *
+ * @param handle The WS2812 device.
+ * @param start_index Index of the first LED of the frame on the strip.
+ * @param frame The frame.
+ * @return Number of bytes written, or -1 on error (check errno for specific error).
+ */
+int ws2812_planar_submit(ws2812_handle *handle, uint16_t start_index,
+			 const ws2812_planar_frame *frame)
+{
+	size_t len = sizeof(led_pixel_data) + frame->length * sizeof(led_pixel);
+
+	pthread_mutex_lock(&handle->lock);
+	uint8_t *buf = ws2812_arena_reserve(handle, len);
+	if (!buf) {
+		pthread_mutex_unlock(&handle->lock);
+		return -1;
+	}
+
+	led_pixel_data header = {
+		.ctrl = CHAR_LED_PIXEL_DATA,
+		.offset = start_index,
+		.led_count = frame->length,
+	};
+	memcpy(buf, &header, sizeof(led_pixel_data));
+	ws2812_planar_to_pixels(frame,
+				(led_pixel *)(buf + sizeof(led_pixel_data)));
+
+	int ret = ws2812_io_write(handle, buf, len);
+	pthread_mutex_unlock(&handle->lock);
+	return ret;
+}
+
+/**
+ * @brief Target color of a blend mode for one channel value.
+ */
+static inline uint8_t ws2812_blend_target(uint8_t d, uint8_t s,
+					  ws2812_blend_mode mode)
+{
+	switch (mode) {
+	case WS2812_BLEND_ADD:
+		return d + s > 255 ? 255 : d + s;
+	case WS2812_BLEND_MULTIPLY:
+		return ws2812_div255(d * s);
+	case WS2812_BLEND_SCREEN:
+		return 255 - ws2812_div255((255 - d) * (255 - s));
+	default:
+		return s;
+	}
+}
+
+/**
+ * @brief Scalar blend of the pixels from..count.
+ */
+static void ws2812_planar_blend_scalar(ws2812_planar_frame *dst,
+				       const ws2812_planar_frame *src,
+				       const uint8_t *alpha, uint8_t opacity,
+				       ws2812_blend_mode mode, size_t from,
+				       size_t count)
+{
+	uint8_t *const dst_planes[3] = { dst->red, dst->green, dst->blue };
+	const uint8_t *const src_planes[3] = { src->red, src->green,
+					       src->blue };
+
+	for (size_t i = from; i < count; i++) {
+		unsigned int a =
+			alpha ? ws2812_div255(alpha[i] * opacity) : opacity;
+		for (int c = 0; c < 3; c++) {
+			uint8_t d = dst_planes[c][i];
+			uint8_t t = ws2812_blend_target(d, src_planes[c][i], mode);
+			dst_planes[c][i] = ws2812_div255(t * a + d * (255 - a));
+		}
+	}
+}
+
+#ifdef WS2812_SIMD_X86
+
+/**
+ * @brief ws2812_div255() of eight 16 bit values.
+ */
+__attribute__((target("ssse3"))) static inline __m128i
+ws2812_div255_epu16_ssse3(__m128i x)
+{
+	x = _mm_add_epi16(x, _mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+/**
+ * @brief ws2812_div255(a * b) of 16 bytes.
+ */
+__attribute__((target("ssse3"))) static inline __m128i
+ws2812_mul255_ssse3(__m128i a, __m128i b)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(a, zero),
+				     _mm_unpacklo_epi8(b, zero));
+	__m128i hi = _mm_mullo_epi16(_mm_unpackhi_epi8(a, zero),
+				     _mm_unpackhi_epi8(b, zero));
+	return _mm_packus_epi16(ws2812_div255_epu16_ssse3(lo),
+				ws2812_div255_epu16_ssse3(hi));
+}
+
+/**
+ * @brief SSSE3 blend of the pixels from..count, 16 per iteration.
+ *
+ * Same arithmetic as ws2812_planar_blend_scalar(), the results are identical.
+ */
+__attribute__((target("ssse3"))) static void
+ws2812_planar_blend_ssse3(ws2812_planar_frame *dst,
+			  const ws2812_planar_frame *src, const uint8_t *alpha,
+			  uint8_t opacity, ws2812_blend_mode mode, size_t from,
+			  size_t count)
+{
+	uint8_t *const dst_planes[3] = { dst->red, dst->green, dst->blue };
+	const uint8_t *const src_planes[3] = { src->red, src->green,
+					       src->blue };
+	const __m128i full = _mm_set1_epi8((char)255);
+	const __m128i opacity_v = _mm_set1_epi8((char)opacity);
+	size_t i = from;
+
+	for (; i + 16 <= count; i += 16) {
+		__m128i a = opacity_v;
+		if (alpha) {
+			a = ws2812_mul255_ssse3(
+				_mm_loadu_si128((const __m128i *)(alpha + i)),
+				opacity_v);
+		}
+		__m128i inv_a = _mm_xor_si128(a, full);
+		for (int c = 0; c < 3; c++) {
+			__m128i d = _mm_load_si128((const __m128i *)(dst_planes[c] + i));
+			__m128i s = _mm_load_si128((const __m128i *)(src_planes[c] + i));
+			__m128i t;
+			switch (mode) {
+			case WS2812_BLEND_ADD:
+				t = _mm_adds_epu8(d, s);
+				break;
+			case WS2812_BLEND_MULTIPLY:
+				t = ws2812_mul255_ssse3(d, s);
+				break;
+			case WS2812_BLEND_SCREEN:
+				t = _mm_xor_si128(
+					ws2812_mul255_ssse3(_mm_xor_si128(d, full),
+							    _mm_xor_si128(s, full)),
+					full);
+				break;
+			default:
+				t = s;
+				break;
+			}
+			// t * a + d * (255 - a) passt in 16 Bit (höchstens 255 * 255)
+			const __m128i zero = _mm_setzero_si128();
+			__m128i lo = _mm_add_epi16(
+				_mm_mullo_epi16(_mm_unpacklo_epi8(t, zero),
+						_mm_unpacklo_epi8(a, zero)),
+				_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero),
+						_mm_unpacklo_epi8(inv_a, zero)));
+			__m128i hi = _mm_add_epi16(
+				_mm_mullo_epi16(_mm_unpackhi_epi8(t, zero),
+						_mm_unpackhi_epi8(a, zero)),
+				_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero),
+						_mm_unpackhi_epi8(inv_a, zero)));
+			_mm_store_si128((__m128i *)(dst_planes[c] + i),
+					_mm_packus_epi16(ws2812_div255_epu16_ssse3(lo),
+							 ws2812_div255_epu16_ssse3(hi)));
+		}
+	}
+	ws2812_planar_blend_scalar(dst, src, alpha, opacity, mode, i, count);
+}
+
+/**
+ * @brief ws2812_div255() of sixteen 16 bit values.
+ */
+__attribute__((target("avx2"))) static inline __m256i
+ws2812_div255_epu16_avx2(__m256i x)
+{
+	x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+	return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)),
+				 8);
+}
+
+/**
+ * @brief ws2812_div255(a * b) of 32 bytes.
+ *
+ * Unpacking and packing both work per 128 bit lane, the byte order is kept.
+ */
+__attribute__((target("avx2"))) static inline __m256i
+ws2812_mul255_avx2(__m256i a, __m256i b)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i lo = _mm256_mullo_epi16(_mm256_unpacklo_epi8(a, zero),
+					_mm256_unpacklo_epi8(b, zero));
+	__m256i hi = _mm256_mullo_epi16(_mm256_unpackhi_epi8(a, zero),
+					_mm256_unpackhi_epi8(b, zero));
+	return _mm256_packus_epi16(ws2812_div255_epu16_avx2(lo),
+				   ws2812_div255_epu16_avx2(hi));
+}
+
+/**
+ * @brief AVX2 blend of the pixels from..count, 32 per iteration.
+ */
+__attribute__((target("avx2"))) static void
+ws2812_planar_blend_avx2(ws2812_planar_frame *dst,
+			 const ws2812_planar_frame *src, const uint8_t *alpha,
+			 uint8_t opacity, ws2812_blend_mode mode, size_t from,
+			 size_t count)
+{
+	uint8_t *const dst_planes[3] = { dst->red, dst->green, dst->blue };
+	const uint8_t *const src_planes[3] = { src->red, src->green,
+					       src->blue };
+	const __m256i full = _mm256_set1_epi8((char)255);
+	const __m256i opacity_v = _mm256_set1_epi8((char)opacity);
+	size_t i = from;
+
+	for (; i + 32 <= count; i += 32) {
+		__m256i a = opacity_v;
+		if (alpha) {
+			a = ws2812_mul255_avx2(
+				_mm256_loadu_si256((const __m256i *)(alpha + i)),
+				opacity_v);
+		}
+		__m256i inv_a = _mm256_xor_si256(a, full);
+		for (int c = 0; c < 3; c++) {
+			__m256i d = _mm256_load_si256((const __m256i *)(dst_planes[c] + i));
+			__m256i s = _mm256_load_si256((const __m256i *)(src_planes[c] + i));
+			__m256i t;
+			switch (mode) {
+			case WS2812_BLEND_ADD:
+				t = _mm256_adds_epu8(d, s);
+				break;
+			case WS2812_BLEND_MULTIPLY:
+				t = ws2812_mul255_avx2(d, s);
+				break;
+			case WS2812_BLEND_SCREEN:
+				t = _mm256_xor_si256(
+					ws2812_mul255_avx2(_mm256_xor_si256(d, full),
+							   _mm256_xor_si256(s, full)),
+					full);
+				break;
+			default:
+				t = s;
+				break;
+			}
+			const __m256i zero = _mm256_setzero_si256();
+			__m256i lo = _mm256_add_epi16(
+				_mm256_mullo_epi16(_mm256_unpacklo_epi8(t, zero),
+						   _mm256_unpacklo_epi8(a, zero)),
+				_mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero),
+						   _mm256_unpacklo_epi8(inv_a, zero)));
+			__m256i hi = _mm256_add_epi16(
+				_mm256_mullo_epi16(_mm256_unpackhi_epi8(t, zero),
+						   _mm256_unpackhi_epi8(a, zero)),
+				_mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero),
+						   _mm256_unpackhi_epi8(inv_a, zero)));
+			_mm256_store_si256((__m256i *)(dst_planes[c] + i),
+					   _mm256_packus_epi16(ws2812_div255_epu16_avx2(lo),
+							       ws2812_div255_epu16_avx2(hi)));
+		}
+	}
+	ws2812_planar_blend_ssse3(dst, src, alpha, opacity, mode, i, count);
+}
+
+#endif
+
+/**
+ * @brief Blends a planar frame onto another one.
+ *
+ * Each pixel of dst is moved from its color towards the target color of mode
+ * (see ws2812_blend_mode) by alpha[i] * opacity / 255. The first
+ * min(dst->length, src->length) pixels are blended. Results are rounded and
+ * identical on all instruction sets.
+ *
+ * @param dst Destination frame, changed in place.
+ * @param src Source frame.
+ * @param alpha Opacity per pixel (0 transparent ... 255 opaque) for src->length
+ *              pixels, or NULL for fully opaque pixels. Needs no alignment.
+ * @param opacity Opacity of the whole source, 0 ... 255.
+ * @param mode Blend mode.
+ */
+void ws2812_planar_blend(ws2812_planar_frame *dst,
+			 const ws2812_planar_frame *src, const uint8_t *alpha,
+			 uint8_t opacity, ws2812_blend_mode mode)
+{
+	size_t count = dst->length < src->length ? dst->length : src->length;
+
+	if (opacity == 0) {
+		return;
+	}
+#ifdef WS2812_SIMD_X86
+	if (ws2812_isa_supported(WS2812_ISA_AVX2)) {
+		ws2812_planar_blend_avx2(dst, src, alpha, opacity, mode, 0,
+					 count);
+		return;
+	}
+	if (ws2812_isa_supported(WS2812_ISA_SSSE3)) {
+		ws2812_planar_blend_ssse3(dst, src, alpha, opacity, mode, 0,
+					  count);
+		return;
+	}
+#endif
+	ws2812_planar_blend_scalar(dst, src, alpha, opacity, mode, 0, count);
+}
+
+/**
+ * @brief Coefficients of a YUV matrix, Q13 fixed point (8192 is 1.0).
+ */
+typedef struct ws2812_yuv_coeffs_s {
+	int16_t y_offset; /**< Black level of Y. */
+	int16_t y; /**< Scale of Y. */
+	int16_t r_v; /**< V to red. */
+	int16_t g_u; /**< U to green. */
+	int16_t g_v; /**< V to green. */
+	int16_t b_u; /**< U to blue. */
+} ws2812_yuv_coeffs;
+
+static const ws2812_yuv_coeffs ws2812_yuv_matrices[] = {
+	[WS2812_YUV_BT601] = { 16, 9539, 13075, -3209, -6660, 16525 },
+	[WS2812_YUV_BT709] = { 16, 9539, 14686, -1747, -4366, 17305 },
+	[WS2812_YUV_BT601_FULL] = { 0, 8192, 11485, -2819, -5850, 14516 },
+	[WS2812_YUV_BT709_FULL] = { 0, 8192, 12901, -1535, -3835, 15201 },
+};
+
+/**
+ * @brief (a * b + 2^14) >> 15, the rounding multiply of pmulhrsw.
+ */
+static inline int16_t ws2812_mulhrs(int16_t a, int16_t b)
+{
+	return (int16_t)(((int32_t)a * b + 0x4000) >> 15);
+}
+
+/**
+ * @brief Channel in 4 fractional bits to a byte, rounded and saturated like packuswb.
+ */
+static inline uint8_t ws2812_yuv_clamp(int16_t x)
+{
+	x = (int16_t)(x + 8) >> 4;
+	return x < 0 ? 0 : x > 255 ? 255 : x;
+}
+
+/**
+ * @brief Scalar conversion of the pixels from..count.
+ *
+ * The inputs are shifted left by 6, a Q13 coefficient then yields the product
+ * with 4 fractional bits after pmulhrsw. All intermediate sums fit 16 bits.
+ */
+static void ws2812_planar_yuv_scalar(ws2812_planar_frame *frame,
+				     const uint8_t *y, const uint8_t *u,
+				     const uint8_t *v,
+				     const ws2812_yuv_coeffs *k, size_t from,
+				     size_t count)
+{
+	for (size_t i = from; i < count; i++) {
+		int16_t yy = ws2812_mulhrs((y[i] - k->y_offset) * 64, k->y);
+		int16_t uu = (u[i] - 128) * 64;
+		int16_t vv = (v[i] - 128) * 64;
+		frame->red[i] = ws2812_yuv_clamp(yy + ws2812_mulhrs(vv, k->r_v));
+		frame->green[i] = ws2812_yuv_clamp(yy + ws2812_mulhrs(uu, k->g_u) +
+						   ws2812_mulhrs(vv, k->g_v));
+		frame->blue[i] = ws2812_yuv_clamp(yy + ws2812_mulhrs(uu, k->b_u));
+	}
+}
+
+#ifdef WS2812_SIMD_X86
+
+/**
+ * @brief Converts eight pixels (16 bit lanes) of Y, U and V into R, G and B.
+ */
+__attribute__((target("ssse3"))) static inline void
+ws2812_yuv8_ssse3(__m128i y, __m128i u, __m128i v, const ws2812_yuv_coeffs *k,
+		  __m128i rgb[3])
+{
+	const __m128i round = _mm_set1_epi16(8);
+	__m128i yy = _mm_mulhrs_epi16(
+		_mm_slli_epi16(_mm_sub_epi16(y, _mm_set1_epi16(k->y_offset)), 6),
+		_mm_set1_epi16(k->y));
+	__m128i uu = _mm_slli_epi16(_mm_sub_epi16(u, _mm_set1_epi16(128)), 6);
+	__m128i vv = _mm_slli_epi16(_mm_sub_epi16(v, _mm_set1_epi16(128)), 6);
+	yy = _mm_add_epi16(yy, round);
+
+	rgb[0] = _mm_add_epi16(yy, _mm_mulhrs_epi16(vv, _mm_set1_epi16(k->r_v)));
+	rgb[1] = _mm_add_epi16(
+		_mm_add_epi16(yy, _mm_mulhrs_epi16(uu, _mm_set1_epi16(k->g_u))),
+		_mm_mulhrs_epi16(vv, _mm_set1_epi16(k->g_v)));
+	rgb[2] = _mm_add_epi16(yy, _mm_mulhrs_epi16(uu, _mm_set1_epi16(k->b_u)));
+	for (int c = 0; c < 3; c++) {
+		rgb[c] = _mm_srai_epi16(rgb[c], 4);
+	}
+}
+
+/**
+ * @brief SSSE3 conversion of the pixels from..count, 16 per iteration.
+ *
+ * Same arithmetic as ws2812_planar_yuv_scalar(), the results are identical.
+ */
+__attribute__((target("ssse3"))) static void
+ws2812_planar_yuv_ssse3(ws2812_planar_frame *frame, const uint8_t *y,
+			const uint8_t *u, const uint8_t *v,
+			const ws2812_yuv_coeffs *k, size_t from, size_t count)
+{
+	uint8_t *const planes[3] = { frame->red, frame->green, frame->blue };
+	const __m128i zero = _mm_setzero_si128();
+	size_t i = from;
+
+	for (; i + 16 <= count; i += 16) {
+		__m128i yv = _mm_loadu_si128((const __m128i *)(y + i));
+		__m128i uv = _mm_loadu_si128((const __m128i *)(u + i));
+		__m128i vv = _mm_loadu_si128((const __m128i *)(v + i));
+		__m128i lo[3], hi[3];
+		ws2812_yuv8_ssse3(_mm_unpacklo_epi8(yv, zero),
+				  _mm_unpacklo_epi8(uv, zero),
+				  _mm_unpacklo_epi8(vv, zero), k, lo);
+		ws2812_yuv8_ssse3(_mm_unpackhi_epi8(yv, zero),
+				  _mm_unpackhi_epi8(uv, zero),
+				  _mm_unpackhi_epi8(vv, zero), k, hi);
+		for (int c = 0; c < 3; c++) {
+			_mm_store_si128((__m128i *)(planes[c] + i),
+					_mm_packus_epi16(lo[c], hi[c]));
+		}
+	}
+	ws2812_planar_yuv_scalar(frame, y, u, v, k, i, count);
+}
+
+/**
+ * @brief Converts sixteen pixels (16 bit lanes) of Y, U and V into R, G and B.
+ */
+__attribute__((target("avx2"))) static inline void
+ws2812_yuv16_avx2(__m256i y, __m256i u, __m256i v, const ws2812_yuv_coeffs *k,
+		  __m256i rgb[3])
+{
+	const __m256i round = _mm256_set1_epi16(8);
+	__m256i yy = _mm256_mulhrs_epi16(
+		_mm256_slli_epi16(
+			_mm256_sub_epi16(y, _mm256_set1_epi16(k->y_offset)), 6),
+		_mm256_set1_epi16(k->y));
+	__m256i uu = _mm256_slli_epi16(
+		_mm256_sub_epi16(u, _mm256_set1_epi16(128)), 6);
+	__m256i vv = _mm256_slli_epi16(
+		_mm256_sub_epi16(v, _mm256_set1_epi16(128)), 6);
+	yy = _mm256_add_epi16(yy, round);
+
+	rgb[0] = _mm256_add_epi16(
+		yy, _mm256_mulhrs_epi16(vv, _mm256_set1_epi16(k->r_v)));
+	rgb[1] = _mm256_add_epi16(
+		_mm256_add_epi16(
+			yy, _mm256_mulhrs_epi16(uu, _mm256_set1_epi16(k->g_u))),
+		_mm256_mulhrs_epi16(vv, _mm256_set1_epi16(k->g_v)));
+	rgb[2] = _mm256_add_epi16(
+		yy, _mm256_mulhrs_epi16(uu, _mm256_set1_epi16(k->b_u)));
+	for (int c = 0; c < 3; c++) {
+		rgb[c] = _mm256_srai_epi16(rgb[c], 4);
+	}
+}
+
+/**
+ * @brief AVX2 conversion of the pixels from..count, 32 per iteration.
+ *
+ * Unpacking and packing both work per 128 bit lane, the byte order is kept.
+ */
+__attribute__((target("avx2"))) static void
+ws2812_planar_yuv_avx2(ws2812_planar_frame *frame, const uint8_t *y,
+		       const uint8_t *u, const uint8_t *v,
+		       const ws2812_yuv_coeffs *k, size_t from, size_t count)
+{
+	uint8_t *const planes[3] = { frame->red, frame->green, frame->blue };
+	const __m256i zero = _mm256_setzero_si256();
+	size_t i = from;
+
+	for (; i + 32 <= count; i += 32) {
+		__m256i yv = _mm256_loadu_si256((const __m256i *)(y + i));
+		__m256i uv = _mm256_loadu_si256((const __m256i *)(u + i));
+		__m256i vv = _mm256_loadu_si256((const __m256i *)(v + i));
+		__m256i lo[3], hi[3];
+		ws2812_yuv16_avx2(_mm256_unpacklo_epi8(yv, zero),
+				  _mm256_unpacklo_epi8(uv, zero),
+				  _mm256_unpacklo_epi8(vv, zero), k, lo);
+		ws2812_yuv16_avx2(_mm256_unpackhi_epi8(yv, zero),
+				  _mm256_unpackhi_epi8(uv, zero),
+				  _mm256_unpackhi_epi8(vv, zero), k, hi);
+		for (int c = 0; c < 3; c++) {
+			_mm256_store_si256((__m256i *)(planes[c] + i),
+					   _mm256_packus_epi16(lo[c], hi[c]));
+		}
+	}
+	ws2812_planar_yuv_ssse3(frame, y, u, v, k, i, count);
+}
+
+#endif
+
+/**
+ * @brief Fills a planar frame from YUV values, e.g. pixels sampled from video.
+ *
+ * Results are rounded and identical on all instruction sets.
+ *
+ * @param frame The frame, frame->length pixels are converted.
+ * @param y Luma, frame->length values. Needs no alignment.
+ * @param u Blue difference (Cb), frame->length values.
+ * @param v Red difference (Cr), frame->length values.
+ * @param matrix Color matrix and range of the values, values outside the
+ *        enum fall back to WS2812_YUV_BT601.
+ */
+void ws2812_planar_from_yuv(ws2812_planar_frame *frame, const uint8_t *y,
+			    const uint8_t *u, const uint8_t *v,
+			    ws2812_yuv_matrix matrix)
+{
+	const ws2812_yuv_coeffs *k =
+		&ws2812_yuv_matrices[(unsigned int)matrix < WS2812_YUV_MATRIX_LENGTH ?
+					     matrix :
+					     WS2812_YUV_BT601];
+	size_t count = frame->length;
+
+#ifdef WS2812_SIMD_X86
+	if (ws2812_isa_supported(WS2812_ISA_AVX2)) {
+		ws2812_planar_yuv_avx2(frame, y, u, v, k, 0, count);
+		return;
+	}
+	if (ws2812_isa_supported(WS2812_ISA_SSSE3)) {
+		ws2812_planar_yuv_ssse3(frame, y, u, v, k, 0, count);
+		return;
+	}
+#endif
+	ws2812_planar_yuv_scalar(frame, y, u, v, k, 0, count);
+}
@@ -0,0 +1,169 @@
+/**
+ * @file usb_ws2812_private.h                                                  *
+ * @brief Internal definitions shared by the modules of the user library       *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#ifndef USB_WS2812_PRIVATE_H
+#define USB_WS2812_PRIVATE_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include "usb_ws2812_lib.h"
+
+/**
+ * @def WS2812_DIFF_PACKET_COST
+ * @brief Cost of an additional pixel data packet in bytes of pixel data.
+ *
+ * Header plus the work to parse and copy a packet in the kernel module. Two changed
+ * runs are merged if the unchanged gap between them is cheaper than this.
+ */
+#define WS2812_DIFF_PACKET_COST (sizeof(led_pixel_data) + 16)
+
+/**
+ * @brief I/O functions of a handle that doesn't use the kernel module.
+ *
+ * The public functions build the packets of dev_packets.h as for the kernel
+ * module, a backend receives them through ws2812_io_writev() and ws2812_io_read()
+ * and must behave like a write()/read() on the device file.
+ */
+typedef struct ws2812_backend_s {
+	/** @brief Like writev() on the device file, lock of the handle held. */
+	ssize_t (*writev)(ws2812_handle *handle, const struct iovec *iov,
+			  int iovcnt);
+	/** @brief Like read() on the device file, lock of the handle held. */
+	ssize_t (*read)(ws2812_handle *handle, void *buf, size_t len);
+	/** @brief Frees backend_data, called by ws2812_close(). */
+	void (*close)(ws2812_handle *handle);
+} ws2812_backend;
+
+/**
+ * @brief State of an opened WS2812 device.
+ *
+ * All members are protected by lock. Every public function takes the lock for
+ * the whole request, so a request/response pair (e.g. CHAR_LED_GET_DATA followed
+ * by read()) can't be interleaved with the request of another thread.
+ *
+ * Length and mode are cached after they were queried once, so uploads don't need a
+ * round trip through the kernel module to check them. Writes of the library that
+ * may change them invalidate the cache, ws2812_refresh() reloads it.
+ */
+struct ws2812_handle_s {
+	int fd; /**< File descriptor of the device file, -1 with a backend. */
+	bool owns_fd; /**< fd is closed by ws2812_close(). */
+	const ws2812_backend *backend; /**< NULL for the kernel module. */
+	void *backend_data; /**< State of the backend. */
+	pthread_mutex_t lock; /**< Serialises all requests on this handle. */
+	uint8_t *arena; /**< Transfer buffer for packets to and from the kernel module. */
+	size_t arena_size; /**< Size of arena in bytes. */
+	uint16_t max_leds; /**< Number of pixels the arena was sized for. */
+	bool length_valid; /**< length holds the length reported by the device. */
+	uint16_t length; /**< Cached answer of the last length query. */
+	bool mode_valid; /**< mode holds the mode reported by the device. */
+	led_set_mode mode; /**< Cached answer of the last mode query. */
+};
+
+/**
+ * @brief Forgets the cached length and mode, the next query asks the device.
+ *
+ * Called after every packet that may change length or mode (everything except
+ * pixel data).
+ *
+ * @param handle The device, lock must be held.
+ */
+static inline void ws2812_cache_invalidate(ws2812_handle *handle)
+{
+	handle->length_valid = false;
+	handle->mode_valid = false;
+}
+
+/**
+ * @brief x / 255 rounded, exact for 0 <= x <= 255 * 255.
+ *
+ * Scalar reference of the SIMD blend and HSV kernels, which use the same formula.
+ */
+static inline uint32_t ws2812_div255(uint32_t x)
+{
+	x += 128;
+	return (x + (x >> 8)) >> 8;
+}
+
+/**
+ * @brief Allocates a handle without a device (fd -1), see ws2812_open_fd().
+ *
+ * @param max_leds Largest number of pixels per request, 0 for WS2812_DEFAULT_MAX_LEDS.
+ * @return The handle, or NULL on error (check errno for specific error).
+ */
+ws2812_handle *ws2812_handle_alloc(uint16_t max_leds);
+
+/**
+ * @brief Opens a strip through libusb (the part of the path after WS2812_USB_PATH_PREFIX).
+ *
+ * @param strip Index of the strip as decimal number, empty for 0.
+ * @param max_leds Largest number of pixels per request, 0 for WS2812_DEFAULT_MAX_LEDS.
+ * @return The handle, or NULL on error (check errno for specific error).
+ *         ENOTSUP if the library was built without libusb.
+ */
+ws2812_handle *ws2812_usb_open(const char *strip, uint16_t max_leds);
+
+/**
+ * @brief Returns a transfer buffer of at least size bytes.
+ *
+ * The arena is allocated by ws2812_open() for max_leds pixels, it only grows
+ * (once) if a request is larger than that.
+ *
+ * @param handle The device, lock must be held.
+ * @param size Required size in bytes.
+ * @return The arena, or NULL with errno set if it could not grow.
+ */
+uint8_t *ws2812_arena_reserve(ws2812_handle *handle, size_t size);
+
+/**
+ * @brief Writes a packet to the kernel module.
+ *
+ * @param handle The device, lock must be held.
+ * @param buf The packet.
+ * @param len Length of the packet.
+ * @return Number of bytes written, or -1 on error (check errno for specific error).
+ */
+ssize_t ws2812_io_write(ws2812_handle *handle, const void *buf, size_t len);
+
+/**
+ * @brief Writes a packet scattered over several buffers to the kernel module.
+ *
+ * The buffers reach the kernel module as one write, so a packet header and the
+ * pixel data of the caller don't have to be copied into the arena first.
+ *
+ * @param handle The device, lock must be held.
+ * @param iov The buffers.
+ * @param iovcnt Number of buffers.
+ * @return Number of bytes written, or -1 on error (check errno for specific error).
+ */
+ssize_t ws2812_io_writev(ws2812_handle *handle, const struct iovec *iov,
+			 int iovcnt);
+
+/**
+ * @brief Reads an answer of the kernel module.
+ *
+ * @param handle The device, lock must be held.
+ * @param buf The buffer for the answer.
+ * @param len Size of the buffer.
+ * @return Number of bytes read, or -1 on error (check errno for specific error).
+ */
+ssize_t ws2812_io_read(ws2812_handle *handle, void *buf, size_t len);
+
+/**
+ * @brief Returns true if the CPU supports an instruction set.
+ *
+ * @param isa The instruction set, WS2812_ISA_AUTO is not supported.
+ * @return true if kernels for isa can run.
+ */
+bool ws2812_isa_supported(ws2812_isa isa);
+
+#endif
@@ -0,0 +1,381 @@
+/**
+ * @file usb_ws2812_queue.c                                                    *
+ * @brief Lock-free frame queue between a render thread and a sender thread    *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#include "usb_ws2812_lib.h"
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+/**
+ * @brief Frame queue of a device.
+ *
+ * The queue holds indices of frame buffers, not the frames. There are slots + 2
+ * buffers: one is rendered by the producer, one is sent by the sender thread and up
+ * to slots are queued. Taking the oldest entry is a CAS on tail, for the sender
+ * as well as for the producer with WS2812_QUEUE_DROP_OLDEST, so whoever wins owns
+ * the buffer. Sent buffers go back to the producer through a second SPSC ring.
+ */
+struct ws2812_frame_queue_s {
+	ws2812_handle *handle; /**< The device. */
+	uint16_t length; /**< Number of LEDs of a frame. */
+	ws2812_queue_policy policy; /**< Policy if the queue is full. */
+	uint32_t slots; /**< Capacity of the queue. */
+	led_pixel *frames; /**< slots + 2 frame buffers. */
+	uint64_t *publish_ns; /**< Publish time of each buffer. */
+
+	uint32_t *ring; /**< Queued buffer indices. */
+	uint64_t head; /**< Next ring entry to write, only written by the producer. */
+	uint64_t tail; /**< Oldest ring entry, CAS by producer and sender. */
+
+	uint32_t *free_ring; /**< Sent buffer indices (slots + 2 entries). */
+	uint64_t free_head; /**< Only written by the sender. */
+	uint64_t free_tail; /**< Only written by the producer. */
+
+	uint32_t producer_buf; /**< Buffer the producer renders into. */
+	uint64_t acquire_ns; /**< Time of ws2812_queue_acquire(). */
+
+	sem_t items; /**< Posted for a waiting sender when a frame was queued. */
+	sem_t space; /**< Posted for a waiting producer when the sender took a frame. */
+	bool sender_waiting; /**< Sender sleeps (or is about to) on items. */
+	bool producer_waiting; /**< Producer sleeps (or is about to) on space. */
+	bool stop; /**< Sender exits when the queue is empty. */
+	pthread_t sender; /**< The sender thread. */
+
+	ws2812_queue_stats stats; /**< Updated with __atomic operations. */
+};
+
+static uint64_t ws2812_queue_now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/**
+ * @brief Adds a measurement to a stage, only called by the thread owning the stage.
+ */
+static void ws2812_stage_add(ws2812_stage_stats *stage, uint64_t ns)
+{
+	__atomic_fetch_add(&stage->count, 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&stage->total_ns, ns, __ATOMIC_RELAXED);
+	if (ns > __atomic_load_n(&stage->max_ns, __ATOMIC_RELAXED)) {
+		__atomic_store_n(&stage->max_ns, ns, __ATOMIC_RELAXED);
+	}
+}
+
+static led_pixel *ws2812_queue_frame(ws2812_frame_queue *queue, uint32_t buf)
+{
+	return queue->frames + (size_t)buf * queue->length;
+}
+
+/**
+ * @brief Takes the oldest queued buffer.
+ *
+ * @param queue The queue.
+ * @param buf Receives the buffer index.
+ * @return true if a buffer was taken, false if the queue is empty.
+ */
+static bool ws2812_queue_pop(ws2812_frame_queue *queue, uint32_t *buf)
+{
+	uint64_t tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+	for (;;) {
+		uint64_t head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+		if (tail == head) {
+			return false;
+		}
+		// Vor dem CAS lesen, danach darf der Producer den Eintrag überschreiben
+		uint32_t value = __atomic_load_n(
+			&queue->ring[tail % queue->slots], __ATOMIC_RELAXED);
+		if (__atomic_compare_exchange_n(&queue->tail, &tail, tail + 1,
+						false, __ATOMIC_SEQ_CST,
+						__ATOMIC_ACQUIRE)) {
+			*buf = value;
+			return true;
+		}
+	}
+}
+
+/**
+ * @brief Returns true if no frame is queued.
+ */
+static bool ws2812_queue_empty(ws2812_frame_queue *queue)
+{
+	return __atomic_load_n(&queue->head, __ATOMIC_SEQ_CST) ==
+	       __atomic_load_n(&queue->tail, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * @brief Returns true if slots frames are queued.
+ */
+static bool ws2812_queue_full(ws2812_frame_queue *queue)
+{
+	return queue->head - __atomic_load_n(&queue->tail, __ATOMIC_SEQ_CST) >=
+	       queue->slots;
+}
+
+/**
+ * @brief Sender thread, sends queued frames until the queue is stopped and empty.
+ *
+ * The semaphores are only posted if the other side announced that it waits. The
+ * waiting flag is set before the condition is checked again and the other side
+ * changes the condition before it checks the flag (all sequentially consistent),
+ * so a wakeup can't be lost.
+ */
+static void *ws2812_queue_sender(void *arg)
+{
+	ws2812_frame_queue *queue = arg;
+
+	for (;;) {
+		uint32_t buf;
+		while (!ws2812_queue_pop(queue, &buf)) {
+			if (__atomic_load_n(&queue->stop, __ATOMIC_SEQ_CST)) {
+				return NULL;
+			}
+			__atomic_store_n(&queue->sender_waiting, true,
+					 __ATOMIC_SEQ_CST);
+			if (ws2812_queue_empty(queue) &&
+			    !__atomic_load_n(&queue->stop, __ATOMIC_SEQ_CST)) {
+				sem_wait(&queue->items);
+			}
+			__atomic_store_n(&queue->sender_waiting, false,
+					 __ATOMIC_SEQ_CST);
+		}
+		if (__atomic_exchange_n(&queue->producer_waiting, false,
+					__ATOMIC_SEQ_CST)) {
+			sem_post(&queue->space);
+		}
+
+		uint64_t start = ws2812_queue_now_ns();
+		ws2812_stage_add(&queue->stats.queue, start - queue->publish_ns[buf]);
+		if (ws2812_set_led_pixel(queue->handle, 0, queue->length,
+					 ws2812_queue_frame(queue, buf)) < 0) {
+			__atomic_fetch_add(&queue->stats.errors, 1,
+					   __ATOMIC_RELAXED);
+		}
+		ws2812_stage_add(&queue->stats.submit,
+				 ws2812_queue_now_ns() - start);
+
+		// Buffer an den Producer zurückgeben
+		uint64_t free_head = queue->free_head;
+		queue->free_ring[free_head % (queue->slots + 2)] = buf;
+		__atomic_store_n(&queue->free_head, free_head + 1,
+				 __ATOMIC_RELEASE);
+	}
+}
+
+/**
+ * @brief Creates a frame queue with its own sender thread.
+ *
+ * One render thread acquires a frame buffer with ws2812_queue_acquire(), renders
+ * into it and publishes it with ws2812_queue_publish(), neither call takes a lock
+ * or allocates memory. The sender thread sends the frames in order with
+ * ws2812_set_led_pixel(). All frame buffers are allocated here.
+ *
+ * @param handle The WS2812 device, it should only be written by the queue afterwards.
+ * @param length Number of LEDs of a frame.
+ * @param slots Number of frames the queue can hold (1 ... UINT32_MAX - 2).
+ * @param policy What ws2812_queue_publish() does if the queue is full.
+ * @return The queue, or NULL on error (check errno for specific error).
+ */
+ws2812_frame_queue *ws2812_queue_create(ws2812_handle *handle, uint16_t length,
+					uint32_t slots,
+					ws2812_queue_policy policy)
+{
+	// Zwei Puffer mehr als Plätze, slots + 2 darf nicht überlaufen
+	if (slots == 0 || slots > UINT32_MAX - 2 || length == 0) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	ws2812_frame_queue *queue = calloc(1, sizeof(ws2812_frame_queue));
+	if (!queue) {
+		return NULL;
+	}
+	queue->handle = handle;
+	queue->length = length;
+	queue->policy = policy;
+	queue->slots = slots;
+	queue->frames = calloc(((size_t)slots + 2) * length, sizeof(led_pixel));
+	queue->publish_ns = calloc((size_t)slots + 2, sizeof(uint64_t));
+	queue->ring = calloc(slots, sizeof(uint32_t));
+	queue->free_ring = calloc((size_t)slots + 2, sizeof(uint32_t));
+	if (!queue->frames || !queue->publish_ns || !queue->ring ||
+	    !queue->free_ring) {
+		goto err_free;
+	}
+
+	// Buffer 0 rendert der Producer, alle anderen sind frei
+	queue->producer_buf = 0;
+	for (uint32_t i = 1; i < slots + 2; i++) {
+		queue->free_ring[i - 1] = i;
+	}
+	queue->free_head = slots + 1;
+
+	sem_init(&queue->items, 0, 0);
+	sem_init(&queue->space, 0, 0);
+	int err = pthread_create(&queue->sender, NULL, ws2812_queue_sender,
+				 queue);
+	if (err) {
+		sem_destroy(&queue->items);
+		sem_destroy(&queue->space);
+		errno = err;
+		goto err_free;
+	}
+	return queue;
+
+err_free:
+	free(queue->free_ring);
+	free(queue->ring);
+	free(queue->publish_ns);
+	free(queue->frames);
+	free(queue);
+	return NULL;
+}
+
+/**
+ * @brief Sends all queued frames, stops the sender thread and frees the queue.
+ *
+ * @param queue The queue, may be NULL.
+ */
+void ws2812_queue_destroy(ws2812_frame_queue *queue)
+{
+	if (!queue) {
+		return;
+	}
+	__atomic_store_n(&queue->stop, true, __ATOMIC_SEQ_CST);
+	sem_post(&queue->items);
+	pthread_join(queue->sender, NULL);
+
+	sem_destroy(&queue->items);
+	sem_destroy(&queue->space);
+	free(queue->free_ring);
+	free(queue->ring);
+	free(queue->publish_ns);
+	free(queue->frames);
+	free(queue);
+}
+
+/**
+ * @brief Returns the frame buffer to render the next frame into.
+ *
+ * The buffer belongs to the render thread until ws2812_queue_publish(). It contains
+ * an old frame, not necessarily the last published one.
+ *
+ * @param queue The queue.
+ * @return The frame buffer with the length given to ws2812_queue_create().
+ */
+led_pixel *ws2812_queue_acquire(ws2812_frame_queue *queue)
+{
+	queue->acquire_ns = ws2812_queue_now_ns();
+	return ws2812_queue_frame(queue, queue->producer_buf);
+}
+
+/**
+ * @brief Queues the frame rendered into the buffer of ws2812_queue_acquire().
+ *
+ * If the queue is full, WS2812_QUEUE_DROP_OLDEST removes the oldest queued frame,
+ * WS2812_QUEUE_DROP_NEWEST discards this frame (the buffer is returned again by the
+ * next ws2812_queue_acquire()) and WS2812_QUEUE_BLOCK waits until the sender took a frame.
+ *
+ * @param queue The queue.
+ * @return 0 if the frame was queued without loss, 1 if a frame was dropped.
+ */
+int ws2812_queue_publish(ws2812_frame_queue *queue)
+{
+	uint64_t now = ws2812_queue_now_ns();
+	ws2812_stage_add(&queue->stats.render, now - queue->acquire_ns);
+
+	uint64_t head = queue->head;
+	uint32_t dropped_buf;
+	bool dropped = false;
+
+	while (ws2812_queue_full(queue)) {
+		if (queue->policy == WS2812_QUEUE_DROP_NEWEST) {
+			__atomic_fetch_add(&queue->stats.dropped, 1,
+					   __ATOMIC_RELAXED);
+			return 1;
+		}
+		if (queue->policy == WS2812_QUEUE_DROP_OLDEST) {
+			if (ws2812_queue_pop(queue, &dropped_buf)) {
+				dropped = true;
+				__atomic_fetch_add(&queue->stats.dropped, 1,
+						   __ATOMIC_RELAXED);
+				break;
+			}
+			continue; // der Sender war schneller
+		}
+		__atomic_store_n(&queue->producer_waiting, true,
+				 __ATOMIC_SEQ_CST);
+		if (ws2812_queue_full(queue)) {
+			sem_wait(&queue->space);
+		}
+		__atomic_store_n(&queue->producer_waiting, false,
+				 __ATOMIC_SEQ_CST);
+	}
+
+	uint32_t buf = queue->producer_buf;
+	queue->publish_ns[buf] = now;
+	__atomic_store_n(&queue->ring[head % queue->slots], buf,
+			 __ATOMIC_RELAXED);
+	__atomic_store_n(&queue->head, head + 1, __ATOMIC_SEQ_CST);
+	if (__atomic_exchange_n(&queue->sender_waiting, false,
+				__ATOMIC_SEQ_CST)) {
+		sem_post(&queue->items);
+	}
+
+	// Neuen Buffer für den nächsten Frame holen
+	if (dropped) {
+		queue->producer_buf = dropped_buf;
+	} else {
+		uint64_t free_tail = queue->free_tail;
+		while (__atomic_load_n(&queue->free_head, __ATOMIC_ACQUIRE) ==
+		       free_tail) {
+			// Kann nicht passieren: slots + 2 Buffer, höchstens slots + 1 belegt
+		}
+		queue->producer_buf =
+			queue->free_ring[free_tail % (queue->slots + 2)];
+		queue->free_tail = free_tail + 1;
+	}
+	__atomic_fetch_add(&queue->stats.published, 1, __ATOMIC_RELAXED);
+	return dropped ? 1 : 0;
+}
+
+/**
+ * @brief Returns the statistics of a queue.
+ *
+ * The stages are measured separately: render from ws2812_queue_acquire() to
+ * ws2812_queue_publish(), queue from publishing until the sender takes the frame
+ * and submit for the write to the kernel module.
+ *
+ * @param queue The queue.
+ * @param stats Receives the statistics.
+ */
+void ws2812_queue_get_stats(ws2812_frame_queue *queue,
+			    ws2812_queue_stats *stats)
+{
+	ws2812_stage_stats *src[] = { &queue->stats.render,
+				      &queue->stats.queue,
+				      &queue->stats.submit };
+	ws2812_stage_stats *dst[] = { &stats->render, &stats->queue,
+				      &stats->submit };
+
+	for (int i = 0; i < 3; i++) {
+		dst[i]->count = __atomic_load_n(&src[i]->count, __ATOMIC_RELAXED);
+		dst[i]->total_ns =
+			__atomic_load_n(&src[i]->total_ns, __ATOMIC_RELAXED);
+		dst[i]->max_ns = __atomic_load_n(&src[i]->max_ns, __ATOMIC_RELAXED);
+	}
+	stats->published =
+		__atomic_load_n(&queue->stats.published, __ATOMIC_RELAXED);
+	stats->dropped = __atomic_load_n(&queue->stats.dropped, __ATOMIC_RELAXED);
+	stats->errors = __atomic_load_n(&queue->stats.errors, __ATOMIC_RELAXED);
+}
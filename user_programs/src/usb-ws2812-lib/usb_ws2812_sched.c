@@ -0,0 +1,238 @@
+/**
+ * @file usb_ws2812_sched.c                                                    *
+ * @brief Frame pacing with a timerfd and a wire-time model of the controller  *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#include "usb_ws2812_lib.h"
+#include <errno.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @def WS2812_USB_PIXELS_PER_PACKET
+ * @brief Pixels per 64 byte USB packet of the kernel module (ws2812_usb_packet_pixeldata).
+ */
+#define WS2812_USB_PIXELS_PER_PACKET 21
+
+/**
+ * @def WS2812_USB_PACKET_NS
+ * @brief Time per bulk packet on USB Full-Speed (at most 19 packets of 64 byte per 1 ms frame).
+ */
+#define WS2812_USB_PACKET_NS 52632
+
+/**
+ * @def WS2812_PIXEL_NS
+ * @brief Wire time of one pixel, 24 bits at 800 kHz.
+ */
+#define WS2812_PIXEL_NS 30000
+
+/**
+ * @def WS2812_LATCH_NS
+ * @brief Time the firmware waits after a frame to latch it (sleep_us(500) in ws2812b_task()).
+ */
+#define WS2812_LATCH_NS 500000
+
+/**
+ * @brief State of a frame scheduler.
+ */
+struct ws2812_scheduler_s {
+	int timer_fd; /**< Periodic timerfd with absolute deadlines. */
+	uint64_t period_ns; /**< Frame period. */
+	uint64_t start_ns; /**< Time the scheduler was started. */
+	uint64_t frame_ns; /**< Time ws2812_scheduler_wait() returned. */
+	ws2812_frame_stats stats; /**< Statistics. */
+};
+
+static uint64_t ws2812_now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/**
+ * @brief Returns the minimum time to show a frame on a strip.
+ *
+ * The time is the sum of the USB transfer of the pixel packets the kernel module
+ * sends for the whole strip, the output of all pixels to the LEDs and the latch time
+ * of the firmware. Frames can't be shown faster than this.
+ *
+ * @param led_count Length (in LED's) of the LED strip.
+ * @return The minimum frame period in nanoseconds.
+ */
+uint64_t ws2812_frame_time_ns(uint16_t led_count)
+{
+	uint64_t packets =
+		(led_count + WS2812_USB_PIXELS_PER_PACKET - 1) /
+		WS2812_USB_PIXELS_PER_PACKET;
+
+	return packets * WS2812_USB_PACKET_NS +
+	       (uint64_t)led_count * WS2812_PIXEL_NS + WS2812_LATCH_NS;
+}
+
+/**
+ * @brief Creates a scheduler that paces frames for a strip.
+ *
+ * The frame period is 1 / fps, but at least ws2812_frame_time_ns(led_count). The
+ * scheduler starts immediately, the first deadline is one period after creation.
+ * Deadlines are absolute (CLOCK_MONOTONIC), so a late frame doesn't shift the
+ * following ones.
+ *
+ * @param fps Target frames per second, 0 for the highest feasible rate. Negative,
+ *            NaN, infinite or so small values that the period overflows are
+ *            rejected with EINVAL.
+ * @param led_count Length (in LED's) of the LED strip.
+ * @return The scheduler, or NULL on error (check errno for specific error).
+ */
+ws2812_scheduler *ws2812_scheduler_create(double fps, uint16_t led_count)
+{
+	// NaN fällt bei jedem Vergleich durch, daher !(fps >= 0)
+	if (!(fps >= 0) || !isfinite(fps) ||
+	    (fps > 0 && 1e9 / fps >= (double)UINT64_MAX)) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	ws2812_scheduler *sched = calloc(1, sizeof(ws2812_scheduler));
+	if (!sched) {
+		return NULL;
+	}
+
+	uint64_t min_period_ns = ws2812_frame_time_ns(led_count);
+	sched->period_ns = fps > 0 ? (uint64_t)(1e9 / fps) : 0;
+	if (sched->period_ns < min_period_ns) {
+		sched->period_ns = min_period_ns;
+	}
+
+	sched->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+	if (sched->timer_fd < 0) {
+		free(sched);
+		return NULL;
+	}
+
+	sched->start_ns = ws2812_now_ns();
+	uint64_t first_ns = sched->start_ns + sched->period_ns;
+	struct itimerspec spec = {
+		.it_interval = { .tv_sec = sched->period_ns / 1000000000ull,
+				 .tv_nsec = sched->period_ns % 1000000000ull },
+		.it_value = { .tv_sec = first_ns / 1000000000ull,
+			      .tv_nsec = first_ns % 1000000000ull },
+	};
+	if (timerfd_settime(sched->timer_fd, TFD_TIMER_ABSTIME, &spec, NULL)) {
+		int err = errno;
+		close(sched->timer_fd);
+		free(sched);
+		errno = err;
+		return NULL;
+	}
+	return sched;
+}
+
+/**
+ * @brief Destroys a scheduler.
+ *
+ * @param sched The scheduler, may be NULL.
+ */
+void ws2812_scheduler_destroy(ws2812_scheduler *sched)
+{
+	if (!sched) {
+		return;
+	}
+	close(sched->timer_fd);
+	free(sched);
+}
+
+/**
+ * @brief Returns the frame period of the scheduler.
+ *
+ * @param sched The scheduler.
+ * @return The frame period in nanoseconds.
+ */
+uint64_t ws2812_scheduler_period_ns(const ws2812_scheduler *sched)
+{
+	return sched->period_ns;
+}
+
+/**
+ * @brief Returns the timerfd of the scheduler.
+ *
+ * The fd is readable when the next frame is due, event loops can poll it and
+ * call ws2812_scheduler_wait() then, which doesn't block in this case.
+ *
+ * @param sched The scheduler.
+ * @return The file descriptor, must not be read or closed by the caller.
+ */
+int ws2812_scheduler_fd(const ws2812_scheduler *sched)
+{
+	return sched->timer_fd;
+}
+
+/**
+ * @brief Waits for the deadline of the next frame.
+ *
+ * If the caller is late and deadlines passed in between, the skipped frames are
+ * counted as missed deadlines and the next deadline is waited for without catching up.
+ *
+ * @param sched The scheduler.
+ * @return Number of periods elapsed since the last call (1 if no deadline was missed),
+ *         or -1 on error (check errno for specific error).
+ */
+int ws2812_scheduler_wait(ws2812_scheduler *sched)
+{
+	uint64_t expirations;
+	ssize_t ret;
+
+	do {
+		ret = read(sched->timer_fd, &expirations, sizeof(expirations));
+	} while (ret < 0 && errno == EINTR);
+	if (ret < 0) {
+		return -1;
+	}
+
+	sched->frame_ns = ws2812_now_ns();
+	sched->stats.frames++;
+	sched->stats.missed_deadlines += expirations - 1;
+	return expirations;
+}
+
+/**
+ * @brief Marks the end of rendering and submitting the current frame.
+ *
+ * If the frame took longer than the period since ws2812_scheduler_wait() returned,
+ * it is counted as an overrun.
+ *
+ * @param sched The scheduler.
+ */
+void ws2812_scheduler_frame_done(ws2812_scheduler *sched)
+{
+	uint64_t render_ns = ws2812_now_ns() - sched->frame_ns;
+
+	if (render_ns > sched->stats.max_render_ns) {
+		sched->stats.max_render_ns = render_ns;
+	}
+	if (render_ns > sched->period_ns) {
+		sched->stats.overruns++;
+	}
+}
+
+/**
+ * @brief Returns the statistics of the scheduler.
+ *
+ * @param sched The scheduler.
+ * @param stats Receives the statistics.
+ */
+void ws2812_scheduler_get_stats(const ws2812_scheduler *sched,
+				ws2812_frame_stats *stats)
+{
+	*stats = sched->stats;
+	uint64_t elapsed_ns = ws2812_now_ns() - sched->start_ns;
+	stats->achieved_fps =
+		elapsed_ns ? stats->frames * 1e9 / elapsed_ns : 0;
+}
@@ -0,0 +1,165 @@
+/**
+ * @file usb_ws2812_simd.h                                                     *
+ * @brief Internal SIMD helpers: conversion between 48 byte blocks of 16       *
+ *        interleaved 3 byte pixels and three 16 byte channel planes           *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#ifndef USB_WS2812_SIMD_H
+#define USB_WS2812_SIMD_H
+
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define WS2812_SIMD_X86
+
+/**
+ * @brief pshufb mask byte: plane c, byte i (pixel i) taken from vector k of a block.
+ */
+#define WS2812_DEINTERLEAVE_MASK(c, k, i) \
+	((3 * (i) + (c)) / 16 == (k) ? (3 * (i) + (c)) % 16 : 0x80)
+
+/**
+ * @brief pshufb mask byte: vector k, byte j of a block taken from plane c.
+ */
+#define WS2812_INTERLEAVE_MASK(k, c, j) \
+	((16 * (k) + (j)) % 3 == (c) ? (16 * (k) + (j)) / 3 : 0x80)
+
+#define WS2812_MASK16(M, a, b)                                              \
+	{                                                                   \
+		M(a, b, 0), M(a, b, 1), M(a, b, 2), M(a, b, 3), M(a, b, 4), \
+			M(a, b, 5), M(a, b, 6), M(a, b, 7), M(a, b, 8),     \
+			M(a, b, 9), M(a, b, 10), M(a, b, 11), M(a, b, 12),  \
+			M(a, b, 13), M(a, b, 14), M(a, b, 15)               \
+	}
+
+#define WS2812_MASK3x16(M, a)                                        \
+	{                                                            \
+		WS2812_MASK16(M, a, 0), WS2812_MASK16(M, a, 1),      \
+			WS2812_MASK16(M, a, 2)                       \
+	}
+
+/**
+ * @brief Masks to gather plane c from vector k: [c][k].
+ */
+static const uint8_t ws2812_deinterleave_masks[3][3][16] = {
+	WS2812_MASK3x16(WS2812_DEINTERLEAVE_MASK, 0),
+	WS2812_MASK3x16(WS2812_DEINTERLEAVE_MASK, 1),
+	WS2812_MASK3x16(WS2812_DEINTERLEAVE_MASK, 2),
+};
+
+/**
+ * @brief Masks to gather vector k from plane c: [k][c].
+ */
+static const uint8_t ws2812_interleave_masks[3][3][16] = {
+	WS2812_MASK3x16(WS2812_INTERLEAVE_MASK, 0),
+	WS2812_MASK3x16(WS2812_INTERLEAVE_MASK, 1),
+	WS2812_MASK3x16(WS2812_INTERLEAVE_MASK, 2),
+};
+
+/**
+ * @brief Shuffles three vectors with masks[0..2] and combines the results.
+ */
+__attribute__((target("ssse3"))) static inline __m128i
+ws2812_simd_gather3_ssse3(const __m128i v[3], const uint8_t masks[3][16])
+{
+	__m128i r = _mm_shuffle_epi8(v[0], _mm_loadu_si128((const __m128i *)masks[0]));
+	r = _mm_or_si128(r, _mm_shuffle_epi8(v[1], _mm_loadu_si128(
+							   (const __m128i *)masks[1])));
+	return _mm_or_si128(r, _mm_shuffle_epi8(v[2], _mm_loadu_si128(
+							      (const __m128i *)masks[2])));
+}
+
+/**
+ * @brief Splits 16 pixels (48 bytes) into their three channel planes.
+ */
+__attribute__((target("ssse3"))) static inline void
+ws2812_simd_deinterleave_ssse3(const void *block, __m128i planes[3])
+{
+	const __m128i *in = block;
+	__m128i v[3] = { _mm_loadu_si128(in), _mm_loadu_si128(in + 1),
+			 _mm_loadu_si128(in + 2) };
+
+	for (int c = 0; c < 3; c++) {
+		planes[c] = ws2812_simd_gather3_ssse3(
+			v, ws2812_deinterleave_masks[c]);
+	}
+}
+
+/**
+ * @brief Stores three channel planes as 16 interleaved pixels (48 bytes).
+ */
+__attribute__((target("ssse3"))) static inline void
+ws2812_simd_interleave_ssse3(void *block, const __m128i planes[3])
+{
+	__m128i *out = block;
+
+	for (int k = 0; k < 3; k++) {
+		_mm_storeu_si128(out + k,
+				 ws2812_simd_gather3_ssse3(
+					 planes, ws2812_interleave_masks[k]));
+	}
+}
+
+/**
+ * @brief Shuffles three vectors with masks[0..2] in both lanes and combines the results.
+ */
+__attribute__((target("avx2"))) static inline __m256i
+ws2812_simd_gather3_avx2(const __m256i v[3], const uint8_t masks[3][16])
+{
+	__m256i r = _mm256_setzero_si256();
+
+	for (int j = 0; j < 3; j++) {
+		__m256i m = _mm256_broadcastsi128_si256(
+			_mm_loadu_si128((const __m128i *)masks[j]));
+		r = _mm256_or_si256(r, _mm256_shuffle_epi8(v[j], m));
+	}
+	return r;
+}
+
+/**
+ * @brief Splits 32 pixels (two 48 byte blocks) into three channel planes.
+ *
+ * pshufb works within 128 bit lanes, so the low lane holds the planes of the first
+ * 16 pixels and the high lane those of the next 16.
+ */
+__attribute__((target("avx2"))) static inline void
+ws2812_simd_deinterleave_avx2(const void *blocks, __m256i planes[3])
+{
+	const __m128i *in = blocks;
+	__m256i v[3];
+
+	for (int k = 0; k < 3; k++) {
+		v[k] = _mm256_inserti128_si256(
+			_mm256_castsi128_si256(_mm_loadu_si128(in + k)),
+			_mm_loadu_si128(in + 3 + k), 1);
+	}
+	for (int c = 0; c < 3; c++) {
+		planes[c] =
+			ws2812_simd_gather3_avx2(v, ws2812_deinterleave_masks[c]);
+	}
+}
+
+/**
+ * @brief Stores three channel planes in the lane layout of
+ *        ws2812_simd_deinterleave_avx2() as 32 interleaved pixels (96 bytes).
+ */
+__attribute__((target("avx2"))) static inline void
+ws2812_simd_interleave_avx2(void *blocks, const __m256i planes[3])
+{
+	__m128i *out = blocks;
+
+	for (int k = 0; k < 3; k++) {
+		__m256i v = ws2812_simd_gather3_avx2(planes,
+						     ws2812_interleave_masks[k]);
+		_mm_storeu_si128(out + k, _mm256_castsi256_si128(v));
+		_mm_storeu_si128(out + 3 + k, _mm256_extracti128_si256(v, 1));
+	}
+}
+
+#endif
+
+#endif
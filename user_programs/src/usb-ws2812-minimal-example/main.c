@@ -13,13 +13,12 @@
 
 int main(int argc, char** argv)
 {
-    ws2812_init(); // Init
-    int fd = open("/dev/usb_ws2812_0", O_RDWR);
-    if(fd < 0){
+    ws2812_handle *dev = ws2812_open("/dev/usb_ws2812_0", 16); // Init
+    if(dev == NULL){
         return 1;
     }
 
-    if(ws2812_set_length(fd, 16) < 0){
+    if(ws2812_set_length(dev, 16) < 0){
         printf("Länge konnte nicht verändert werden!\n");
         return 1;
     }
@@ -30,7 +29,7 @@ int main(int argc, char** argv)
         pixel_data[i].blue = 0;
     }
     // Alle Leds rot färben
-    ws2812_set_led_pixel(fd, 0, 16, pixel_data);
+    ws2812_set_led_pixel(dev, 0, 16, pixel_data);
 
     sleep(10);
 
@@ -40,7 +39,7 @@ int main(int argc, char** argv)
         pixel_data[i].blue = 0;
     }
     // LEDs 5 bis 8 grün Färben
-    ws2812_set_led_pixel(fd, 4, 4, pixel_data);
-    ws2812_deinit(); // deinit
+    ws2812_set_led_pixel(dev, 4, 4, pixel_data);
+    ws2812_close(dev); // deinit
     return 0;
 }
@@ -0,0 +1,285 @@
+/**
+ * @file anim_convert.c                                                        *
+ * @brief Creates animation files from blink pattern files or generates        *
+ *        test animations                                                      *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#include <argp.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "usb_ws2812_lib.h"
+
+const char *argp_program_version = "usb-ws2812-anim-convert";
+const char *argp_program_bug_address = "";
+static char doc[] =
+	"usb-ws2812-anim-convert schreibt eine Animationsdatei für usb-ws2812-player. Quelle ist "
+	"entweder eine Musterdatei des usb-ws2812-client (-p, jedes Muster wird ein Frame) oder ein "
+	"erzeugtes Testmuster (-g rainbow|chase|noise). Frames werden als Schlüsselbild (roh oder "
+	"RLE) oder als Differenz zum vorherigen Frame gespeichert, je nachdem was kleiner ist.";
+static char args_doc[] = "DATEI";
+
+static struct argp_option options[] = {
+	{ "pattern", 'p', "FILE", 0, "Musterdatei des usb-ws2812-client umwandeln", 0 },
+	{ "generate", 'g', "NAME", 0, "Testmuster erzeugen: rainbow, chase oder noise", 0 },
+	{ "leds", 'l', "NUM", 0, "LEDs des Testmusters (Standard 300)", 0 },
+	{ "frames", 'f', "NUM", 0, "Frames des Testmusters (Standard 600)", 0 },
+	{ "duration", 'D', "MS", 0, "Anzeigedauer pro Frame (Standard 25 ms, Muster 1000 ms)", 0 },
+	{ "keyframes", 'k', "NUM", 0, "Höchstens NUM Frames zwischen zwei Schlüsselbildern (Standard 60)", 0 },
+	{ "loop", 'L', 0, 0, "Als Schleife markieren", 0 },
+	{ 0, 0, 0, 0, 0, 0 },
+};
+
+struct arguments {
+	const char *file;
+	const char *pattern;
+	const char *generate;
+	long leds;
+	long frames;
+	long duration;
+	long keyframes;
+	bool loop;
+};
+
+static error_t parse_opt(int key, char *arg, struct argp_state *state)
+{
+	struct arguments *arg_s = state->input;
+	switch (key) {
+	case 'p':
+		arg_s->pattern = arg;
+		break;
+	case 'g':
+		arg_s->generate = arg;
+		break;
+	case 'l':
+		arg_s->leds = strtol(arg, NULL, 10);
+		break;
+	case 'f':
+		arg_s->frames = strtol(arg, NULL, 10);
+		break;
+	case 'D':
+		arg_s->duration = strtol(arg, NULL, 10);
+		break;
+	case 'k':
+		arg_s->keyframes = strtol(arg, NULL, 10);
+		break;
+	case 'L':
+		arg_s->loop = true;
+		break;
+	case ARGP_KEY_ARG:
+		if (arg_s->file) {
+			argp_usage(state);
+		}
+		arg_s->file = arg;
+		break;
+	case ARGP_KEY_END:
+		if (!arg_s->file || !arg_s->pattern == !arg_s->generate) {
+			argp_usage(state);
+		}
+		break;
+	default:
+		return ARGP_ERR_UNKNOWN;
+	}
+	return 0;
+}
+
+static struct argp argp = { options, parse_opt, args_doc, doc, 0, 0, 0 };
+
+/**
+ * @brief Liest die nächste Zahl der Musterdatei.
+ *
+ * @return 0 bei Erfolg, -1 am Ende oder bei ungültigem Inhalt.
+ */
+static int next_number(char **pos, long min, long max, long *value)
+{
+	char *end;
+	errno = 0;
+	*value = strtol(*pos, &end, 0);
+	if (end == *pos || errno || *value < min || *value > max) {
+		return -1;
+	}
+	*pos = end;
+	return 0;
+}
+
+/**
+ * @brief Wandelt eine Musterdatei (Länge Anzahl R G B ...) um.
+ *
+ * Die Datei wird in einem Stück gelesen und mit strtol() zerlegt.
+ */
+static int convert_pattern(const char *path, ws2812_anim_writer **writer,
+			   const struct arguments *arguments)
+{
+	FILE *f = fopen(path, "r");
+	if (!f) {
+		perror(path);
+		return -1;
+	}
+	struct stat st;
+	char *text = NULL;
+	if (fstat(fileno(f), &st) < 0 || !(text = malloc(st.st_size + 1)) ||
+	    fread(text, 1, st.st_size, f) != (size_t)st.st_size) {
+		perror(path);
+		fclose(f);
+		free(text);
+		return -1;
+	}
+	fclose(f);
+	text[st.st_size] = '\0';
+
+	int ret = -1;
+	char *pos = text;
+	long length, states;
+	led_pixel *frame = NULL;
+	if (next_number(&pos, 1, UINT16_MAX, &length) < 0 ||
+	    next_number(&pos, 1, UINT16_MAX, &states) < 0) {
+		printf("%s: Länge und Musteranzahl fehlen\n", path);
+		goto out;
+	}
+	frame = malloc(length * sizeof(led_pixel));
+	*writer = ws2812_anim_writer_create(arguments->file, length,
+					    arguments->keyframes, arguments->loop);
+	if (!frame || !*writer) {
+		perror(arguments->file);
+		goto out;
+	}
+	for (long s = 0; s < states; s++) {
+		for (long i = 0; i < length; i++) {
+			long r, g, b;
+			if (next_number(&pos, 0, 255, &r) < 0 ||
+			    next_number(&pos, 0, 255, &g) < 0 ||
+			    next_number(&pos, 0, 255, &b) < 0) {
+				printf("%s: Muster %ld, Pixel %ld fehlt oder ist ungültig\n",
+				       path, s, i);
+				goto out;
+			}
+			frame[i] = (led_pixel){ r, g, b };
+		}
+		if (ws2812_anim_writer_add(*writer, frame,
+					   arguments->duration * 1000) < 0) {
+			perror(arguments->file);
+			goto out;
+		}
+	}
+	ret = 0;
+
+out:
+	free(frame);
+	free(text);
+	return ret;
+}
+
+/**
+ * @brief Erzeugt ein Testmuster.
+ */
+static int generate(const char *name, ws2812_anim_writer **writer,
+		    const struct arguments *arguments)
+{
+	long length = arguments->leds;
+	led_pixel *frame = calloc(length, sizeof(led_pixel));
+	ws2812_hsv *hsv = calloc(length, sizeof(ws2812_hsv));
+	uint32_t seed = 1;
+	int ret = -1;
+
+	if (strcmp(name, "rainbow") != 0 && strcmp(name, "chase") != 0 &&
+	    strcmp(name, "noise") != 0) {
+		printf("Unbekanntes Testmuster: %s\n", name);
+		goto out;
+	}
+	*writer = ws2812_anim_writer_create(arguments->file, length,
+					    arguments->keyframes, arguments->loop);
+	if (!frame || !hsv || !*writer) {
+		perror(arguments->file);
+		goto out;
+	}
+	for (long f = 0; f < arguments->frames; f++) {
+		if (name[0] == 'r') {
+			// Regenbogen, der pro Frame um einen Farbschritt wandert
+			for (long i = 0; i < length; i++) {
+				hsv[i] = (ws2812_hsv){ (i * 256 / length + f) & 0xff,
+						       255, 128 };
+			}
+			ws2812_hsv_to_rgb(frame, hsv, length);
+		} else if (name[0] == 'c') {
+			// Ein Punkt mit Schweif auf Schwarz, wenige Pixel ändern sich
+			memset(frame, 0, length * sizeof(led_pixel));
+			for (long t = 0; t < 8 && t <= f; t++) {
+				frame[(f - t) % length] =
+					(led_pixel){ 255 >> t, 64 >> t, 0 };
+			}
+		} else {
+			// Rauschen, nicht komprimierbar
+			for (long i = 0; i < length; i++) {
+				seed = seed * 1664525u + 1013904223u;
+				frame[i] = (led_pixel){ seed >> 24, seed >> 16,
+							seed >> 8 };
+			}
+		}
+		if (ws2812_anim_writer_add(*writer, frame,
+					   arguments->duration * 1000) < 0) {
+			perror(arguments->file);
+			goto out;
+		}
+	}
+	ret = 0;
+
+out:
+	free(hsv);
+	free(frame);
+	return ret;
+}
+
+int main(int argc, char **argv)
+{
+	struct arguments arguments = {
+		.leds = 300,
+		.frames = 600,
+		.duration = -1,
+		.keyframes = 60,
+	};
+	argp_parse(&argp, argc, argv, 0, 0, &arguments);
+	if (arguments.duration < 0) {
+		arguments.duration = arguments.pattern ? 1000 : 25;
+	}
+	if (arguments.leds < 1 || arguments.leds > UINT16_MAX ||
+	    arguments.frames < 0 || arguments.duration > UINT32_MAX / 1000 ||
+	    arguments.keyframes < 0 || arguments.keyframes > UINT16_MAX) {
+		printf("Ungültige Länge, Frameanzahl, Dauer oder Schlüsselbildabstand\n");
+		return 1;
+	}
+
+	ws2812_anim_writer *writer = NULL;
+	int ret = arguments.pattern ?
+			  convert_pattern(arguments.pattern, &writer, &arguments) :
+			  generate(arguments.generate, &writer, &arguments);
+	if (writer && ws2812_anim_writer_finish(writer) < 0) {
+		perror(arguments.file);
+		ret = -1;
+	}
+	if (ret < 0) {
+		remove(arguments.file);
+		return 1;
+	}
+
+	ws2812_anim *anim = ws2812_anim_open(arguments.file);
+	if (!anim) {
+		perror(arguments.file);
+		return 1;
+	}
+	ws2812_anim_info info;
+	struct stat st;
+	ws2812_anim_get_info(anim, &info);
+	stat(arguments.file, &st);
+	double raw = (double)info.frame_count * info.length * sizeof(led_pixel);
+	printf("%s: %u LEDs, %u Frames, %.3f s, %lld Bytes (%.1f %% der Rohdaten)\n",
+	       arguments.file, info.length, info.frame_count,
+	       info.duration_us / 1e6, (long long)st.st_size,
+	       raw > 0 ? 100.0 * st.st_size / raw : 0.0);
+	ws2812_anim_close(anim);
+	return 0;
+}
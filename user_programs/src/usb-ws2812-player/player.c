@@ -0,0 +1,359 @@
+/**
+ * @file player.c                                                              *
+ * @brief Animation player: decodes animation files ahead on a worker thread   *
+ *        and streams them to the strip with absolute deadlines                *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#include <argp.h>
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "usb_ws2812_lib.h"
+
+/**
+ * @def LATE_THRESHOLD_NS
+ * @brief A frame sent later than this after its deadline counts as late.
+ */
+#define LATE_THRESHOLD_NS 1000000ull
+
+/**
+ * @def RESYNC_THRESHOLD_NS
+ * @brief Further behind (e.g. after SIGSTOP) the deadlines restart instead of catching up.
+ */
+#define RESYNC_THRESHOLD_NS 1000000000ull
+
+const char *argp_program_version = "usb-ws2812-player";
+const char *argp_program_bug_address = "";
+static char doc[] =
+	"usb-ws2812-player spielt eine Animationsdatei (siehe usb-ws2812-anim-convert) auf einem "
+	"LED-Streifen ab. Die Datei wird eingeblendet (mmap), ein Arbeitsthread dekodiert die Frames "
+	"im Voraus und der Hauptthread sendet sie zu absoluten Zeitpunkten, sodass sich Verspätungen "
+	"nicht aufsummieren. Über den Index springt -s/-t ohne die Datei zu lesen direkt an jede "
+	"Stelle.";
+static char args_doc[] = "DATEI";
+
+static struct argp_option options[] = {
+	{ "device", 'd', "PATH", 0, "Gerätedatei oder usb:N (Standard /dev/usb_ws2812_0)", 0 },
+	{ "start", 's', "FRAME", 0, "Ab diesem Frame abspielen", 0 },
+	{ "time", 't', "SEC", 0, "Ab dieser Zeit abspielen", 0 },
+	{ "loops", 'n', "NUM", 0, "Anzahl Durchläufe, 0 endlos (Standard: endlos, wenn die Datei als Schleife markiert ist, sonst 1)", 0 },
+	{ "ahead", 'a', "NUM", 0, "Im Voraus dekodierte Frames (Standard 8)", 0 },
+	{ 0, 0, 0, 0, 0, 0 },
+};
+
+struct arguments {
+	const char *device;
+	const char *file;
+	long start;
+	double time;
+	long loops;
+	long ahead;
+};
+
+static error_t parse_opt(int key, char *arg, struct argp_state *state)
+{
+	struct arguments *arg_s = state->input;
+	switch (key) {
+	case 'd':
+		arg_s->device = arg;
+		break;
+	case 's':
+		arg_s->start = strtol(arg, NULL, 10);
+		break;
+	case 't':
+		arg_s->time = strtod(arg, NULL);
+		break;
+	case 'n':
+		arg_s->loops = strtol(arg, NULL, 10);
+		break;
+	case 'a':
+		arg_s->ahead = strtol(arg, NULL, 10);
+		break;
+	case ARGP_KEY_ARG:
+		if (arg_s->file) {
+			argp_usage(state);
+		}
+		arg_s->file = arg;
+		break;
+	case ARGP_KEY_END:
+		if (!arg_s->file) {
+			argp_usage(state);
+		}
+		break;
+	default:
+		return ARGP_ERR_UNKNOWN;
+	}
+	return 0;
+}
+
+static struct argp argp = { options, parse_opt, args_doc, doc, 0, 0, 0 };
+
+/**
+ * @brief Dekodierter Frame im Ring.
+ */
+struct slot {
+	led_pixel *pixels;
+	uint32_t frame;
+	uint32_t duration_us;
+};
+
+/**
+ * @brief Zustand des Players, der Ring wird vom Arbeitsthread gefüllt.
+ */
+struct player {
+	ws2812_anim *anim;
+	ws2812_anim_info info;
+	struct slot *slots;
+	size_t slot_count;
+	uint64_t head; /**< Nächster zu füllender Platz (Arbeitsthread). */
+	uint64_t tail; /**< Nächster zu sendender Platz (Hauptthread). */
+	pthread_mutex_t lock;
+	pthread_cond_t filled;
+	pthread_cond_t freed;
+	bool stop; /**< Hauptthread beendet. */
+	bool done; /**< Alle Durchläufe dekodiert oder Fehler. */
+	int error; /**< errno des Dekodierfehlers. */
+	uint32_t start_frame;
+	long loops;
+};
+
+static volatile sig_atomic_t running = 1;
+
+static void stop_handler(int sig)
+{
+	(void)sig;
+	running = 0;
+}
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/**
+ * @brief Arbeitsthread: dekodiert Frames, solange im Ring Platz ist.
+ */
+static void *decode_worker(void *arg)
+{
+	struct player *p = arg;
+	uint32_t frame = p->start_frame;
+	long loop = 0;
+
+	for (;;) {
+		pthread_mutex_lock(&p->lock);
+		while (!p->stop && p->head - p->tail == p->slot_count) {
+			pthread_cond_wait(&p->freed, &p->lock);
+		}
+		bool stop = p->stop;
+		pthread_mutex_unlock(&p->lock);
+		if (stop) {
+			break;
+		}
+
+		// Der Platz gehört bis head++ allein dem Arbeitsthread
+		struct slot *slot = &p->slots[p->head % p->slot_count];
+		int ret = ws2812_anim_decode(p->anim, frame, slot->pixels);
+		slot->frame = frame;
+		slot->duration_us = ws2812_anim_frame_duration(p->anim, frame);
+
+		bool last = false;
+		if (++frame == p->info.frame_count) {
+			frame = 0;
+			last = p->loops && ++loop == p->loops;
+		}
+		pthread_mutex_lock(&p->lock);
+		if (ret < 0) {
+			p->error = errno;
+			p->done = true;
+		} else {
+			p->head++;
+			p->done = last;
+		}
+		pthread_cond_signal(&p->filled);
+		pthread_mutex_unlock(&p->lock);
+		if (ret < 0 || last) {
+			break;
+		}
+	}
+	return NULL;
+}
+
+int main(int argc, char **argv)
+{
+	struct arguments arguments = {
+		.device = "/dev/usb_ws2812_0",
+		.loops = -1,
+		.ahead = 8,
+	};
+	argp_parse(&argp, argc, argv, 0, 0, &arguments);
+	if (arguments.start < 0 || arguments.time < 0 || arguments.ahead < 1 ||
+	    arguments.ahead > 1024) {
+		printf("Ungültiger Start oder Vorlauf\n");
+		return 1;
+	}
+
+	struct player p = {
+		.lock = PTHREAD_MUTEX_INITIALIZER,
+		.filled = PTHREAD_COND_INITIALIZER,
+		.freed = PTHREAD_COND_INITIALIZER,
+	};
+	ws2812_handle *handle = NULL;
+	ws2812_shadow *shadow = NULL;
+	int ret = 1;
+
+	p.anim = ws2812_anim_open(arguments.file);
+	if (!p.anim) {
+		perror(arguments.file);
+		return 1;
+	}
+	ws2812_anim_get_info(p.anim, &p.info);
+	if (p.info.frame_count == 0 || p.info.length == 0) {
+		printf("Die Animation ist leer\n");
+		goto out;
+	}
+	p.loops = arguments.loops >= 0 ? arguments.loops : !p.info.loop;
+	p.start_frame = arguments.time > 0 ?
+				ws2812_anim_frame_at(p.anim, arguments.time * 1e6) :
+				(uint32_t)arguments.start;
+	if (p.start_frame >= p.info.frame_count) {
+		printf("Die Animation hat nur %u Frames\n", p.info.frame_count);
+		goto out;
+	}
+
+	handle = ws2812_open(arguments.device, p.info.length);
+	if (!handle) {
+		perror(arguments.device);
+		goto out;
+	}
+	if (ws2812_set_mode_static(handle) < 0 ||
+	    ws2812_set_length(handle, p.info.length) < 0) {
+		perror("ws2812_set_length");
+		goto out;
+	}
+	shadow = ws2812_shadow_create(handle, p.info.length);
+	p.slot_count = arguments.ahead;
+	p.slots = calloc(p.slot_count, sizeof(struct slot));
+	if (!shadow || !p.slots) {
+		perror("calloc");
+		goto out;
+	}
+	for (size_t i = 0; i < p.slot_count; i++) {
+		p.slots[i].pixels = malloc(p.info.length * sizeof(led_pixel));
+		if (!p.slots[i].pixels) {
+			perror("malloc");
+			goto out;
+		}
+	}
+
+	printf("%u LEDs, %u Frames, %.3f s, ab Frame %u\n", p.info.length,
+	       p.info.frame_count, p.info.duration_us / 1e6, p.start_frame);
+	fflush(stdout);
+
+	struct sigaction sa = { .sa_handler = stop_handler };
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+
+	pthread_t worker;
+	int err = pthread_create(&worker, NULL, decode_worker, &p);
+	if (err) {
+		errno = err;
+		perror("pthread_create");
+		goto out;
+	}
+
+	uint64_t frames = 0, late = 0, underruns = 0, errors = 0;
+	uint64_t max_late_ns = 0, sum_late_ns = 0;
+	uint64_t deadline = 0;
+	while (running) {
+		pthread_mutex_lock(&p.lock);
+		if (p.head == p.tail && !p.done) {
+			while (p.head == p.tail && !p.done) {
+				pthread_cond_wait(&p.filled, &p.lock);
+			}
+			// Unterlauf nur, wenn der Frame erst nach seinem Zeitpunkt fertig wurde
+			underruns += frames > 0 && now_ns() > deadline;
+		}
+		bool empty = p.head == p.tail;
+		pthread_mutex_unlock(&p.lock);
+		if (empty) {
+			break;
+		}
+
+		struct slot *slot = &p.slots[p.tail % p.slot_count];
+		if (frames == 0) {
+			deadline = now_ns();
+		}
+		struct timespec ts = { deadline / 1000000000ull,
+				       deadline % 1000000000ull };
+		while (running && clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME,
+						  &ts, NULL) == EINTR) {
+		}
+		if (!running) {
+			break;
+		}
+		uint64_t now = now_ns();
+		uint64_t late_ns = now - deadline;
+		if (ws2812_shadow_submit(shadow, slot->pixels) < 0 && errors++ == 0) {
+			perror("ws2812_shadow_submit");
+		}
+		frames++;
+		sum_late_ns += late_ns;
+		if (late_ns > max_late_ns) {
+			max_late_ns = late_ns;
+		}
+		if (late_ns > LATE_THRESHOLD_NS) {
+			late++;
+		}
+		deadline = late_ns > RESYNC_THRESHOLD_NS ? now : deadline;
+		deadline += slot->duration_us * 1000ull;
+
+		pthread_mutex_lock(&p.lock);
+		p.tail++;
+		pthread_cond_signal(&p.freed);
+		pthread_mutex_unlock(&p.lock);
+	}
+
+	// Der letzte Frame bleibt für seine Dauer stehen
+	if (running && frames) {
+		struct timespec ts = { deadline / 1000000000ull,
+				       deadline % 1000000000ull };
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+	}
+
+	pthread_mutex_lock(&p.lock);
+	p.stop = true;
+	pthread_cond_signal(&p.freed);
+	pthread_mutex_unlock(&p.lock);
+	pthread_join(worker, NULL);
+
+	if (p.error) {
+		printf("Dekodieren fehlgeschlagen: %s\n", strerror(p.error));
+	}
+	printf("%llu Frames, %llu verspätet (> 1 ms), Verspätung Mittel %.1f us, max %.1f us, "
+	       "%llu Unterläufe, %llu Fehler\n",
+	       (unsigned long long)frames, (unsigned long long)late,
+	       frames ? sum_late_ns / 1e3 / frames : 0.0, max_late_ns / 1e3,
+	       (unsigned long long)underruns, (unsigned long long)errors);
+	ret = p.error || errors ? 1 : 0;
+
+out:
+	if (p.slots) {
+		for (size_t i = 0; i < p.slot_count; i++) {
+			free(p.slots[i].pixels);
+		}
+		free(p.slots);
+	}
+	ws2812_shadow_free(shadow);
+	ws2812_close(handle);
+	ws2812_anim_close(p.anim);
+	return ret;
+}
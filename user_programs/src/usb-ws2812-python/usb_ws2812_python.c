@@ -0,0 +1,606 @@
+/**
+ * @file usb_ws2812_python.c                                                   *
+ * @brief Python bindings of the user library (module usb_ws2812)              *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <errno.h>
+#include "usb_ws2812_lib.h"
+
+/**
+ * @brief Python object of an opened device.
+ *
+ * busy counts blocking calls running without the GIL and asynchronous requests
+ * in flight, close() refuses to free the handle while it is not 0.
+ */
+typedef struct {
+	PyObject_HEAD
+	ws2812_handle *handle; /**< NULL after close(). */
+	Py_ssize_t busy; /**< Users of handle outside the GIL. */
+} DeviceObject;
+
+/**
+ * @brief An asynchronous request, owns the buffer until the callback ran.
+ */
+typedef struct py_async_request_s {
+	Py_buffer view; /**< The pixels, kept alive until completion. */
+	struct AsyncObject_s *owner; /**< The context that queued the request. */
+	DeviceObject *device; /**< Strong reference. */
+	PyObject *callback; /**< Strong reference or NULL. */
+	struct py_async_request_s *prev; /**< List of pending requests. */
+	struct py_async_request_s *next; /**< List of pending requests. */
+} py_async_request;
+
+/**
+ * @brief Python object of an async context.
+ */
+typedef struct AsyncObject_s {
+	PyObject_HEAD
+	ws2812_async *ctx; /**< NULL after close(). */
+	py_async_request *pending; /**< Requests whose callback didn't run yet. */
+	int dispatching; /**< Inside process_events() or close(). */
+	PyObject *error_type; /**< First exception raised by a callback. */
+	PyObject *error_value;
+	PyObject *error_traceback;
+} AsyncObject;
+
+static PyTypeObject DeviceType;
+
+/**
+ * @brief Returns the handle of a device, or NULL with ValueError if it is closed.
+ */
+static ws2812_handle *device_handle(DeviceObject *self)
+{
+	if (!self->handle) {
+		PyErr_SetString(PyExc_ValueError, "I/O operation on closed device");
+	}
+	return self->handle;
+}
+
+/**
+ * @brief Gets a C-contiguous byte buffer of whole pixels.
+ *
+ * @return 0 on success, -1 with an exception set.
+ */
+static int get_pixel_buffer(PyObject *obj, Py_buffer *view)
+{
+	if (PyObject_GetBuffer(obj, view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT)) {
+		return -1;
+	}
+	if (view->itemsize != 1 ||
+	    (view->format && strcmp(view->format, "B") &&
+	     strcmp(view->format, "b") && strcmp(view->format, "c"))) {
+		PyErr_Format(PyExc_TypeError,
+			     "expected a buffer of uint8, got format '%s'",
+			     view->format ? view->format : "B");
+		PyBuffer_Release(view);
+		return -1;
+	}
+	if (view->len % sizeof(led_pixel) ||
+	    view->len / sizeof(led_pixel) > UINT16_MAX) {
+		PyErr_Format(PyExc_ValueError,
+			     "buffer must hold whole pixels (3 bytes) and at most %d of them",
+			     UINT16_MAX);
+		PyBuffer_Release(view);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * @brief Calls a function of the library on the handle without the GIL.
+ */
+#define DEVICE_CALL(self, ret, call)                      \
+	do {                                              \
+		ws2812_handle *handle = device_handle(self); \
+		if (!handle) {                            \
+			return NULL;                      \
+		}                                         \
+		self->busy++;                             \
+		Py_BEGIN_ALLOW_THREADS                    \
+		ret = call;                               \
+		Py_END_ALLOW_THREADS                      \
+		self->busy--;                             \
+		if (ret < 0) {                            \
+			return PyErr_SetFromErrno(PyExc_OSError); \
+		}                                         \
+	} while (0)
+
+static int Device_init(DeviceObject *self, PyObject *args, PyObject *kwds)
+{
+	static char *kwlist[] = { "path", "max_leds", NULL };
+	PyObject *path;
+	unsigned short max_leds = 0;
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&|H", kwlist,
+					 PyUnicode_FSConverter, &path,
+					 &max_leds)) {
+		return -1;
+	}
+	if (self->busy) {
+		Py_DECREF(path);
+		PyErr_SetString(PyExc_RuntimeError,
+				"device is in use by another thread or an async request");
+		return -1;
+	}
+	if (self->handle) {
+		ws2812_close(self->handle);
+		self->handle = NULL;
+	}
+
+	ws2812_handle *handle;
+	Py_BEGIN_ALLOW_THREADS
+	handle = ws2812_open(PyBytes_AS_STRING(path), max_leds);
+	Py_END_ALLOW_THREADS
+	if (!handle) {
+		PyErr_SetFromErrnoWithFilenameObject(PyExc_OSError, path);
+		Py_DECREF(path);
+		return -1;
+	}
+	Py_DECREF(path);
+	self->handle = handle;
+	return 0;
+}
+
+static void Device_dealloc(DeviceObject *self)
+{
+	ws2812_close(self->handle);
+	Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *Device_close(DeviceObject *self, PyObject *Py_UNUSED(ignored))
+{
+	if (self->busy) {
+		PyErr_SetString(PyExc_RuntimeError,
+				"device is in use by another thread or an async request");
+		return NULL;
+	}
+	ws2812_close(self->handle);
+	self->handle = NULL;
+	Py_RETURN_NONE;
+}
+
+static PyObject *Device_enter(DeviceObject *self, PyObject *Py_UNUSED(ignored))
+{
+	if (!device_handle(self)) {
+		return NULL;
+	}
+	Py_INCREF(self);
+	return (PyObject *)self;
+}
+
+static PyObject *Device_exit(DeviceObject *self, PyObject *Py_UNUSED(args))
+{
+	return Device_close(self, NULL);
+}
+
+static PyObject *Device_fileno(DeviceObject *self, PyObject *Py_UNUSED(ignored))
+{
+	ws2812_handle *handle = device_handle(self);
+	if (!handle) {
+		return NULL;
+	}
+	return PyLong_FromLong(ws2812_fd(handle));
+}
+
+static PyObject *Device_set_length(DeviceObject *self, PyObject *arg)
+{
+	unsigned long length = PyLong_AsUnsignedLong(arg);
+	if (PyErr_Occurred()) {
+		return NULL;
+	}
+	if (length > UINT16_MAX) {
+		PyErr_SetString(PyExc_OverflowError, "length must be < 65536");
+		return NULL;
+	}
+	int ret;
+	DEVICE_CALL(self, ret, ws2812_set_length(handle, length));
+	Py_RETURN_NONE;
+}
+
+static PyObject *Device_clear(DeviceObject *self, PyObject *Py_UNUSED(ignored))
+{
+	int ret;
+	DEVICE_CALL(self, ret, ws2812_clear(handle));
+	Py_RETURN_NONE;
+}
+
+static PyObject *Device_set_mode_static(DeviceObject *self,
+				       PyObject *Py_UNUSED(ignored))
+{
+	int ret;
+	DEVICE_CALL(self, ret, ws2812_set_mode_static(handle));
+	Py_RETURN_NONE;
+}
+
+static PyObject *Device_save_boot_frame(DeviceObject *self,
+				       PyObject *Py_UNUSED(ignored))
+{
+	int ret;
+	DEVICE_CALL(self, ret, ws2812_save_boot_frame(handle));
+	Py_RETURN_NONE;
+}
+
+static PyObject *Device_get_length(DeviceObject *self,
+				   PyObject *Py_UNUSED(ignored))
+{
+	int ret;
+	DEVICE_CALL(self, ret, ws2812_get_length(handle));
+	return PyLong_FromLong(ret);
+}
+
+static PyObject *Device_refresh(DeviceObject *self, PyObject *Py_UNUSED(ignored))
+{
+	int ret;
+	DEVICE_CALL(self, ret, ws2812_refresh(handle));
+	Py_RETURN_NONE;
+}
+
+static PyObject *Device_submit(DeviceObject *self, PyObject *args,
+			       PyObject *kwds)
+{
+	static char *kwlist[] = { "pixels", "start", NULL };
+	PyObject *obj;
+	unsigned short start = 0;
+	Py_buffer view;
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|H", kwlist, &obj,
+					 &start)) {
+		return NULL;
+	}
+	if (!device_handle(self) || get_pixel_buffer(obj, &view)) {
+		return NULL;
+	}
+
+	int ret;
+	uint16_t count = view.len / sizeof(led_pixel);
+	ws2812_handle *handle = self->handle;
+	self->busy++;
+	Py_BEGIN_ALLOW_THREADS
+	ret = ws2812_set_led_pixel(handle, start, count, view.buf);
+	Py_END_ALLOW_THREADS
+	self->busy--;
+	PyBuffer_Release(&view);
+	if (ret < 0) {
+		return PyErr_SetFromErrno(PyExc_OSError);
+	}
+	return PyLong_FromLong(ret);
+}
+
+static PyMethodDef Device_methods[] = {
+	{ "close", (PyCFunction)Device_close, METH_NOARGS,
+	  "Close the device. Raises RuntimeError while requests are in flight." },
+	{ "fileno", (PyCFunction)Device_fileno, METH_NOARGS,
+	  "Return the file descriptor of the device file." },
+	{ "set_length", (PyCFunction)Device_set_length, METH_O,
+	  "Set the length of the strip in LEDs." },
+	{ "clear", (PyCFunction)Device_clear, METH_NOARGS,
+	  "Turn all LEDs off." },
+	{ "set_mode_static", (PyCFunction)Device_set_mode_static, METH_NOARGS,
+	  "Switch to static mode." },
+	{ "save_boot_frame", (PyCFunction)Device_save_boot_frame, METH_NOARGS,
+	  "Store the current frame as the frame shown after power-up." },
+	{ "get_length", (PyCFunction)Device_get_length, METH_NOARGS,
+	  "Return the length of the strip in LEDs." },
+	{ "refresh", (PyCFunction)Device_refresh, METH_NOARGS,
+	  "Reload the cached length and mode from the device." },
+	{ "submit", (PyCFunction)(void (*)(void))Device_submit,
+	  METH_VARARGS | METH_KEYWORDS,
+	  "submit(pixels, start=0) -> int\n\n"
+	  "Send pixels starting at LED start. pixels is any C-contiguous buffer of\n"
+	  "uint8 with 3 bytes (red, green, blue) per LED, e.g. a numpy array of\n"
+	  "shape (N, 3). The buffer is written without a copy and the GIL is\n"
+	  "released during the write. Returns the number of bytes written." },
+	{ "__enter__", (PyCFunction)Device_enter, METH_NOARGS, NULL },
+	{ "__exit__", (PyCFunction)Device_exit, METH_VARARGS, NULL },
+	{ NULL, NULL, 0, NULL },
+};
+
+static PyTypeObject DeviceType = {
+	PyVarObject_HEAD_INIT(NULL, 0).tp_name = "usb_ws2812.Device",
+	.tp_doc = "Device(path, max_leds=0)\n\n"
+		  "An opened WS2812 device file (e.g. /dev/usb_ws2812_0).",
+	.tp_basicsize = sizeof(DeviceObject),
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_new = PyType_GenericNew,
+	.tp_init = (initproc)Device_init,
+	.tp_dealloc = (destructor)Device_dealloc,
+	.tp_methods = Device_methods,
+};
+
+/**
+ * @brief Unlinks a request and releases everything it holds, GIL must be held.
+ */
+static void async_request_release(AsyncObject *self, py_async_request *req)
+{
+	if (req->prev) {
+		req->prev->next = req->next;
+	} else {
+		self->pending = req->next;
+	}
+	if (req->next) {
+		req->next->prev = req->prev;
+	}
+	PyBuffer_Release(&req->view);
+	req->device->busy--;
+	Py_DECREF(req->device);
+	Py_XDECREF(req->callback);
+	PyMem_Free(req);
+}
+
+/**
+ * @brief Completion callback, runs in Async.process_events() with the GIL held
+ *        and in Async.close() (ws2812_async_destroy()) without it.
+ */
+static void async_request_done(ws2812_handle *handle, int result,
+			       void *user_data)
+{
+	py_async_request *req = user_data;
+	AsyncObject *self = req->owner;
+	int error = errno;
+	PyGILState_STATE gil = PyGILState_Ensure();
+
+	(void)handle;
+	if (req->callback) {
+		PyObject *exc;
+		if (result < 0) {
+			exc = PyObject_CallFunction(PyExc_OSError, "is", error,
+						    strerror(error));
+		} else {
+			exc = Py_None;
+			Py_INCREF(exc);
+		}
+		PyObject *ret = NULL;
+		if (exc) {
+			ret = PyObject_CallFunction(req->callback, "iO", result,
+						    exc);
+			Py_DECREF(exc);
+		}
+		if (!ret) {
+			if (!self->error_type) {
+				PyErr_Fetch(&self->error_type, &self->error_value,
+					    &self->error_traceback);
+			} else {
+				PyErr_WriteUnraisable(req->callback);
+			}
+		}
+		Py_XDECREF(ret);
+	}
+	async_request_release(self, req);
+	PyGILState_Release(gil);
+}
+
+static PyObject *Async_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+	static char *kwlist[] = { "workers", NULL };
+	unsigned int workers = 0;
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "|I", kwlist, &workers)) {
+		return NULL;
+	}
+	AsyncObject *self = (AsyncObject *)type->tp_alloc(type, 0);
+	if (!self) {
+		return NULL;
+	}
+	self->ctx = ws2812_async_create(workers);
+	if (!self->ctx) {
+		Py_DECREF(self);
+		return PyErr_SetFromErrno(PyExc_OSError);
+	}
+	return (PyObject *)self;
+}
+
+/**
+ * @brief Stops the workers, requests that didn't complete get their callback with ECANCELED.
+ */
+static void async_close(AsyncObject *self)
+{
+	if (self->ctx) {
+		self->dispatching = 1;
+		Py_BEGIN_ALLOW_THREADS
+		ws2812_async_destroy(self->ctx);
+		Py_END_ALLOW_THREADS
+		self->dispatching = 0;
+		self->ctx = NULL;
+	}
+	// Nach destroy() greift kein Worker mehr auf die Buffer zu
+	while (self->pending) {
+		async_request_release(self, self->pending);
+	}
+	Py_CLEAR(self->error_type);
+	Py_CLEAR(self->error_value);
+	Py_CLEAR(self->error_traceback);
+}
+
+static void Async_dealloc(AsyncObject *self)
+{
+	async_close(self);
+	Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *Async_close(AsyncObject *self, PyObject *Py_UNUSED(ignored))
+{
+	if (self->dispatching) {
+		PyErr_SetString(PyExc_RuntimeError,
+				"cannot close the context from a callback");
+		return NULL;
+	}
+	async_close(self);
+	Py_RETURN_NONE;
+}
+
+static PyObject *Async_fileno(AsyncObject *self, PyObject *Py_UNUSED(ignored))
+{
+	if (!self->ctx) {
+		PyErr_SetString(PyExc_ValueError, "async context is closed");
+		return NULL;
+	}
+	return PyLong_FromLong(ws2812_async_fd(self->ctx));
+}
+
+static PyObject *Async_submit(AsyncObject *self, PyObject *args, PyObject *kwds)
+{
+	static char *kwlist[] = { "device", "pixels", "start", "callback", NULL };
+	DeviceObject *device;
+	PyObject *obj;
+	unsigned short start = 0;
+	PyObject *callback = Py_None;
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!O|HO", kwlist,
+					 &DeviceType, &device, &obj, &start,
+					 &callback)) {
+		return NULL;
+	}
+	if (!self->ctx) {
+		PyErr_SetString(PyExc_ValueError, "async context is closed");
+		return NULL;
+	}
+	if (callback != Py_None && !PyCallable_Check(callback)) {
+		PyErr_SetString(PyExc_TypeError, "callback must be callable");
+		return NULL;
+	}
+	if (!device_handle(device)) {
+		return NULL;
+	}
+
+	py_async_request *req = PyMem_Calloc(1, sizeof(py_async_request));
+	if (!req) {
+		return PyErr_NoMemory();
+	}
+	if (get_pixel_buffer(obj, &req->view)) {
+		PyMem_Free(req);
+		return NULL;
+	}
+	req->owner = self;
+	Py_INCREF(device);
+	req->device = device;
+	device->busy++;
+	if (callback != Py_None) {
+		Py_INCREF(callback);
+		req->callback = callback;
+	}
+	req->next = self->pending;
+	if (req->next) {
+		req->next->prev = req;
+	}
+	self->pending = req;
+
+	if (ws2812_async_set_led_pixel(self->ctx, device->handle, start,
+				       req->view.len / sizeof(led_pixel),
+				       req->view.buf, async_request_done,
+				       req) < 0) {
+		int error = errno;
+		async_request_release(self, req);
+		errno = error;
+		return PyErr_SetFromErrno(PyExc_OSError);
+	}
+	Py_RETURN_NONE;
+}
+
+static PyObject *Async_process_events(AsyncObject *self,
+				      PyObject *Py_UNUSED(ignored))
+{
+	if (!self->ctx) {
+		PyErr_SetString(PyExc_ValueError, "async context is closed");
+		return NULL;
+	}
+
+	// Blockiert nie, die Callbacks laufen mit gehaltenem GIL
+	self->dispatching = 1;
+	int processed = ws2812_async_process_events(self->ctx);
+	self->dispatching = 0;
+	if (self->error_type) {
+		PyErr_Restore(self->error_type, self->error_value,
+			      self->error_traceback);
+		self->error_type = NULL;
+		self->error_value = NULL;
+		self->error_traceback = NULL;
+		return NULL;
+	}
+	if (processed < 0) {
+		return PyErr_SetFromErrno(PyExc_OSError);
+	}
+	return PyLong_FromLong(processed);
+}
+
+static PyObject *Async_get_pending(AsyncObject *self, void *Py_UNUSED(closure))
+{
+	Py_ssize_t count = 0;
+	for (py_async_request *req = self->pending; req; req = req->next) {
+		count++;
+	}
+	return PyLong_FromSsize_t(count);
+}
+
+static PyMethodDef Async_methods[] = {
+	{ "close", (PyCFunction)Async_close, METH_NOARGS,
+	  "Stop the workers. Requests that didn't complete get their callback with\n"
+	  "an OSError ECANCELED." },
+	{ "fileno", (PyCFunction)Async_fileno, METH_NOARGS,
+	  "Return the eventfd that is readable while completions wait for\n"
+	  "process_events(), e.g. for loop.add_reader() or selectors." },
+	{ "submit", (PyCFunction)(void (*)(void))Async_submit,
+	  METH_VARARGS | METH_KEYWORDS,
+	  "submit(device, pixels, start=0, callback=None)\n\n"
+	  "Queue a pixel upload like Device.submit() and return immediately. The\n"
+	  "buffer is kept referenced and must not be modified until the callback\n"
+	  "ran. callback(result, error) is called from process_events(), error is\n"
+	  "None or an OSError. Requests of one device complete in order." },
+	{ "process_events", (PyCFunction)Async_process_events, METH_NOARGS,
+	  "Run the callbacks of finished requests, return their number. Never blocks.\n"
+	  "The first exception raised by a callback is re-raised afterwards." },
+	{ NULL, NULL, 0, NULL },
+};
+
+static PyGetSetDef Async_getset[] = {
+	{ "pending", (getter)Async_get_pending, NULL,
+	  "Number of requests whose callback didn't run yet.", NULL },
+	{ NULL, NULL, NULL, NULL, NULL },
+};
+
+static PyTypeObject AsyncType = {
+	PyVarObject_HEAD_INIT(NULL, 0).tp_name = "usb_ws2812.Async",
+	.tp_doc = "Async(workers=0)\n\n"
+		  "Context for asynchronous submission with its own worker threads,\n"
+		  "0 for the library default (WS2812_ASYNC_DEFAULT_WORKERS).",
+	.tp_basicsize = sizeof(AsyncObject),
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_new = Async_new,
+	.tp_dealloc = (destructor)Async_dealloc,
+	.tp_methods = Async_methods,
+	.tp_getset = Async_getset,
+};
+
+static struct PyModuleDef usb_ws2812_module = {
+	PyModuleDef_HEAD_INIT,
+	.m_name = "usb_ws2812",
+	.m_doc = "Bindings of the WS2812 user library.\n\n"
+		 "Pixels are passed as buffers (bytes, bytearray, memoryview or numpy\n"
+		 "uint8 arrays of shape (N, 3)) and reach the kernel module without\n"
+		 "per-pixel Python work.",
+	.m_size = -1,
+};
+
+PyMODINIT_FUNC PyInit_usb_ws2812(void)
+{
+	if (PyType_Ready(&DeviceType) < 0 || PyType_Ready(&AsyncType) < 0) {
+		return NULL;
+	}
+
+	PyObject *m = PyModule_Create(&usb_ws2812_module);
+	if (!m) {
+		return NULL;
+	}
+	if (PyModule_AddObjectRef(m, "Device", (PyObject *)&DeviceType) < 0 ||
+	    PyModule_AddObjectRef(m, "Async", (PyObject *)&AsyncType) < 0 ||
+	    PyModule_AddIntConstant(m, "QUEUE_DEPTH", WS2812_ASYNC_QUEUE_DEPTH) <
+		    0) {
+		Py_DECREF(m);
+		return NULL;
+	}
+	return m;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file lighting_packets.h                                                    *
+ * @brief Packet layouts of sACN (E1.31), Art-Net and DDP as used by the       *
+ *        receiver and the test sender                                         *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#ifndef LIGHTING_PACKETS_H
+#define LIGHTING_PACKETS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @def DMX_CHANNELS
+ * @brief Channels of a DMX universe.
+ */
+#define DMX_CHANNELS 512
+
+/**
+ * @def DMX_PIXELS
+ * @brief RGB pixels of a universe (170 * 3 = 510 channels, 2 unused).
+ */
+#define DMX_PIXELS 170
+
+/*
+ * sACN (ANSI E1.31), all fields big endian. Offsets from the start of the UDP payload.
+ */
+#define SACN_PORT 5568
+#define SACN_ACN_ID_OFFSET 4 /**< "ASC-E1.17\0\0\0" */
+#define SACN_ACN_ID_LENGTH 12
+#define SACN_ROOT_VECTOR_OFFSET 18
+#define SACN_ROOT_VECTOR_DATA 0x00000004 /**< VECTOR_ROOT_E131_DATA */
+#define SACN_ROOT_VECTOR_EXTENDED 0x00000008 /**< VECTOR_ROOT_E131_EXTENDED */
+#define SACN_CID_OFFSET 22
+#define SACN_FRAMING_VECTOR_OFFSET 40
+#define SACN_FRAMING_VECTOR_DATA 0x00000002 /**< VECTOR_E131_DATA_PACKET */
+#define SACN_FRAMING_VECTOR_SYNC 0x00000001 /**< VECTOR_E131_EXTENDED_SYNCHRONIZATION */
+#define SACN_SOURCE_NAME_OFFSET 44
+#define SACN_PRIORITY_OFFSET 108
+#define SACN_SYNC_ADDRESS_OFFSET 109
+#define SACN_SEQUENCE_OFFSET 111
+#define SACN_OPTIONS_OFFSET 112
+#define SACN_OPTION_PREVIEW 0x80 /**< Preview data, not for output. */
+#define SACN_OPTION_TERMINATED 0x40 /**< Last packet of the stream. */
+#define SACN_UNIVERSE_OFFSET 113
+#define SACN_DMP_VECTOR_OFFSET 117
+#define SACN_DMP_VECTOR 0x02 /**< VECTOR_DMP_SET_PROPERTY */
+#define SACN_PROPERTY_COUNT_OFFSET 123 /**< Start code + channels. */
+#define SACN_START_CODE_OFFSET 125
+#define SACN_DATA_OFFSET 126
+#define SACN_SYNC_SEQUENCE_OFFSET 44 /**< Sequence of a synchronization packet. */
+#define SACN_SYNC_UNIVERSE_OFFSET 45 /**< Synchronization address of a synchronization packet. */
+#define SACN_SYNC_LENGTH 49
+
+/**
+ * @def SACN_MULTICAST_GROUP
+ * @brief Multicast group of a universe: 239.255.<high byte>.<low byte>.
+ */
+#define SACN_MULTICAST_GROUP(universe) \
+	(0xefff0000u | ((uint32_t)(universe)&0xffff))
+
+/*
+ * Art-Net 4, OpCode and ArtDmx length little/big endian as noted.
+ */
+#define ARTNET_PORT 6454
+#define ARTNET_ID_LENGTH 8 /**< "Art-Net\0" */
+#define ARTNET_OPCODE_OFFSET 8 /**< Little endian. */
+#define ARTNET_OP_DMX 0x5000
+#define ARTNET_OP_SYNC 0x5200
+#define ARTNET_PROTOCOL_VERSION 14
+#define ARTNET_SEQUENCE_OFFSET 12
+#define ARTNET_SUBUNI_OFFSET 14 /**< Low byte of the port address. */
+#define ARTNET_NET_OFFSET 15 /**< High 7 bits of the port address. */
+#define ARTNET_LENGTH_OFFSET 16 /**< Big endian. */
+#define ARTNET_DATA_OFFSET 18
+#define ARTNET_SYNC_LENGTH 14
+
+/**
+ * @def ARTNET_SYNC_TIMEOUT_NS
+ * @brief Without ArtSync for this time a receiver outputs ArtDmx immediately again.
+ */
+#define ARTNET_SYNC_TIMEOUT_NS 4000000000ull
+
+/*
+ * DDP (Distributed Display Protocol), big endian.
+ */
+#define DDP_PORT 4048
+#define DDP_FLAGS_OFFSET 0
+#define DDP_FLAG_VERSION_MASK 0xc0
+#define DDP_FLAG_VERSION_1 0x40
+#define DDP_FLAG_TIMECODE 0x10 /**< 4 byte timecode behind the header. */
+#define DDP_FLAG_QUERY 0x02
+#define DDP_FLAG_PUSH 0x01 /**< Output everything received so far. */
+#define DDP_SEQUENCE_OFFSET 1
+#define DDP_TYPE_OFFSET 2
+#define DDP_ID_OFFSET 3
+#define DDP_ID_DISPLAY 1 /**< Default output device. */
+#define DDP_DATA_OFFSET_OFFSET 4 /**< Byte offset into the output buffer. */
+#define DDP_LENGTH_OFFSET 8
+#define DDP_HEADER_LENGTH 10
+#define DDP_TIMECODE_LENGTH 4
+#define DDP_MAX_DATA 1440 /**< Largest payload senders use (480 RGB pixels). */
+
+static inline uint16_t get_be16(const uint8_t *p)
+{
+	return (uint16_t)(p[0] << 8 | p[1]);
+}
+
+static inline uint32_t get_be32(const uint8_t *p)
+{
+	return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 |
+	       (uint32_t)p[2] << 8 | p[3];
+}
+
+static inline void put_be16(uint8_t *p, uint16_t value)
+{
+	p[0] = value >> 8;
+	p[1] = value & 0xff;
+}
+
+static inline void put_be32(uint8_t *p, uint32_t value)
+{
+	p[0] = value >> 24;
+	p[1] = (value >> 16) & 0xff;
+	p[2] = (value >> 8) & 0xff;
+	p[3] = value & 0xff;
+}
+
+#endif
@@ -0,0 +1,787 @@
+/**
+ * @file receiver.c                                                            *
+ * @brief Network receiver: sACN (E1.31), Art-Net and DDP from lighting        *
+ *        consoles to the strip                                                *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#include <argp.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include "lighting_packets.h"
+#include "usb_ws2812_lib.h"
+
+/**
+ * @def RECV_BATCH
+ * @brief Datagrams per recvmmsg() call.
+ */
+#define RECV_BATCH 32
+
+/**
+ * @def RECV_BUFFER
+ * @brief Largest datagram (DDP with timecode and 1440 bytes of data fits).
+ */
+#define RECV_BUFFER 1500
+
+/**
+ * @def MAX_MAPPINGS
+ * @brief Largest number of universes given with -m.
+ */
+#define MAX_MAPPINGS 512
+
+/**
+ * @def LATENCY_SAMPLES
+ * @brief Latencies kept per report interval for the percentiles.
+ */
+#define LATENCY_SAMPLES 4096
+
+const char *argp_program_version = "usb-ws2812-receiver";
+const char *argp_program_bug_address = "";
+static char doc[] =
+	"usb-ws2812-receiver empfängt Lichtdaten von Lichtpulten über sACN (E1.31, Port 5568), Art-Net "
+	"(Port 6454) und DDP (Port 4048) und gibt sie auf einem LED-Streifen aus. Universen werden über "
+	"vorberechnete Tabellen auf LED-Bereiche abgebildet (Standard: ab dem ersten Universum je 170 LEDs "
+	"pro Universum). Alle in einem Sync (sACN-Synchronisation, ArtSync, DDP-Push) bzw. in einem "
+	"recvmmsg()-Stapel empfangenen Daten werden als ein Frame gesendet. Die Latenz vom Empfang des "
+	"ersten Pakets eines Frames (Zeitstempel des Kernels) bis zum Ende der Ausgabe wird regelmäßig "
+	"ausgegeben.\vMAP hat die Form UNIVERSUM:LED[:ANZAHL[:KANAL]], KANAL ist der erste DMX-Kanal "
+	"(ab 1) der Farbe Rot. Universen werden wie bei sACN ab 1 gezählt, Art-Net zählt ab 0: "
+	"Art-Net-Universum 0 ist Universum 1 (mit -a 0 gelten die Art-Net-Nummern unverändert).";
+static char args_doc[] = "";
+
+static struct argp_option options[] = {
+	{ "device", 'd', "PATH", 0, "Gerätedatei oder usb:N (Standard /dev/usb_ws2812_0)", 0 },
+	{ "leds", 'l', "NUM", 0, "Länge des Streifens setzen (Standard: aktuelle Länge)", 0 },
+	{ "universe", 'u', "NUM", 0, "Erstes Universum der Standardabbildung (Standard 1)", 0 },
+	{ "artnet-offset", 'a', "NUM", 0, "Universum, auf das Art-Net-Universum 0 fällt (Standard 1)", 0 },
+	{ "map", 'm', "MAP", 0, "Universum auf LEDs abbilden (mehrfach, ersetzt die Standardabbildung)", 0 },
+	{ "bind", 'b', "ADDR", 0, "Lokale Adresse (Standard 0.0.0.0)", 0 },
+	{ "no-multicast", 'n', 0, 0, "sACN-Multicastgruppen nicht beitreten", 0 },
+	{ "protocols", 'p', "LIST", 0, "Protokolle: sacn,artnet,ddp (Standard alle)", 0 },
+	{ "report", 'r', "SEC", 0, "Statistik alle SEC Sekunden ausgeben, 0 nur am Ende (Standard 5)", 0 },
+	{ 0, 0, 0, 0, 0, 0 },
+};
+
+/**
+ * @brief Abbildung eines Universums, wie auf der Kommandozeile angegeben.
+ */
+struct mapping {
+	uint16_t universe;
+	uint16_t led; /**< Erste LED. */
+	uint16_t count; /**< Anzahl LEDs. */
+	uint16_t channel; /**< Erster Kanal (ab 1). */
+};
+
+struct arguments {
+	const char *device;
+	long leds;
+	long universe;
+	long artnet_offset;
+	struct mapping mappings[MAX_MAPPINGS];
+	size_t mapping_count;
+	const char *bind;
+	bool multicast;
+	bool sacn, artnet, ddp;
+	long report;
+};
+
+static error_t parse_opt(int key, char *arg, struct argp_state *state)
+{
+	struct arguments *arg_s = state->input;
+	switch (key) {
+	case 'd':
+		arg_s->device = arg;
+		break;
+	case 'l':
+		arg_s->leds = strtol(arg, NULL, 10);
+		break;
+	case 'u':
+		arg_s->universe = strtol(arg, NULL, 10);
+		break;
+	case 'a':
+		arg_s->artnet_offset = strtol(arg, NULL, 10);
+		break;
+	case 'm': {
+		if (arg_s->mapping_count == MAX_MAPPINGS) {
+			argp_error(state, "höchstens %d Abbildungen", MAX_MAPPINGS);
+		}
+		unsigned int universe, led, count = 0, channel = 1;
+		int n = sscanf(arg, "%u:%u:%u:%u", &universe, &led, &count,
+			       &channel);
+		if (n < 2 || universe > UINT16_MAX || led > UINT16_MAX ||
+		    channel < 1 || channel > DMX_CHANNELS - 2) {
+			argp_error(state, "ungültige Abbildung: %s", arg);
+		}
+		if (n < 3) {
+			count = DMX_PIXELS;
+		}
+		arg_s->mappings[arg_s->mapping_count++] = (struct mapping){
+			universe, led, count > UINT16_MAX ? UINT16_MAX : count,
+			channel
+		};
+		break;
+	}
+	case 'b':
+		arg_s->bind = arg;
+		break;
+	case 'n':
+		arg_s->multicast = false;
+		break;
+	case 'p':
+		arg_s->sacn = strstr(arg, "sacn") != NULL;
+		arg_s->artnet = strstr(arg, "artnet") != NULL;
+		arg_s->ddp = strstr(arg, "ddp") != NULL;
+		break;
+	case 'r':
+		arg_s->report = strtol(arg, NULL, 10);
+		break;
+	default:
+		return ARGP_ERR_UNKNOWN;
+	}
+	return 0;
+}
+
+static struct argp argp = { options, parse_opt, args_doc, doc, 0, 0, 0 };
+
+/**
+ * @brief Vorberechnete Kopie eines Universums in den Frame.
+ *
+ * Auf die Länge des Streifens und des Universums beschnitten, pro Paket bleibt
+ * nur ein memcpy().
+ */
+struct universe_slot {
+	uint32_t dst; /**< Byte im Frame. */
+	uint16_t src; /**< Erster Kanal im Universum (ab 0). */
+	uint16_t len; /**< Bytes. */
+	uint8_t sequence; /**< Letzte sACN-Sequenznummer. */
+	bool seen; /**< sequence ist gültig. */
+};
+
+/**
+ * @brief Protokolle mit eigenem Socket.
+ */
+enum protocol { PROTO_SACN, PROTO_ARTNET, PROTO_DDP, PROTO_COUNT };
+
+static const char *const protocol_names[PROTO_COUNT] = { "sACN", "Art-Net",
+							 "DDP" };
+
+/**
+ * @brief Puffer eines Sockets für recvmmsg().
+ */
+struct receive_batch {
+	struct mmsghdr msgs[RECV_BATCH];
+	struct iovec iov[RECV_BATCH];
+	uint8_t data[RECV_BATCH][RECV_BUFFER];
+	union {
+		struct cmsghdr header;
+		char buf[CMSG_SPACE(sizeof(struct timespec))];
+	} control[RECV_BATCH];
+};
+
+/**
+ * @brief Zustand des Empfängers.
+ */
+struct receiver {
+	ws2812_handle *handle;
+	ws2812_shadow *shadow; /**< Sendet nur geänderte Bereiche. */
+	led_pixel *frame;
+	uint16_t length;
+	uint16_t *universe_index; /**< 65536 Einträge: 0 nicht abgebildet, sonst Slot + 1. */
+	struct universe_slot *slots;
+	uint16_t artnet_offset; /**< Wird zu Art-Net-Universen addiert (Art-Net zählt ab 0). */
+	int sockets[PROTO_COUNT];
+	struct receive_batch *batch;
+	bool pending; /**< Daten seit der letzten Ausgabe. */
+	bool flush; /**< Am Ende des Stapels ausgeben (Daten ohne Sync). */
+	struct timespec first_rx; /**< Empfang des ersten Pakets seit der letzten Ausgabe. */
+	uint64_t artsync_ns; /**< Letztes ArtSync (CLOCK_MONOTONIC), 0 keins. */
+	uint64_t packets[PROTO_COUNT];
+	uint64_t ignored; /**< Ungültig, nicht abgebildet oder veraltet. */
+	uint64_t frames;
+	uint64_t errors;
+	double latencies[LATENCY_SAMPLES]; /**< Latenzen in us seit dem letzten Bericht. */
+	size_t latency_count;
+	double latency_max;
+	double latency_sum;
+	uint64_t latency_total;
+};
+
+static volatile sig_atomic_t running = 1;
+
+static void stop_handler(int sig)
+{
+	(void)sig;
+	running = 0;
+}
+
+static uint64_t now_ns(clockid_t clock)
+{
+	struct timespec ts;
+	clock_gettime(clock, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/**
+ * @brief Baut die Tabellen aus den Abbildungen.
+ */
+static int build_tables(struct receiver *recv, const struct mapping *mappings,
+			size_t count)
+{
+	recv->universe_index = calloc(UINT16_MAX + 1, sizeof(uint16_t));
+	recv->slots = calloc(count ? count : 1, sizeof(struct universe_slot));
+	if (!recv->universe_index || !recv->slots) {
+		perror("calloc");
+		return -1;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		const struct mapping *m = &mappings[i];
+		if (recv->universe_index[m->universe]) {
+			fprintf(stderr, "Universum %u mehrfach abgebildet\n",
+				m->universe);
+			return -1;
+		}
+		size_t src = m->channel - 1;
+		size_t pixels = m->count;
+		if (pixels > (DMX_CHANNELS - src) / 3) {
+			pixels = (DMX_CHANNELS - src) / 3;
+		}
+		if (m->led >= recv->length) {
+			pixels = 0;
+		} else if (pixels > (size_t)recv->length - m->led) {
+			pixels = recv->length - m->led;
+		}
+		recv->slots[i] = (struct universe_slot){
+			.dst = m->led * sizeof(led_pixel),
+			.src = src,
+			.len = pixels * sizeof(led_pixel),
+		};
+		recv->universe_index[m->universe] = i + 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief Kopiert DMX-Kanäle eines Universums in den Frame.
+ */
+static void apply_universe(struct receiver *recv, uint16_t universe,
+			   const uint8_t *data, size_t channels,
+			   const struct timespec *rx)
+{
+	struct universe_slot *slot = &recv->slots[recv->universe_index[universe] - 1];
+	size_t len = slot->len;
+
+	if (slot->src >= channels) {
+		return;
+	}
+	if (len > channels - slot->src) {
+		len = channels - slot->src;
+	}
+	memcpy((uint8_t *)recv->frame + slot->dst, data + slot->src, len);
+	if (!recv->pending) {
+		recv->pending = true;
+		recv->first_rx = *rx;
+	}
+}
+
+/**
+ * @brief Gibt den Frame aus, wenn seit der letzten Ausgabe Daten kamen.
+ */
+static void output_frame(struct receiver *recv)
+{
+	recv->flush = false;
+	if (!recv->pending) {
+		return;
+	}
+	recv->pending = false;
+	if (ws2812_shadow_submit(recv->shadow, recv->frame) < 0) {
+		if (recv->errors++ == 0) {
+			perror("ws2812_shadow_submit");
+		}
+		return;
+	}
+	recv->frames++;
+
+	// Zeitstempel des Kernels sind CLOCK_REALTIME
+	uint64_t rx = (uint64_t)recv->first_rx.tv_sec * 1000000000ull +
+		      recv->first_rx.tv_nsec;
+	double latency = (now_ns(CLOCK_REALTIME) - rx) / 1e3;
+	if (recv->latency_count < LATENCY_SAMPLES) {
+		recv->latencies[recv->latency_count++] = latency;
+	}
+	if (latency > recv->latency_max) {
+		recv->latency_max = latency;
+	}
+	recv->latency_sum += latency;
+	recv->latency_total++;
+}
+
+/**
+ * @brief sACN-Datenpaket oder Synchronisation.
+ */
+static void handle_sacn(struct receiver *recv, const uint8_t *p, size_t len,
+			const struct timespec *rx)
+{
+	static const uint8_t acn_id[SACN_ACN_ID_LENGTH] = "ASC-E1.17\0\0";
+
+	if (len < SACN_SYNC_LENGTH ||
+	    memcmp(p + SACN_ACN_ID_OFFSET, acn_id, SACN_ACN_ID_LENGTH) != 0) {
+		recv->ignored++;
+		return;
+	}
+	uint32_t root = get_be32(p + SACN_ROOT_VECTOR_OFFSET);
+	uint32_t framing = get_be32(p + SACN_FRAMING_VECTOR_OFFSET);
+	if (root == SACN_ROOT_VECTOR_EXTENDED &&
+	    framing == SACN_FRAMING_VECTOR_SYNC) {
+		output_frame(recv);
+		return;
+	}
+	if (root != SACN_ROOT_VECTOR_DATA || framing != SACN_FRAMING_VECTOR_DATA ||
+	    len < SACN_DATA_OFFSET || p[SACN_DMP_VECTOR_OFFSET] != SACN_DMP_VECTOR ||
+	    p[SACN_START_CODE_OFFSET] != 0 ||
+	    (p[SACN_OPTIONS_OFFSET] &
+	     (SACN_OPTION_PREVIEW | SACN_OPTION_TERMINATED))) {
+		recv->ignored++;
+		return;
+	}
+	uint16_t universe = get_be16(p + SACN_UNIVERSE_OFFSET);
+	if (!recv->universe_index[universe]) {
+		recv->ignored++;
+		return;
+	}
+
+	// Veraltete Pakete verwerfen (E1.31 6.7.2): -20 < neu - alt <= 0
+	struct universe_slot *slot = &recv->slots[recv->universe_index[universe] - 1];
+	uint8_t sequence = p[SACN_SEQUENCE_OFFSET];
+	int8_t diff = (int8_t)(sequence - slot->sequence);
+	if (slot->seen && diff <= 0 && diff > -20) {
+		recv->ignored++;
+		return;
+	}
+	slot->sequence = sequence;
+	slot->seen = true;
+
+	size_t channels = get_be16(p + SACN_PROPERTY_COUNT_OFFSET);
+	channels = channels ? channels - 1 : 0;
+	if (channels > len - SACN_DATA_OFFSET) {
+		channels = len - SACN_DATA_OFFSET;
+	}
+	apply_universe(recv, universe, p + SACN_DATA_OFFSET, channels, rx);
+	// Mit Synchronisationsadresse bis zur Synchronisation warten
+	if (get_be16(p + SACN_SYNC_ADDRESS_OFFSET) == 0) {
+		recv->flush = true;
+	}
+}
+
+/**
+ * @brief ArtDmx oder ArtSync.
+ */
+static void handle_artnet(struct receiver *recv, const uint8_t *p, size_t len,
+			  const struct timespec *rx)
+{
+	if (len < ARTNET_SYNC_LENGTH || memcmp(p, "Art-Net", ARTNET_ID_LENGTH) != 0) {
+		recv->ignored++;
+		return;
+	}
+	uint16_t opcode = p[ARTNET_OPCODE_OFFSET] | p[ARTNET_OPCODE_OFFSET + 1] << 8;
+	if (opcode == ARTNET_OP_SYNC) {
+		recv->artsync_ns = now_ns(CLOCK_MONOTONIC);
+		output_frame(recv);
+		return;
+	}
+	if (opcode != ARTNET_OP_DMX || len < ARTNET_DATA_OFFSET) {
+		recv->ignored++;
+		return;
+	}
+	uint32_t port_address = (p[ARTNET_NET_OFFSET] & 0x7f) << 8 |
+				p[ARTNET_SUBUNI_OFFSET];
+	if (port_address + recv->artnet_offset > UINT16_MAX) {
+		recv->ignored++;
+		return;
+	}
+	uint16_t universe = port_address + recv->artnet_offset;
+	if (!recv->universe_index[universe]) {
+		recv->ignored++;
+		return;
+	}
+	size_t channels = get_be16(p + ARTNET_LENGTH_OFFSET);
+	if (channels > len - ARTNET_DATA_OFFSET) {
+		channels = len - ARTNET_DATA_OFFSET;
+	}
+	apply_universe(recv, universe, p + ARTNET_DATA_OFFSET, channels, rx);
+	// Nach einem ArtSync synchron, ohne ArtSync für 4 s wieder sofort ausgeben
+	if (!recv->artsync_ns ||
+	    now_ns(CLOCK_MONOTONIC) - recv->artsync_ns > ARTNET_SYNC_TIMEOUT_NS) {
+		recv->flush = true;
+	}
+}
+
+/**
+ * @brief DDP-Datenpaket, der Datenoffset zählt in Bytes ab der ersten LED.
+ */
+static void handle_ddp(struct receiver *recv, const uint8_t *p, size_t len,
+		       const struct timespec *rx)
+{
+	if (len < DDP_HEADER_LENGTH ||
+	    (p[DDP_FLAGS_OFFSET] & DDP_FLAG_VERSION_MASK) != DDP_FLAG_VERSION_1 ||
+	    (p[DDP_FLAGS_OFFSET] & DDP_FLAG_QUERY) ||
+	    p[DDP_ID_OFFSET] != DDP_ID_DISPLAY) {
+		recv->ignored++;
+		return;
+	}
+	size_t header = DDP_HEADER_LENGTH;
+	if (p[DDP_FLAGS_OFFSET] & DDP_FLAG_TIMECODE) {
+		header += DDP_TIMECODE_LENGTH;
+	}
+	size_t offset = get_be32(p + DDP_DATA_OFFSET_OFFSET);
+	size_t data_len = get_be16(p + DDP_LENGTH_OFFSET);
+	size_t frame_len = recv->length * sizeof(led_pixel);
+	if (len < header) {
+		recv->ignored++;
+		return;
+	}
+	if (data_len > len - header) {
+		data_len = len - header;
+	}
+	if (offset < frame_len && data_len) {
+		if (data_len > frame_len - offset) {
+			data_len = frame_len - offset;
+		}
+		memcpy((uint8_t *)recv->frame + offset, p + header, data_len);
+		if (!recv->pending) {
+			recv->pending = true;
+			recv->first_rx = *rx;
+		}
+	}
+	if (p[DDP_FLAGS_OFFSET] & DDP_FLAG_PUSH) {
+		output_frame(recv);
+	}
+}
+
+/**
+ * @brief Liest alle wartenden Datagramme eines Sockets in Stapeln.
+ */
+static void receive(struct receiver *recv, enum protocol proto)
+{
+	struct receive_batch *b = recv->batch;
+	int n;
+
+	do {
+		for (int i = 0; i < RECV_BATCH; i++) {
+			b->iov[i] = (struct iovec){ b->data[i], RECV_BUFFER };
+			b->msgs[i].msg_hdr = (struct msghdr){
+				.msg_iov = &b->iov[i],
+				.msg_iovlen = 1,
+				.msg_control = b->control[i].buf,
+				.msg_controllen = sizeof(b->control[i].buf),
+			};
+		}
+		n = recvmmsg(recv->sockets[proto], b->msgs, RECV_BATCH,
+			     MSG_DONTWAIT, NULL);
+		if (n < 0) {
+			if (errno != EAGAIN && errno != EINTR) {
+				perror("recvmmsg");
+			}
+			return;
+		}
+
+		for (int i = 0; i < n; i++) {
+			struct timespec rx = { 0, 0 };
+			struct cmsghdr *cmsg = CMSG_FIRSTHDR(&b->msgs[i].msg_hdr);
+			if (cmsg && cmsg->cmsg_level == SOL_SOCKET &&
+			    cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+				memcpy(&rx, CMSG_DATA(cmsg), sizeof(rx));
+			} else {
+				clock_gettime(CLOCK_REALTIME, &rx);
+			}
+			const uint8_t *p = b->data[i];
+			size_t len = b->msgs[i].msg_len;
+			recv->packets[proto]++;
+			switch (proto) {
+			case PROTO_SACN:
+				handle_sacn(recv, p, len, &rx);
+				break;
+			case PROTO_ARTNET:
+				handle_artnet(recv, p, len, &rx);
+				break;
+			default:
+				handle_ddp(recv, p, len, &rx);
+				break;
+			}
+		}
+		// Daten ohne Sync: ein Frame pro Stapel
+		if (recv->flush) {
+			output_frame(recv);
+		}
+	} while (n == RECV_BATCH);
+}
+
+static int compare_double(const void *a, const void *b)
+{
+	double x = *(const double *)a, y = *(const double *)b;
+	return (x > y) - (x < y);
+}
+
+/**
+ * @brief Gibt die Statistik seit dem letzten Bericht aus.
+ */
+static void report(struct receiver *recv)
+{
+	printf("Pakete: sACN %llu, Art-Net %llu, DDP %llu, ignoriert %llu; Frames %llu, Fehler %llu\n",
+	       (unsigned long long)recv->packets[PROTO_SACN],
+	       (unsigned long long)recv->packets[PROTO_ARTNET],
+	       (unsigned long long)recv->packets[PROTO_DDP],
+	       (unsigned long long)recv->ignored,
+	       (unsigned long long)recv->frames,
+	       (unsigned long long)recv->errors);
+	if (recv->latency_total) {
+		size_t count = recv->latency_count;
+		qsort(recv->latencies, count, sizeof(double), compare_double);
+		printf("Latenz Paket bis Ausgabe: Mittel %.1f us, p50 %.1f us, p99 %.1f us, max %.1f us (%llu Frames)\n",
+		       recv->latency_sum / recv->latency_total,
+		       recv->latencies[count / 2],
+		       recv->latencies[count * 99 / 100], recv->latency_max,
+		       (unsigned long long)recv->latency_total);
+	}
+	fflush(stdout);
+	recv->latency_count = 0;
+	recv->latency_max = 0;
+	recv->latency_sum = 0;
+	recv->latency_total = 0;
+}
+
+/**
+ * @brief Öffnet den UDP-Socket eines Protokolls mit Kernel-Zeitstempeln.
+ */
+static int open_socket(const char *bind_addr, uint16_t port)
+{
+	struct sockaddr_in addr = { .sin_family = AF_INET,
+				    .sin_port = htons(port) };
+	if (inet_pton(AF_INET, bind_addr, &addr.sin_addr) != 1) {
+		fprintf(stderr, "Ungültige Adresse: %s\n", bind_addr);
+		return -1;
+	}
+
+	int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+	if (fd < 0) {
+		perror("socket");
+		return -1;
+	}
+	int on = 1;
+	// Größerer Puffer, damit Bursts zwischen zwei Ausgaben nicht verloren gehen
+	int rcvbuf = 4 << 20;
+	setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+	setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+	if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) < 0 ||
+	    bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		fprintf(stderr, "Port %u: %s\n", port, strerror(errno));
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+/**
+ * @brief Tritt den Multicastgruppen der abgebildeten sACN-Universen bei.
+ *
+ * Ein Fehler bricht nicht ab, damit die übrigen Universen empfangen werden.
+ * Linux erlaubt pro Socket nur net.ipv4.igmp_max_memberships Gruppen
+ * (Standard 20), also 3400 LEDs bei der Standardabbildung.
+ */
+static void join_multicast(int fd, const struct mapping *mappings, size_t count)
+{
+	size_t joined = 0, failed = 0;
+	int error = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		// Mehrere Abbildungen desselben Universums teilen sich eine Gruppe
+		bool seen = false;
+		for (size_t k = 0; k < i && !seen; k++) {
+			seen = mappings[k].universe == mappings[i].universe;
+		}
+		if (seen) {
+			continue;
+		}
+
+		struct ip_mreq mreq = {
+			.imr_multiaddr.s_addr =
+				htonl(SACN_MULTICAST_GROUP(mappings[i].universe)),
+			.imr_interface.s_addr = htonl(INADDR_ANY),
+		};
+		if (setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq,
+			       sizeof(mreq)) < 0) {
+			if (failed++ == 0) {
+				error = errno;
+				fprintf(stderr, "Multicast fehlgeschlagen für Universum");
+			}
+			fprintf(stderr, " %u", mappings[i].universe);
+			continue;
+		}
+		joined++;
+	}
+	if (failed) {
+		fprintf(stderr, " (%s)\n", strerror(error));
+		fprintf(stderr, "Linux erlaubt pro Socket nur net.ipv4.igmp_max_memberships "
+				"Gruppen (Standard 20): den Wert mit sysctl erhöhen oder "
+				"sACN per Unicast an diesen Rechner senden\n");
+	}
+	printf("Multicast: %zu von %zu Universen beigetreten\n", joined,
+	       joined + failed);
+}
+
+int main(int argc, char **argv)
+{
+	static struct arguments arguments = {
+		.device = "/dev/usb_ws2812_0",
+		.universe = 1,
+		.artnet_offset = 1,
+		.bind = "0.0.0.0",
+		.multicast = true,
+		.sacn = true,
+		.artnet = true,
+		.ddp = true,
+		.report = 5,
+	};
+	argp_parse(&argp, argc, argv, 0, 0, &arguments);
+	if (arguments.leds < 0 || arguments.leds > UINT16_MAX ||
+	    arguments.universe < 0 || arguments.universe > UINT16_MAX ||
+	    arguments.artnet_offset < 0 || arguments.artnet_offset > UINT16_MAX ||
+	    arguments.report < 0) {
+		printf("Ungültige Länge, Universum, Art-Net-Versatz oder Berichtsintervall\n");
+		return 1;
+	}
+
+	struct receiver recv = {
+		.sockets = { -1, -1, -1 },
+		.artnet_offset = arguments.artnet_offset,
+	};
+	int epoll_fd = -1;
+	int ret = 1;
+	recv.handle = ws2812_open(arguments.device, 0);
+	if (!recv.handle) {
+		perror(arguments.device);
+		return 1;
+	}
+	if (ws2812_set_mode_static(recv.handle) < 0 ||
+	    (arguments.leds && ws2812_set_length(recv.handle, arguments.leds) < 0)) {
+		perror("ws2812_set_length");
+		goto out;
+	}
+	int length = ws2812_get_length(recv.handle);
+	if (length <= 0) {
+		printf("Der Streifen hat keine Länge, mit -l setzen\n");
+		goto out;
+	}
+	recv.length = length;
+
+	// Standardabbildung: aufeinanderfolgende Universen, je 170 LEDs
+	if (arguments.mapping_count == 0) {
+		for (long led = 0; led < length && arguments.mapping_count < MAX_MAPPINGS;
+		     led += DMX_PIXELS) {
+			long universe = arguments.universe + led / DMX_PIXELS;
+			if (universe > UINT16_MAX) {
+				break;
+			}
+			arguments.mappings[arguments.mapping_count++] =
+				(struct mapping){ universe, led, DMX_PIXELS, 1 };
+		}
+	}
+
+	recv.frame = calloc(length, sizeof(led_pixel));
+	recv.batch = malloc(sizeof(struct receive_batch));
+	recv.shadow = ws2812_shadow_create(recv.handle, length);
+	if (!recv.frame || !recv.batch || !recv.shadow ||
+	    build_tables(&recv, arguments.mappings, arguments.mapping_count) < 0) {
+		perror("ws2812_shadow_create");
+		goto out;
+	}
+
+	epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (epoll_fd < 0) {
+		perror("epoll_create1");
+		goto out;
+	}
+	const bool enabled[PROTO_COUNT] = { arguments.sacn, arguments.artnet,
+					    arguments.ddp };
+	const uint16_t ports[PROTO_COUNT] = { SACN_PORT, ARTNET_PORT, DDP_PORT };
+	for (int proto = 0; proto < PROTO_COUNT; proto++) {
+		if (!enabled[proto]) {
+			continue;
+		}
+		recv.sockets[proto] = open_socket(arguments.bind, ports[proto]);
+		if (recv.sockets[proto] < 0) {
+			goto out;
+		}
+		struct epoll_event ev = { .events = EPOLLIN, .data.u32 = proto };
+		if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, recv.sockets[proto], &ev) < 0) {
+			perror("epoll_ctl");
+			goto out;
+		}
+		printf("%s auf Port %u\n", protocol_names[proto], ports[proto]);
+	}
+	if (arguments.sacn && arguments.multicast) {
+		join_multicast(recv.sockets[PROTO_SACN], arguments.mappings,
+			       arguments.mapping_count);
+	}
+	printf("%d LEDs, %zu Universen\n", length, arguments.mapping_count);
+	fflush(stdout);
+
+	struct sigaction sa = { .sa_handler = stop_handler };
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+
+	uint64_t interval_ns = arguments.report * 1000000000ull;
+	uint64_t next_report = now_ns(CLOCK_MONOTONIC) + interval_ns;
+	while (running) {
+		int timeout = -1;
+		if (interval_ns) {
+			uint64_t now = now_ns(CLOCK_MONOTONIC);
+			timeout = now >= next_report ?
+					  0 :
+					  (next_report - now) / 1000000 + 1;
+		}
+		struct epoll_event events[PROTO_COUNT];
+		int n = epoll_wait(epoll_fd, events, PROTO_COUNT, timeout);
+		if (n < 0 && errno != EINTR) {
+			perror("epoll_wait");
+			goto out;
+		}
+		for (int i = 0; i < n; i++) {
+			receive(&recv, events[i].data.u32);
+		}
+		if (interval_ns && now_ns(CLOCK_MONOTONIC) >= next_report) {
+			report(&recv);
+			next_report += interval_ns;
+		}
+	}
+	report(&recv);
+	ret = 0;
+
+out:
+	for (int proto = 0; proto < PROTO_COUNT; proto++) {
+		if (recv.sockets[proto] >= 0) {
+			close(recv.sockets[proto]);
+		}
+	}
+	if (epoll_fd >= 0) {
+		close(epoll_fd);
+	}
+	ws2812_shadow_free(recv.shadow);
+	free(recv.slots);
+	free(recv.universe_index);
+	free(recv.batch);
+	free(recv.frame);
+	ws2812_close(recv.handle);
+	return ret;
+}
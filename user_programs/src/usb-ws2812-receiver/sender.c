@@ -0,0 +1,299 @@
+/**
+ * @file sender.c                                                              *
+ * @brief Test sender for the network receiver: sends a moving pattern as      *
+ *        sACN, Art-Net or DDP                                                 *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#include <argp.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include "lighting_packets.h"
+
+const char *argp_program_version = "usb-ws2812-sender";
+const char *argp_program_bug_address = "";
+static char doc[] =
+	"usb-ws2812-sender sendet ein wanderndes Testmuster als sACN, Art-Net oder DDP, z. B. an "
+	"usb-ws2812-receiver auf 127.0.0.1. Mit -s folgt jedem Frame ein Sync (sACN-Synchronisation "
+	"bzw. ArtSync), bei DDP trägt das letzte Paket eines Frames immer das Push-Flag.";
+static char args_doc[] = "";
+
+static struct argp_option options[] = {
+	{ "protocol", 'p', "PROTO", 0, "sacn, artnet oder ddp (Standard sacn)", 0 },
+	{ "target", 't', "ADDR", 0, "Zieladresse (Standard 127.0.0.1)", 0 },
+	{ "leds", 'l', "NUM", 0, "Anzahl LEDs (Standard 340)", 0 },
+	{ "universe", 'u', "NUM", 0, "Erstes Universum (Standard 1, Art-Net 0)", 0 },
+	{ "rate", 'r', "FPS", 0, "Frames pro Sekunde (Standard 40)", 0 },
+	{ "frames", 'f', "NUM", 0, "Anzahl Frames, 0 endlos (Standard 200)", 0 },
+	{ "sync", 's', 0, 0, "Nach jedem Frame einen Sync senden", 0 },
+	{ 0, 0, 0, 0, 0, 0 },
+};
+
+enum protocol { PROTO_SACN, PROTO_ARTNET, PROTO_DDP };
+
+struct arguments {
+	enum protocol protocol;
+	const char *target;
+	long leds;
+	long universe;
+	bool universe_given;
+	long rate;
+	long frames;
+	bool sync;
+};
+
+static error_t parse_opt(int key, char *arg, struct argp_state *state)
+{
+	struct arguments *arg_s = state->input;
+	switch (key) {
+	case 'p':
+		if (strcmp(arg, "sacn") == 0) {
+			arg_s->protocol = PROTO_SACN;
+		} else if (strcmp(arg, "artnet") == 0) {
+			arg_s->protocol = PROTO_ARTNET;
+		} else if (strcmp(arg, "ddp") == 0) {
+			arg_s->protocol = PROTO_DDP;
+		} else {
+			argp_error(state, "unbekanntes Protokoll: %s", arg);
+		}
+		break;
+	case 't':
+		arg_s->target = arg;
+		break;
+	case 'l':
+		arg_s->leds = strtol(arg, NULL, 10);
+		break;
+	case 'u':
+		arg_s->universe = strtol(arg, NULL, 10);
+		arg_s->universe_given = true;
+		break;
+	case 'r':
+		arg_s->rate = strtol(arg, NULL, 10);
+		break;
+	case 'f':
+		arg_s->frames = strtol(arg, NULL, 10);
+		break;
+	case 's':
+		arg_s->sync = true;
+		break;
+	default:
+		return ARGP_ERR_UNKNOWN;
+	}
+	return 0;
+}
+
+static struct argp argp = { options, parse_opt, args_doc, doc, 0, 0, 0 };
+
+/**
+ * @brief Sendezustand.
+ */
+struct sender {
+	int fd;
+	struct sockaddr_in target;
+	uint8_t sequence;
+	uint8_t packet[DDP_HEADER_LENGTH + DDP_MAX_DATA];
+};
+
+static void send_packet(struct sender *s, uint16_t port, size_t len)
+{
+	s->target.sin_port = htons(port);
+	if (sendto(s->fd, s->packet, len, 0, (struct sockaddr *)&s->target,
+		   sizeof(s->target)) < 0) {
+		perror("sendto");
+	}
+}
+
+/**
+ * @brief Root- und Framing-Layer eines sACN-Pakets.
+ */
+static void sacn_header(uint8_t *p, size_t len, uint32_t root_vector)
+{
+	static const uint8_t cid[16] = { 0x75, 0x73, 0x62, 0x2d, 0x77, 0x73,
+					 0x32, 0x38, 0x31, 0x32, 0x2d, 0x73,
+					 0x65, 0x6e, 0x64, 0x01 };
+
+	memset(p, 0, len);
+	put_be16(p, 0x0010); // Preamble Size
+	memcpy(p + SACN_ACN_ID_OFFSET, "ASC-E1.17\0\0\0", SACN_ACN_ID_LENGTH);
+	put_be16(p + 16, 0x7000 | (len - 16));
+	put_be32(p + SACN_ROOT_VECTOR_OFFSET, root_vector);
+	memcpy(p + SACN_CID_OFFSET, cid, sizeof(cid));
+	put_be16(p + 38, 0x7000 | (len - 38));
+}
+
+static void send_sacn(struct sender *s, const uint8_t *frame, size_t bytes,
+		      uint16_t first, bool sync)
+{
+	uint16_t universe = first;
+
+	for (size_t pos = 0; pos < bytes; pos += DMX_PIXELS * 3, universe++) {
+		size_t channels = bytes - pos < DMX_PIXELS * 3 ? bytes - pos :
+								  DMX_PIXELS * 3;
+		size_t len = SACN_DATA_OFFSET + channels;
+		uint8_t *p = s->packet;
+
+		sacn_header(p, len, SACN_ROOT_VECTOR_DATA);
+		put_be32(p + SACN_FRAMING_VECTOR_OFFSET, SACN_FRAMING_VECTOR_DATA);
+		strcpy((char *)p + SACN_SOURCE_NAME_OFFSET, "usb-ws2812-sender");
+		p[SACN_PRIORITY_OFFSET] = 100;
+		// Synchronisationsadresse ist das erste Universum
+		put_be16(p + SACN_SYNC_ADDRESS_OFFSET, sync ? first : 0);
+		p[SACN_SEQUENCE_OFFSET] = s->sequence;
+		put_be16(p + SACN_UNIVERSE_OFFSET, universe);
+		put_be16(p + 115, 0x7000 | (len - 115));
+		p[SACN_DMP_VECTOR_OFFSET] = SACN_DMP_VECTOR;
+		p[118] = 0xa1; // Address Type & Data Type
+		put_be16(p + 121, 1); // Address Increment
+		put_be16(p + SACN_PROPERTY_COUNT_OFFSET, channels + 1);
+		memcpy(p + SACN_DATA_OFFSET, frame + pos, channels);
+		send_packet(s, SACN_PORT, len);
+	}
+	if (sync) {
+		sacn_header(s->packet, SACN_SYNC_LENGTH, SACN_ROOT_VECTOR_EXTENDED);
+		put_be32(s->packet + SACN_FRAMING_VECTOR_OFFSET,
+			 SACN_FRAMING_VECTOR_SYNC);
+		s->packet[SACN_SYNC_SEQUENCE_OFFSET] = s->sequence;
+		put_be16(s->packet + SACN_SYNC_UNIVERSE_OFFSET, first);
+		send_packet(s, SACN_PORT, SACN_SYNC_LENGTH);
+	}
+}
+
+static void artnet_header(uint8_t *p, uint16_t opcode)
+{
+	memcpy(p, "Art-Net", ARTNET_ID_LENGTH);
+	p[ARTNET_OPCODE_OFFSET] = opcode & 0xff;
+	p[ARTNET_OPCODE_OFFSET + 1] = opcode >> 8;
+	put_be16(p + 10, ARTNET_PROTOCOL_VERSION);
+}
+
+static void send_artnet(struct sender *s, const uint8_t *frame, size_t bytes,
+			uint16_t universe, bool sync)
+{
+	for (size_t pos = 0; pos < bytes; pos += DMX_PIXELS * 3, universe++) {
+		size_t channels = bytes - pos < DMX_PIXELS * 3 ? bytes - pos :
+								  DMX_PIXELS * 3;
+		// ArtDmx verlangt eine gerade Länge
+		size_t padded = (channels + 1) & ~(size_t)1;
+		uint8_t *p = s->packet;
+
+		memset(p, 0, ARTNET_DATA_OFFSET + padded);
+		artnet_header(p, ARTNET_OP_DMX);
+		p[ARTNET_SEQUENCE_OFFSET] = s->sequence ? s->sequence : 1;
+		p[ARTNET_SUBUNI_OFFSET] = universe & 0xff;
+		p[ARTNET_NET_OFFSET] = (universe >> 8) & 0x7f;
+		put_be16(p + ARTNET_LENGTH_OFFSET, padded);
+		memcpy(p + ARTNET_DATA_OFFSET, frame + pos, channels);
+		send_packet(s, ARTNET_PORT, ARTNET_DATA_OFFSET + padded);
+	}
+	if (sync) {
+		memset(s->packet, 0, ARTNET_SYNC_LENGTH);
+		artnet_header(s->packet, ARTNET_OP_SYNC);
+		send_packet(s, ARTNET_PORT, ARTNET_SYNC_LENGTH);
+	}
+}
+
+static void send_ddp(struct sender *s, const uint8_t *frame, size_t bytes)
+{
+	for (size_t pos = 0; pos < bytes; pos += DDP_MAX_DATA) {
+		size_t len = bytes - pos < DDP_MAX_DATA ? bytes - pos : DDP_MAX_DATA;
+		uint8_t *p = s->packet;
+
+		p[DDP_FLAGS_OFFSET] = DDP_FLAG_VERSION_1;
+		if (pos + len == bytes) {
+			p[DDP_FLAGS_OFFSET] |= DDP_FLAG_PUSH;
+		}
+		p[DDP_SEQUENCE_OFFSET] = (s->sequence & 0x0f) ? s->sequence & 0x0f : 1;
+		p[DDP_TYPE_OFFSET] = 0x0b; // RGB, 8 Bit pro Kanal
+		p[DDP_ID_OFFSET] = DDP_ID_DISPLAY;
+		put_be32(p + DDP_DATA_OFFSET_OFFSET, pos);
+		put_be16(p + DDP_LENGTH_OFFSET, len);
+		memcpy(p + DDP_HEADER_LENGTH, frame + pos, len);
+		send_packet(s, DDP_PORT, DDP_HEADER_LENGTH + len);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	struct arguments arguments = {
+		.protocol = PROTO_SACN,
+		.target = "127.0.0.1",
+		.leds = 340,
+		.universe = 1,
+		.rate = 40,
+		.frames = 200,
+	};
+	argp_parse(&argp, argc, argv, 0, 0, &arguments);
+	// Art-Net zählt Universen ab 0, sACN ab 1
+	if (!arguments.universe_given && arguments.protocol == PROTO_ARTNET) {
+		arguments.universe = 0;
+	}
+	if (arguments.leds <= 0 || arguments.leds > UINT16_MAX ||
+	    arguments.universe < 0 || arguments.universe > UINT16_MAX ||
+	    arguments.rate <= 0 || arguments.frames < 0) {
+		printf("Ungültige Länge, Universum, Rate oder Frameanzahl\n");
+		return 1;
+	}
+
+	struct sender s = { .target = { .sin_family = AF_INET } };
+	if (inet_pton(AF_INET, arguments.target, &s.target.sin_addr) != 1) {
+		printf("Ungültige Adresse: %s\n", arguments.target);
+		return 1;
+	}
+	s.fd = socket(AF_INET, SOCK_DGRAM, 0);
+	if (s.fd < 0) {
+		perror("socket");
+		return 1;
+	}
+
+	size_t bytes = arguments.leds * 3;
+	uint8_t *frame = malloc(bytes);
+	if (!frame) {
+		perror("malloc");
+		close(s.fd);
+		return 1;
+	}
+
+	struct timespec next;
+	clock_gettime(CLOCK_MONOTONIC, &next);
+	for (long f = 0; arguments.frames == 0 || f < arguments.frames; f++) {
+		// Ein heller Punkt wandert über einen schwachen Verlauf
+		for (long i = 0; i < arguments.leds; i++) {
+			bool dot = i == f % arguments.leds;
+			frame[i * 3] = dot ? 255 : (i * 4) & 0x3f;
+			frame[i * 3 + 1] = dot ? 255 : 0;
+			frame[i * 3 + 2] = dot ? 255 : 0x3f - ((i * 4) & 0x3f);
+		}
+		switch (arguments.protocol) {
+		case PROTO_SACN:
+			send_sacn(&s, frame, bytes, arguments.universe, arguments.sync);
+			break;
+		case PROTO_ARTNET:
+			send_artnet(&s, frame, bytes, arguments.universe, arguments.sync);
+			break;
+		default:
+			send_ddp(&s, frame, bytes);
+			break;
+		}
+		s.sequence++;
+
+		next.tv_nsec += 1000000000l / arguments.rate;
+		if (next.tv_nsec >= 1000000000l) {
+			next.tv_sec++;
+			next.tv_nsec -= 1000000000l;
+		}
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+	}
+
+	free(frame);
+	close(s.fd);
+	return 0;
+}
@@ -0,0 +1,846 @@
+/**
+ * @file video.c                                                               *
+ * @brief Video sampler: Y4M or raw YUV frames sampled onto an LED layout      *
+ *        with precomputed weights, pipelined over three threads               *
+ * @date  Sunday 18th-October-2026                                             *
+ * Document class: public                                                      *
+ * (c) 2026 Erik Appel, Kristian Minderer, https://git.fh-muenster.de          *
+ */
+
+#include <argp.h>
+#include <assert.h>
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "usb_ws2812_lib.h"
+
+/**
+ * @def VIDEO_BUFFERS
+ * @brief Decoded frames between the decode and the sample stage.
+ */
+#define VIDEO_BUFFERS 3
+
+/**
+ * @def WEIGHT_SHIFT
+ * @brief Fixed point of the sample weights, the weights of an LED sum to 1 << WEIGHT_SHIFT.
+ */
+#define WEIGHT_SHIFT 24
+
+/**
+ * @def LATE_THRESHOLD_NS
+ * @brief A frame published later than this after its deadline counts as late.
+ */
+#define LATE_THRESHOLD_NS 1000000ull
+
+/**
+ * @def RESYNC_THRESHOLD_NS
+ * @brief Further behind (slow pipe, SIGSTOP) the deadlines restart instead of catching up.
+ */
+#define RESYNC_THRESHOLD_NS 1000000000ull
+
+const char *argp_program_version = "usb-ws2812-video";
+const char *argp_program_bug_address = "";
+static char doc[] =
+	"usb-ws2812-video liest Y4M- oder rohe YUV-Frames aus einer Datei oder einer Pipe (z. B. "
+	"ffmpeg -i film.mp4 -f yuv4mpegpipe -) und tastet sie auf eine LED-Anordnung ab. Die Gewichte "
+	"(Flächenmittel oder bilinear) werden beim Start pro LED und Ebene vorberechnet, die Umrechnung "
+	"nach RGB läuft mit SIMD. Dekodieren, Abtasten und Senden laufen in eigenen Threads, "
+	"ausgegeben wird mit der Bildrate der Quelle.\vANORDNUNG: -g BxH ist ein Raster über das ganze "
+	"Bild (zeilenweise, mit -S jede zweite Zeile rückwärts), -p DATEI enthält pro LED eine Zeile "
+	"\"x y [b h]\" mit Mittelpunkt und Größe relativ zum Bild (0 ... 1).";
+static char args_doc[] = "";
+
+static struct argp_option options[] = {
+	{ "device", 'd', "PATH", 0, "Gerätedatei oder usb:N (Standard /dev/usb_ws2812_0)", 0 },
+	{ "input", 'i', "FILE", 0, "Eingabe, - für stdin (Standard)", 0 },
+	{ "size", 's', "BxH", 0, "Rohes YUV dieser Größe statt Y4M lesen", 0 },
+	{ "chroma", 'c', "420|422|444", 0, "Farbunterabtastung von rohem YUV (Standard 420)", 0 },
+	{ "rate", 'r', "FPS", 0, "Bildrate statt der der Quelle, 0 so schnell wie möglich (rohes YUV: Standard 25)", 0 },
+	{ "grid", 'g', "BxH", 0, "Raster als Anordnung (Standard 16x16)", 0 },
+	{ "serpentine", 'S', 0, 0, "Rasterzeilen abwechselnd verdrahtet", 0 },
+	{ "map", 'p', "FILE", 0, "Anordnung aus Datei", 0 },
+	{ "bilinear", 'b', 0, 0, "Bilinear am LED-Mittelpunkt statt Flächenmittel abtasten", 0 },
+	{ "matrix", 'M', "601|709", 0, "Farbmatrix (Standard 709 ab 720 Zeilen, sonst 601)", 0 },
+	{ "full-range", 'F', 0, 0, "YUV nutzt den vollen Bereich 0 ... 255", 0 },
+	{ "report", 'R', "SEC", 0, "Zeiten alle SEC Sekunden ausgeben, 0 nur am Ende (Standard 5)", 0 },
+	{ 0, 0, 0, 0, 0, 0 },
+};
+
+struct arguments {
+	const char *device;
+	const char *input;
+	unsigned int raw_width, raw_height;
+	unsigned int chroma;
+	double rate;
+	unsigned int grid_width, grid_height;
+	bool serpentine;
+	const char *map;
+	bool bilinear;
+	int matrix;
+	bool full_range;
+	long report;
+};
+
+static error_t parse_opt(int key, char *arg, struct argp_state *state)
+{
+	struct arguments *arg_s = state->input;
+	switch (key) {
+	case 'd':
+		arg_s->device = arg;
+		break;
+	case 'i':
+		arg_s->input = arg;
+		break;
+	case 's':
+		if (sscanf(arg, "%ux%u", &arg_s->raw_width, &arg_s->raw_height) != 2 ||
+		    !arg_s->raw_width || !arg_s->raw_height) {
+			argp_error(state, "ungültige Größe: %s", arg);
+		}
+		break;
+	case 'c':
+		arg_s->chroma = strtoul(arg, NULL, 10);
+		if (arg_s->chroma != 420 && arg_s->chroma != 422 &&
+		    arg_s->chroma != 444) {
+			argp_error(state, "ungültige Unterabtastung: %s", arg);
+		}
+		break;
+	case 'r':
+		arg_s->rate = strtod(arg, NULL);
+		break;
+	case 'g':
+		if (sscanf(arg, "%ux%u", &arg_s->grid_width, &arg_s->grid_height) != 2 ||
+		    !arg_s->grid_width || !arg_s->grid_height ||
+		    (uint64_t)arg_s->grid_width * arg_s->grid_height > UINT16_MAX) {
+			argp_error(state, "ungültiges Raster: %s", arg);
+		}
+		break;
+	case 'S':
+		arg_s->serpentine = true;
+		break;
+	case 'p':
+		arg_s->map = arg;
+		break;
+	case 'b':
+		arg_s->bilinear = true;
+		break;
+	case 'M':
+		arg_s->matrix = strtol(arg, NULL, 10);
+		if (arg_s->matrix != 601 && arg_s->matrix != 709) {
+			argp_error(state, "ungültige Farbmatrix: %s", arg);
+		}
+		break;
+	case 'F':
+		arg_s->full_range = true;
+		break;
+	case 'R':
+		arg_s->report = strtol(arg, NULL, 10);
+		break;
+	default:
+		return ARGP_ERR_UNKNOWN;
+	}
+	return 0;
+}
+
+static struct argp argp = { options, parse_opt, args_doc, doc, 0, 0, 0 };
+
+/**
+ * @brief Format der Eingabe.
+ */
+struct video_format {
+	bool y4m;
+	unsigned int width, height;
+	unsigned int chroma_width, chroma_height; /**< 0 bei Graustufen. */
+	double fps; /**< 0 unbekannt. */
+	bool full_range;
+	size_t luma_size, chroma_size, frame_size;
+};
+
+/**
+ * @brief Abtastpunkt einer LED relativ zum Bild.
+ */
+struct led_sample {
+	double x, y; /**< Mittelpunkt. */
+	double w, h; /**< Größe, 0 tastet bilinear ab. */
+};
+
+/**
+ * @brief Vorberechnete Gewichte einer Ebene: LED i liest die Taps first[i] ... first[i + 1] - 1.
+ */
+struct plane_taps {
+	uint32_t *first;
+	uint32_t *offset;
+	uint32_t *weight;
+	size_t count, capacity;
+};
+
+/**
+ * @brief Ring dekodierter Frames zwischen Dekodier- und Abtaststufe.
+ */
+struct video_ring {
+	uint8_t *frames[VIDEO_BUFFERS];
+	uint64_t head; /**< Nächster zu füllender Frame (Dekodierthread). */
+	uint64_t tail; /**< Nächster abzutastender Frame. */
+	pthread_mutex_t lock;
+	pthread_cond_t filled, freed;
+	bool eof; /**< Eingabe zu Ende oder Lesefehler. */
+	bool stop; /**< Abtaststufe beendet. */
+	bool finished; /**< Dekodierthread beendet. */
+};
+
+/**
+ * @brief Gemeinsamer Zustand der Stufen.
+ */
+struct pipeline {
+	FILE *input;
+	struct video_format format;
+	struct video_ring ring;
+	ws2812_stage_stats decode;
+	ws2812_stage_stats sample;
+};
+
+static volatile sig_atomic_t running = 1;
+
+static void stop_handler(int sig)
+{
+	(void)sig;
+	running = 0;
+}
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/**
+ * @brief Addiert eine Messung zu einer Stufe, nur vom Thread der Stufe aufgerufen.
+ */
+static void stage_add(ws2812_stage_stats *stage, uint64_t ns)
+{
+	__atomic_fetch_add(&stage->count, 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&stage->total_ns, ns, __ATOMIC_RELAXED);
+	if (ns > __atomic_load_n(&stage->max_ns, __ATOMIC_RELAXED)) {
+		__atomic_store_n(&stage->max_ns, ns, __ATOMIC_RELAXED);
+	}
+}
+
+static void set_sizes(struct video_format *f)
+{
+	f->luma_size = (size_t)f->width * f->height;
+	f->chroma_size = (size_t)f->chroma_width * f->chroma_height;
+	f->frame_size = f->luma_size + 2 * f->chroma_size;
+}
+
+static void set_chroma(struct video_format *f, unsigned int chroma)
+{
+	f->chroma_width = chroma == 444 ? f->width : (f->width + 1) / 2;
+	f->chroma_height = chroma == 420 ? (f->height + 1) / 2 : f->height;
+	if (chroma == 0) {
+		f->chroma_width = f->chroma_height = 0;
+	}
+}
+
+/**
+ * @brief Liest den Y4M-Kopf (YUV4MPEG2 W H F C X...).
+ */
+static int parse_y4m_header(FILE *in, struct video_format *f)
+{
+	char line[1024];
+	if (!fgets(line, sizeof(line), in) || strncmp(line, "YUV4MPEG2 ", 10) != 0 ||
+	    !strchr(line, '\n')) {
+		printf("Kein Y4M-Kopf, für rohes YUV -s angeben\n");
+		return -1;
+	}
+
+	unsigned int chroma = 420;
+	f->y4m = true;
+	for (char *tok = strtok(line + 10, " \n"); tok; tok = strtok(NULL, " \n")) {
+		unsigned int num, den;
+		switch (tok[0]) {
+		case 'W':
+			f->width = strtoul(tok + 1, NULL, 10);
+			break;
+		case 'H':
+			f->height = strtoul(tok + 1, NULL, 10);
+			break;
+		case 'F':
+			if (sscanf(tok + 1, "%u:%u", &num, &den) == 2 && den) {
+				f->fps = (double)num / den;
+			}
+			break;
+		case 'C':
+			if (strncmp(tok + 1, "420", 3) == 0 &&
+			    (tok[4] == '\0' || strcmp(tok + 4, "jpeg") == 0 ||
+			     strcmp(tok + 4, "mpeg2") == 0 || strcmp(tok + 4, "paldv") == 0)) {
+				chroma = 420;
+			} else if (strcmp(tok + 1, "422") == 0) {
+				chroma = 422;
+			} else if (strcmp(tok + 1, "444") == 0) {
+				chroma = 444;
+			} else if (strcmp(tok + 1, "mono") == 0) {
+				chroma = 0;
+			} else {
+				printf("Nicht unterstütztes Y4M-Format %s (nur 8 Bit)\n", tok + 1);
+				return -1;
+			}
+			break;
+		case 'X':
+			if (strcmp(tok, "XCOLORRANGE=FULL") == 0) {
+				f->full_range = true;
+			}
+			break;
+		default:
+			break;
+		}
+	}
+	if (!f->width || !f->height) {
+		printf("Y4M-Kopf ohne Größe\n");
+		return -1;
+	}
+	set_chroma(f, chroma);
+	set_sizes(f);
+	return 0;
+}
+
+/**
+ * @brief Liest einen Frame, bei Y4M mit der FRAME-Zeile davor.
+ *
+ * @return 0 bei Erfolg, -1 am Ende der Eingabe oder bei einem Fehler.
+ */
+static int read_frame(FILE *in, const struct video_format *f, uint8_t *frame)
+{
+	if (f->y4m) {
+		char line[256];
+		if (!fgets(line, sizeof(line), in)) {
+			return -1;
+		}
+		if (strncmp(line, "FRAME", 5) != 0 || !strchr(line, '\n')) {
+			fprintf(stderr, "Ungültiger Y4M-Frame\n");
+			return -1;
+		}
+	}
+	return fread(frame, f->frame_size, 1, in) == 1 ? 0 : -1;
+}
+
+/**
+ * @brief Dekodierstufe: liest Frames in den Ring, solange Platz ist.
+ */
+static void *decode_thread(void *arg)
+{
+	struct pipeline *p = arg;
+	struct video_ring *r = &p->ring;
+
+	for (;;) {
+		pthread_mutex_lock(&r->lock);
+		while (!r->stop && r->head - r->tail == VIDEO_BUFFERS) {
+			pthread_cond_wait(&r->freed, &r->lock);
+		}
+		bool stop = r->stop || !running;
+		pthread_mutex_unlock(&r->lock);
+		if (stop) {
+			break;
+		}
+
+		uint64_t start = now_ns();
+		int ret = read_frame(p->input, &p->format,
+				     r->frames[r->head % VIDEO_BUFFERS]);
+		if (ret == 0) {
+			stage_add(&p->decode, now_ns() - start);
+		}
+
+		pthread_mutex_lock(&r->lock);
+		if (ret < 0) {
+			r->eof = true;
+		} else {
+			r->head++;
+		}
+		pthread_cond_signal(&r->filled);
+		pthread_mutex_unlock(&r->lock);
+		if (ret < 0) {
+			break;
+		}
+	}
+
+	pthread_mutex_lock(&r->lock);
+	r->finished = true;
+	pthread_mutex_unlock(&r->lock);
+	return NULL;
+}
+
+/**
+ * @brief Hängt einen Tap an, der Speicher wächst bei Bedarf.
+ */
+static int taps_push(struct plane_taps *t, uint32_t offset, uint32_t weight)
+{
+	if (t->count == t->capacity) {
+		size_t capacity = t->capacity ? t->capacity * 2 : 4096;
+		uint32_t *o = realloc(t->offset, capacity * sizeof(uint32_t));
+		if (!o) {
+			return -1;
+		}
+		t->offset = o;
+		uint32_t *w = realloc(t->weight, capacity * sizeof(uint32_t));
+		if (!w) {
+			return -1;
+		}
+		t->weight = w;
+		t->capacity = capacity;
+	}
+	t->offset[t->count] = offset;
+	t->weight[t->count] = weight;
+	t->count++;
+	return 0;
+}
+
+/**
+ * @brief Hängt einen Tap mit dem Anteil weight (0 ... 1) an.
+ *
+ * Gerundet wird die laufende Summe, der Tap bekommt die Differenz zur
+ * vorherigen gerundeten Summe. So sammelt sich kein Rundungsfehler an und
+ * kein Gewicht wird negativ.
+ *
+ * @param exact Ungerundete Summe der bisherigen Taps der LED.
+ * @param rounded Gerundete Summe der bisherigen Taps der LED.
+ */
+static int taps_push_share(struct plane_taps *t, uint32_t offset, double weight,
+			   double *exact, int64_t *rounded)
+{
+	*exact += weight * (1u << WEIGHT_SHIFT);
+	int64_t next = llround(fmin(*exact, 1u << WEIGHT_SHIFT));
+	assert(next >= *rounded);
+	uint32_t w = next - *rounded;
+	*rounded = next;
+	return taps_push(t, offset, w);
+}
+
+/**
+ * @brief Berechnet die Taps aller LEDs für eine Ebene der Größe pw x ph.
+ *
+ * Flächenmittel: jedes Pixel, das das Rechteck der LED überdeckt, zählt mit
+ * seinem Flächenanteil. Bilinear: die vier Nachbarn des Mittelpunkts. Die
+ * Gewichte werden gerundet und summieren sich exakt zu 1 << WEIGHT_SHIFT.
+ */
+static int build_taps(struct plane_taps *t, const struct led_sample *leds,
+		      size_t count, unsigned int pw, unsigned int ph, bool area)
+{
+	t->first = malloc((count + 1) * sizeof(uint32_t));
+	if (!t->first) {
+		return -1;
+	}
+	for (size_t i = 0; i < count; i++) {
+		const struct led_sample *s = &leds[i];
+		double x0 = fmax((s->x - s->w / 2) * pw, 0);
+		double x1 = fmin((s->x + s->w / 2) * pw, pw);
+		double y0 = fmax((s->y - s->h / 2) * ph, 0);
+		double y1 = fmin((s->y + s->h / 2) * ph, ph);
+		double exact = 0;
+		int64_t rounded = 0;
+
+		t->first[i] = t->count;
+		if (area && x1 > x0 && y1 > y0) {
+			double scale = 1 / ((x1 - x0) * (y1 - y0));
+			for (unsigned int y = y0; y < y1; y++) {
+				double oy = fmin(y + 1, y1) - fmax(y, y0);
+				for (unsigned int x = x0; x < x1; x++) {
+					double ox = fmin(x + 1, x1) - fmax(x, x0);
+					if (taps_push_share(t, y * pw + x, ox * oy * scale,
+							    &exact, &rounded) < 0) {
+						return -1;
+					}
+				}
+			}
+		} else {
+			// Bilinear, Pixelmitten liegen bei x + 0.5
+			double sx = fmin(fmax(s->x * pw - 0.5, 0), pw - 1);
+			double sy = fmin(fmax(s->y * ph - 0.5, 0), ph - 1);
+			unsigned int ix = sx, iy = sy;
+			unsigned int nx = ix + 1 < pw ? ix + 1 : ix;
+			unsigned int ny = iy + 1 < ph ? iy + 1 : iy;
+			double fx = sx - ix, fy = sy - iy;
+			const uint32_t offsets[4] = { iy * pw + ix, iy * pw + nx,
+						      ny * pw + ix, ny * pw + nx };
+			const double weights[4] = { (1 - fx) * (1 - fy),
+						    fx * (1 - fy), (1 - fx) * fy,
+						    fx * fy };
+			for (int k = 0; k < 4; k++) {
+				if (taps_push_share(t, offsets[k], weights[k], &exact,
+						    &rounded) < 0) {
+					return -1;
+				}
+			}
+		}
+
+		// Nur Fließkommafehler der Summe bleiben übrig, die Summe ist exakt 1 << WEIGHT_SHIFT
+		int64_t rest = (int64_t)(1u << WEIGHT_SHIFT) - rounded;
+		assert(rest >= 0 && rest <= 1);
+		t->weight[t->count - 1] += rest;
+	}
+	t->first[count] = t->count;
+	return 0;
+}
+
+static void free_taps(struct plane_taps *t)
+{
+	free(t->first);
+	free(t->offset);
+	free(t->weight);
+}
+
+/**
+ * @brief Tastet eine Ebene für alle LEDs ab.
+ */
+static void sample_plane(const struct plane_taps *t, const uint8_t *plane,
+			 size_t count, uint8_t *out)
+{
+	for (size_t i = 0; i < count; i++) {
+		uint64_t acc = 1u << (WEIGHT_SHIFT - 1);
+		for (uint32_t k = t->first[i]; k < t->first[i + 1]; k++) {
+			acc += (uint64_t)plane[t->offset[k]] * t->weight[k];
+		}
+		out[i] = acc >> WEIGHT_SHIFT;
+	}
+}
+
+/**
+ * @brief Liest eine Anordnung (pro Zeile "x y [b h]").
+ *
+ * @return Anzahl der LEDs, oder -1 bei einem Fehler.
+ */
+static long load_map(const char *path, struct led_sample **leds)
+{
+	FILE *f = fopen(path, "r");
+	if (!f) {
+		perror(path);
+		return -1;
+	}
+	size_t count = 0, capacity = 0;
+	char line[256];
+	unsigned int lineno = 0;
+	while (fgets(line, sizeof(line), f)) {
+		lineno++;
+		struct led_sample s = { 0 };
+		char *hash = strchr(line, '#');
+		if (hash) {
+			*hash = '\0';
+		}
+		int n = sscanf(line, "%lf %lf %lf %lf", &s.x, &s.y, &s.w, &s.h);
+		if (n <= 0) {
+			continue;
+		}
+		if ((n != 2 && n != 4) || s.w < 0 || s.h < 0 ||
+		    count == UINT16_MAX) {
+			printf("%s:%u: erwartet \"x y [b h]\"\n", path, lineno);
+			fclose(f);
+			return -1;
+		}
+		if (count == capacity) {
+			capacity = capacity ? capacity * 2 : 256;
+			struct led_sample *l = realloc(*leds, capacity * sizeof(*l));
+			if (!l) {
+				perror("realloc");
+				fclose(f);
+				return -1;
+			}
+			*leds = l;
+		}
+		(*leds)[count++] = s;
+	}
+	fclose(f);
+	return count;
+}
+
+/**
+ * @brief Raster über das ganze Bild, LEDs in Verdrahtungsreihenfolge.
+ */
+static long make_grid(unsigned int w, unsigned int h, bool serpentine,
+		      struct led_sample **leds)
+{
+	*leds = malloc((size_t)w * h * sizeof(struct led_sample));
+	if (!*leds) {
+		perror("malloc");
+		return -1;
+	}
+	for (unsigned int row = 0; row < h; row++) {
+		for (unsigned int col = 0; col < w; col++) {
+			unsigned int x = serpentine && (row & 1) ? w - 1 - col : col;
+			(*leds)[row * w + col] = (struct led_sample){
+				(x + 0.5) / w, (row + 0.5) / h, 1.0 / w, 1.0 / h
+			};
+		}
+	}
+	return (long)w * h;
+}
+
+static void print_stage(const char *name, const ws2812_stage_stats *s)
+{
+	printf(" | %s Mittel %.2f ms, max %.2f ms", name,
+	       s->count ? s->total_ns / 1e6 / s->count : 0.0, s->max_ns / 1e6);
+}
+
+/**
+ * @brief Gibt die Zeiten der Stufen seit dem Start aus.
+ */
+static void report(struct pipeline *p, ws2812_frame_queue *queue,
+		   uint64_t frames, uint64_t late, uint64_t start_ns)
+{
+	ws2812_queue_stats qs;
+	ws2812_stage_stats decode, sample;
+	ws2812_queue_get_stats(queue, &qs);
+	__atomic_load(&p->decode.count, &decode.count, __ATOMIC_RELAXED);
+	__atomic_load(&p->decode.total_ns, &decode.total_ns, __ATOMIC_RELAXED);
+	__atomic_load(&p->decode.max_ns, &decode.max_ns, __ATOMIC_RELAXED);
+	sample = p->sample;
+
+	double seconds = (now_ns() - start_ns) / 1e9;
+	printf("%llu Frames (%.1f fps), %llu verspätet", (unsigned long long)frames,
+	       seconds > 0 ? frames / seconds : 0.0, (unsigned long long)late);
+	print_stage("Dekodieren", &decode);
+	print_stage("Abtasten", &sample);
+	print_stage("Warteschlange", &qs.queue);
+	print_stage("Senden", &qs.submit);
+	printf("\n");
+	fflush(stdout);
+}
+
+int main(int argc, char **argv)
+{
+	struct arguments arguments = {
+		.device = "/dev/usb_ws2812_0",
+		.input = "-",
+		.chroma = 420,
+		.rate = -1,
+		.grid_width = 16,
+		.grid_height = 16,
+		.report = 5,
+	};
+	argp_parse(&argp, argc, argv, 0, 0, &arguments);
+
+	struct pipeline p = {
+		.ring = { .lock = PTHREAD_MUTEX_INITIALIZER,
+			  .filled = PTHREAD_COND_INITIALIZER,
+			  .freed = PTHREAD_COND_INITIALIZER },
+	};
+	struct led_sample *leds = NULL;
+	struct plane_taps taps[2] = { { 0 } };
+	uint8_t *yuv = NULL;
+	ws2812_planar_frame *planar = NULL;
+	ws2812_handle *handle = NULL;
+	ws2812_frame_queue *queue = NULL;
+	int ret = 1;
+
+	long count = arguments.map ? load_map(arguments.map, &leds) :
+				     make_grid(arguments.grid_width,
+					       arguments.grid_height,
+					       arguments.serpentine, &leds);
+	if (count <= 0) {
+		if (count == 0) {
+			printf("Die Anordnung enthält keine LEDs\n");
+		}
+		goto out;
+	}
+
+	p.input = strcmp(arguments.input, "-") == 0 ? stdin :
+						      fopen(arguments.input, "rb");
+	if (!p.input) {
+		perror(arguments.input);
+		goto out;
+	}
+	struct video_format *f = &p.format;
+	if (arguments.raw_width) {
+		f->width = arguments.raw_width;
+		f->height = arguments.raw_height;
+		f->fps = 25;
+		set_chroma(f, arguments.chroma);
+		set_sizes(f);
+	} else if (parse_y4m_header(p.input, f) < 0) {
+		goto out;
+	}
+	if (arguments.rate >= 0) {
+		f->fps = arguments.rate;
+	}
+	f->full_range |= arguments.full_range;
+	int matrix = arguments.matrix ? arguments.matrix :
+					f->height >= 720 ? 709 : 601;
+	ws2812_yuv_matrix yuv_matrix =
+		matrix == 709 ? (f->full_range ? WS2812_YUV_BT709_FULL : WS2812_YUV_BT709) :
+				(f->full_range ? WS2812_YUV_BT601_FULL : WS2812_YUV_BT601);
+
+	// Gewichte einmal pro Ebene, die Chromaebenen haben ihre eigene Größe
+	bool area = !arguments.bilinear;
+	if (build_taps(&taps[0], leds, count, f->width, f->height, area) < 0 ||
+	    (f->chroma_size &&
+	     (build_taps(&taps[1], leds, count, f->chroma_width,
+			 f->chroma_height, area) < 0))) {
+		perror("build_taps");
+		goto out;
+	}
+
+	// Die Threads der Bibliothek erben eine Maske ohne SIGINT/SIGTERM
+	sigset_t signals;
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGINT);
+	sigaddset(&signals, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+	handle = ws2812_open(arguments.device, count);
+	if (!handle) {
+		perror(arguments.device);
+		goto out;
+	}
+	if (ws2812_set_mode_static(handle) < 0 ||
+	    ws2812_set_length(handle, count) < 0) {
+		perror("ws2812_set_length");
+		goto out;
+	}
+	queue = ws2812_queue_create(handle, count, 2, WS2812_QUEUE_BLOCK);
+	planar = ws2812_planar_create(count);
+	yuv = malloc(3 * count);
+	for (int i = 0; i < VIDEO_BUFFERS; i++) {
+		p.ring.frames[i] = malloc(f->frame_size);
+		if (!p.ring.frames[i]) {
+			goto out;
+		}
+	}
+	if (!queue || !planar || !yuv) {
+		perror("ws2812_queue_create");
+		goto out;
+	}
+	pthread_sigmask(SIG_UNBLOCK, &signals, NULL);
+	if (!f->chroma_size) {
+		memset(yuv + count, 128, 2 * count);
+	}
+
+	printf("%ux%u, %.2f fps, BT.%d %s, %ld LEDs, %s, %zu Taps\n", f->width,
+	       f->height, f->fps, matrix,
+	       f->full_range ? "voller Bereich" : "begrenzter Bereich", count,
+	       area ? "Flächenmittel" : "bilinear", taps[0].count + taps[1].count);
+	fflush(stdout);
+
+	struct sigaction sa = { .sa_handler = stop_handler };
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+
+	pthread_t decoder;
+	int err = pthread_create(&decoder, NULL, decode_thread, &p);
+	if (err) {
+		errno = err;
+		perror("pthread_create");
+		goto out;
+	}
+
+	uint64_t period_ns = f->fps > 0 ? 1e9 / f->fps : 0;
+	uint64_t interval_ns = arguments.report * 1000000000ull;
+	uint64_t start_ns = now_ns();
+	uint64_t next_report = start_ns + interval_ns;
+	uint64_t deadline = 0, frames = 0, late = 0;
+	struct video_ring *r = &p.ring;
+	while (running) {
+		pthread_mutex_lock(&r->lock);
+		while (r->head == r->tail && !r->eof && running) {
+			// Kurz warten, falls das Signal vor dem read() des Dekodierthreads kam
+			struct timespec ts;
+			clock_gettime(CLOCK_REALTIME, &ts);
+			ts.tv_nsec += 100000000;
+			if (ts.tv_nsec >= 1000000000) {
+				ts.tv_sec++;
+				ts.tv_nsec -= 1000000000;
+			}
+			pthread_cond_timedwait(&r->filled, &r->lock, &ts);
+		}
+		bool empty = r->head == r->tail;
+		pthread_mutex_unlock(&r->lock);
+		if (empty || !running) {
+			break;
+		}
+
+		// Abtasten und Umrechnen in den nächsten Puffer der Warteschlange
+		uint64_t start = now_ns();
+		const uint8_t *frame = r->frames[r->tail % VIDEO_BUFFERS];
+		sample_plane(&taps[0], frame, count, yuv);
+		if (f->chroma_size) {
+			sample_plane(&taps[1], frame + f->luma_size, count,
+				     yuv + count);
+			sample_plane(&taps[1], frame + f->luma_size + f->chroma_size,
+				     count, yuv + 2 * count);
+		}
+		ws2812_planar_from_yuv(planar, yuv, yuv + count, yuv + 2 * count,
+				       yuv_matrix);
+		led_pixel *pixels = ws2812_queue_acquire(queue);
+		ws2812_planar_to_pixels(planar, pixels);
+		stage_add(&p.sample, now_ns() - start);
+
+		pthread_mutex_lock(&r->lock);
+		r->tail++;
+		pthread_cond_signal(&r->freed);
+		pthread_mutex_unlock(&r->lock);
+
+		// Mit der Bildrate der Quelle veröffentlichen, Fristen sind absolut
+		uint64_t now = now_ns();
+		if (frames == 0 || now > deadline + RESYNC_THRESHOLD_NS) {
+			deadline = now;
+		}
+		if (period_ns) {
+			struct timespec ts = { deadline / 1000000000ull,
+					       deadline % 1000000000ull };
+			while (running && clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME,
+							  &ts, NULL) == EINTR) {
+			}
+			if (!running) {
+				break;
+			}
+			if (now_ns() > deadline + LATE_THRESHOLD_NS) {
+				late++;
+			}
+		}
+		ws2812_queue_publish(queue);
+		frames++;
+		deadline += period_ns;
+
+		if (interval_ns && now_ns() >= next_report) {
+			report(&p, queue, frames, late, start_ns);
+			next_report += interval_ns;
+		}
+	}
+
+	// Den Dekodierthread auch aus einem blockierenden read() holen
+	pthread_mutex_lock(&r->lock);
+	r->stop = true;
+	pthread_cond_signal(&r->freed);
+	bool finished = r->finished;
+	pthread_mutex_unlock(&r->lock);
+	while (!finished) {
+		pthread_kill(decoder, SIGINT);
+		nanosleep(&(struct timespec){ 0, 10000000 }, NULL);
+		pthread_mutex_lock(&r->lock);
+		finished = r->finished;
+		pthread_mutex_unlock(&r->lock);
+	}
+	pthread_join(decoder, NULL);
+	if (ferror(p.input) && running) {
+		perror(arguments.input);
+	}
+	report(&p, queue, frames, late, start_ns);
+	ret = 0;
+
+out:
+	ws2812_queue_destroy(queue);
+	ws2812_close(handle);
+	ws2812_planar_free(planar);
+	for (int i = 0; i < VIDEO_BUFFERS; i++) {
+		free(p.ring.frames[i]);
+	}
+	free(yuv);
+	free_taps(&taps[0]);
+	free_taps(&taps[1]);
+	free(leds);
+	if (p.input && p.input != stdin) {
+		fclose(p.input);
+	}
+	return ret;
+}
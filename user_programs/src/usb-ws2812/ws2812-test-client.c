@@ -43,6 +43,7 @@ static struct argp_option options[] = {
 	{ "pixeldatafile", 324, "LED DATEN FILE", 0, "Eine Datei mit Leddaten im Format: \"LÄNGE OFFSET R0 G0 B0 ... RN GN BN\""},
 	{ "clear", 'c', 0, 0, "Clear den Ledstreifen"},
 	{ "get_length", 325, 0, 0, "gibt die aktuelle Länge des USB-Geräts zurück."},
+	{ "save_boot_frame", 326, 0, 0, "Speichert die aktuellen Leddaten als Boot-Frame im Flash des USB-Geräts."},
     { 0 },
 };
 
@@ -71,6 +72,7 @@ struct arguments {
 	bool set_mode;
 	bool set_legnth;
 	bool clear;
+	bool save_boot_frame;
 };
 
 
@@ -121,6 +123,9 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
 	case 325:
 		arg_s->get_length = true;
 		break;
+	case 326:
+		arg_s->save_boot_frame = true;
+		break;
 	case 'c':
 		arg_s->clear = true;
 		break;
@@ -134,7 +139,7 @@ static struct argp argp = { options, parse_opt, args_doc, doc, 0, 0, 0 };
 /**
  * @brief Function to start the blinking mode
  */
-void start_blink(int fd, uint16_t delay, char* pattern_file){
+void start_blink(ws2812_handle *dev, uint16_t delay, char* pattern_file){
 	led_pixel pattern_data[9];
 	pattern_data[0] = (led_pixel){ 0x41, 0, 0 };
 	pattern_data[1] = (led_pixel){ 0, 0x41, 0 };
@@ -189,13 +194,13 @@ void start_blink(int fd, uint16_t delay, char* pattern_file){
 
 	}
 	// Modus ändern
-	if(ws2812_set_mode_blink(fd, pattern.pattern_states, pattern.length, delay) < 0){
+	if(ws2812_set_mode_blink(dev, pattern.pattern_states, pattern.length, delay) < 0){
 		perror("Modechange failed!\n");
 		return;
 	};
 
 	// Pattern senden
-	if(ws2812_set_blink_pattern(fd, &pattern) < 0){
+	if(ws2812_set_blink_pattern(dev, &pattern) < 0){
 		perror("Failed to send new pattern!\n");
 	};
 }
@@ -204,10 +209,10 @@ void start_blink(int fd, uint16_t delay, char* pattern_file){
 /**
  * @brief Function to send the get mode command
  */
-void send_get_mode(int fd){
+void send_get_mode(ws2812_handle *dev){
 	led_set_mode mode;
 	// modus abfragen
-	int mode_id = ws2812_get_mode(fd, &mode);
+	int mode_id = ws2812_get_mode(dev, &mode);
 	if(mode_id < 0){
 		printf("get_mode encountered a problem: %s\n", strerror(errno));
 	}
@@ -232,8 +237,8 @@ void send_get_mode(int fd){
 /**
  * @brief Function to send the get pixel data command
  */
-void send_get_pixel_data(int fd){
-	uint16_t pixel_count = ws2812_get_length(fd);
+void send_get_pixel_data(ws2812_handle *dev){
+	uint16_t pixel_count = ws2812_get_length(dev);
 	ws2812_pixel_buffer pixel_buf = {
 		.length = pixel_count,
 		.pixel_data = malloc(pixel_count * sizeof(led_pixel))
@@ -244,7 +249,7 @@ void send_get_pixel_data(int fd){
 		return;
 	}
 
-	int error = ws2812_get_data(fd, &pixel_buf);
+	int error = ws2812_get_data(dev, &pixel_buf);
 	if(error < 0){
 		printf("ws2812_get_data encountered a problem: %s\n", strerror(errno));
 		return;
@@ -260,8 +265,8 @@ void send_get_pixel_data(int fd){
 /**
  * @brief Function to send the get mode pixel data command
  */
-void send_get_mode_pixel_data(int fd){
-	uint16_t pixel_count = ws2812_get_mode_data_length(fd);
+void send_get_mode_pixel_data(ws2812_handle *dev){
+	uint16_t pixel_count = ws2812_get_mode_data_length(dev);
 	ws2812_pixel_buffer pixel_buf = {
 		.length = pixel_count,
 		.pixel_data = malloc(pixel_count * sizeof(led_pixel))
@@ -272,7 +277,7 @@ void send_get_mode_pixel_data(int fd){
 		return;
 	}
 
-	int error = ws2812_get_mode_data(fd, &pixel_buf);
+	int error = ws2812_get_mode_data(dev, &pixel_buf);
 	if(error < 0){
 		printf("ws2812_get_mode_data encountered a problem: %s\n", strerror(errno));
 		return;
@@ -289,7 +294,7 @@ void send_get_mode_pixel_data(int fd){
 /**
  * @brief Function to update pixel data
  */
-void update_pixel(int fd, char* pixel_daten_file){
+void update_pixel(ws2812_handle *dev, char* pixel_daten_file){
 	FILE* pixel_file = fopen(pixel_daten_file, "r");
 	if(pixel_file == NULL){
 		perror("File not found");
@@ -324,7 +329,7 @@ void update_pixel(int fd, char* pixel_daten_file){
 	/*for(i = 0; i < pixel_count; i++){
 		printf("Pixel[%03d]{r = %x, g = %x, b = %x}\n", i , pixel_data[i].red,pixel_data[i].green,pixel_data[i].blue);
 	}*/
-	if(ws2812_set_led_pixel(fd, offset, pixel_count, pixel_data) < 0){
+	if(ws2812_set_led_pixel(dev, offset, pixel_count, pixel_data) < 0){
 		printf("Pixeldaten wurden nicht gesendet: %s\n", strerror(errno));
 	}
 	free(pixel_data);
@@ -348,6 +353,7 @@ int main(int argc, char *argv[])
 		.get_length = false, //
 		.set_legnth = false, //
 		.clear = false, //
+		.save_boot_frame = false, //
 	};
 
 	if(argc <= 1){
@@ -358,31 +364,30 @@ int main(int argc, char *argv[])
 		printf("Kein Devicefile angegben!\n");
 		return 1;
 	}
-	int fd = open(arguments.device_file, O_RDWR);
-	printf("fd: %d\n",fd);
-	if(fd < 0){
+	ws2812_handle *dev = ws2812_open(arguments.device_file, 0);
+	if(dev == NULL){
 		perror("Der Devicefile konnte nicht geöfnet werden!\n");
 		return 0;
 	}
-	ws2812_init();
+	printf("fd: %d\n", ws2812_fd(dev));
 
 	if(arguments.set_legnth == true) {
 		printf("Ändere die länge auf %d\n", arguments.length);
-		ws2812_set_length(fd,  arguments.length);
+		ws2812_set_length(dev,  arguments.length);
 	}
 
 	if(arguments.new_mode != NONE){
 		printf("Ändere den Modus\n");
 		if(arguments.new_mode == STATIC){
-			ws2812_set_mode_static(fd);
+			ws2812_set_mode_static(dev);
 		}else if(arguments.new_mode == BLINK){
-			start_blink(fd, arguments.pattern_delay, arguments.pattern);
+			start_blink(dev, arguments.pattern_delay, arguments.pattern);
 		}
 	}
 
 	if(arguments.get_length == true){
 		int len = 0;
-		len = ws2812_get_length(fd);
+		len = ws2812_get_length(dev);
 		if(len < 0)  {
 			perror("Failed to update length!");
 		}else{
@@ -392,31 +397,37 @@ int main(int argc, char *argv[])
 	}
 
 	if(arguments.get_mode == true){
-		send_get_mode(fd);
+		send_get_mode(dev);
 	}
 
 	if(arguments.get_data == true){
 		printf("Daten des USB-Geräts:\n");
-		send_get_pixel_data(fd);
+		send_get_pixel_data(dev);
 	}
 
 	if(arguments.get_mode_data == true){
 		printf("Daten des Modus:\n");
-		send_get_mode_pixel_data(fd);
+		send_get_mode_pixel_data(dev);
 	}
 
 	if(arguments.led_daten != NULL){
 		printf("Update Pixeldaten\n");
-		update_pixel(fd, arguments.led_daten);
+		update_pixel(dev, arguments.led_daten);
+	}
+
+	if(arguments.save_boot_frame == true){
+		printf("Speichere Boot-Frame\n");
+		if(ws2812_save_boot_frame(dev) < 0){
+			perror("Failed to send save boot frame command!");
+		};
 	}
 
 	if(arguments.clear == true){
 		printf("Clear\n");
-		if(ws2812_clear(fd) < 0){
+		if(ws2812_clear(dev) < 0){
 			perror("Failed to send clear command!");
 		};
 	}
 
-	ws2812_deinit();
-	close(fd);
+	ws2812_close(dev);
 }
\ No newline at end of file